@@ -6,21 +6,35 @@
  */
 
 #pragma once
+#include <atomic>
+#include <cstdint>
 #include "bno055_imu.h"
 #include "drv8245.h"
+#include "flash.h"
 #include "gpio.h"
 #include "i2c.h"
 #include "motor_support/dc_motor.h"
+#include "sample_ring.h"
 
 namespace LBR
 {
 
+/// 630ms of IMU output at the 100Hz fusion rate (63 readable samples)
+using ImuHistory = Utils::SampleRing<Bno055Data, 64>;
+
 struct Board
 {
-    I2c& i2c;
+    I2c& i2c;               ///< IMU sample reads
+    I2c& housekeeping_i2c;  ///< Same bus as i2c, yields to it when queued
     Gpio& gpio;
     Bno055Data imu;
     Motor* motor;
+    /// Set by the primary IMU's data-ready interrupt. The alternate's INT
+    /// has no pin on this board, it is read on a timeout instead.
+    std::atomic<bool>& imu_ready;
+    Flash& calib_flash;      ///< Primary IMU calibration profile
+    Flash& calib_flash_alt;  ///< Alternate IMU calibration profile
+    uint32_t (*now_ms)();          ///< Monotonic millisecond clock
 };
 
 // Implementations are platform-specific (see l476_board.cc)
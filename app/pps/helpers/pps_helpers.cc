@@ -4,27 +4,22 @@
 
 namespace
 {
+// Ramped up from standstill by the motor's speed profile, no current spike
 void motorDeployImpl(LBR::Motor& motor)
 {
-    motor.motorEnable(true);
-    motor.motorDirection(true);  // true = deploy direction
-    motor.motorSpeed(100);       // Full speed
+    motor.rampSpeed(100);  // positive = deploy direction, full speed
 }
 
 void motorTargetImpl(LBR::Motor& motor)
 {
     // Example: move to a target position (implement as needed)
     // motor.moveDegrees(target_degrees, speed);
-    motor.motorEnable(true);
-    motor.motorDirection(true);  // true = target direction
-    motor.motorSpeed(100);       // Full speed
+    motor.rampSpeed(100);  // positive = target direction, full speed
 }
 
 void motorRetractImpl(LBR::Motor& motor)
 {
-    motor.motorEnable(true);
-    motor.motorDirection(false);  // false = retract direction
-    motor.motorSpeed(100);        // Full speed reverse
+    motor.rampSpeed(-100);  // negative = retract direction, full speed reverse
 }
 }  // namespace
 
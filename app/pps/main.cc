@@ -1,22 +1,130 @@
+#include "bno055_calib_store.h"
+#include "bno055_pair.h"
 #include "board.h"
 #include "pps.h"
 #include "pps_helpers.h"
 
 using LBR::Board;
 using LBR::Pps;
+using Progress = LBR::Bno055::Progress;
 
 int main()
 {
     Board& board = LBR::get_board();
-    Pps pps(board.gpio,
-            *board.motor);  // board.motor is a pointer, so dereference
+    // Every consumer reads IMU samples from here, PPS included
+    static LBR::ImuHistory imu_history;
+    Pps pps(board.gpio, *board.motor,
+            imu_history);  // board.motor is a pointer, so dereference
+    // Redundant IMUs on the same bus, only the primary's INT is wired (see
+    // Board::imu_ready)
+    LBR::Bno055 imu(board.i2c, board.housekeeping_i2c);
+    LBR::Bno055 imu_alt(board.i2c, board.housekeeping_i2c,
+                        LBR::Bno055::ADDR_ALTERNATE);
+    LBR::Bno055Pair imus(imu, imu_alt);
+
+    // Bring up the rest of the board while the IMUs boot
+    imu.start_init(board.now_ms());
+    imu_alt.start_init(board.now_ms());
+    LBR::bsp_init();
+
+    /* A sensor that fails its startup is started again. Flight goes ahead
+     * on one sensor if the other stays down, the pair never counts it as
+     * healthy. With neither, there is nothing to fly on, keep trying. */
+    static constexpr int IMU_BOOT_TRIES = 3;
+    bool imu_up = false;
+    bool imu_alt_up = false;
+    for (int tries = 1;; tries++)
+    {
+        Progress primary = Progress::PENDING;
+        Progress alternate = Progress::PENDING;
+        while (primary == Progress::PENDING || alternate == Progress::PENDING)
+        {
+            const uint32_t now = board.now_ms();
+            primary = imu.step(now);
+            alternate = imu_alt.step(now);
+        }
+        imu_up = primary == Progress::DONE;
+        imu_alt_up = alternate == Progress::DONE;
+        if ((imu_up && imu_alt_up) ||
+            ((imu_up || imu_alt_up) && tries >= IMU_BOOT_TRIES))
+        {
+            break;
+        }
+        if (!imu_up)
+        {
+            imu.start_init(board.now_ms());
+        }
+        if (!imu_alt_up)
+        {
+            imu_alt.start_init(board.now_ms());
+        }
+    }
+
+    LBR::Bno055* const sensors[] = {&imu, &imu_alt};
+    const bool sensor_up[] = {imu_up, imu_alt_up};
+    // One profile per sensor, their offsets differ
+    LBR::Bno055CalibStore calib_stores[] = {
+        LBR::Bno055CalibStore(board.calib_flash),
+        LBR::Bno055CalibStore(board.calib_flash_alt)};
+    // A sensor that stayed down never calibrates, nothing to save for it
+    bool calib_saved[] = {true, true};
+    for (size_t i = 0; i < LBR::Bno055Pair::NUM_IMUS; i++)
+    {
+        if (!sensor_up[i])
+        {
+            continue;
+        }
+        // Warm start from the last profile instead of recalibrating on the pad
+        LBR::Bno055Calibration calib{};
+        calib_saved[i] = calib_stores[i].load(calib) &&
+                         sensors[i]->write_calibration(calib);
+
+        // The pair tells new samples apart through INT_STA on both sensors
+        sensors[i]->set_data_ready_interrupt();
+        // INT may already be latched high, which would hide the next edge
+        sensors[i]->ack_interrupt();
+    }
+
+    // Polling fallback at the 100Hz output rate. The alternate's INT is not
+    // wired, this keeps it going if the primary drops out and its INT stops
+    static constexpr uint32_t IMU_POLL_MS = 10;
+    uint32_t last_poll_ms = board.now_ms();
     while (true)
     {
-        // Simulate fetching IMU data
-        LBR::Quaternion imu_data;
-        pps.fetchImuData(imu_data);
-        LBR::Vec3 accel_data;
-        pps.fetchAccelData(accel_data);
+        // Fetch exactly once per new sample instead of polling the bus
+        const uint32_t now = board.now_ms();
+        if (board.imu_ready.exchange(false, std::memory_order_acquire) ||
+            now - last_poll_ms >= IMU_POLL_MS)
+        {
+            last_poll_ms = now;
+            // Faulty, stale or outvoted samples never reach PPS
+            if (imus.update(now))
+            {
+                board.imu = imus.data();
+                imu_history.push(now, board.imu);
+                pps.fetchImuData(board.imu.quat);
+            }
+
+            // IMU mode fuses gyro and accel only, save once both converge.
+            // One attempt per sensor and boot, reading the profile halts
+            // fusion, so never on both sensors in the same cycle.
+            static constexpr uint8_t IMU_CALIBRATED =
+                LBR::Bno055::CALIB_GYR | LBR::Bno055::CALIB_ACC;
+            for (size_t i = 0; i < LBR::Bno055Pair::NUM_IMUS; i++)
+            {
+                if (!calib_saved[i] &&
+                    imus.sample(i).status.calibrated(IMU_CALIBRATED))
+                {
+                    calib_saved[i] = true;
+                    LBR::Bno055Calibration calib{};
+                    if (sensors[i]->read_calibration(calib))
+                    {
+                        calib_stores[i].save(calib);
+                    }
+                    break;
+                }
+            }
+        }
 
         // Update PPS state machine
         pps.update();
@@ -5,8 +5,37 @@
 namespace LBR
 {
 
-Motor::Motor(Drv8245& drv, Encoder& encoder) : _drv(drv), _encoder(encoder)
+/* Gains are in % duty per tick of error, assuming 1 degree = 1 tick.
+ * Starting point only, tune on the mechanism. */
+static constexpr PidGains POSITION_GAINS{3.0f, 20.0f, 0.4f};
+static constexpr float CONTROL_DT_S = 1.0f / Motor::CONTROL_RATE_HZ;
+// Smooths the 1-tick encoder steps the derivative sees at 1kHz
+static constexpr float DERIVATIVE_TAU_S = 0.01f;
+// Integrator only fights friction close in, not the whole approach
+static constexpr float INTEGRAL_ZONE_TICKS = 5.0f;
+
+/* Moves at speed 100, in ticks: 1 turn/s, full speed in 250ms, 50ms jerk
+ * ramps. max_vel scales with the requested speed. */
+static constexpr MotionLimits POSITION_LIMITS{360.0f, 1440.0f, 28800.0f};
+// Speed ramps, in % duty: 0 to 100 in 500ms with 100ms jerk ramps
+static constexpr MotionLimits SPEED_LIMITS{100.0f, 200.0f, 2000.0f};
+// A longer jerk ramp than the smoothing holds would be cut short silently
+static_assert(MotionProfile::smooth_taps(POSITION_LIMITS, CONTROL_DT_S) <=
+              MotionProfile::MAX_SMOOTH_TAPS);
+static_assert(MotionProfile::smooth_taps(SPEED_LIMITS, CONTROL_DT_S) <=
+              MotionProfile::MAX_SMOOTH_TAPS);
+// Slowest speed told apart from stopped: a tick per 500ms, 1/3 rpm
+static constexpr EncoderVelocityParams VELOCITY_PARAMS{CONTROL_DT_S, 0.5f};
+
+Motor::Motor(Drv8245& drv, Encoder& encoder)
+    : _drv(drv),
+      _encoder(encoder),
+      _position_profile(POSITION_LIMITS, CONTROL_DT_S),
+      _speed_profile(SPEED_LIMITS, CONTROL_DT_S),
+      _pid(POSITION_GAINS, CONTROL_DT_S, -100.0f, 100.0f, DERIVATIVE_TAU_S),
+      _velocity(encoder, VELOCITY_PARAMS)
 {
+    _pid.set_integral_zone(INTEGRAL_ZONE_TICKS);
 }
 
 Motor::~Motor()
@@ -48,34 +77,143 @@ void Motor::motorDirection(bool forward)
 
 void Motor::moveDegrees(int degrees, int speed)
 {
+    if (speed <= 0)
+    {
+        // A move at no speed never gets anywhere, don't start one
+        stopMove();
+        return;
+    }
+
     // Encoder
     int initial_ticks = _encoder.getTicks();
     int target_ticks =
         initial_ticks + degrees;  // Assuming 1 degree = 1 tick for
 
-    // Move motor to target degrees using encoder feedback
-    bool forward = (degrees >= 0);
-    motorDirection(forward);
+    _target_ticks.store(target_ticks, std::memory_order_relaxed);
+    _speed_limit.store(std::min(speed, 100), std::memory_order_relaxed);
+    _restart.store(true, std::memory_order_relaxed);
+    _mode.store(Mode::Position, std::memory_order_relaxed);
     motorEnable(true);
-    motorSpeed(std::abs(speed));
+    // Publishes the setpoint to controlStep()
+    _moving.store(true, std::memory_order_release);
+}
+
+void Motor::rampSpeed(int speed)
+{
+    _target_speed.store(std::clamp(speed, -100, 100),
+                        std::memory_order_relaxed);
+    _mode.store(Mode::Speed, std::memory_order_relaxed);
+    if (!_moving.load(std::memory_order_relaxed))
+    {
+        motorEnable(true);
+        _moving.store(true, std::memory_order_release);
+    }
+}
+
+bool Motor::moveDone() const
+{
+    return !_moving.load(std::memory_order_acquire);
+}
 
-    // Simple polling loop (blocking)
-    if (forward)
+void Motor::stopMove()
+{
+    // controlStep() preempts us, so once this is stored it won't drive again
+    _moving.store(false, std::memory_order_release);
+    motorSpeed(0);
+    motorEnable(false);
+}
+
+void Motor::controlStep()
+{
+    const float ticks_per_s = _velocity.update();
+    _rpm.store(ticks_per_s * 60.0f / TICKS_PER_REV, std::memory_order_relaxed);
+
+    if (!_moving.load(std::memory_order_acquire))
+    {
+        _active = Mode::Idle;
+        return;
+    }
+
+    if (_mode.load(std::memory_order_relaxed) == Mode::Speed)
     {
-        while (_encoder.getTicks() < target_ticks)
+        speedStep();
+    }
+    else
+    {
+        positionStep();
+    }
+}
+
+void Motor::positionStep()
+{
+    const int ticks = _encoder.getTicks();
+    const int target = _target_ticks.load(std::memory_order_relaxed);
+    const int speed = _speed_limit.load(std::memory_order_relaxed);
+    if (_restart.exchange(false, std::memory_order_relaxed))
+    {
+        // A new target mid-move carries on from the current setpoint
+        if (_active != Mode::Position)
         {
-            LBR::Utils::DelayMs(1);
+            _position_profile.reset(static_cast<float>(ticks));
+            _pid.reset();
         }
+        _position_profile.set_max_vel(POSITION_LIMITS.max_vel * speed /
+                                      100.0f);
+        _position_profile.move_to(static_cast<float>(target));
+        _pid.set_output_limits(-speed, speed);
+        _settle_steps = 0;
+        _active = Mode::Position;
     }
-    else
+
+    const MotionSetpoint setpoint = _position_profile.step();
+    const float output =
+        _pid.update(setpoint.pos, static_cast<float>(ticks));
+
+    // Settled once the profile ended and the position held still in the band
+    if (_position_profile.done() && std::abs(target - ticks) <= SETTLE_TICKS &&
+        (_settle_steps == 0 || ticks == _settle_at))
     {
-        while (_encoder.getTicks() > target_ticks)
+        _settle_at = ticks;
+        if (++_settle_steps >= SETTLE_STEPS)
         {
-            LBR::Utils::DelayMs(1);
+            motorSpeed(0);
+            motorEnable(false);
+            _active = Mode::Idle;
+            _moving.store(false, std::memory_order_release);
+            return;
         }
     }
-    motorSpeed(0);
-    motorEnable(false);
+    else
+    {
+        _settle_steps = 0;
+    }
+    drive(output);
+}
+
+void Motor::speedStep()
+{
+    if (_active != Mode::Speed)
+    {
+        // Ramps start from standstill
+        _speed_profile.reset(0.0f);
+        _active = Mode::Speed;
+    }
+    _speed_profile.run_at(static_cast<float>(
+        _target_speed.load(std::memory_order_relaxed)));
+    drive(_speed_profile.step().vel);
+}
+
+void Motor::drive(float output)
+{
+    // Truncates toward zero, PWM resolution is 1%
+    const int speed = static_cast<int>(output);
+    motorDirection(speed >= 0);
+    motorSpeed(speed);
+}
+
+float Motor::getRpm() const
+{
+    return _rpm.load(std::memory_order_relaxed);
 }
 
 int Motor::getTicks() const
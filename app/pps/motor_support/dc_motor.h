@@ -7,9 +7,13 @@
  * @date 2025/12/31
  */
 
-#include "delay.h"
+#include <atomic>
+#include <cstdint>
 #include "drv8245.h"  //PPS motor driver
 #include "encoder.h"
+#include "encoder_velocity.h"
+#include "motion_profile.h"
+#include "pid.h"
 /* #include "drv8874.h" - Auger motor driver */
 
 namespace LBR
@@ -18,6 +22,9 @@ namespace LBR
 class Motor
 {
 public:
+    static constexpr uint32_t CONTROL_RATE_HZ = 1000;  // controlStep() rate
+    static constexpr float TICKS_PER_REV = 360.0f;     // 1 degree = 1 tick
+
     Motor(Drv8245& drv, Encoder& encoder);
     ~Motor();
 
@@ -51,11 +58,47 @@ public:
     /**
 	* @brief Move motor a specific number of degrees at given speed (encoder feedback)
 	* @param degrees Number of degrees to move (positive or negative)
-	* @param speed Speed value from 0 to 100
-	* @note Uses encoder feedback to move specified degrees
+	* @param speed Speed limit from 1 to 100, 0 or less stops the motor and
+	*        completes at once, see stopMove()
+	* @note Only sets the target and returns. controlStep() tracks an S-curve
+	*       profile towards it on the encoder. Poll moveDone() for completion.
 	*/
     virtual void moveDegrees(int degrees, int speed);
 
+    /**
+	* @brief Ramp to a constant speed, open loop
+	* @param speed Speed value from -100 to 100 (negative for reverse)
+	* @note Safe to call every loop with the same speed. controlStep() ramps
+	*       the duty cycle under SPEED_LIMITS instead of stepping it.
+	*/
+    void rampSpeed(int speed);
+
+    /**
+	* @brief Check if the last moveDegrees() target is reached
+	* @return true once the position held still within SETTLE_TICKS for
+	*         SETTLE_STEPS control steps, or if no move was started
+	*/
+    bool moveDone() const;
+
+    /**
+	* @brief Abandon the current move or ramp and stop the motor
+	*/
+    void stopMove();
+
+    /**
+	* @brief One profile step, then PID position control or the speed ramp
+	* @note Call at CONTROL_RATE_HZ from a timer interrupt that preempts
+	*       every caller of moveDegrees()/rampSpeed()/stopMove(). Only
+	*       measures the speed while idle.
+	*/
+    void controlStep();
+
+    /**
+	* @brief Shaft speed measured by controlStep()
+	* @return revolutions per minute, negative in reverse
+	*/
+    float getRpm() const;
+
     /**
 	* @brief Get current encoder ticks
 	* @param ticks Reference to store current encoder ticks
@@ -71,11 +114,43 @@ public:
     virtual int getStatus() const;
 
 private:
+    static constexpr int SETTLE_TICKS = 1;
+    static constexpr uint32_t SETTLE_STEPS = 20;  // 20ms at CONTROL_RATE_HZ
+
+    enum class Mode : uint8_t
+    {
+        Idle,
+        Position,
+        Speed
+    };
+
+    void positionStep();
+    void speedStep();
+    void drive(float output);
+
     Drv8245& _drv;
     Encoder& _encoder;
 
     bool _initialized{false};
     int _status{0};  // 0 = OK, nonzero = error code
+
+    // Shared with controlStep(), written by moveDegrees()/rampSpeed()/stopMove()
+    std::atomic<int> _target_ticks{0};
+    std::atomic<int> _speed_limit{0};
+    std::atomic<int> _target_speed{0};
+    std::atomic<Mode> _mode{Mode::Idle};
+    std::atomic<bool> _moving{false};
+    std::atomic<bool> _restart{false};
+
+    // Owned by controlStep()
+    Mode _active{Mode::Idle};  // What the last step ran, Idle once stopped
+    MotionProfile _position_profile;
+    MotionProfile _speed_profile;
+    PidController _pid;
+    uint32_t _settle_steps{0};
+    int _settle_at{0};  // Position the settle window started at
+    EncoderVelocity _velocity;
+    std::atomic<float> _rpm{0.0f};
 };
 
 }  // namespace LBR
\ No newline at end of file
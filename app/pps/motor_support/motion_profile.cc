@@ -0,0 +1,140 @@
+#include "motion_profile.h"
+#include <algorithm>
+#include <cmath>
+
+namespace LBR
+{
+
+MotionProfile::MotionProfile(const MotionLimits& limits, float dt_s)
+    : limits_(limits),
+      dt_s_(dt_s),
+      num_taps_(std::min(smooth_taps(limits, dt_s), MAX_SMOOTH_TAPS))
+{
+    reset(0.0f);
+}
+
+void MotionProfile::reset(float pos)
+{
+    pos_ = pos;
+    vel_ = 0.0f;
+    target_ = pos;
+    velocity_mode_ = false;
+    idle_steps_ = num_taps_;
+
+    std::fill_n(tap_pos_, num_taps_, pos);
+    std::fill_n(tap_vel_, num_taps_, 0.0f);
+    tap_head_ = 0;
+    sum_pos_ = pos * num_taps_;
+    sum_vel_ = 0.0f;
+    out_ = MotionSetpoint{pos, 0.0f};
+}
+
+void MotionProfile::move_to(float target)
+{
+    target_ = target;
+    velocity_mode_ = false;
+}
+
+void MotionProfile::run_at(float vel)
+{
+    target_ = vel;
+    velocity_mode_ = true;
+}
+
+void MotionProfile::set_max_vel(float max_vel)
+{
+    limits_.max_vel = max_vel;
+}
+
+MotionSetpoint MotionProfile::step()
+{
+    const float prev_pos = pos_;
+    const float prev_vel = vel_;
+    step_trapezoid();
+    // Holding a velocity still moves the position
+    const bool changed =
+        vel_ != prev_vel || (!velocity_mode_ && pos_ != prev_pos);
+    idle_steps_ = changed ? 0 : std::min(idle_steps_ + 1, num_taps_);
+
+    push_tap(pos_, vel_);
+    out_ = MotionSetpoint{sum_pos_ / num_taps_, sum_vel_ / num_taps_};
+    if (idle_steps_ >= num_taps_)
+    {
+        // Every tap holds the same sample, skip the rounding of the average
+        out_.vel = vel_;
+        if (!velocity_mode_)
+        {
+            out_.pos = pos_;
+        }
+    }
+    return out_;
+}
+
+bool MotionProfile::done() const
+{
+    const bool reached = velocity_mode_
+                             ? vel_ == target_
+                             : (pos_ == target_ && vel_ == 0.0f);
+    return reached && idle_steps_ >= num_taps_;
+}
+
+void MotionProfile::step_trapezoid()
+{
+    float vel_target;
+    if (velocity_mode_)
+    {
+        vel_target = std::clamp(target_, -limits_.max_vel, limits_.max_vel);
+    }
+    else
+    {
+        /* Fastest speed that can still brake to a stop at the target. In
+         * ticks of dv = A dt braking from v covers v^2 / 2A + v dt / 2,
+         * one dv more than the continuous v^2 / 2A. */
+        const float dist = target_ - pos_;
+        const float half_dv = 0.5f * limits_.max_accel * dt_s_;
+        const float brake_vel =
+            std::sqrt(half_dv * half_dv +
+                      2.0f * limits_.max_accel * std::fabs(dist)) -
+            half_dv;
+        vel_target = std::copysign(std::min(limits_.max_vel, brake_vel), dist);
+    }
+
+    const float dv = limits_.max_accel * dt_s_;
+    vel_ += std::clamp(vel_target - vel_, -dv, dv);
+
+    if (!velocity_mode_)
+    {
+        // Land exactly instead of stepping across the target
+        const float dist = target_ - pos_;
+        if (dist * vel_ >= 0.0f && std::fabs(dist) <= std::fabs(vel_) * dt_s_)
+        {
+            pos_ = target_;
+            vel_ = 0.0f;
+            return;
+        }
+    }
+    pos_ += vel_ * dt_s_;
+}
+
+void MotionProfile::push_tap(float pos, float vel)
+{
+    sum_pos_ += pos - tap_pos_[tap_head_];
+    sum_vel_ += vel - tap_vel_[tap_head_];
+    tap_pos_[tap_head_] = pos;
+    tap_vel_[tap_head_] = vel;
+
+    if (++tap_head_ == num_taps_)
+    {
+        // Running sums drift in float, re-add once per lap
+        tap_head_ = 0;
+        sum_pos_ = 0.0f;
+        sum_vel_ = 0.0f;
+        for (size_t i = 0; i < num_taps_; i++)
+        {
+            sum_pos_ += tap_pos_[i];
+            sum_vel_ += tap_vel_[i];
+        }
+    }
+}
+
+}  // namespace LBR
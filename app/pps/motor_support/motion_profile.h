@@ -0,0 +1,129 @@
+#pragma once
+/**
+ * @file motion_profile.h
+ * @brief Trapezoidal / S-curve setpoint generator for motor moves
+ * @note Computed one tick at a time in fixed memory, so it can run inside
+ *       the control interrupt. Units are whatever the caller uses (ticks,
+ *       % duty, ...), per second.
+ * @date 10/17/2026
+ */
+
+#include <cstddef>
+
+namespace LBR
+{
+
+struct MotionLimits
+{
+    float max_vel;
+    float max_accel;
+    float max_jerk;  // 0 for a plain trapezoid
+};
+
+struct MotionSetpoint
+{
+    float pos;
+    float vel;
+};
+
+/**
+ * @class MotionProfile
+ * @brief Online profile towards a position or a velocity
+ * @details A trapezoid is generated each tick at the velocity and
+ *          acceleration limits: accelerate until max_vel or until the
+ *          braking distance reaches the target. It then goes through a
+ *          moving average of max_accel / max_jerk seconds. That bounds
+ *          jerk (the S-curve) and keeps the final position exact, at the
+ *          cost of finishing that much later. The average is capped at
+ *          MAX_SMOOTH_TAPS ticks, a lower jerk limit is not reached.
+ * @note Jerk doubles where acceleration reverses with no cruise between,
+ *       and the last tick of a move may drop up to 2 * max_accel * dt of
+ *       velocity.
+ */
+class MotionProfile
+{
+public:
+    static constexpr size_t MAX_SMOOTH_TAPS = 128;
+
+    /**
+     * @brief Moving average length that meets limits' jerk at dt_s, before
+     *        the MAX_SMOOTH_TAPS cap
+     */
+    static constexpr size_t smooth_taps(const MotionLimits& limits, float dt_s)
+    {
+        // Averaging over T turns an acceleration step into a ramp of A / T
+        if (limits.max_jerk <= 0.0f)
+        {
+            return 1;
+        }
+        const float taps = limits.max_accel / (limits.max_jerk * dt_s) + 0.5f;
+        return taps < 1.0f ? 1 : static_cast<size_t>(taps);
+    }
+
+    /**
+     * @param dt_s tick period step() is called at
+     */
+    MotionProfile(const MotionLimits& limits, float dt_s);
+
+    /**
+     * @brief At rest at pos, drops any move in progress
+     */
+    void reset(float pos);
+
+    /**
+     * @brief Heads for target from the current state, also mid-move
+     */
+    void move_to(float target);
+
+    /**
+     * @brief Ramps to a constant velocity and holds it
+     */
+    void run_at(float vel);
+
+    /**
+     * @note Takes effect from the next tick, smoothing is unchanged
+     */
+    void set_max_vel(float max_vel);
+
+    /**
+     * @brief Advances one tick
+     * @return setpoint for this tick
+     */
+    MotionSetpoint step();
+
+    const MotionSetpoint& setpoint() const
+    {
+        return out_;
+    }
+
+    /**
+     * @brief Target position (or velocity) reached and smoothing drained
+     */
+    bool done() const;
+
+private:
+    void step_trapezoid();
+    void push_tap(float pos, float vel);
+
+    MotionLimits limits_;
+    float dt_s_;
+    size_t num_taps_;
+
+    // Unsmoothed trapezoid
+    float pos_{0.0f};
+    float vel_{0.0f};
+    float target_{0.0f};
+    bool velocity_mode_{false};
+    size_t idle_steps_{0};  // Ticks since the trapezoid stopped changing
+
+    // Moving average over the last num_taps_ trapezoid samples
+    float tap_pos_[MAX_SMOOTH_TAPS]{};
+    float tap_vel_[MAX_SMOOTH_TAPS]{};
+    size_t tap_head_{0};
+    float sum_pos_{0.0f};
+    float sum_vel_{0.0f};
+
+    MotionSetpoint out_{};
+};
+
+}  // namespace LBR
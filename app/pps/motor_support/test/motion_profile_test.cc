@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include "motion_profile.h"
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+using namespace LBR;
+
+namespace
+{
+
+constexpr float DT_S = 1e-3f;  // Motor::CONTROL_RATE_HZ
+constexpr MotionLimits TRAPEZOID{360.0f, 1440.0f, 0.0f};
+constexpr MotionLimits S_CURVE{360.0f, 1440.0f, 28800.0f};
+constexpr size_t MAX_TICKS = 100'000;
+
+struct MoveStats
+{
+    size_t ticks{0};
+    float max_vel{0.0f};
+    float max_accel{0.0f};  ///< Excluding the last tick, see the class note
+    float max_jerk{0.0f};
+    float overshoot{0.0f};
+};
+
+MoveStats run_move(MotionProfile& profile, float start, float target)
+{
+    MoveStats stats;
+    profile.reset(start);
+    profile.move_to(target);
+    const float dir = (target >= start) ? 1.0f : -1.0f;
+    float prev_vel = 0.0f;
+    float prev_accel = 0.0f;
+    while (!profile.done() && stats.ticks < MAX_TICKS)
+    {
+        const MotionSetpoint s = profile.step();
+        const float accel = (s.vel - prev_vel) / DT_S;
+        const float jerk = (accel - prev_accel) / DT_S;
+        stats.ticks++;
+        if (!profile.done())
+        {
+            stats.max_accel = std::fmax(stats.max_accel, std::fabs(accel));
+            stats.max_jerk = std::fmax(stats.max_jerk, std::fabs(jerk));
+        }
+        stats.max_vel = std::fmax(stats.max_vel, std::fabs(s.vel));
+        stats.overshoot =
+            std::fmax(stats.overshoot, dir * (s.pos - target));
+        prev_vel = s.vel;
+        prev_accel = accel;
+    }
+    return stats;
+}
+
+class MotionProfileMoves : public ::testing::TestWithParam<float>
+{
+};
+
+TEST_P(MotionProfileMoves, TrapezoidEndsExactlyWithinLimits)
+{
+    const float distance = GetParam();
+    MotionProfile profile(TRAPEZOID, DT_S);
+    const MoveStats stats = run_move(profile, 10.0f, 10.0f + distance);
+    ASSERT_TRUE(profile.done());
+    EXPECT_FLOAT_EQ(profile.setpoint().pos, 10.0f + distance);
+    EXPECT_FLOAT_EQ(profile.setpoint().vel, 0.0f);
+    EXPECT_LE(stats.overshoot, 1e-3f);
+    EXPECT_LE(stats.max_vel, TRAPEZOID.max_vel * 1.001f);
+}
+
+TEST_P(MotionProfileMoves, SCurveEndsExactlyWithinLimits)
+{
+    const float distance = GetParam();
+    MotionProfile profile(S_CURVE, DT_S);
+    const MoveStats stats = run_move(profile, 10.0f, 10.0f + distance);
+    ASSERT_TRUE(profile.done());
+    EXPECT_FLOAT_EQ(profile.setpoint().pos, 10.0f + distance);
+    EXPECT_LE(stats.overshoot, 1e-3f);
+    EXPECT_LE(stats.max_vel, S_CURVE.max_vel * 1.001f);
+    EXPECT_LE(stats.max_accel, S_CURVE.max_accel * 1.05f);
+    // Doubles where acceleration reverses with no cruise between
+    EXPECT_LE(stats.max_jerk, 2.0f * S_CURVE.max_jerk * 1.05f);
+}
+
+INSTANTIATE_TEST_SUITE_P(Distances, MotionProfileMoves,
+                         ::testing::Values(90.0f, -7.0f, 1000.0f, 0.4f,
+                                           -360.0f));
+
+TEST(MotionProfileTest, LongMoveTakesTheTheoreticalTime)
+{
+    // Cruise d / v plus one ramp v / a, the S-curve adds its average
+    constexpr float distance = 1000.0f;
+    const float trapezoid_s =
+        distance / TRAPEZOID.max_vel + TRAPEZOID.max_vel / TRAPEZOID.max_accel;
+
+    MotionProfile trapezoid(TRAPEZOID, DT_S);
+    EXPECT_NEAR(run_move(trapezoid, 0.0f, distance).ticks * DT_S,
+                trapezoid_s, 2 * DT_S);
+
+    MotionProfile s_curve(S_CURVE, DT_S);
+    const float smoothing_s = S_CURVE.max_accel / S_CURVE.max_jerk;
+    EXPECT_NEAR(run_move(s_curve, 0.0f, distance).ticks * DT_S,
+                trapezoid_s + smoothing_s, 2 * DT_S);
+}
+
+TEST(MotionProfileTest, RetargetMidMoveEndsAtTheNewTarget)
+{
+    MotionProfile profile(S_CURVE, DT_S);
+    profile.reset(0.0f);
+    profile.move_to(300.0f);
+    for (int i = 0; i < 200; i++)
+    {
+        profile.step();
+    }
+    profile.move_to(-50.0f);
+    size_t ticks = 0;
+    while (!profile.done() && ticks < MAX_TICKS)
+    {
+        profile.step();
+        ticks++;
+    }
+    ASSERT_TRUE(profile.done());
+    EXPECT_FLOAT_EQ(profile.setpoint().pos, -50.0f);
+}
+
+TEST(MotionProfileTest, VelocityRampsAndHolds)
+{
+    constexpr MotionLimits SPEED{100.0f, 200.0f, 2000.0f};
+    MotionProfile profile(SPEED, DT_S);
+    profile.reset(0.0f);
+    profile.run_at(100.0f);
+    size_t ticks = 0;
+    float max_accel = 0.0f;
+    float prev_vel = 0.0f;
+    while (!profile.done() && ticks < MAX_TICKS)
+    {
+        const float vel = profile.step().vel;
+        max_accel = std::fmax(max_accel, (vel - prev_vel) / DT_S);
+        prev_vel = vel;
+        ticks++;
+    }
+    EXPECT_FLOAT_EQ(profile.setpoint().vel, 100.0f);
+    EXPECT_LE(max_accel, SPEED.max_accel * 1.001f);
+    // v / a to ramp, plus a / j of smoothing
+    EXPECT_NEAR(ticks * DT_S, 0.5f + 0.1f, 2 * DT_S);
+
+    for (int i = 0; i < 100; i++)
+    {
+        EXPECT_FLOAT_EQ(profile.step().vel, 100.0f);
+    }
+
+    profile.run_at(-50.0f);
+    while (!profile.done() && ticks < 2 * MAX_TICKS)
+    {
+        profile.step();
+        ticks++;
+    }
+    EXPECT_FLOAT_EQ(profile.setpoint().vel, -50.0f);
+}
+
+TEST(MotionProfileTest, SmoothingIsCappedAtMaxTaps)
+{
+    // Would need 1000 taps at 1kHz
+    EXPECT_EQ(MotionProfile::smooth_taps({360.0f, 1440.0f, 1440.0f}, DT_S),
+              1000u);
+    EXPECT_EQ(MotionProfile::smooth_taps(TRAPEZOID, DT_S), 1u);
+    EXPECT_EQ(MotionProfile::smooth_taps(S_CURVE, DT_S), 50u);
+
+    MotionProfile capped({360.0f, 1440.0f, 1440.0f}, DT_S);
+    run_move(capped, 0.0f, 100.0f);
+    ASSERT_TRUE(capped.done());
+    EXPECT_FLOAT_EQ(capped.setpoint().pos, 100.0f);
+}
+
+// Host cost of one control tick, printed for comparison with the M4 budget
+TEST(MotionProfileTest, CostPerTick)
+{
+    constexpr int MOVES = 500;
+    constexpr int TICKS_PER_MOVE = 2000;
+    MotionProfile profile(S_CURVE, DT_S);
+    profile.reset(0.0f);
+    float sink = 0.0f;
+
+    const auto start = std::chrono::steady_clock::now();
+#if defined(__x86_64__)
+    const uint64_t start_tsc = __rdtsc();
+#endif
+    for (int m = 0; m < MOVES; m++)
+    {
+        profile.move_to((m & 1) ? 0.0f : 500.0f);
+        for (int i = 0; i < TICKS_PER_MOVE; i++)
+        {
+            sink += profile.step().pos;
+        }
+    }
+    constexpr double TICKS = static_cast<double>(MOVES) * TICKS_PER_MOVE;
+#if defined(__x86_64__)
+    const double cycles = (__rdtsc() - start_tsc) / TICKS;
+#else
+    const double cycles = 0.0;
+#endif
+    const double ns = std::chrono::duration<double, std::nano>(
+                          std::chrono::steady_clock::now() - start)
+                          .count() /
+                      TICKS;
+    std::printf("MotionProfile::step %.1f TSC cycles %.1f ns per tick\n",
+                cycles, ns);
+    EXPECT_TRUE(std::isfinite(sink));
+}
+
+}  // namespace
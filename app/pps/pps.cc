@@ -3,7 +3,8 @@
 namespace LBR
 {
 
-Pps::Pps(Gpio& gpio, Motor& motor) : gpio_(gpio), motor_(motor)
+Pps::Pps(Gpio& gpio, Motor& motor, const ImuHistory& history)
+    : gpio_(gpio), motor_(motor), history_(history)
 {
 }
 
@@ -18,12 +19,6 @@ void Pps::fetchImuData(const LBR::Quaternion& data)
     state_quat_ = data;
 }
 
-void Pps::fetchAccelData(const LBR::Vec3& data)
-{
-    // Store acceleration data from IMU
-    state_accel_ = data;
-}
-
 void Pps::update()
 {
 
@@ -45,7 +40,7 @@ void Pps::update()
             motorDeploy();
             if (readLimitSwitch() == LimitSwitchState::extended)
             {
-                motor_.motorEnable(false);
+                motor_.stopMove();
                 // After deploying, rotate
                 state_ = PpsState::Rotating;
             }
@@ -55,7 +50,7 @@ void Pps::update()
             motorTarget();  // Determine the target position
             if (rotationComplete())
             {
-                motor_.motorEnable(false);
+                motor_.stopMove();
                 state_ = PpsState::Idle;
             }
             break;
@@ -64,7 +59,7 @@ void Pps::update()
             motorRetract();
             if (readLimitSwitch() == LimitSwitchState::retracted)
             {
-                motor_.motorEnable(false);
+                motor_.stopMove();
                 state_ = PpsState::Idle;
             }
             break;
@@ -103,24 +98,46 @@ bool Pps::deploy()
 bool Pps::retracted()
 {
     // Use limit switch and IMU acceleration to determine if retracted
-    static LBR::Vec3 prev_accel = {0, 0, 0};
-    LBR::Vec3 accel = state_accel_;
+    static constexpr uint32_t STILL_WINDOW_MS = 100;  // 10 samples at 100Hz
 
-    if (readLimitSwitch() == LimitSwitchState::retracted)
+    if (readLimitSwitch() != LimitSwitchState::retracted)
     {
-        // Check if mechanism is moving (acceleration changed)
-        float delta = (accel.x - prev_accel.x) * (accel.x - prev_accel.x) +
-                      (accel.y - prev_accel.y) * (accel.y - prev_accel.y) +
-                      (accel.z - prev_accel.z) * (accel.z - prev_accel.z);
-        prev_accel = accel;
-        // If not moving (delta is small), we are truly retracted
-        if (delta < 0.01f)
+        return false;
+    }
+
+    ImuHistory::Sample newest;
+    if (!history_.get(0, newest))
+    {
+        return false;
+    }
+    const ImuHistory::View recent =
+        history_.window(newest.stamp_ms, STILL_WINDOW_MS);
+    ImuHistory::Sample prev;
+    if (recent.size() < 2 || !recent.get(0, prev))
+    {
+        return false;
+    }
+
+    // Check if mechanism is moving (acceleration changed between samples)
+    for (size_t i = 1; i < recent.size(); i++)
+    {
+        ImuHistory::Sample sample;
+        if (!recent.get(i, sample))
+        {
+            return false;
+        }
+        const LBR::Vec3& a = prev.value.accel;
+        const LBR::Vec3& b = sample.value.accel;
+        float delta = (a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y) +
+                      (a.z - b.z) * (a.z - b.z);
+        if (delta >= 0.01f)
         {
-            return true;
+            return false;
         }
+        prev = sample;
     }
-    prev_accel = state_accel_;
-    return false;
+    // Not moving (every delta is small), we are truly retracted
+    return true;
 }
 
 bool Pps::rotationComplete()
@@ -25,20 +25,18 @@ enum class PpsState
 class Pps
 {
     LBR::Quaternion state_quat_{};
-    LBR::Vec3 state_accel_{};
 
 public:
     PpsState getState() const;
-    Pps(Gpio& gpio, Motor& motor);
+    Pps(Gpio& gpio, Motor& motor, const ImuHistory& history);
     void fetchImuData(
         const LBR::Quaternion& data);  // Fetch IMU data for quaternion
-    void fetchAccelData(
-        const LBR::Vec3& data);  // Fetch IMU data for acceleration
-    void update();               // State machine update, no IMU arg
+    void update();                     // State machine update, no IMU arg
 
 private:
     Gpio& gpio_;
     Motor& motor_;
+    const ImuHistory& history_;  // Shared IMU samples, filled by main
 
     PpsState state_ = PpsState::Idle;  // Initial state is Idle
 
@@ -65,6 +63,8 @@ private:
      * @brief Check if mechanism is retracted. 
      * @return true if retracted, false otherwise.
      * @note Used to determine when to transition from Retract to Done state.
+     * @note Still means acceleration steady over the last STILL_WINDOW_MS
+     *       of IMU history.
      */
     bool retracted();
 
@@ -1,10 +1,16 @@
+#include <atomic>
 #include <cstdint>
 #include "board.h"
+#include "i2c_arbiter.h"
 #include "motor_support/dc_motor.h"
 #include "st_encoder.h"
+#include "st_flash.h"
 #include "st_gpio.h"
 #include "st_i2c.h"
 #include "st_pwm.h"
+#include "st_quad_decoder.h"
+#include "st_timer.h"
+#include "stm32l4xx_hal.h"
 
 namespace LBR
 {
@@ -67,6 +73,24 @@ Stml4::StGpioSettings dbg_rx_settings{
     Stml4::GpioOspeed::HIGH, Stml4::GpioPupd::NO_PULL, 0};
 const Stml4::StGpioParams dbg_rx_params{dbg_rx_settings, 7, GPIOB};
 
+// I2C1_SCL (PB8) & I2C1_SDA (PB9) pin config, pulled up on the board
+Stml4::StGpioSettings i2c_scl_settings{
+    Stml4::GpioMode::ALT_FUNC, Stml4::GpioOtype::OPEN_DRAIN,
+    Stml4::GpioOspeed::HIGH, Stml4::GpioPupd::NO_PULL, 4};
+const Stml4::StGpioParams i2c_scl_params{i2c_scl_settings, 8, GPIOB};
+
+Stml4::StGpioSettings i2c_sda_settings{
+    Stml4::GpioMode::ALT_FUNC, Stml4::GpioOtype::OPEN_DRAIN,
+    Stml4::GpioOspeed::HIGH, Stml4::GpioPupd::NO_PULL, 4};
+const Stml4::StGpioParams i2c_sda_params{i2c_sda_settings, 9, GPIOB};
+
+// IMU_INT (PB0) pin config, BNO055 INT is push-pull active high. Only the
+// primary IMU's INT is routed to the MCU, the alternate is polled.
+Stml4::StGpioSettings imu_int_settings{
+    Stml4::GpioMode::INPUT, Stml4::GpioOtype::PUSH_PULL, Stml4::GpioOspeed::LOW,
+    Stml4::GpioPupd::PULL_DOWN, 0};
+const Stml4::StGpioParams imu_int_params{imu_int_settings, 0, GPIOB};
+
 // ADC Pins
 // CS_PADC (PC0)
 Stml4::StGpioSettings cs_padc_settings{
@@ -142,43 +166,103 @@ Stml4::HwGpio gpio_dbg_red(dbg_red_params);
 Stml4::HwGpio gpio_dbg_blue(dbg_blue_params);
 Stml4::HwGpio gpio_dbg_green(dbg_green_params);
 
-Stml4::HwGpio gpio_enc_a_l(enc_a_l_params);
-Stml4::HwGpio gpio_enc_b_l(enc_b_l_params);
-
 Stml4::HwGpio gpio_drv_fault(drv_fault_params);
 Stml4::HwGpio gpio_mtr_slp(mtr_slp_params);
 Stml4::HwGpio gpio_drv_z(drv_z_params);
 
+Stml4::HwGpio gpio_imu_int(imu_int_params);
+
+Stml4::HwGpio gpio_i2c_scl(i2c_scl_params);
+Stml4::HwGpio gpio_i2c_sda(i2c_sda_params);
+
 static Bno055Data imu_hw = {};
+static std::atomic<bool> imu_ready{false};
 // Use an existing GPIO as the board's main GPIO interface
 Gpio& board_gpio = gpio_lmt_swt;
 
 // I2C hardware setup (example values, adjust as needed)
-Stml4::StI2cParams i2c_params{I2C1, 0x10909CEC};
+/* Board runs off the 4Mhz reset clock, which also feeds I2C1 through PCLK1 */
+constexpr uint32_t i2c_timingr{
+    Stml4::compute_timingr(4'000'000, Stml4::I2cSpeed::STANDARD)};
+static_assert(i2c_timingr != 0);
+// The pins let recover() clock a stuck slave off SDA, timeouts run on the
+// SysTick that bsp_init() starts before i2c_hw.init()
+Stml4::StI2cParams i2c_params{I2C1, i2c_timingr, true, 10, &i2c_scl_params,
+                              &i2c_sda_params, HAL_GetTick};
 Stml4::HwI2c i2c_hw(i2c_params);
 
-// Motor and IMU objects (still dummy for now)
-Motor motor_hw{*(Drv8245*)nullptr, *(Encoder*)nullptr};
+// Drivers share I2C1 through the arbiter, IMU data goes first
+I2cArbiter i2c_arbiter(i2c_hw, HAL_GetTick);
+I2cClient imu_i2c(i2c_arbiter, I2cPriority::HIGH);
+// Startup, calibration and status
+I2cClient housekeeping_i2c(i2c_arbiter, I2cPriority::LOW);
+
+// Last two flash pages, kept out of the FLASH region by the linker script
+Stml4::StFlashParams calib_flash_params{0x080FF800, 100};
+Stml4::HwFlash calib_flash(calib_flash_params);
+Stml4::StFlashParams calib_flash_alt_params{0x080FF000, 100};
+Stml4::HwFlash calib_flash_alt(calib_flash_alt_params);
+
+// Level with I2C, a late edge interrupt loses counts
+static constexpr uint32_t ENCODER_PRIORITY = 0;
+
+// PC4/PC5 have no timer encoder mode, decoded from their EXTI lines
+Stml4::StQuadDecoderParams motor_encoder_params{enc_a_l_params, enc_b_l_params,
+                                                ENCODER_PRIORITY};
+Stml4::HwQuadDecoder motor_encoder(motor_encoder_params);
+
+// Motor and IMU objects (driver still dummy for now)
+Motor motor_hw{*(Drv8245*)nullptr, motor_encoder};
+
+// Fixed-rate motor position loop, TIM6 has no pins to conflict with
+Stml4::StTimerParams control_timer_params{TIM6, Motor::CONTROL_RATE_HZ};
+Stml4::HwTimer control_timer(control_timer_params);
 
 // Construct the Board object with real hardware objects
-static Board board{i2c_hw, board_gpio, imu_hw, &motor_hw};
+static Board board{imu_i2c,     housekeeping_i2c, board_gpio,
+                   imu_hw,      &motor_hw,        imu_ready,
+                   calib_flash, calib_flash_alt,  HAL_GetTick};
 
 // Forward declarations for Motor& overloads (defined in helpers)
 void motorDeploy(Motor&);
 void motorTarget(Motor&);
 void motorRetract(Motor&);
 
+static void imu_data_ready(void*)
+{
+    imu_ready.store(true, std::memory_order_release);
+}
+
+static void motor_control_tick(void* ctx)
+{
+    static_cast<Motor*>(ctx)->controlStep();
+}
+
+// Below the I2C interrupts so a sample edge never stalls a transfer
+static constexpr uint32_t IMU_INT_PRIORITY = 5;
+// Right below I2C, a late control step is jitter in the loop
+static constexpr uint32_t MOTOR_CONTROL_PRIORITY = 1;
+
 bool bsp_init()
 {
+    // 1ms SysTick behind Board::now_ms, the IMU startup runs on it
+    HAL_Init();
+
     // Enable peripheral clocks
     RCC->AHB2ENR |= RCC_AHB2ENR_GPIOAEN;
     RCC->AHB2ENR |= RCC_AHB2ENR_GPIOBEN;
     RCC->AHB2ENR |= RCC_AHB2ENR_GPIOCEN;
     RCC->AHB2ENR |= RCC_AHB2ENR_GPIODEN;
+    RCC->APB1ENR1 |= RCC_APB1ENR1_I2C1EN;
 
     // Initialize GPIOs
     bool ret = true;
 
+    // I2C1 first, the IMU startup steps run right after bsp_init()
+    ret = ret && gpio_i2c_scl.init();
+    ret = ret && gpio_i2c_sda.init();
+    ret = ret && i2c_hw.init();
+
     ret = ret && gpio_lmt_swt.init();
     ret = ret && gpio_rs_en.init();
     ret = ret && gpio_mtr_dir2.init();
@@ -188,13 +272,21 @@ bool bsp_init()
     ret = ret && gpio_dbg_blue.init();
     ret = ret && gpio_dbg_green.init();
 
-    ret = ret && gpio_enc_a_l.init();
-    ret = ret && gpio_enc_b_l.init();
+    ret = ret && motor_encoder.init();
 
     ret = ret && gpio_drv_fault.init();
     ret = ret && gpio_mtr_slp.init();
     ret = ret && gpio_drv_z.init();
 
+    ret = ret && gpio_imu_int.init();
+    ret = ret && gpio_imu_int.enable_irq(Stml4::GpioEdge::RISING,
+                                         imu_data_ready, nullptr,
+                                         IMU_INT_PRIORITY);
+
+    ret = ret && control_timer.init();
+    ret = ret && control_timer.start(motor_control_tick, &motor_hw,
+                                     MOTOR_CONTROL_PRIORITY);
+
     return ret;
 }
 
@@ -204,3 +296,48 @@ Board& get_board()
 }
 
 }  // namespace LBR
+
+extern "C"
+{
+    // Here and not only in st_sys_clock.cc, the app never pulls that object
+    // in from the hal archive and the tick would land in Default_Handler
+    void SysTick_Handler()
+    {
+        HAL_IncTick();
+    }
+
+    void I2C1_EV_IRQHandler()
+    {
+        LBR::i2c_hw.ev_irq_handler();
+    }
+
+    void I2C1_ER_IRQHandler()
+    {
+        LBR::i2c_hw.er_irq_handler();
+    }
+
+    void DMA1_Channel7_IRQHandler()
+    {
+        LBR::i2c_hw.dma_irq_handler();
+    }
+
+    void EXTI0_IRQHandler()
+    {
+        LBR::Stml4::HwGpio::exti_irq_handler(0, 0);
+    }
+
+    void EXTI4_IRQHandler()
+    {
+        LBR::Stml4::HwGpio::exti_irq_handler(4, 4);
+    }
+
+    void EXTI9_5_IRQHandler()
+    {
+        LBR::Stml4::HwGpio::exti_irq_handler(5, 9);
+    }
+
+    void TIM6_DAC_IRQHandler()
+    {
+        LBR::control_timer.irq_handler();
+    }
+}
@@ -90,6 +90,7 @@ function(add_tests LINK_LIB)#Changethis so you enter full file name and not appe
 
         include(CTest)
         include(GoogleTest)
+        find_package(GTest REQUIRED)
 
         foreach(SRC_NAME ${ARGN})
 
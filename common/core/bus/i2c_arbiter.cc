@@ -0,0 +1,206 @@
+#include "i2c_arbiter.h"
+
+namespace LBR
+{
+
+static constexpr size_t index_of(I2cPriority priority)
+{
+    return static_cast<size_t>(priority);
+}
+
+I2cArbiter::I2cArbiter(I2c& bus, TickFn now) : _bus(bus), _now(now) {}
+
+bool I2cArbiter::submit(I2cRequest& req)
+{
+    if (req.ops.empty() || req.priority >= I2cPriority::COUNT)
+    {
+        return false;
+    }
+
+    req.next = nullptr;
+    req.enqueue_tick = _now();
+
+    Queue& queue = _queues[index_of(req.priority)];
+    if (queue.tail)
+    {
+        queue.tail->next = &req;
+    }
+    else
+    {
+        queue.head = &req;
+    }
+    queue.tail = &req;
+
+    I2cQueueStats& stats = _stats[index_of(req.priority)];
+    stats.depth++;
+    if (stats.depth > stats.max_depth)
+    {
+        stats.max_depth = stats.depth;
+    }
+    return true;
+}
+
+bool I2cArbiter::poll()
+{
+    if (_active)
+    {
+        return false;
+    }
+
+    I2cRequest* req = pop(I2cPriority::LOW);
+    if (!req)
+    {
+        return false;
+    }
+    run_request(*req);
+    return true;
+}
+
+void I2cArbiter::run()
+{
+    while (poll())
+    {
+    }
+}
+
+I2cStatus I2cArbiter::execute(I2cPriority priority,
+                              std::span<const I2cOp> ops)
+{
+    return execute(priority, [ops](I2c& bus) { return bus.transfer(ops); });
+}
+
+uint32_t I2cArbiter::depth(I2cPriority priority) const
+{
+    return _stats[index_of(priority)].depth;
+}
+
+const I2cQueueStats& I2cArbiter::stats(I2cPriority priority) const
+{
+    return _stats[index_of(priority)];
+}
+
+void I2cArbiter::reset_stats()
+{
+    for (I2cQueueStats& stats : _stats)
+    {
+        stats = I2cQueueStats{0, 0, stats.depth, stats.depth, 0, 0};
+    }
+}
+
+/* Oldest request of the most urgent queue no less urgent than max_priority */
+I2cRequest* I2cArbiter::pop(I2cPriority max_priority)
+{
+    for (size_t i = 0; i <= index_of(max_priority); i++)
+    {
+        Queue& queue = _queues[i];
+        I2cRequest* req = queue.head;
+        if (!req)
+        {
+            continue;
+        }
+
+        queue.head = req->next;
+        if (!queue.head)
+        {
+            queue.tail = nullptr;
+        }
+        req->next = nullptr;
+        _stats[i].depth--;
+        return req;
+    }
+    return nullptr;
+}
+
+void I2cArbiter::run_request(I2cRequest& req)
+{
+    const uint32_t wait = _now() - req.enqueue_tick;
+
+    _active = true;
+    req.status = _bus.transfer(req.ops);
+    _active = false;
+
+    record(req.priority, wait, req.status);
+    if (req.cb)
+    {
+        req.cb(req.ctx, req.status);
+    }
+}
+
+void I2cArbiter::drain(I2cPriority max_priority)
+{
+    while (I2cRequest* req = pop(max_priority))
+    {
+        run_request(*req);
+    }
+}
+
+void I2cArbiter::record(I2cPriority priority, uint32_t wait, I2cStatus status)
+{
+    I2cQueueStats& stats = _stats[index_of(priority)];
+    stats.completed++;
+    if (status != I2cStatus::OK)
+    {
+        stats.errors++;
+    }
+    stats.total_wait += wait;
+    if (wait > stats.max_wait)
+    {
+        stats.max_wait = wait;
+    }
+}
+
+I2cClient::I2cClient(I2cArbiter& arbiter, I2cPriority priority)
+    : _arbiter(arbiter), _priority(priority)
+{
+}
+
+I2cStatus I2cClient::mem_read(std::span<uint8_t> data, const uint8_t reg_addr,
+                              uint8_t dev_addr)
+{
+    return _arbiter.execute(_priority, [&](I2c& bus) {
+        return bus.mem_read(data, reg_addr, dev_addr);
+    });
+}
+
+I2cStatus I2cClient::mem_read(std::span<uint8_t> data, const uint16_t reg_addr,
+                              uint8_t dev_addr)
+{
+    return _arbiter.execute(_priority, [&](I2c& bus) {
+        return bus.mem_read(data, reg_addr, dev_addr);
+    });
+}
+
+I2cStatus I2cClient::mem_write(std::span<const uint8_t> data,
+                               const uint8_t reg_addr, uint8_t dev_addr)
+{
+    return _arbiter.execute(_priority, [&](I2c& bus) {
+        return bus.mem_write(data, reg_addr, dev_addr);
+    });
+}
+
+I2cStatus I2cClient::mem_write(std::span<const uint8_t> data,
+                               const uint16_t reg_addr, uint8_t dev_addr)
+{
+    return _arbiter.execute(_priority, [&](I2c& bus) {
+        return bus.mem_write(data, reg_addr, dev_addr);
+    });
+}
+
+I2cStatus I2cClient::read(std::span<uint8_t> data, uint8_t dev_addr)
+{
+    return _arbiter.execute(
+        _priority, [&](I2c& bus) { return bus.read(data, dev_addr); });
+}
+
+I2cStatus I2cClient::write(std::span<const uint8_t> data, uint8_t dev_addr)
+{
+    return _arbiter.execute(
+        _priority, [&](I2c& bus) { return bus.write(data, dev_addr); });
+}
+
+I2cStatus I2cClient::transfer(std::span<const I2cOp> ops)
+{
+    return _arbiter.execute(_priority, ops);
+}
+
+}  // namespace LBR
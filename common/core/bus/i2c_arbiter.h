@@ -0,0 +1,208 @@
+/**
+ * @file i2c_arbiter.h
+ * @brief Priority arbiter for device drivers sharing one I2c bus
+ * @date 10/17/2026
+ */
+
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include "i2c.h"
+
+namespace LBR
+{
+
+/**
+ * @brief Urgency of a bus request, lower value runs first
+ */
+enum class I2cPriority : uint8_t
+{
+    HIGH = 0,  ///< High rate sensor data (IMU reads)
+    NORMAL,    ///< Regular device traffic
+    LOW,       ///< Housekeeping (status, calibration polling)
+    COUNT
+};
+
+using I2cRequestCallback = void (*)(void* ctx, I2cStatus status);
+
+/**
+ * @brief Queued batch of register accesses, owned by the submitter
+ * @note Must stay alive and unmodified until its callback runs
+ */
+struct I2cRequest
+{
+    std::span<const I2cOp> ops;
+    I2cPriority priority{I2cPriority::NORMAL};
+    I2cRequestCallback cb{nullptr};
+    void* ctx{nullptr};
+
+    // Filled in by the arbiter
+    I2cStatus status{I2cStatus::OK};
+    uint32_t enqueue_tick{0};
+    I2cRequest* next{nullptr};
+};
+
+/**
+ * @brief Per-priority queue statistics, times in ticks of the arbiter clock
+ */
+struct I2cQueueStats
+{
+    uint32_t completed{0};
+    uint32_t errors{0};
+    uint32_t depth{0};
+    uint32_t max_depth{0};
+    uint32_t max_wait{0};
+    uint64_t total_wait{0};
+};
+
+/**
+ * @class I2cArbiter
+ * @brief Serializes transactions of several drivers on one bus by priority
+ * @details Requests wait in one FIFO per priority. Whenever the bus is free
+ *          the oldest request of the most urgent non-empty queue runs, so a
+ *          high rate read preempts queued housekeeping between transactions.
+ *          A transaction that is already on the bus is never interrupted.
+ *
+ *          Everything runs synchronously on the caller, through the bus's
+ *          blocking transfer(). The HwI2c *_it engine is not driven from
+ *          here, so priority orders queued requests against each other and
+ *          against execute(), and cannot cut into a blocking call that is
+ *          already running.
+ * @note Not ISR safe, submit and poll from thread context only
+ */
+class I2cArbiter
+{
+public:
+    using TickFn = uint32_t (*)();
+
+    /**
+     * @param bus shared bus all requests run on
+     * @param now monotonic tick source wait times are measured with
+     */
+    I2cArbiter(I2c& bus, TickFn now);
+
+    /**
+     * @brief Queues a request without touching the bus
+     *
+     * @param req request to queue, ops must not be empty
+     * @return true if queued
+     */
+    bool submit(I2cRequest& req);
+
+    /**
+     * @brief Runs the most urgent queued request, if any
+     *
+     * @return true if a request ran
+     */
+    bool poll();
+
+    /**
+     * @brief Runs queued requests until every queue is empty
+     */
+    void run();
+
+    /**
+     * @brief Runs a batch now, after queued requests at least as urgent
+     *
+     * @param priority urgency of the caller
+     * @param ops operations to run
+     * @return I2cStatus::OK if successful, error code otherwise
+     */
+    I2cStatus execute(I2cPriority priority, std::span<const I2cOp> ops);
+
+    /**
+     * @brief Runs an arbitrary bus access now, after queued requests at
+     *        least as urgent
+     *
+     * @param priority urgency of the caller
+     * @param fn callable taking I2c& and returning I2cStatus
+     * @return status returned by fn
+     */
+    template <typename Fn>
+        requires std::invocable<Fn&, I2c&>
+    I2cStatus execute(I2cPriority priority, Fn&& fn)
+    {
+        const uint32_t start = _now();
+        if (!_active)
+        {
+            drain(priority);
+        }
+        const bool nested = _active;
+        _active = true;
+        const uint32_t wait = _now() - start;
+        const I2cStatus status = fn(_bus);
+        _active = nested;
+        record(priority, wait, status);
+        return status;
+    }
+
+    /**
+     * @brief Number of requests waiting at a priority
+     */
+    uint32_t depth(I2cPriority priority) const;
+
+    /**
+     * @brief Statistics of one priority level
+     */
+    const I2cQueueStats& stats(I2cPriority priority) const;
+
+    /**
+     * @brief Clears counters and maxima, keeps the current depth
+     */
+    void reset_stats();
+
+private:
+    static constexpr size_t NUM_PRIORITIES =
+        static_cast<size_t>(I2cPriority::COUNT);
+
+    struct Queue
+    {
+        I2cRequest* head{nullptr};
+        I2cRequest* tail{nullptr};
+    };
+
+    I2cRequest* pop(I2cPriority max_priority);
+    void run_request(I2cRequest& req);
+    void drain(I2cPriority max_priority);
+    void record(I2cPriority priority, uint32_t wait, I2cStatus status);
+
+    I2c& _bus;
+    TickFn _now;
+    bool _active{false};
+    std::array<Queue, NUM_PRIORITIES> _queues{};
+    std::array<I2cQueueStats, NUM_PRIORITIES> _stats{};
+};
+
+/**
+ * @class I2cClient
+ * @brief I2c view of an arbiter at a fixed priority
+ * @details Lets an unmodified driver such as Bno055 share the bus, e.g. one
+ *          HIGH client for IMU data and one LOW client for diagnostics.
+ */
+class I2cClient : public I2c
+{
+public:
+    I2cClient(I2cArbiter& arbiter, I2cPriority priority);
+
+    I2cStatus mem_read(std::span<uint8_t> data, const uint8_t reg_addr,
+                       uint8_t dev_addr) override;
+    I2cStatus mem_read(std::span<uint8_t> data, const uint16_t reg_addr,
+                       uint8_t dev_addr) override;
+    I2cStatus mem_write(std::span<const uint8_t> data, const uint8_t reg_addr,
+                        uint8_t dev_addr) override;
+    I2cStatus mem_write(std::span<const uint8_t> data, const uint16_t reg_addr,
+                        uint8_t dev_addr) override;
+    I2cStatus read(std::span<uint8_t> data, uint8_t dev_addr) override;
+    I2cStatus write(std::span<const uint8_t> data, uint8_t dev_addr) override;
+    I2cStatus transfer(std::span<const I2cOp> ops) override;
+
+private:
+    I2cArbiter& _arbiter;
+    I2cPriority _priority;
+};
+
+}  // namespace LBR
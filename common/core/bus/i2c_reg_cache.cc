@@ -0,0 +1,346 @@
+#include "i2c_reg_cache.h"
+
+namespace LBR
+{
+
+I2cRegCache::I2cRegCache(I2c& bus, uint8_t dev_addr,
+                         std::span<const I2cRegRange> cached,
+                         std::optional<uint8_t> page_reg)
+    : _bus(bus),
+      _dev_addr(dev_addr),
+      _page_reg(page_reg),
+      _page_known(!page_reg.has_value())
+{
+    for (const I2cRegRange& range : cached)
+    {
+        if (range.page >= MAX_PAGES)
+        {
+            continue;
+        }
+        for (size_t reg = range.first; reg <= range.last; reg++)
+        {
+            _pages[range.page].cacheable.set(reg);
+        }
+    }
+}
+
+I2cStatus I2cRegCache::mem_read(std::span<uint8_t> data,
+                                const uint8_t reg_addr, uint8_t dev_addr)
+{
+    if (dev_addr != _dev_addr || data.empty())
+    {
+        return _bus.mem_read(data, reg_addr, dev_addr);
+    }
+
+    if (covered(reg_addr, data.size()))
+    {
+        copy_out(data, reg_addr);
+        _stats.read_hits++;
+        return I2cStatus::OK;
+    }
+
+    _stats.read_misses++;
+    const I2cStatus status = _bus.mem_read(data, reg_addr, dev_addr);
+    if (status == I2cStatus::OK)
+    {
+        update(data, reg_addr);
+    }
+    return status;
+}
+
+I2cStatus I2cRegCache::mem_read(std::span<uint8_t> data,
+                                const uint16_t reg_addr, uint8_t dev_addr)
+{
+    return _bus.mem_read(data, reg_addr, dev_addr);
+}
+
+I2cStatus I2cRegCache::mem_write(std::span<const uint8_t> data,
+                                 const uint8_t reg_addr, uint8_t dev_addr)
+{
+    if (dev_addr != _dev_addr || data.empty())
+    {
+        return _bus.mem_write(data, reg_addr, dev_addr);
+    }
+
+    if (unchanged(data, reg_addr))
+    {
+        _stats.writes_skipped++;
+        return I2cStatus::OK;
+    }
+
+    _stats.writes++;
+    const I2cStatus status = _bus.mem_write(data, reg_addr, dev_addr);
+    if (status == I2cStatus::OK)
+    {
+        update(data, reg_addr);
+    }
+    else
+    {
+        // Unknown how many bytes landed
+        invalidate(reg_addr, data.size());
+    }
+    return status;
+}
+
+I2cStatus I2cRegCache::mem_write(std::span<const uint8_t> data,
+                                 const uint16_t reg_addr, uint8_t dev_addr)
+{
+    if (dev_addr == _dev_addr)
+    {
+        invalidate();
+    }
+    return _bus.mem_write(data, reg_addr, dev_addr);
+}
+
+I2cStatus I2cRegCache::read(std::span<uint8_t> data, uint8_t dev_addr)
+{
+    return _bus.read(data, dev_addr);
+}
+
+I2cStatus I2cRegCache::write(std::span<const uint8_t> data, uint8_t dev_addr)
+{
+    // Raw writes may move the register pointer or hit any register
+    if (dev_addr == _dev_addr)
+    {
+        invalidate();
+    }
+    return _bus.write(data, dev_addr);
+}
+
+I2cStatus I2cRegCache::transfer(std::span<const I2cOp> ops)
+{
+    if (ops.size() > MAX_BATCH_OPS)
+    {
+        // No room to collect the misses, go op by op through the shadow
+        return I2c::transfer(ops);
+    }
+
+    // Each op sees the shadow as the ops before it left it, writes update
+    // it up front so a later read in the batch can hit what they wrote
+    const uint8_t page = _page;
+    const bool page_known = _page_known;
+    std::array<I2cOp, MAX_BATCH_OPS> misses{};
+    size_t num_misses = 0;
+    for (const I2cOp& op : ops)
+    {
+        if (!serve(op))
+        {
+            misses[num_misses++] = op;
+        }
+    }
+    if (num_misses == 0)
+    {
+        return I2cStatus::OK;
+    }
+
+    const I2cStatus status =
+        _bus.transfer(std::span(misses.data(), num_misses));
+    if (status != I2cStatus::OK)
+    {
+        // Unknown which op failed or how many bytes landed
+        invalidate();
+        return status;
+    }
+
+    // Replay the batch so the bytes read land on the page they came from
+    _page = page;
+    _page_known = page_known;
+    for (const I2cOp& op : ops)
+    {
+        if (op.dev_addr != _dev_addr)
+        {
+            continue;
+        }
+        update((op.dir == I2cOp::Dir::READ) ? op.rx : op.tx, op.reg_addr);
+    }
+    return I2cStatus::OK;
+}
+
+bool I2cRegCache::peek(uint8_t reg_addr, uint8_t& value) const
+{
+    if (!covered(reg_addr, 1))
+    {
+        return false;
+    }
+    value = is_page_reg(reg_addr) ? _page : active_page()->value[reg_addr];
+    return true;
+}
+
+void I2cRegCache::invalidate()
+{
+    for (Page& page : _pages)
+    {
+        page.valid.reset();
+    }
+    _page_known = !_page_reg.has_value();
+}
+
+void I2cRegCache::invalidate(uint8_t reg_addr, size_t len)
+{
+    for (size_t reg = reg_addr; reg < reg_addr + len && reg < NUM_REGS; reg++)
+    {
+        if (is_page_reg(reg))
+        {
+            _page_known = false;
+            continue;
+        }
+
+        Page* page = active_page();
+        if (page)
+        {
+            page->valid.reset(reg);
+            continue;
+        }
+        // Page unknown, the access could have landed on any of them
+        for (Page& any : _pages)
+        {
+            any.valid.reset(reg);
+        }
+    }
+}
+
+I2cRegCache::Page* I2cRegCache::active_page()
+{
+    return (_page_known && _page < MAX_PAGES) ? &_pages[_page] : nullptr;
+}
+
+const I2cRegCache::Page* I2cRegCache::active_page() const
+{
+    return (_page_known && _page < MAX_PAGES) ? &_pages[_page] : nullptr;
+}
+
+bool I2cRegCache::is_page_reg(size_t reg) const
+{
+    return _page_reg.has_value() && *_page_reg == reg;
+}
+
+void I2cRegCache::set_page(uint8_t page)
+{
+    _page = page;
+    _page_known = true;
+}
+
+bool I2cRegCache::covered(uint8_t reg_addr, size_t len) const
+{
+    if (reg_addr + len > NUM_REGS)
+    {
+        return false;
+    }
+
+    const Page* page = active_page();
+    for (size_t reg = reg_addr; reg < reg_addr + len; reg++)
+    {
+        if (is_page_reg(reg))
+        {
+            if (!_page_known)
+            {
+                return false;
+            }
+        }
+        else if (!page || !page->cacheable[reg] || !page->valid[reg])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool I2cRegCache::unchanged(std::span<const uint8_t> data,
+                            uint8_t reg_addr) const
+{
+    if (!covered(reg_addr, data.size()))
+    {
+        return false;
+    }
+
+    const Page* page = active_page();
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        const size_t reg = reg_addr + i;
+        const uint8_t cached = is_page_reg(reg) ? _page : page->value[reg];
+        if (cached != data[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void I2cRegCache::update(std::span<const uint8_t> data, uint8_t reg_addr)
+{
+    for (size_t i = 0; i < data.size() && reg_addr + i < NUM_REGS; i++)
+    {
+        const size_t reg = reg_addr + i;
+        if (is_page_reg(reg))
+        {
+            set_page(data[i]);
+            continue;
+        }
+
+        Page* page = active_page();
+        if (!page)
+        {
+            // Page unknown, a shadow of any page may be stale now
+            for (Page& any : _pages)
+            {
+                any.valid.reset(reg);
+            }
+            continue;
+        }
+        if (page->cacheable[reg])
+        {
+            page->value[reg] = data[i];
+            page->valid.set(reg);
+        }
+    }
+}
+
+void I2cRegCache::copy_out(std::span<uint8_t> data, uint8_t reg_addr) const
+{
+    const Page* page = active_page();
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        const size_t reg = reg_addr + i;
+        data[i] = is_page_reg(reg) ? _page : page->value[reg];
+    }
+}
+
+bool I2cRegCache::serve(const I2cOp& op)
+{
+    if (op.dev_addr != _dev_addr)
+    {
+        return false;
+    }
+
+    if (op.dir == I2cOp::Dir::READ)
+    {
+        if (op.rx.empty())
+        {
+            return true;
+        }
+        if (covered(op.reg_addr, op.rx.size()))
+        {
+            copy_out(op.rx, op.reg_addr);
+            _stats.read_hits++;
+            return true;
+        }
+        _stats.read_misses++;
+        return false;
+    }
+
+    if (op.tx.empty())
+    {
+        // Still moves the register pointer
+        return false;
+    }
+    if (unchanged(op.tx, op.reg_addr))
+    {
+        _stats.writes_skipped++;
+        return true;
+    }
+    _stats.writes++;
+    update(op.tx, op.reg_addr);
+    return false;
+}
+
+}  // namespace LBR
@@ -0,0 +1,147 @@
+/**
+ * @file i2c_reg_cache.h
+ * @brief Write-through register shadow for one I2C device
+ * @date 10/17/2026
+ */
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include "i2c.h"
+
+namespace LBR
+{
+
+/**
+ * @brief Inclusive range of registers that only change through bus writes
+ */
+struct I2cRegRange
+{
+    uint8_t page;
+    uint8_t first;
+    uint8_t last;
+};
+
+/**
+ * @brief Cache effectiveness counters
+ */
+struct I2cRegCacheStats
+{
+    uint32_t read_hits{0};       ///< Reads served from the shadow
+    uint32_t read_misses{0};     ///< Reads that went to the bus
+    uint32_t writes_skipped{0};  ///< Writes matching the shadow, not sent
+    uint32_t writes{0};          ///< Writes that went to the bus
+};
+
+/**
+ * @class I2cRegCache
+ * @brief I2c adapter that shadows the static/config registers of one device
+ * @details 8-bit register accesses to the cached device are checked against
+ *          the shadow. Reads fully covered by valid cached registers never
+ *          touch the bus and writes that would not change any cached value
+ *          are dropped. Everything else is written through and updates the
+ *          shadow on success. Registers outside the cached ranges, other
+ *          devices and raw/16-bit accesses pass straight through.
+ *
+ *          transfer() serves what it can from the shadow the same way and
+ *          hands the remaining ops to the bus as one batch, so they keep
+ *          their repeated-START chaining. A failed batch drops the whole
+ *          shadow.
+ *
+ *          With a page register, the shadow is kept per page and the page
+ *          register itself is tracked, so a page switch redirects the cache
+ *          instead of flushing it.
+ * @note Anything that changes the device behind the cache's back (reset,
+ *       self-clearing bits, another master) needs an explicit invalidate()
+ */
+class I2cRegCache : public I2c
+{
+public:
+    static constexpr size_t MAX_PAGES = 2;
+    /// Longest transfer() batch that keeps its misses in one bus transfer
+    static constexpr size_t MAX_BATCH_OPS = 8;
+
+    /**
+     * @param bus bus the device sits on
+     * @param dev_addr address of the cached device
+     * @param cached register ranges that are safe to shadow
+     * @param page_reg register selecting the active page, if any
+     */
+    I2cRegCache(I2c& bus, uint8_t dev_addr,
+                std::span<const I2cRegRange> cached,
+                std::optional<uint8_t> page_reg = std::nullopt);
+
+    I2cStatus mem_read(std::span<uint8_t> data, const uint8_t reg_addr,
+                       uint8_t dev_addr) override;
+    I2cStatus mem_read(std::span<uint8_t> data, const uint16_t reg_addr,
+                       uint8_t dev_addr) override;
+    I2cStatus mem_write(std::span<const uint8_t> data, const uint8_t reg_addr,
+                        uint8_t dev_addr) override;
+    I2cStatus mem_write(std::span<const uint8_t> data, const uint16_t reg_addr,
+                        uint8_t dev_addr) override;
+    I2cStatus read(std::span<uint8_t> data, uint8_t dev_addr) override;
+    I2cStatus write(std::span<const uint8_t> data, uint8_t dev_addr) override;
+    I2cStatus transfer(std::span<const I2cOp> ops) override;
+
+    /**
+     * @brief Looks up a register of the active page without bus traffic
+     *
+     * @param reg_addr register to look up
+     * @param[out] value cached value
+     * @return true if the register is cached and valid
+     */
+    bool peek(uint8_t reg_addr, uint8_t& value) const;
+
+    /**
+     * @brief Drops every cached value, including the active page
+     */
+    void invalidate();
+
+    /**
+     * @brief Drops cached values of a register block on the active page
+     *
+     * @param reg_addr first register
+     * @param len number of registers
+     */
+    void invalidate(uint8_t reg_addr, size_t len);
+
+    const I2cRegCacheStats& stats() const
+    {
+        return _stats;
+    }
+
+private:
+    static constexpr size_t NUM_REGS = 256;
+
+    struct Page
+    {
+        std::bitset<NUM_REGS> cacheable;
+        std::bitset<NUM_REGS> valid;
+        std::array<uint8_t, NUM_REGS> value{};
+    };
+
+    Page* active_page();
+    const Page* active_page() const;
+    bool is_page_reg(size_t reg) const;
+    void set_page(uint8_t page);
+    bool covered(uint8_t reg_addr, size_t len) const;
+    bool unchanged(std::span<const uint8_t> data, uint8_t reg_addr) const;
+    void update(std::span<const uint8_t> data, uint8_t reg_addr);
+    void copy_out(std::span<uint8_t> data, uint8_t reg_addr) const;
+    bool serve(const I2cOp& op);
+
+    I2c& _bus;
+    uint8_t _dev_addr;
+    std::optional<uint8_t> _page_reg;
+    uint8_t _page{0};
+    bool _page_known;
+    std::array<Page, MAX_PAGES> _pages{};
+    I2cRegCacheStats _stats{};
+};
+
+}  // namespace LBR
@@ -0,0 +1,281 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <vector>
+#include "i2c_arbiter.h"
+
+using namespace LBR;
+
+namespace
+{
+
+constexpr uint8_t DEV_ADDR = 0x28;
+constexpr uint32_t TICKS_PER_ACCESS = 5;
+
+uint32_t fake_ticks = 0;
+
+uint32_t fake_now()
+{
+    return fake_ticks;
+}
+
+// Logs the register of every access, each one takes TICKS_PER_ACCESS
+class LogBus : public I2c
+{
+public:
+    I2cStatus mem_read(std::span<uint8_t> data, const uint8_t reg_addr,
+                       uint8_t dev_addr) override
+    {
+        (void)data;
+        (void)dev_addr;
+        return access(reg_addr);
+    }
+    I2cStatus mem_read(std::span<uint8_t> data, const uint16_t reg_addr,
+                       uint8_t dev_addr) override
+    {
+        (void)data;
+        (void)dev_addr;
+        return access(reg_addr);
+    }
+    I2cStatus mem_write(std::span<const uint8_t> data, const uint8_t reg_addr,
+                        uint8_t dev_addr) override
+    {
+        (void)data;
+        (void)dev_addr;
+        return access(reg_addr);
+    }
+    I2cStatus mem_write(std::span<const uint8_t> data,
+                        const uint16_t reg_addr, uint8_t dev_addr) override
+    {
+        (void)data;
+        (void)dev_addr;
+        return access(reg_addr);
+    }
+    I2cStatus read(std::span<uint8_t> data, uint8_t dev_addr) override
+    {
+        (void)data;
+        (void)dev_addr;
+        return access(0);
+    }
+    I2cStatus write(std::span<const uint8_t> data, uint8_t dev_addr) override
+    {
+        (void)data;
+        (void)dev_addr;
+        return access(0);
+    }
+
+    std::vector<uint16_t> log;
+    uint16_t nack_reg{0xFFFF};  ///< Register whose accesses fail
+
+private:
+    I2cStatus access(uint16_t reg_addr)
+    {
+        log.push_back(reg_addr);
+        fake_ticks += TICKS_PER_ACCESS;
+        return reg_addr == nack_reg ? I2cStatus::NACK : I2cStatus::OK;
+    }
+};
+
+class I2cArbiterTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        fake_ticks = 0;
+    }
+
+    I2cOp op(uint8_t reg_addr)
+    {
+        return I2cOp::read(DEV_ADDR, reg_addr, buf);
+    }
+
+    LogBus bus;
+    I2cArbiter arbiter{bus, fake_now};
+    std::array<uint8_t, 2> buf{};
+};
+
+TEST_F(I2cArbiterTest, SubmitOnlyQueues)
+{
+    const std::array<I2cOp, 1> ops{op(0x10)};
+    I2cRequest req{ops, I2cPriority::NORMAL};
+    ASSERT_TRUE(arbiter.submit(req));
+    EXPECT_TRUE(bus.log.empty());
+    EXPECT_EQ(arbiter.depth(I2cPriority::NORMAL), 1u);
+
+    EXPECT_TRUE(arbiter.poll());
+    EXPECT_EQ(bus.log, std::vector<uint16_t>{0x10});
+    EXPECT_EQ(arbiter.depth(I2cPriority::NORMAL), 0u);
+    EXPECT_FALSE(arbiter.poll());
+}
+
+TEST_F(I2cArbiterTest, RejectsEmptyOrInvalidRequests)
+{
+    I2cRequest empty{{}, I2cPriority::HIGH};
+    EXPECT_FALSE(arbiter.submit(empty));
+
+    const std::array<I2cOp, 1> ops{op(0x10)};
+    I2cRequest invalid{ops, I2cPriority::COUNT};
+    EXPECT_FALSE(arbiter.submit(invalid));
+}
+
+TEST_F(I2cArbiterTest, MostUrgentQueueRunsFirst)
+{
+    const std::array<I2cOp, 1> low_ops{op(0x34)};
+    const std::array<I2cOp, 1> normal_ops{op(0x3D)};
+    const std::array<I2cOp, 1> high_ops{op(0x08)};
+    I2cRequest low{low_ops, I2cPriority::LOW};
+    I2cRequest normal{normal_ops, I2cPriority::NORMAL};
+    I2cRequest high{high_ops, I2cPriority::HIGH};
+    ASSERT_TRUE(arbiter.submit(low));
+    ASSERT_TRUE(arbiter.submit(normal));
+    ASSERT_TRUE(arbiter.submit(high));
+
+    arbiter.run();
+    EXPECT_EQ(bus.log, (std::vector<uint16_t>{0x08, 0x3D, 0x34}));
+}
+
+TEST_F(I2cArbiterTest, FifoWithinAPriority)
+{
+    const std::array<I2cOp, 1> first_ops{op(0x01)};
+    const std::array<I2cOp, 1> second_ops{op(0x02)};
+    I2cRequest first{first_ops, I2cPriority::LOW};
+    I2cRequest second{second_ops, I2cPriority::LOW};
+    ASSERT_TRUE(arbiter.submit(first));
+    ASSERT_TRUE(arbiter.submit(second));
+
+    arbiter.run();
+    EXPECT_EQ(bus.log, (std::vector<uint16_t>{0x01, 0x02}));
+}
+
+TEST_F(I2cArbiterTest, ClientPreemptsQueuedHousekeeping)
+{
+    const std::array<I2cOp, 1> high_ops{op(0x08)};
+    const std::array<I2cOp, 1> low_ops{op(0x34)};
+    I2cRequest high{high_ops, I2cPriority::HIGH};
+    I2cRequest low{low_ops, I2cPriority::LOW};
+    ASSERT_TRUE(arbiter.submit(low));
+    ASSERT_TRUE(arbiter.submit(high));
+
+    // Queued work at least as urgent goes first, LOW keeps waiting
+    I2cClient client(arbiter, I2cPriority::NORMAL);
+    ASSERT_EQ(client.mem_read(buf, static_cast<uint8_t>(0x99), DEV_ADDR),
+              I2cStatus::OK);
+    EXPECT_EQ(bus.log, (std::vector<uint16_t>{0x08, 0x99}));
+    EXPECT_EQ(arbiter.depth(I2cPriority::LOW), 1u);
+
+    arbiter.run();
+    EXPECT_EQ(bus.log.back(), 0x34);
+}
+
+TEST_F(I2cArbiterTest, CallbackGetsTheStatus)
+{
+    bus.nack_reg = 0x3D;
+    const std::array<I2cOp, 2> ops{op(0x3D), op(0x3E)};
+
+    struct Result
+    {
+        int calls{0};
+        I2cStatus status{I2cStatus::OK};
+    } result;
+    I2cRequest req{ops, I2cPriority::NORMAL,
+                   [](void* ctx, I2cStatus status) {
+                       auto* r = static_cast<Result*>(ctx);
+                       r->calls++;
+                       r->status = status;
+                   },
+                   &result};
+    ASSERT_TRUE(arbiter.submit(req));
+    arbiter.run();
+
+    EXPECT_EQ(result.calls, 1);
+    EXPECT_EQ(result.status, I2cStatus::NACK);
+    EXPECT_EQ(req.status, I2cStatus::NACK);
+    // The batch stopped at the failed op
+    EXPECT_EQ(bus.log, std::vector<uint16_t>{0x3D});
+    EXPECT_EQ(arbiter.stats(I2cPriority::NORMAL).errors, 1u);
+}
+
+TEST_F(I2cArbiterTest, NestedAccessesDontReenterTheQueues)
+{
+    const std::array<I2cOp, 1> inner_ops{op(0x02)};
+    I2cRequest inner{inner_ops, I2cPriority::HIGH};
+
+    struct Ctx
+    {
+        I2cArbiter* arbiter;
+        I2cRequest* inner;
+        bool polled{true};
+    } ctx{&arbiter, &inner};
+    const std::array<I2cOp, 1> outer_ops{op(0x01)};
+    I2cRequest outer{outer_ops, I2cPriority::LOW,
+                     [](void* p, I2cStatus) {
+                         auto* c = static_cast<Ctx*>(p);
+                         c->arbiter->submit(*c->inner);
+                         c->polled = c->arbiter->poll();
+                     },
+                     &ctx};
+    ASSERT_TRUE(arbiter.submit(outer));
+    ASSERT_TRUE(arbiter.poll());
+    // Callbacks run once the bus is free again
+    EXPECT_TRUE(ctx.polled);
+    EXPECT_EQ(bus.log, (std::vector<uint16_t>{0x01, 0x02}));
+
+    // A client access inside execute() doesn't drain the queues again
+    I2cRequest queued{inner_ops, I2cPriority::HIGH};
+    ASSERT_TRUE(arbiter.submit(queued));
+    I2cClient client(arbiter, I2cPriority::LOW);
+    bus.log.clear();
+    arbiter.execute(I2cPriority::LOW, [&](I2c&) {
+        EXPECT_FALSE(arbiter.poll());
+        return client.mem_read(buf, static_cast<uint8_t>(0x03), DEV_ADDR);
+    });
+    EXPECT_EQ(bus.log, (std::vector<uint16_t>{0x02, 0x03}));
+}
+
+TEST_F(I2cArbiterTest, StatsTrackDepthAndWait)
+{
+    const std::array<I2cOp, 1> ops{op(0x10)};
+    std::array<I2cRequest, 3> reqs{};
+    for (I2cRequest& req : reqs)
+    {
+        req.ops = ops;
+        req.priority = I2cPriority::LOW;
+        ASSERT_TRUE(arbiter.submit(req));
+    }
+    const std::array<I2cOp, 1> high_ops{op(0x08)};
+    I2cRequest high{high_ops, I2cPriority::HIGH};
+    ASSERT_TRUE(arbiter.submit(high));
+
+    arbiter.run();
+
+    // Queued at tick 0, each access before it took TICKS_PER_ACCESS
+    const I2cQueueStats& low = arbiter.stats(I2cPriority::LOW);
+    EXPECT_EQ(low.completed, 3u);
+    EXPECT_EQ(low.errors, 0u);
+    EXPECT_EQ(low.depth, 0u);
+    EXPECT_EQ(low.max_depth, 3u);
+    EXPECT_EQ(low.max_wait, 3 * TICKS_PER_ACCESS);
+    EXPECT_EQ(low.total_wait, (1 + 2 + 3) * TICKS_PER_ACCESS);
+
+    const I2cQueueStats& hi = arbiter.stats(I2cPriority::HIGH);
+    EXPECT_EQ(hi.completed, 1u);
+    EXPECT_EQ(hi.max_wait, 0u);
+}
+
+TEST_F(I2cArbiterTest, ResetStatsKeepsTheDepth)
+{
+    const std::array<I2cOp, 1> ops{op(0x10)};
+    I2cRequest done{ops, I2cPriority::NORMAL};
+    I2cRequest waiting{ops, I2cPriority::NORMAL};
+    ASSERT_TRUE(arbiter.submit(done));
+    ASSERT_TRUE(arbiter.poll());
+    ASSERT_TRUE(arbiter.submit(waiting));
+
+    arbiter.reset_stats();
+    const I2cQueueStats& stats = arbiter.stats(I2cPriority::NORMAL);
+    EXPECT_EQ(stats.completed, 0u);
+    EXPECT_EQ(stats.total_wait, 0u);
+    EXPECT_EQ(stats.depth, 1u);
+    EXPECT_EQ(stats.max_depth, 1u);
+}
+
+}  // namespace
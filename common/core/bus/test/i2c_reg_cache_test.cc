@@ -0,0 +1,432 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <random>
+#include "i2c_reg_cache.h"
+
+using namespace LBR;
+
+namespace
+{
+
+constexpr uint8_t DEV_ADDR = 0x28;
+constexpr uint8_t OTHER_ADDR = 0x29;
+constexpr uint8_t PAGE_REG = 0x07;
+
+// Two register pages behind PAGE_REG, like the BNO055. Only bit 0 of the
+// page selects, the rest reads back as written.
+class PagedDevice : public I2c
+{
+public:
+    I2cStatus mem_read(std::span<uint8_t> data, const uint8_t reg_addr,
+                       uint8_t dev_addr) override
+    {
+        (void)dev_addr;
+        reads++;
+        if (fail)
+        {
+            return I2cStatus::NACK;
+        }
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            const size_t reg = reg_addr + i;
+            data[i] = (reg == PAGE_REG) ? page : regs[page & 1][reg];
+        }
+        return I2cStatus::OK;
+    }
+    I2cStatus mem_read(std::span<uint8_t> data, const uint16_t reg_addr,
+                       uint8_t dev_addr) override
+    {
+        return mem_read(data, static_cast<uint8_t>(reg_addr), dev_addr);
+    }
+    I2cStatus mem_write(std::span<const uint8_t> data, const uint8_t reg_addr,
+                        uint8_t dev_addr) override
+    {
+        (void)dev_addr;
+        writes++;
+        // Bytes up to the failure land, like a NACK mid-burst
+        const size_t len = fail ? std::min(fail_after, data.size())
+                                : data.size();
+        for (size_t i = 0; i < len; i++)
+        {
+            const size_t reg = reg_addr + i;
+            if (reg == PAGE_REG)
+            {
+                page = data[i];
+            }
+            else
+            {
+                regs[page & 1][reg] = data[i];
+            }
+        }
+        return fail ? I2cStatus::NACK : I2cStatus::OK;
+    }
+    I2cStatus mem_write(std::span<const uint8_t> data,
+                        const uint16_t reg_addr, uint8_t dev_addr) override
+    {
+        return mem_write(data, static_cast<uint8_t>(reg_addr), dev_addr);
+    }
+    I2cStatus read(std::span<uint8_t> data, uint8_t dev_addr) override
+    {
+        return mem_read(data, static_cast<uint8_t>(0), dev_addr);
+    }
+    I2cStatus write(std::span<const uint8_t> data, uint8_t dev_addr) override
+    {
+        if (data.empty())
+        {
+            return I2cStatus::OK;
+        }
+        return mem_write(data.subspan(1), data[0], dev_addr);
+    }
+    // One call is one bus transaction, chained with repeated-START
+    I2cStatus transfer(std::span<const I2cOp> ops) override
+    {
+        transfers++;
+        return I2c::transfer(ops);
+    }
+
+    std::array<std::array<uint8_t, 256>, 2> regs{};
+    uint8_t page{0};
+    uint32_t reads{0};
+    uint32_t writes{0};
+    uint32_t transfers{0};
+    bool fail{false};
+    size_t fail_after{0};
+};
+
+// Page 0: IDs and config, page 1: a config block. 0x08.. on page 0 is data.
+constexpr std::array<I2cRegRange, 3> CACHED{{
+    {0, 0x00, 0x06},
+    {0, 0x3D, 0x3E},
+    {1, 0x08, 0x1F},
+}};
+
+class I2cRegCacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        dev.regs[0][0x00] = 0xA0;
+        dev.regs[1][0x08] = 0x0D;
+    }
+
+    uint8_t read_reg(uint8_t reg_addr)
+    {
+        uint8_t value = 0;
+        EXPECT_EQ(cache.mem_read({&value, 1}, reg_addr, DEV_ADDR),
+                  I2cStatus::OK);
+        return value;
+    }
+
+    I2cStatus write_reg(uint8_t reg_addr, uint8_t value)
+    {
+        return cache.mem_write({&value, 1}, reg_addr, DEV_ADDR);
+    }
+
+    PagedDevice dev;
+    I2cRegCache cache{dev, DEV_ADDR, CACHED, PAGE_REG};
+};
+
+TEST_F(I2cRegCacheTest, UnknownPageGoesToTheBus)
+{
+    EXPECT_EQ(read_reg(0x00), 0xA0);
+    EXPECT_EQ(read_reg(0x00), 0xA0);
+    EXPECT_EQ(dev.reads, 2u);
+    EXPECT_EQ(cache.stats().read_hits, 0u);
+}
+
+TEST_F(I2cRegCacheTest, ReadsHitOnceThePageIsKnown)
+{
+    ASSERT_EQ(write_reg(PAGE_REG, 0), I2cStatus::OK);
+    EXPECT_EQ(read_reg(0x00), 0xA0);
+    EXPECT_EQ(read_reg(0x00), 0xA0);
+    EXPECT_EQ(read_reg(PAGE_REG), 0);
+    EXPECT_EQ(dev.reads, 1u);
+    EXPECT_EQ(cache.stats().read_hits, 2u);
+    EXPECT_EQ(cache.stats().read_misses, 1u);
+}
+
+TEST_F(I2cRegCacheTest, UnchangedWritesAreSkipped)
+{
+    ASSERT_EQ(write_reg(PAGE_REG, 0), I2cStatus::OK);
+    ASSERT_EQ(write_reg(0x3D, 0x08), I2cStatus::OK);
+    ASSERT_EQ(write_reg(0x3D, 0x08), I2cStatus::OK);
+    ASSERT_EQ(write_reg(PAGE_REG, 0), I2cStatus::OK);
+    EXPECT_EQ(dev.writes, 2u);
+    EXPECT_EQ(cache.stats().writes_skipped, 2u);
+
+    uint8_t value = 0;
+    ASSERT_TRUE(cache.peek(0x3D, value));
+    EXPECT_EQ(value, 0x08);
+}
+
+TEST_F(I2cRegCacheTest, PageSwitchRedirectsTheShadow)
+{
+    ASSERT_EQ(write_reg(PAGE_REG, 0), I2cStatus::OK);
+    ASSERT_EQ(write_reg(0x3D, 0x08), I2cStatus::OK);
+
+    ASSERT_EQ(write_reg(PAGE_REG, 1), I2cStatus::OK);
+    uint8_t value = 0;
+    EXPECT_FALSE(cache.peek(0x3D, value));
+    EXPECT_EQ(read_reg(0x08), 0x0D);
+    EXPECT_EQ(read_reg(0x08), 0x0D);
+    EXPECT_EQ(dev.reads, 1u);
+
+    // Page 0's shadow survived the trip
+    ASSERT_EQ(write_reg(PAGE_REG, 0), I2cStatus::OK);
+    ASSERT_TRUE(cache.peek(0x3D, value));
+    EXPECT_EQ(value, 0x08);
+}
+
+TEST_F(I2cRegCacheTest, UncachedRegistersAlwaysGoToTheBus)
+{
+    ASSERT_EQ(write_reg(PAGE_REG, 0), I2cStatus::OK);
+    std::array<uint8_t, 6> data{};
+    ASSERT_EQ(cache.mem_read(data, static_cast<uint8_t>(0x08), DEV_ADDR),
+              I2cStatus::OK);
+    dev.regs[0][0x08] = 0x55;
+    ASSERT_EQ(cache.mem_read(data, static_cast<uint8_t>(0x08), DEV_ADDR),
+              I2cStatus::OK);
+    EXPECT_EQ(data[0], 0x55);
+    EXPECT_EQ(dev.reads, 2u);
+
+    // A read straddling cached and uncached registers is not served either
+    read_reg(0x06);
+    ASSERT_EQ(cache.mem_read(data, static_cast<uint8_t>(0x05), DEV_ADDR),
+              I2cStatus::OK);
+    EXPECT_EQ(dev.reads, 4u);
+}
+
+TEST_F(I2cRegCacheTest, FailedWriteInvalidates)
+{
+    ASSERT_EQ(write_reg(PAGE_REG, 0), I2cStatus::OK);
+    ASSERT_EQ(write_reg(0x3D, 0x08), I2cStatus::OK);
+
+    dev.fail = true;
+    dev.fail_after = 1;
+    EXPECT_EQ(write_reg(0x3D, 0x00), I2cStatus::NACK);
+    dev.fail = false;
+
+    uint8_t value = 0;
+    EXPECT_FALSE(cache.peek(0x3D, value));
+    // The byte did land, the next read must see it
+    EXPECT_EQ(read_reg(0x3D), 0x00);
+}
+
+TEST_F(I2cRegCacheTest, WriteOnAnUnknownPageDropsEveryPage)
+{
+    ASSERT_EQ(write_reg(PAGE_REG, 1), I2cStatus::OK);
+    EXPECT_EQ(read_reg(0x08), 0x0D);
+
+    // Page tracking lost, then a write lands on whatever page is active
+    cache.invalidate(PAGE_REG, 1);
+    ASSERT_EQ(write_reg(0x08, 0x0E), I2cStatus::OK);
+
+    ASSERT_EQ(write_reg(PAGE_REG, 1), I2cStatus::OK);
+    uint8_t value = 0;
+    EXPECT_FALSE(cache.peek(0x08, value));
+    EXPECT_EQ(read_reg(0x08), 0x0E);
+}
+
+TEST_F(I2cRegCacheTest, FailedReadCachesNothing)
+{
+    ASSERT_EQ(write_reg(PAGE_REG, 0), I2cStatus::OK);
+    dev.fail = true;
+    uint8_t value = 0;
+    EXPECT_EQ(cache.mem_read({&value, 1}, static_cast<uint8_t>(0x00),
+                             DEV_ADDR),
+              I2cStatus::NACK);
+    dev.fail = false;
+    EXPECT_FALSE(cache.peek(0x00, value));
+}
+
+TEST_F(I2cRegCacheTest, RawAndWideWritesInvalidateEverything)
+{
+    ASSERT_EQ(write_reg(PAGE_REG, 0), I2cStatus::OK);
+    read_reg(0x00);
+
+    const std::array<uint8_t, 2> raw{0x3D, 0x0C};
+    ASSERT_EQ(cache.write(raw, DEV_ADDR), I2cStatus::OK);
+    uint8_t value = 0;
+    EXPECT_FALSE(cache.peek(0x00, value));
+    EXPECT_FALSE(cache.peek(PAGE_REG, value));
+
+    ASSERT_EQ(write_reg(PAGE_REG, 0), I2cStatus::OK);
+    read_reg(0x00);
+    const uint8_t wide = 0;
+    ASSERT_EQ(cache.mem_write({&wide, 1}, static_cast<uint16_t>(0x3E),
+                              DEV_ADDR),
+              I2cStatus::OK);
+    EXPECT_FALSE(cache.peek(0x00, value));
+}
+
+TEST_F(I2cRegCacheTest, OtherDevicesPassThrough)
+{
+    ASSERT_EQ(write_reg(PAGE_REG, 0), I2cStatus::OK);
+    uint8_t value = 0;
+    for (int i = 0; i < 2; i++)
+    {
+        ASSERT_EQ(cache.mem_read({&value, 1}, static_cast<uint8_t>(0x00),
+                                 OTHER_ADDR),
+                  I2cStatus::OK);
+    }
+    EXPECT_EQ(dev.reads, 2u);
+    EXPECT_EQ(cache.stats().read_misses, 0u);
+}
+
+TEST_F(I2cRegCacheTest, TransferHitsTheShadow)
+{
+    ASSERT_EQ(write_reg(PAGE_REG, 0), I2cStatus::OK);
+    read_reg(0x00);
+    const uint32_t reads = dev.reads;
+
+    const uint8_t page = 0;
+    uint8_t id = 0;
+    const std::array<I2cOp, 2> ops{
+        I2cOp::write(DEV_ADDR, PAGE_REG, {&page, 1}),
+        I2cOp::read(DEV_ADDR, 0x00, {&id, 1}),
+    };
+    ASSERT_EQ(cache.transfer(ops), I2cStatus::OK);
+    EXPECT_EQ(id, 0xA0);
+    EXPECT_EQ(dev.reads, reads);
+    EXPECT_EQ(dev.writes, 1u);
+}
+
+TEST_F(I2cRegCacheTest, TransferSendsTheMissesAsOneBatch)
+{
+    ASSERT_EQ(write_reg(PAGE_REG, 0), I2cStatus::OK);
+    read_reg(0x00);
+    dev.regs[0][0x20] = 0x55;
+    const uint32_t reads = dev.reads;
+    const uint32_t writes = dev.writes;
+
+    // Hit, miss, new write, unchanged page write, then a read on page 1
+    const uint8_t page0 = 0;
+    const uint8_t page1 = 1;
+    const uint8_t cfg = 0x3C;
+    uint8_t id = 0;
+    uint8_t data = 0;
+    uint8_t block = 0;
+    const std::array<I2cOp, 6> ops{
+        I2cOp::read(DEV_ADDR, 0x00, {&id, 1}),
+        I2cOp::read(DEV_ADDR, 0x20, {&data, 1}),
+        I2cOp::write(DEV_ADDR, 0x3D, {&cfg, 1}),
+        I2cOp::write(DEV_ADDR, PAGE_REG, {&page0, 1}),
+        I2cOp::write(DEV_ADDR, PAGE_REG, {&page1, 1}),
+        I2cOp::read(DEV_ADDR, 0x08, {&block, 1}),
+    };
+    ASSERT_EQ(cache.transfer(ops), I2cStatus::OK);
+    EXPECT_EQ(dev.transfers, 1u);
+    EXPECT_EQ(dev.reads - reads, 2u);
+    EXPECT_EQ(dev.writes - writes, 2u);
+    EXPECT_EQ(id, 0xA0);
+    EXPECT_EQ(data, 0x55);
+    EXPECT_EQ(block, 0x0D);
+    EXPECT_EQ(cache.stats().writes_skipped, 1u);
+
+    // The read landed on page 1, the write on page 0
+    uint8_t value = 0;
+    EXPECT_TRUE(cache.peek(0x08, value));
+    EXPECT_EQ(value, 0x0D);
+    ASSERT_EQ(write_reg(PAGE_REG, 0), I2cStatus::OK);
+    EXPECT_TRUE(cache.peek(0x3D, value));
+    EXPECT_EQ(value, 0x3C);
+    EXPECT_EQ(dev.regs[0][0x3D], 0x3C);
+}
+
+TEST_F(I2cRegCacheTest, FailedTransferDropsTheShadow)
+{
+    ASSERT_EQ(write_reg(PAGE_REG, 0), I2cStatus::OK);
+    read_reg(0x00);
+
+    const uint8_t cfg = 0x3C;
+    const std::array<I2cOp, 1> ops{
+        I2cOp::write(DEV_ADDR, 0x3D, {&cfg, 1}),
+    };
+    dev.fail = true;
+    EXPECT_EQ(cache.transfer(ops), I2cStatus::NACK);
+    dev.fail = false;
+
+    uint8_t value = 0;
+    EXPECT_FALSE(cache.peek(0x00, value));
+    EXPECT_FALSE(cache.peek(0x3D, value));
+}
+
+TEST_F(I2cRegCacheTest, InvalidateDropsABlock)
+{
+    ASSERT_EQ(write_reg(PAGE_REG, 0), I2cStatus::OK);
+    std::array<uint8_t, 7> block{};
+    ASSERT_EQ(cache.mem_read(block, static_cast<uint8_t>(0x00), DEV_ADDR),
+              I2cStatus::OK);
+
+    // e.g. a self-clearing bit the device changed on its own
+    dev.regs[0][0x03] = 0x42;
+    cache.invalidate(0x03, 1);
+    uint8_t value = 0;
+    EXPECT_TRUE(cache.peek(0x02, value));
+    EXPECT_EQ(read_reg(0x03), 0x42);
+}
+
+// Random traffic through the cache must always read what the device holds
+TEST_F(I2cRegCacheTest, RandomTrafficStaysCoherent)
+{
+    std::mt19937 rng(0x1234);
+    auto pick = [&rng](uint32_t n) {
+        return std::uniform_int_distribution<uint32_t>(0, n - 1)(rng);
+    };
+
+    std::array<uint8_t, 8> buf{};
+    for (int i = 0; i < 20'000; i++)
+    {
+        const uint8_t reg_addr = static_cast<uint8_t>(pick(0x40));
+        const size_t len = 1 + pick(buf.size());
+        const std::span<uint8_t> data(buf.data(), len);
+        dev.fail = pick(50) == 0;
+        dev.fail_after = pick(len + 1);
+
+        switch (pick(6))
+        {
+            case 0:
+            {
+                const uint8_t page = static_cast<uint8_t>(pick(2));
+                cache.mem_write({&page, 1}, PAGE_REG, DEV_ADDR);
+                break;
+            }
+            case 1:
+            case 2:
+                for (uint8_t& byte : data)
+                {
+                    // Few values, so unchanged writes do happen
+                    byte = static_cast<uint8_t>(pick(4));
+                }
+                cache.mem_write(data, reg_addr, DEV_ADDR);
+                break;
+            case 3:
+                cache.invalidate(reg_addr, len);
+                break;
+            default:
+            {
+                if (cache.mem_read(data, reg_addr, DEV_ADDR) != I2cStatus::OK)
+                {
+                    break;
+                }
+                for (size_t j = 0; j < len; j++)
+                {
+                    const size_t reg = reg_addr + j;
+                    const uint8_t truth =
+                        (reg == PAGE_REG) ? dev.page
+                                          : dev.regs[dev.page & 1][reg];
+                    ASSERT_EQ(data[j], truth)
+                        << "step " << i << " reg 0x" << std::hex << reg;
+                }
+                break;
+            }
+        }
+    }
+    dev.fail = false;
+
+    // The mix exercised every path
+    EXPECT_GT(cache.stats().read_hits, 0u);
+    EXPECT_GT(cache.stats().writes_skipped, 0u);
+}
+
+}  // namespace
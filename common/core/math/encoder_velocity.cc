@@ -0,0 +1,119 @@
+#include "encoder_velocity.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace LBR
+{
+
+EncoderVelocity::EncoderVelocity(const Encoder& encoder,
+                                 const EncoderVelocityParams& params)
+    : encoder_(encoder), params_(params)
+{
+}
+
+void EncoderVelocity::reset()
+{
+    started_ = false;
+    num_edges_ = 0;
+    stalled_ = false;
+    velocity_ = 0.0f;
+}
+
+float EncoderVelocity::update()
+{
+    const uint32_t hz = encoder_.getTimestampHz();
+    EncoderEdge edge;
+    if (hz != 0 && encoder_.getEdge(edge))
+    {
+        velocity_ = update_timed(edge, hz);
+    }
+    else
+    {
+        velocity_ = update_counted(encoder_.getTicks());
+    }
+    return velocity_;
+}
+
+float EncoderVelocity::update_counted(int ticks)
+{
+    const bool started = started_;
+    const int delta = ticks - last_ticks_;
+    last_ticks_ = ticks;
+    started_ = true;
+    return started ? delta / params_.dt_s : 0.0f;
+}
+
+float EncoderVelocity::update_timed(const EncoderEdge& edge, uint32_t hz)
+{
+    const EncoderEdge& last = edges_[head_];
+    if (num_edges_ == 0 || (stalled_ && edge.time != last.time))
+    {
+        // The edge before a stall may be older than the timestamps reach
+        num_edges_ = 0;
+        stalled_ = false;
+        push_edge(edge);
+        return 0.0f;
+    }
+
+    if (edge.time != last.time)
+    {
+        // Newest edge at least a cycle back, or the last one on reversals
+        const EncoderEdge* start = &last;
+        for (size_t i = 0; i < num_edges_; i++)
+        {
+            const EncoderEdge& prev =
+                edges_[(head_ + CYCLE_COUNTS - i) % CYCLE_COUNTS];
+            if (std::abs(edge.ticks - prev.ticks) >= CYCLE_COUNTS)
+            {
+                start = &prev;
+                break;
+            }
+        }
+        // Unsigned differences stay right across timestamp wraps
+        const int counts = edge.ticks - start->ticks;
+        const float span_s = static_cast<float>(edge.time - start->time) / hz;
+        push_edge(edge);
+        return counts / span_s;
+    }
+
+    const float since_s = static_cast<float>(edge.now - last.time) / hz;
+    if (stalled_ || since_s >= params_.stall_s)
+    {
+        stalled_ = true;
+        return 0.0f;
+    }
+
+    /* No edge since the last one: the next is at least this far off, so
+     * the speed is at most one count more than the window holds over that
+     * long. The window is the cycle the next edge completes, so phase
+     * error does not pull the bound under the held speed. */
+    const EncoderEdge* from = &last;
+    for (size_t i = 0; i < num_edges_; i++)
+    {
+        const EncoderEdge& prev =
+            edges_[(head_ + CYCLE_COUNTS - i) % CYCLE_COUNTS];
+        if (std::abs(last.ticks - prev.ticks) >= CYCLE_COUNTS - 1)
+        {
+            from = &prev;
+            break;
+        }
+    }
+    const int counts = std::abs(last.ticks - from->ticks) + 1;
+    const float bound =
+        counts * hz / static_cast<float>(edge.now - from->time);
+    if (std::fabs(velocity_) > bound)
+    {
+        return std::copysign(bound, velocity_);
+    }
+    return velocity_;
+}
+
+void EncoderVelocity::push_edge(const EncoderEdge& edge)
+{
+    head_ = (head_ + 1) % CYCLE_COUNTS;
+    edges_[head_] = edge;
+    num_edges_ = std::min(num_edges_ + 1, static_cast<size_t>(CYCLE_COUNTS));
+}
+
+}  // namespace LBR
@@ -0,0 +1,82 @@
+/**
+ * @file encoder_velocity.h
+ * @brief Encoder speed from stall to full speed (M/T method)
+ * @date 10/17/2026
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "encoder.h"
+
+namespace LBR
+{
+
+struct EncoderVelocityParams
+{
+    float dt_s;     ///< Period update() is called at
+    float stall_s;  ///< No edge for this long reads as stopped
+};
+
+/**
+ * @class EncoderVelocity
+ * @brief Counts divided by the time between the edges that bound them
+ * @details Fast, many edges fall between two timed edges about one tick
+ *          apart, so the count is exact and the window is timed rather
+ *          than assumed to be dt. Slow, each edge is timed on its own and
+ *          the window reaches back to the edge a full quadrature cycle
+ *          (CYCLE_COUNTS) earlier, which cancels the A/B phase error of
+ *          the encoder. Between edges the speed is held, but no higher
+ *          than the counts to the next edge over the time since the start
+ *          of its cycle, so it decays to 0 as the shaft stops.
+ *
+ *          Encoders without edge timing fall back to counts / dt.
+ * @note Speeds under a count per stall_s read as 0, and a shaft
+ *       dithering on an edge reads as motion.
+ */
+class EncoderVelocity
+{
+public:
+    static constexpr int CYCLE_COUNTS = 4;  ///< Edges per quadrature cycle
+
+    EncoderVelocity(const Encoder& encoder,
+                    const EncoderVelocityParams& params);
+
+    /**
+     * @brief Forget the history, the next update() starts from 0
+     */
+    void reset();
+
+    /**
+     * @brief Reads the encoder, O(1)
+     * @return ticks per second
+     */
+    float update();
+
+    float velocity() const
+    {
+        return velocity_;
+    }
+
+private:
+    float update_counted(int ticks);
+    float update_timed(const EncoderEdge& edge, uint32_t hz);
+    void push_edge(const EncoderEdge& edge);
+
+    const Encoder& encoder_;
+    EncoderVelocityParams params_;
+
+    bool started_{false};
+    int last_ticks_{0};  ///< Untimed: position at the previous update()
+
+    // Timed: last edges a window can start from, newest at edges_[head_]
+    EncoderEdge edges_[CYCLE_COUNTS]{};
+    size_t head_{0};
+    size_t num_edges_{0};
+    bool stalled_{false};
+
+    float velocity_{0.0f};
+};
+
+}  // namespace LBR
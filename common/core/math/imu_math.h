@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <cstdint>
+
 namespace LBR
 {
 
@@ -20,4 +22,33 @@ struct Quaternion
     float w, x, y, z;
 };
 
+/**
+ * @brief Sensor counts as read off the bus, scale depends on the source
+ */
+struct RawVec3
+{
+    int16_t x, y, z;
+};
+
+struct RawQuaternion
+{
+    int16_t w, x, y, z;
+};
+
+/**
+ * @brief Converts counts to units only when a consumer needs them
+ * @param lsb_per_unit counts per unit of the source
+ */
+inline Vec3 to_vec3(const RawVec3& raw, float lsb_per_unit)
+{
+    return Vec3{raw.x / lsb_per_unit, raw.y / lsb_per_unit,
+                raw.z / lsb_per_unit};
+}
+
+inline Quaternion to_quaternion(const RawQuaternion& raw, float lsb_per_unit)
+{
+    return Quaternion{raw.w / lsb_per_unit, raw.x / lsb_per_unit,
+                      raw.y / lsb_per_unit, raw.z / lsb_per_unit};
+}
+
 }  // namespace LBR
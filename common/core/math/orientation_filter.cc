@@ -0,0 +1,147 @@
+#include "orientation_filter.h"
+#include <cmath>
+
+namespace LBR
+{
+
+void OrientationFilter::reset()
+{
+    q_ = Quaternion{1.0f, 0.0f, 0.0f, 0.0f};
+}
+
+void OrientationFilter::reset(const Vec3& accel)
+{
+    reset();
+    Vec3 a = accel;
+    if (!normalize(a))
+    {
+        return;
+    }
+
+    // Roll and pitch that put gravity along a, as a ZYX rotation with zero
+    // yaw
+    const float roll = std::atan2(a.y, a.z);
+    const float pitch = std::atan2(-a.x, std::sqrt(a.y * a.y + a.z * a.z));
+    const float cr = std::cos(roll * 0.5f);
+    const float sr = std::sin(roll * 0.5f);
+    const float cp = std::cos(pitch * 0.5f);
+    const float sp = std::sin(pitch * 0.5f);
+    q_ = Quaternion{cr * cp, sr * cp, cr * sp, -sr * sp};
+}
+
+bool OrientationFilter::normalize(Vec3& v)
+{
+    const float norm_sq = v.x * v.x + v.y * v.y + v.z * v.z;
+    if (norm_sq <= 0.0f)
+    {
+        return false;
+    }
+    const float inv = 1.0f / std::sqrt(norm_sq);
+    v = Vec3{v.x * inv, v.y * inv, v.z * inv};
+    return true;
+}
+
+void OrientationFilter::normalize(Quaternion& q)
+{
+    const float inv =
+        1.0f / std::sqrt(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z);
+    q = Quaternion{q.w * inv, q.x * inv, q.y * inv, q.z * inv};
+}
+
+MadgwickFilter::MadgwickFilter(float beta) : beta_(beta) {}
+
+void MadgwickFilter::update(const Vec3& gyro, const Vec3& accel, float dt)
+{
+    const float q0 = q_.w, q1 = q_.x, q2 = q_.y, q3 = q_.z;
+
+    // Rate of change from the gyro, q_dot = 0.5 * q * (0, gyro)
+    float dq0 = 0.5f * (-q1 * gyro.x - q2 * gyro.y - q3 * gyro.z);
+    float dq1 = 0.5f * (q0 * gyro.x + q2 * gyro.z - q3 * gyro.y);
+    float dq2 = 0.5f * (q0 * gyro.y - q1 * gyro.z + q3 * gyro.x);
+    float dq3 = 0.5f * (q0 * gyro.z + q1 * gyro.y - q2 * gyro.x);
+
+    Vec3 a = accel;
+    if (normalize(a))
+    {
+        // Gradient of the error between measured and estimated gravity
+        const float _2q0 = 2.0f * q0, _2q1 = 2.0f * q1;
+        const float _2q2 = 2.0f * q2, _2q3 = 2.0f * q3;
+        const float _4q0 = 4.0f * q0, _4q1 = 4.0f * q1, _4q2 = 4.0f * q2;
+        const float _8q1 = 8.0f * q1, _8q2 = 8.0f * q2;
+        const float q0q0 = q0 * q0, q1q1 = q1 * q1;
+        const float q2q2 = q2 * q2, q3q3 = q3 * q3;
+
+        float s0 = _4q0 * q2q2 + _2q2 * a.x + _4q0 * q1q1 - _2q1 * a.y;
+        float s1 = _4q1 * q3q3 - _2q3 * a.x + 4.0f * q0q0 * q1 - _2q0 * a.y -
+                   _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * a.z;
+        float s2 = 4.0f * q0q0 * q2 + _2q0 * a.x + _4q2 * q3q3 - _2q3 * a.y -
+                   _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * a.z;
+        float s3 = 4.0f * q1q1 * q3 - _2q1 * a.x + 4.0f * q2q2 * q3 -
+                   _2q2 * a.y;
+
+        const float norm_sq = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+        // Zero exactly when the estimate already matches
+        if (norm_sq > 0.0f)
+        {
+            const float step = beta_ / std::sqrt(norm_sq);
+            dq0 -= step * s0;
+            dq1 -= step * s1;
+            dq2 -= step * s2;
+            dq3 -= step * s3;
+        }
+    }
+
+    q_ = Quaternion{q0 + dq0 * dt, q1 + dq1 * dt, q2 + dq2 * dt,
+                    q3 + dq3 * dt};
+    normalize(q_);
+}
+
+MahonyFilter::MahonyFilter(float kp, float ki) : kp_(kp), ki_(ki) {}
+
+void MahonyFilter::reset()
+{
+    OrientationFilter::reset();
+    integral_ = Vec3{0.0f, 0.0f, 0.0f};
+}
+
+void MahonyFilter::update(const Vec3& gyro, const Vec3& accel, float dt)
+{
+    const float q0 = q_.w, q1 = q_.x, q2 = q_.y, q3 = q_.z;
+    Vec3 w = gyro;
+
+    Vec3 a = accel;
+    if (normalize(a))
+    {
+        // Gravity direction the estimate predicts in the sensor frame
+        const float vx = 2.0f * (q1 * q3 - q0 * q2);
+        const float vy = 2.0f * (q0 * q1 + q2 * q3);
+        const float vz = q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3;
+
+        // Rotation that takes the estimate onto the measurement
+        const float ex = a.y * vz - a.z * vy;
+        const float ey = a.z * vx - a.x * vz;
+        const float ez = a.x * vy - a.y * vx;
+
+        if (ki_ > 0.0f)
+        {
+            integral_.x += ki_ * ex * dt;
+            integral_.y += ki_ * ey * dt;
+            integral_.z += ki_ * ez * dt;
+            w.x += integral_.x;
+            w.y += integral_.y;
+            w.z += integral_.z;
+        }
+        w.x += kp_ * ex;
+        w.y += kp_ * ey;
+        w.z += kp_ * ez;
+    }
+
+    const float h = 0.5f * dt;
+    q_ = Quaternion{q0 + h * (-q1 * w.x - q2 * w.y - q3 * w.z),
+                    q1 + h * (q0 * w.x + q2 * w.z - q3 * w.y),
+                    q2 + h * (q0 * w.y - q1 * w.z + q3 * w.x),
+                    q3 + h * (q0 * w.z + q1 * w.y - q2 * w.x)};
+    normalize(q_);
+}
+
+}  // namespace LBR
@@ -0,0 +1,124 @@
+/**
+ * @file orientation_filter.h
+ * @brief Gyro/accel orientation filters to run on raw IMU samples
+ * @date 10/17/2026
+ * @note Both filters are the 6-axis (no magnetometer) forms, so yaw is
+ *       integrated gyro only and drifts with gyro bias
+ */
+
+#pragma once
+
+#include "imu_math.h"
+
+namespace LBR
+{
+
+/**
+ * @class OrientationFilter
+ * @brief Fuses angular rate and measured gravity into an orientation
+ * @details The quaternion rotates sensor-frame vectors into the earth frame,
+ *          with earth z pointing up.
+ */
+class OrientationFilter
+{
+public:
+    /**
+     * @brief Advance the estimate by one sample
+     * @param gyro angular rate in rad/s
+     * @param accel specific force in any unit, only its direction is used,
+     *              all zero skips the correction
+     * @param dt seconds since the previous sample
+     */
+    virtual void update(const Vec3& gyro, const Vec3& accel, float dt) = 0;
+
+    /**
+     * @brief Restart from a level, zero-yaw orientation
+     */
+    virtual void reset();
+
+    /**
+     * @brief Restart aligned with the gravity in accel, zero yaw
+     * @note Skips the convergence a cold start from level would need
+     */
+    void reset(const Vec3& accel);
+
+    const Quaternion& orientation() const
+    {
+        return q_;
+    }
+
+    ~OrientationFilter() = default;
+
+protected:
+    /**
+     * @brief Scales v to unit length
+     * @return false if v is zero and was left alone
+     */
+    static bool normalize(Vec3& v);
+    static void normalize(Quaternion& q);
+
+    Quaternion q_{1.0f, 0.0f, 0.0f, 0.0f};
+};
+
+/**
+ * @class MadgwickFilter
+ * @brief Gradient-descent filter, S. Madgwick 2010
+ * @details One gain: beta, the gyro error it corrects in rad/s. Larger
+ *          follows accel faster but lets linear acceleration through.
+ */
+class MadgwickFilter : public OrientationFilter
+{
+public:
+    explicit MadgwickFilter(float beta = 0.1f);
+
+    void update(const Vec3& gyro, const Vec3& accel, float dt) override;
+
+    void set_beta(float beta)
+    {
+        beta_ = beta;
+    }
+
+private:
+    float beta_;
+};
+
+/**
+ * @class MahonyFilter
+ * @brief Nonlinear complementary filter, R. Mahony 2008
+ * @details PI feedback of the accel/estimate gravity error into the gyro:
+ *          kp sets how fast accel pulls the estimate, ki learns gyro bias
+ *          in rad/s per rad of error and second.
+ */
+class MahonyFilter : public OrientationFilter
+{
+public:
+    explicit MahonyFilter(float kp = 1.0f, float ki = 0.0f);
+
+    void update(const Vec3& gyro, const Vec3& accel, float dt) override;
+
+    /**
+     * @brief Also clears the learned gyro bias
+     */
+    void reset() override;
+
+    void set_gains(float kp, float ki)
+    {
+        kp_ = kp;
+        ki_ = ki;
+    }
+
+    /**
+     * @return gyro bias correction learned by the integral term, rad/s
+     */
+    const Vec3& bias() const
+    {
+        return integral_;
+    }
+
+private:
+    float kp_;
+    float ki_;
+    Vec3 integral_{0.0f, 0.0f, 0.0f};
+};
+
+}  // namespace LBR
@@ -0,0 +1,74 @@
+#include "pid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace LBR
+{
+
+PidController::PidController(const PidGains& gains, float dt_s, float out_min,
+                             float out_max, float d_tau_s)
+    : gains_(gains),
+      dt_s_(dt_s),
+      out_min_(out_min),
+      out_max_(out_max),
+      d_alpha_(dt_s / (d_tau_s + dt_s))
+{
+}
+
+float PidController::update(float setpoint, float measurement)
+{
+    const float error = setpoint - measurement;
+
+    if (has_prev_)
+    {
+        const float rate = (measurement - prev_measurement_) / dt_s_;
+        derivative_ += d_alpha_ * (-gains_.kd * rate - derivative_);
+    }
+    prev_measurement_ = measurement;
+    has_prev_ = true;
+
+    float integral = integral_;
+    if (i_zone_ <= 0.0f || std::fabs(error) <= i_zone_)
+    {
+        integral = std::clamp(integral_ + gains_.ki * error * dt_s_,
+                              out_min_, out_max_);
+    }
+    float out = gains_.kp * error + integral + derivative_;
+
+    // Saturated: keep the integrator from winding further the same way
+    if (out > out_max_)
+    {
+        out = out_max_;
+        if (error > 0.0f)
+        {
+            integral = integral_;
+        }
+    }
+    else if (out < out_min_)
+    {
+        out = out_min_;
+        if (error < 0.0f)
+        {
+            integral = integral_;
+        }
+    }
+    integral_ = integral;
+    return out;
+}
+
+void PidController::reset()
+{
+    integral_ = 0.0f;
+    derivative_ = 0.0f;
+    prev_measurement_ = 0.0f;
+    has_prev_ = false;
+}
+
+void PidController::set_output_limits(float out_min, float out_max)
+{
+    out_min_ = out_min;
+    out_max_ = out_max;
+    integral_ = std::clamp(integral_, out_min_, out_max_);
+}
+
+}  // namespace LBR
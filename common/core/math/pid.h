@@ -0,0 +1,88 @@
+/**
+ * @file pid.h
+ * @brief Fixed-rate PID controller
+ * @date 10/17/2026
+ */
+
+#pragma once
+
+namespace LBR
+{
+
+/**
+ * @struct PidGains
+ * @brief Gains in output units per unit of error (kp), per unit error and
+ *        second (ki), per unit of error rate (kd)
+ */
+struct PidGains
+{
+    float kp;
+    float ki;
+    float kd;
+};
+
+/**
+ * @class PidController
+ * @brief Discrete PID for a loop called every dt seconds
+ * @details
+ *   - Output saturated to [out_min, out_max]
+ *   - Anti-windup: the integrator is clamped to the output range and
+ *     holds while the output is saturated in the direction of the error,
+ *     or optionally while the error is outside an integration zone
+ *   - Derivative on the measurement, so a setpoint step does not kick,
+ *     optionally low-pass filtered against quantized measurements
+ */
+class PidController
+{
+public:
+    /**
+     * @param d_tau_s time constant of the derivative low-pass, 0 for none
+     */
+    PidController(const PidGains& gains, float dt_s, float out_min,
+                  float out_max, float d_tau_s = 0.0f);
+
+    /**
+     * @brief One control step
+     * @return saturated output
+     */
+    float update(float setpoint, float measurement);
+
+    /**
+     * @brief Clears the integrator and derivative history
+     */
+    void reset();
+
+    /**
+     * @note The integrator is clamped into the new range
+     */
+    void set_output_limits(float out_min, float out_max);
+
+    void set_gains(const PidGains& gains)
+    {
+        gains_ = gains;
+    }
+
+    /**
+     * @brief Only integrate while |error| <= zone, 0 to always integrate
+     * @note Keeps a long unsaturated approach from charging the integrator,
+     *       it then only works against the friction near the setpoint
+     */
+    void set_integral_zone(float zone)
+    {
+        i_zone_ = zone;
+    }
+
+private:
+    PidGains gains_;
+    float dt_s_;
+    float out_min_;
+    float out_max_;
+    float d_alpha_;         ///< Derivative low-pass weight of a new sample
+    float i_zone_{0.0f};
+    float integral_{0.0f};  ///< Integral term, in output units
+    float derivative_{0.0f};
+    float prev_measurement_{0.0f};
+    bool has_prev_{false};
+};
+
+}  // namespace LBR
@@ -0,0 +1,281 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include "encoder_velocity.h"
+
+using namespace LBR;
+
+namespace
+{
+
+constexpr uint32_t TIMER_HZ = 80'000'000;  // Edge timestamps at SYSCLK
+constexpr float DT_S = 1e-3f;
+constexpr EncoderVelocityParams PARAMS{DT_S, 0.5f};
+constexpr int STEPS_PER_TICK = 1000;  // Shaft simulated at 1us
+constexpr double PI = 3.14159265358979;
+
+/* A/B pair of a shaft at pos counts. A switches at even counts, B at odd
+ * ones plus phase_error of a count, as a misaligned encoder disc does. */
+struct Quadrature
+{
+    bool a;
+    bool b;
+};
+
+Quadrature channels(double pos, double phase_error)
+{
+    int n = static_cast<int>(std::floor(pos));
+    if ((n & 1) && pos < n + phase_error)
+    {
+        n--;
+    }
+    // Gray code: 00, 01, 11, 10
+    const int gray = (n & 3) ^ ((n & 3) >> 1);
+    return {static_cast<bool>(gray & 2), static_cast<bool>(gray & 1)};
+}
+
+/* Decodes the A/B stream into counts like the timer in encoder mode and
+ * times the first edge after each getEdge(), like HwEncoder */
+class QuadratureDecoder : public Encoder
+{
+public:
+    explicit QuadratureDecoder(bool timed) : timed_(timed) {}
+
+    void sample(Quadrature q, uint32_t stamp)
+    {
+        now_ = stamp;
+        const int state = (q.a << 1) | q.b;
+        // +1 for 00 > 01 > 11 > 10 > 00, -1 backwards
+        static constexpr int STEP[16] = {0,  1, -1, 0, -1, 0, 0, 1,
+                                         1, 0, 0,  -1, 0, -1, 1, 0};
+        const int step = STEP[(state_ << 2) | state];
+        state_ = state;
+        if (step == 0)
+        {
+            return;
+        }
+        ticks_ += step;
+        if (armed_)
+        {
+            edge_ = EncoderEdge{ticks_, stamp, stamp};
+            has_edge_ = true;
+            armed_ = false;
+        }
+    }
+
+    void prime(Quadrature q)
+    {
+        state_ = (q.a << 1) | q.b;
+    }
+
+    int getTicks() const override
+    {
+        return ticks_;
+    }
+
+    int getStatus() const override
+    {
+        return 0;
+    }
+
+    bool getEdge(EncoderEdge& edge) const override
+    {
+        if (!timed_ || !has_edge_)
+        {
+            return false;
+        }
+        edge = edge_;
+        edge.now = now_;
+        armed_ = true;
+        return true;
+    }
+
+    uint32_t getTimestampHz() const override
+    {
+        return timed_ ? TIMER_HZ : 0;
+    }
+
+private:
+    bool timed_;
+    int state_{0};
+    int ticks_{0};
+    uint32_t now_{0};
+    EncoderEdge edge_{};
+    bool has_edge_{false};
+    mutable bool armed_{true};
+};
+
+struct Error
+{
+    double rms;
+    double max;
+};
+
+struct Scenario
+{
+    std::function<double(double)> speed;  ///< counts/s at t seconds
+    double seconds;
+    bool timed{true};
+    double phase_error{0.0};
+    uint32_t stamp_offset{0};  ///< Start of the timestamp counter
+    double settle_s{0.6};      ///< Not scored, the estimate starts from 0
+};
+
+Error run(const Scenario& r)
+{
+    QuadratureDecoder encoder(r.timed);
+    EncoderVelocity velocity(encoder, PARAMS);
+    double pos = 0.3;
+    encoder.prime(channels(pos, r.phase_error));
+
+    const double step_s = DT_S / STEPS_PER_TICK;
+    double sum_sq = 0.0;
+    double max_err = 0.0;
+    int scored = 0;
+    const int ticks = static_cast<int>(r.seconds / DT_S);
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        for (int i = 1; i <= STEPS_PER_TICK; i++)
+        {
+            const double t = (tick * STEPS_PER_TICK + i) * step_s;
+            pos += r.speed(t) * step_s;
+            const uint32_t stamp =
+                r.stamp_offset + static_cast<uint32_t>(
+                                     static_cast<uint64_t>(t * TIMER_HZ));
+            encoder.sample(channels(pos, r.phase_error), stamp);
+        }
+        const double estimate = velocity.update();
+        const double t = (tick + 1) * DT_S;
+        if (t >= r.settle_s)
+        {
+            const double err = estimate - r.speed(t);
+            sum_sq += err * err;
+            max_err = std::fmax(max_err, std::fabs(err));
+            scored++;
+        }
+    }
+    return {std::sqrt(sum_sq / scored), max_err};
+}
+
+TEST(EncoderVelocityTest, TimedEdgesAreAccurateFromCrawlToFullSpeed)
+{
+    std::printf("%10s %22s %22s\n", "counts/s", "M/T rms (max) %",
+                "counts/dt rms (max) %");
+    for (double speed : {5.0, 20.0, 100.0, 1000.0, 10'000.0, 100'000.0})
+    {
+        auto constant = [speed](double) { return speed; };
+        const Error timed = run({constant, 1.6});
+        const Error counted = run({constant, 1.6, false});
+        std::printf("%10.0f %12.3f (%7.3f) %12.3f (%7.3f)\n", speed,
+                    100 * timed.rms / speed, 100 * timed.max / speed,
+                    100 * counted.rms / speed, 100 * counted.max / speed);
+
+        EXPECT_LT(timed.rms / speed, 0.001) << speed << " counts/s";
+        EXPECT_LT(timed.max / speed, 0.002) << speed << " counts/s";
+        if (speed <= 100.0)
+        {
+            // A count per tick or less, counts / dt is mostly 0 or 1000
+            EXPECT_GT(counted.rms / speed, 1.0) << speed << " counts/s";
+        }
+    }
+}
+
+TEST(EncoderVelocityTest, FullCycleWindowCancelsPhaseError)
+{
+    // 10% A/B misalignment, both the windows and the hold bound between
+    // edges span a full cycle once four edges are in
+    for (double speed : {20.0, 50.0, 100.0, 200.0, 1000.0, 10'000.0})
+    {
+        const Error e =
+            run({[speed](double) { return speed; }, 1.6, true, 0.1});
+        EXPECT_LT(e.max / speed, 0.002) << speed << " counts/s";
+    }
+}
+
+TEST(EncoderVelocityTest, TimestampWrapIsHarmless)
+{
+    // The 32-bit timestamp wraps every 53s at 80MHz, here mid-run
+    Scenario r{[](double) { return 50.0; }, 1.6};
+    r.stamp_offset = UINT32_MAX - TIMER_HZ;  // Wraps at 1s
+    const Error e = run(r);
+    EXPECT_LT(e.max / 50.0, 0.002);
+}
+
+TEST(EncoderVelocityTest, StopDecaysToZero)
+{
+    // 50 counts/s, then the shaft stops dead at 1s
+    auto speed = [](double t) { return t < 1.0 ? 50.0 : 0.0; };
+    QuadratureDecoder encoder(true);
+    EncoderVelocity velocity(encoder, PARAMS);
+    double pos = 0.3;
+    encoder.prime(channels(pos, 0.0));
+
+    float prev = 0.0f;
+    for (int tick = 0; tick < 2000; tick++)
+    {
+        for (int i = 1; i <= STEPS_PER_TICK; i++)
+        {
+            const double t = (tick * STEPS_PER_TICK + i) * 1e-6;
+            pos += speed(t) * 1e-6;
+            encoder.sample(channels(pos, 0.0),
+                           static_cast<uint32_t>(t * TIMER_HZ));
+        }
+        const float v = velocity.update();
+        const double t = (tick + 1) * DT_S;
+        if (t > 0.6 && t < 1.0)
+        {
+            EXPECT_NEAR(v, 50.0f, 0.1f) << "t " << t;
+        }
+        if (t > 1.02)
+        {
+            // Never rises while stopped, bounded by a cycle since the edge
+            // three counts before the last, 60ms before the stop at most
+            EXPECT_LE(v, prev) << "t " << t;
+            EXPECT_LE(v, 4.0 / (t - 1.0 + 0.06)) << "t " << t;
+        }
+        if (t >= 1.0 + PARAMS.stall_s + 0.02)
+        {
+            EXPECT_EQ(v, 0.0f) << "t " << t;
+        }
+        prev = v;
+    }
+}
+
+TEST(EncoderVelocityTest, TracksReversals)
+{
+    // 2000 counts/s peak at 1Hz, through zero twice a second
+    auto sine = [](double t) { return 2000.0 * std::sin(2.0 * PI * t); };
+    const Error timed = run({sine, 2.0});
+    const Error counted = run({sine, 2.0, false});
+    std::printf("sine: M/T rms %.1f max %.1f, counts/dt rms %.1f max %.1f "
+                "counts/s\n",
+                timed.rms, timed.max, counted.rms, counted.max);
+    EXPECT_LT(timed.rms, counted.rms / 4);
+    EXPECT_LT(timed.rms, 0.05 * 2000.0);
+}
+
+TEST(EncoderVelocityTest, UntimedEncoderFallsBackToCounts)
+{
+    // 10 counts per tick, counts / dt is exact
+    const Error e = run({[](double) { return 10'000.0; }, 0.5, false, 0.0,
+                         0, 0.1});
+    EXPECT_LT(e.max, 1.0);
+}
+
+TEST(EncoderVelocityTest, ResetStartsFromZero)
+{
+    QuadratureDecoder encoder(false);
+    EncoderVelocity velocity(encoder, PARAMS);
+    encoder.prime({false, false});
+    EXPECT_EQ(velocity.update(), 0.0f);
+    encoder.sample({false, true}, 0);
+    EXPECT_FLOAT_EQ(velocity.update(), 1.0f / DT_S);
+
+    velocity.reset();
+    EXPECT_EQ(velocity.velocity(), 0.0f);
+    encoder.sample({true, true}, 0);
+    EXPECT_EQ(velocity.update(), 0.0f);
+}
+
+}  // namespace
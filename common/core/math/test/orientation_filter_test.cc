@@ -0,0 +1,290 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "orientation_filter.h"
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+using namespace LBR;
+
+namespace
+{
+
+constexpr float RATE_HZ = 400.0f;
+constexpr float DT_S = 1.0f / RATE_HZ;
+constexpr float GRAVITY = 9.81f;
+constexpr float RAD_TO_DEG = 57.2957795f;
+constexpr float TWO_PI = 6.2831853f;
+
+struct Sample
+{
+    Vec3 gyro;
+    Vec3 accel;
+    Quaternion truth;
+};
+
+Quaternion multiply(const Quaternion& a, const Quaternion& b)
+{
+    return {a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+            a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+            a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+            a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w};
+}
+
+// Earth z (up) seen in the sensor frame
+Vec3 up_in_sensor(const Quaternion& q)
+{
+    return {2.0f * (q.x * q.z - q.w * q.y), 2.0f * (q.w * q.x + q.y * q.z),
+            q.w * q.w - q.x * q.x - q.y * q.y + q.z * q.z};
+}
+
+float tilt_error_deg(const Quaternion& truth, const Quaternion& estimate)
+{
+    const Vec3 a = up_in_sensor(truth);
+    const Vec3 b = up_in_sensor(estimate);
+    const float dot = std::fmin(1.0f, a.x * b.x + a.y * b.y + a.z * b.z);
+    return std::acos(std::fmax(-1.0f, dot)) * RAD_TO_DEG;
+}
+
+// BNO055 AMG resolution: 100 LSB per m/s^2, 16 LSB per dps
+float quantize_accel(float v)
+{
+    return std::round(v * 100.0f) / 100.0f;
+}
+
+float quantize_gyro(float v)
+{
+    constexpr float LSB_PER_RAD = 16.0f * RAD_TO_DEG;
+    return std::round(v * LSB_PER_RAD) / LSB_PER_RAD;
+}
+
+/* Tumbling motion with sensor noise, gyro bias and 0.5s bursts of linear
+ * acceleration every 10s, sampled at RATE_HZ */
+std::vector<Sample> synthetic_motion(float seconds)
+{
+    std::mt19937 rng(1);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    const int n = static_cast<int>(seconds * RATE_HZ);
+    std::vector<Sample> samples(n);
+    Quaternion q{1.0f, 0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < n; i++)
+    {
+        const float t = i * DT_S;
+        const Vec3 rate{1.5f * std::sin(TWO_PI * 0.5f * t),
+                        1.0f * std::sin(TWO_PI * 0.3f * t + 1.0f),
+                        0.8f * std::cos(TWO_PI * 0.2f * t)};
+        // Truth integrated in substeps, finer than the filter's
+        constexpr int SUBSTEPS = 10;
+        for (int k = 0; k < SUBSTEPS; k++)
+        {
+            const Quaternion dq =
+                multiply(q, Quaternion{0.0f, rate.x, rate.y, rate.z});
+            const float h = 0.5f * DT_S / SUBSTEPS;
+            q = {q.w + h * dq.w, q.x + h * dq.x, q.y + h * dq.y,
+                 q.z + h * dq.z};
+            const float norm =
+                std::sqrt(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z);
+            q = {q.w / norm, q.x / norm, q.y / norm, q.z / norm};
+        }
+
+        const Vec3 up = up_in_sensor(q);
+        const float linear = (std::fmod(t, 10.0f) < 0.5f) ? 3.0f : 0.0f;
+        samples[i].accel = {
+            quantize_accel(GRAVITY * up.x + linear + 0.05f * noise(rng)),
+            quantize_accel(GRAVITY * up.y + 0.05f * noise(rng)),
+            quantize_accel(GRAVITY * up.z + 0.05f * noise(rng))};
+        samples[i].gyro = {
+            quantize_gyro(rate.x + 0.01f + 0.003f * noise(rng)),
+            quantize_gyro(rate.y - 0.008f + 0.003f * noise(rng)),
+            quantize_gyro(rate.z + 0.005f + 0.003f * noise(rng))};
+        samples[i].truth = q;
+    }
+    return samples;
+}
+
+struct TiltError
+{
+    float rms_deg;
+    float max_deg;
+};
+
+// Error after a 2s settling time
+TiltError track(OrientationFilter& filter, const std::vector<Sample>& samples)
+{
+    filter.reset(samples[0].accel);
+    double sum_sq = 0.0;
+    float max_deg = 0.0f;
+    int count = 0;
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        filter.update(samples[i].gyro, samples[i].accel, DT_S);
+        if (i < 2 * RATE_HZ)
+        {
+            continue;
+        }
+        const float err = tilt_error_deg(samples[i].truth,
+                                         filter.orientation());
+        sum_sq += err * err;
+        max_deg = std::fmax(max_deg, err);
+        count++;
+    }
+    return {static_cast<float>(std::sqrt(sum_sq / count)), max_deg};
+}
+
+class OrientationFilterTest : public ::testing::Test
+{
+protected:
+    static void SetUpTestSuite()
+    {
+        motion = synthetic_motion(60.0f);
+    }
+
+    static std::vector<Sample> motion;
+};
+
+std::vector<Sample> OrientationFilterTest::motion;
+
+TEST_F(OrientationFilterTest, LevelAtRestStaysLevel)
+{
+    MadgwickFilter madgwick;
+    MahonyFilter mahony;
+    const Vec3 still{0.0f, 0.0f, 0.0f};
+    const Vec3 level{0.0f, 0.0f, GRAVITY};
+    for (int i = 0; i < 10 * RATE_HZ; i++)
+    {
+        madgwick.update(still, level, DT_S);
+        mahony.update(still, level, DT_S);
+    }
+    const Quaternion identity{1.0f, 0.0f, 0.0f, 0.0f};
+    EXPECT_LT(tilt_error_deg(identity, madgwick.orientation()), 0.01f);
+    EXPECT_LT(tilt_error_deg(identity, mahony.orientation()), 0.01f);
+}
+
+TEST_F(OrientationFilterTest, ConvergesFromALevelStart)
+{
+    // Held still at 30 degrees of roll, filters start level
+    const float roll = 30.0f / RAD_TO_DEG;
+    const Quaternion truth{std::cos(roll / 2), std::sin(roll / 2), 0.0f, 0.0f};
+    const Vec3 up = up_in_sensor(truth);
+    const Vec3 accel{GRAVITY * up.x, GRAVITY * up.y, GRAVITY * up.z};
+    const Vec3 still{0.0f, 0.0f, 0.0f};
+
+    MadgwickFilter madgwick(0.1f);
+    MahonyFilter mahony(1.0f);
+    for (int i = 0; i < 5 * RATE_HZ; i++)
+    {
+        madgwick.update(still, accel, DT_S);
+        mahony.update(still, accel, DT_S);
+    }
+    EXPECT_LT(tilt_error_deg(truth, madgwick.orientation()), 0.5f);
+    EXPECT_LT(tilt_error_deg(truth, mahony.orientation()), 0.5f);
+
+    // reset(accel) skips the convergence
+    MadgwickFilter aligned;
+    aligned.reset(accel);
+    EXPECT_LT(tilt_error_deg(truth, aligned.orientation()), 0.01f);
+}
+
+TEST_F(OrientationFilterTest, TracksSyntheticMotion)
+{
+    MadgwickFilter gyro_only(0.0f);
+    MadgwickFilter madgwick(0.1f);
+    MahonyFilter mahony(1.0f);
+    const TiltError drift = track(gyro_only, motion);
+    const TiltError m = track(madgwick, motion);
+    const TiltError h = track(mahony, motion);
+    std::printf("tilt error RMS / max: gyro only %.2f / %.2f deg, "
+                "Madgwick %.2f / %.2f deg, Mahony %.2f / %.2f deg\n",
+                drift.rms_deg, drift.max_deg, m.rms_deg, m.max_deg, h.rms_deg,
+                h.max_deg);
+
+    // Bias alone walks integrated gyro far off, accel pulls it back
+    EXPECT_GT(drift.rms_deg, 10.0f);
+    EXPECT_LT(m.rms_deg, 2.0f);
+    EXPECT_LT(m.max_deg, 10.0f);
+    EXPECT_LT(h.rms_deg, 3.0f);
+    EXPECT_LT(h.max_deg, 10.0f);
+}
+
+TEST_F(OrientationFilterTest, MahonyLearnsTiltGyroBias)
+{
+    // At rest and level only x/y bias is observable from gravity
+    const Vec3 bias{0.02f, -0.015f, 0.0f};
+    const Vec3 level{0.0f, 0.0f, GRAVITY};
+    MahonyFilter mahony(2.0f, 0.2f);
+    for (int i = 0; i < 60 * RATE_HZ; i++)
+    {
+        mahony.update(bias, level, DT_S);
+    }
+    EXPECT_NEAR(mahony.bias().x, -bias.x, 1e-3f);
+    EXPECT_NEAR(mahony.bias().y, -bias.y, 1e-3f);
+    EXPECT_LT(tilt_error_deg({1.0f, 0.0f, 0.0f, 0.0f}, mahony.orientation()),
+              0.05f);
+}
+
+TEST_F(OrientationFilterTest, ZeroAccelSkipsTheCorrection)
+{
+    MadgwickFilter madgwick;
+    MahonyFilter mahony;
+    const Vec3 rate{0.5f, 0.0f, 0.0f};
+    const Vec3 none{0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < RATE_HZ; i++)
+    {
+        madgwick.update(rate, none, DT_S);
+        mahony.update(rate, none, DT_S);
+    }
+    // One second at 0.5 rad/s of pure gyro integration
+    const Quaternion truth{std::cos(0.25f), std::sin(0.25f), 0.0f, 0.0f};
+    EXPECT_LT(tilt_error_deg(truth, madgwick.orientation()), 0.1f);
+    EXPECT_LT(tilt_error_deg(truth, mahony.orientation()), 0.1f);
+}
+
+// Host cost of one update, printed for comparison with the M4 budget
+template <typename Filter>
+double cost_per_update(Filter& filter, const std::vector<Sample>& samples,
+                       const char* name)
+{
+    constexpr int ROUNDS = 20;
+    filter.reset();
+    const auto start = std::chrono::steady_clock::now();
+#if defined(__x86_64__)
+    const uint64_t start_tsc = __rdtsc();
+#endif
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        for (const Sample& s : samples)
+        {
+            filter.update(s.gyro, s.accel, DT_S);
+        }
+    }
+    const double updates = static_cast<double>(ROUNDS) * samples.size();
+#if defined(__x86_64__)
+    const double cycles = (__rdtsc() - start_tsc) / updates;
+#else
+    const double cycles = 0.0;
+#endif
+    const double ns = std::chrono::duration<double, std::nano>(
+                          std::chrono::steady_clock::now() - start)
+                          .count() /
+                      updates;
+    std::printf("%-9s %7.1f TSC cycles %6.1f ns per update\n", name, cycles,
+                ns);
+    return ns;
+}
+
+TEST_F(OrientationFilterTest, UpdateCost)
+{
+    MadgwickFilter madgwick(0.1f);
+    MahonyFilter mahony(1.0f, 0.1f);
+    EXPECT_GT(cost_per_update(madgwick, motion, "Madgwick"), 0.0);
+    EXPECT_GT(cost_per_update(mahony, motion, "Mahony"), 0.0);
+
+    const Quaternion& q = madgwick.orientation();
+    EXPECT_NEAR(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z, 1.0f, 1e-4f);
+}
+
+}  // namespace
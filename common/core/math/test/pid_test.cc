@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include "pid.h"
+
+using namespace LBR;
+
+namespace
+{
+
+constexpr float DT_S = 1e-3f;
+constexpr float OUT_LIMIT = 1.0f;
+
+/* First order plant y' = (gain * u - y) / tau, stepped at DT_S. Held plants
+ * stand in for a stalled motor. */
+struct Plant
+{
+    float gain{2.0f};
+    float tau_s{0.1f};
+    float y{0.0f};
+    bool held{false};
+
+    void step(float u)
+    {
+        if (!held)
+        {
+            y += (gain * u - y) * DT_S / tau_s;
+        }
+    }
+};
+
+// Highest y seen over a run of steps
+float run(PidController& pid, Plant& plant, float setpoint, int steps)
+{
+    float peak = plant.y;
+    for (int i = 0; i < steps; i++)
+    {
+        const float u = pid.update(setpoint, plant.y);
+        EXPECT_LE(std::fabs(u), OUT_LIMIT) << "step " << i;
+        plant.step(u);
+        peak = std::max(peak, plant.y);
+    }
+    return peak;
+}
+
+TEST(PidTest, SettlesOnAFirstOrderPlant)
+{
+    PidController pid({2.0f, 20.0f, 0.0f}, DT_S, -OUT_LIMIT, OUT_LIMIT);
+    Plant plant;
+    const float peak = run(pid, plant, 1.0f, 3000);
+    EXPECT_NEAR(plant.y, 1.0f, 1e-3f);
+    EXPECT_LT(peak, 1.1f);
+
+    // A new setpoint settles the same way, the other direction too
+    run(pid, plant, -0.5f, 3000);
+    EXPECT_NEAR(plant.y, -0.5f, 1e-3f);
+}
+
+TEST(PidTest, NoWindupOvershootAfterTheLimitReleases)
+{
+    const PidGains gains{2.0f, 20.0f, 0.0f};
+
+    // Reference: the same step without a stall
+    PidController free_pid(gains, DT_S, -OUT_LIMIT, OUT_LIMIT);
+    Plant free_plant;
+    const float free_peak = run(free_pid, free_plant, 1.0f, 3000);
+
+    // Stalled for 2 s at full output, then let go
+    PidController pid(gains, DT_S, -OUT_LIMIT, OUT_LIMIT);
+    Plant plant;
+    plant.held = true;
+    for (int i = 0; i < 2000; i++)
+    {
+        EXPECT_EQ(pid.update(1.0f, plant.y), OUT_LIMIT);
+    }
+    plant.held = false;
+    const float peak = run(pid, plant, 1.0f, 3000);
+
+    EXPECT_LT(peak, free_peak + 0.01f);
+    EXPECT_NEAR(plant.y, 1.0f, 1e-3f);
+}
+
+TEST(PidTest, IntegratorIsClampedToTheOutputRange)
+{
+    // Integral alone, error of 1 for 10 s would reach 10 unclamped
+    PidController pid({0.0f, 1.0f, 0.0f}, DT_S, -OUT_LIMIT, OUT_LIMIT);
+    for (int i = 0; i < 10'000; i++)
+    {
+        pid.update(1.0f, 0.0f);
+    }
+    EXPECT_FLOAT_EQ(pid.update(0.0f, 0.0f), OUT_LIMIT);
+
+    // Narrower limits pull the stored integral in with them
+    pid.set_output_limits(-0.25f, 0.25f);
+    EXPECT_FLOAT_EQ(pid.update(0.0f, 0.0f), 0.25f);
+
+    // Unwinds from the limit at once, not from 10
+    EXPECT_LT(pid.update(-1.0f, 0.0f), 0.25f);
+}
+
+TEST(PidTest, NothingIntegratesOutsideTheZone)
+{
+    PidController pid({0.0f, 10.0f, 0.0f}, DT_S, -OUT_LIMIT, OUT_LIMIT);
+    pid.set_integral_zone(0.1f);
+    for (int i = 0; i < 1000; i++)
+    {
+        ASSERT_EQ(pid.update(0.5f, 0.0f), 0.0f) << "step " << i;
+        ASSERT_EQ(pid.update(-0.5f, 0.0f), 0.0f) << "step " << i;
+    }
+
+    // Inside the zone it integrates ki * error * dt per step
+    const float out = pid.update(0.05f, 0.0f);
+    EXPECT_NEAR(out, 10.0f * 0.05f * DT_S, 1e-7f);
+    EXPECT_NEAR(pid.update(0.05f, 0.0f), 2.0f * out, 1e-7f);
+}
+
+TEST(PidTest, SetpointStepDoesNotKick)
+{
+    PidController pid({0.0f, 0.0f, 0.5f}, DT_S, -OUT_LIMIT, OUT_LIMIT);
+    EXPECT_EQ(pid.update(0.0f, 0.0f), 0.0f);
+    EXPECT_EQ(pid.update(10.0f, 0.0f), 0.0f);
+    EXPECT_EQ(pid.update(-10.0f, 0.0f), 0.0f);
+
+    // The measurement moving is what drives the derivative
+    EXPECT_NEAR(pid.update(-10.0f, 1e-3f), -0.5f, 1e-4f);
+}
+
+TEST(PidTest, DerivativeFilterSpreadsAMeasurementStep)
+{
+    constexpr float TAU_S = 9e-3f;  // Weight of 0.1 per sample
+    constexpr float KD = 1e-3f;
+    PidController pid({0.0f, 0.0f, KD}, DT_S, -OUT_LIMIT, OUT_LIMIT, TAU_S);
+    pid.update(0.0f, 0.0f);
+
+    // Unfiltered this is -KD / DT_S = -1 for one step
+    float out = pid.update(0.0f, 1.0f);
+    EXPECT_NEAR(out, -0.1f, 1e-5f);
+
+    // Then decays by 0.9 a step while the measurement rests
+    for (int i = 0; i < 20; i++)
+    {
+        const float next = pid.update(0.0f, 1.0f);
+        ASSERT_NEAR(next, 0.9f * out, 1e-5f) << "step " << i;
+        out = next;
+    }
+
+    pid.reset();
+    EXPECT_EQ(pid.update(0.0f, 5.0f), 0.0f);
+}
+
+}  // namespace
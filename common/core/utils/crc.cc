@@ -0,0 +1,27 @@
+#include "crc.h"
+#include <array>
+
+namespace LBR
+{
+namespace Utils
+{
+
+/* Nibble table, 64 bytes of flash instead of 1KB for the byte table */
+static constexpr std::array<uint32_t, 16> CRC32_NIBBLE{
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+    0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+
+uint32_t crc32(std::span<const uint8_t> data, uint32_t crc)
+{
+    crc = ~crc;
+    for (const uint8_t byte : data)
+    {
+        crc = (crc >> 4) ^ CRC32_NIBBLE[(crc ^ byte) & 0x0F];
+        crc = (crc >> 4) ^ CRC32_NIBBLE[(crc ^ (byte >> 4)) & 0x0F];
+    }
+    return ~crc;
+}
+
+}  // namespace Utils
+}  // namespace LBR
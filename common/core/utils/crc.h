@@ -0,0 +1,26 @@
+/**
+ * @file crc.h
+ * @brief Checksums for stored and transmitted records
+ * @date 10/17/2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+namespace LBR
+{
+namespace Utils
+{
+
+/**
+ * @brief CRC-32 (IEEE 802.3, reflected, as zlib)
+ * @param data bytes to checksum
+ * @param crc result of a previous call to continue a running checksum
+ * @return checksum of everything fed so far
+ */
+uint32_t crc32(std::span<const uint8_t> data, uint32_t crc = 0);
+
+}  // namespace Utils
+}  // namespace LBR
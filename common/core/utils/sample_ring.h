@@ -0,0 +1,198 @@
+/**
+ * @file sample_ring.h
+ * @brief Fixed-capacity history of timestamped samples
+ * @date 10/17/2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace LBR
+{
+namespace Utils
+{
+
+/**
+ * @class SampleRing
+ * @brief Lock-free ring of the last N samples, oldest overwritten first
+ * @details One producer pushes, any number of readers in other contexts
+ *          (main loop vs. ISR) read. Nothing blocks: a reader copies a
+ *          sample out and then checks that the producer did not lap it
+ *          meanwhile, a lapped read fails instead of returning torn data.
+ * @tparam T sample type, trivially copyable
+ * @tparam N slots, a power of two. N - 1 samples are readable, the last
+ *           slot is the one the producer writes next.
+ */
+template <typename T, size_t N>
+class SampleRing
+{
+    static_assert(N > 1 && (N & (N - 1)) == 0, "N must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Readers copy samples while the producer may write them");
+
+public:
+    static constexpr size_t CAPACITY = N - 1;
+
+    struct Sample
+    {
+        uint32_t stamp_ms;
+        T value;
+    };
+
+    /**
+     * @class View
+     * @brief Subset of the history fixed when the view was taken, index 0
+     *        is the newest sample in it
+     */
+    class View
+    {
+    public:
+        size_t size() const
+        {
+            return count_;
+        }
+
+        /**
+         * @return false if out of range or overwritten since the view was
+         *         taken
+         */
+        bool get(size_t idx, Sample& out) const
+        {
+            if (idx >= count_)
+            {
+                return false;
+            }
+            return ring_.read_seq(newest_ - idx * stride_, out);
+        }
+
+    private:
+        friend class SampleRing;
+
+        View(const SampleRing& ring, uint32_t newest, size_t count,
+             size_t stride)
+            : ring_(ring), newest_(newest), count_(count), stride_(stride)
+        {
+        }
+
+        const SampleRing& ring_;
+        uint32_t newest_;
+        size_t count_;
+        size_t stride_;
+    };
+
+    /**
+     * @brief Producer only
+     */
+    void push(uint32_t stamp_ms, const T& value)
+    {
+        const uint32_t head = head_.load(std::memory_order_relaxed);
+        slots_[head & MASK] = Sample{stamp_ms, value};
+        if (head + 1 == CAPACITY)
+        {
+            full_.store(true, std::memory_order_relaxed);
+        }
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Samples currently held, up to CAPACITY
+     */
+    size_t size() const
+    {
+        return held(head_.load(std::memory_order_acquire));
+    }
+
+    /**
+     * @brief Total pushes so far, wraps at 2^32. A change means new data.
+     */
+    uint32_t pushed() const
+    {
+        return head_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @param age 0 for the newest sample, 1 for the one before, ...
+     * @return false if there is no such sample or it was overwritten
+     */
+    bool get(size_t age, Sample& out) const
+    {
+        const uint32_t head = head_.load(std::memory_order_acquire);
+        if (age >= held(head))
+        {
+            return false;
+        }
+        return read_seq(head - 1 - static_cast<uint32_t>(age), out);
+    }
+
+    /**
+     * @brief Every stride-th sample starting from the newest
+     * @param count samples wanted, fewer if the history is shorter
+     */
+    View decimated(size_t stride, size_t count) const
+    {
+        const uint32_t head = head_.load(std::memory_order_acquire);
+        const size_t count_held = held(head);
+        if (stride == 0 || count_held == 0)
+        {
+            return View(*this, head - 1, 0, 1);
+        }
+        const size_t available = (count_held - 1) / stride + 1;
+        return View(*this, head - 1, (count < available) ? count : available,
+                    stride);
+    }
+
+    /**
+     * @brief Samples stamped within span_ms of now_ms, newest first
+     */
+    View window(uint32_t now_ms, uint32_t span_ms) const
+    {
+        const uint32_t head = head_.load(std::memory_order_acquire);
+        const size_t count_held = held(head);
+        size_t count = 0;
+        Sample s;
+        // Wrap-safe, stamps are only compared as a difference
+        while (count < count_held && read_seq(head - 1 - count, s) &&
+               now_ms - s.stamp_ms <= span_ms)
+        {
+            count++;
+        }
+        return View(*this, head - 1, count, 1);
+    }
+
+private:
+    static constexpr uint32_t MASK = N - 1;
+
+    size_t held(uint32_t head) const
+    {
+        // head alone is ambiguous once it wraps at 2^32
+        if (head >= CAPACITY || full_.load(std::memory_order_relaxed))
+        {
+            return CAPACITY;
+        }
+        return head;
+    }
+
+    /* Sequence seq lives in slot seq % N until the producer starts writing
+     * seq + N, which happens while head == seq + N */
+    bool read_seq(uint32_t seq, Sample& out) const
+    {
+        if (head_.load(std::memory_order_acquire) - seq >= N)
+        {
+            return false;
+        }
+        out = slots_[seq & MASK];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return head_.load(std::memory_order_relaxed) - seq < N;
+    }
+
+    Sample slots_[N]{};
+    std::atomic<uint32_t> head_{0};
+    std::atomic<bool> full_{false};
+};
+
+}  // namespace Utils
+}  // namespace LBR
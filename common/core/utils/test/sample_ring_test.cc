@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include "sample_ring.h"
+
+using namespace LBR::Utils;
+
+namespace
+{
+
+using Ring = SampleRing<int, 8>;
+
+void fill(Ring& ring, int count, uint32_t stamp_step = 10)
+{
+    for (int i = 0; i < count; i++)
+    {
+        ring.push(static_cast<uint32_t>(i) * stamp_step, i);
+    }
+}
+
+TEST(SampleRingTest, EmptyRingHasNothing)
+{
+    Ring ring;
+    Ring::Sample s;
+    EXPECT_EQ(ring.size(), 0u);
+    EXPECT_EQ(ring.pushed(), 0u);
+    EXPECT_FALSE(ring.get(0, s));
+    EXPECT_EQ(ring.decimated(1, 4).size(), 0u);
+    EXPECT_EQ(ring.window(100, 100).size(), 0u);
+}
+
+TEST(SampleRingTest, NewestFirst)
+{
+    Ring ring;
+    fill(ring, 3);
+    EXPECT_EQ(ring.size(), 3u);
+    Ring::Sample s;
+    ASSERT_TRUE(ring.get(0, s));
+    EXPECT_EQ(s.value, 2);
+    EXPECT_EQ(s.stamp_ms, 20u);
+    ASSERT_TRUE(ring.get(2, s));
+    EXPECT_EQ(s.value, 0);
+    EXPECT_FALSE(ring.get(3, s));
+}
+
+TEST(SampleRingTest, WraparoundKeepsTheLastCapacity)
+{
+    Ring ring;
+    fill(ring, 21);
+    EXPECT_EQ(ring.size(), Ring::CAPACITY);
+    EXPECT_EQ(ring.pushed(), 21u);
+
+    Ring::Sample s;
+    for (size_t age = 0; age < Ring::CAPACITY; age++)
+    {
+        ASSERT_TRUE(ring.get(age, s));
+        EXPECT_EQ(s.value, 20 - static_cast<int>(age));
+    }
+    EXPECT_FALSE(ring.get(Ring::CAPACITY, s));
+}
+
+TEST(SampleRingTest, FullExactlyAtCapacity)
+{
+    Ring ring;
+    fill(ring, Ring::CAPACITY);
+    EXPECT_EQ(ring.size(), Ring::CAPACITY);
+    ring.push(1000, 99);
+    EXPECT_EQ(ring.size(), Ring::CAPACITY);
+}
+
+TEST(SampleRingTest, DecimatedViewStridesFromTheNewest)
+{
+    Ring ring;
+    fill(ring, 21);
+    const Ring::View view = ring.decimated(3, 10);
+    // Seven held: 20..14, every third of them
+    ASSERT_EQ(view.size(), 3u);
+    Ring::Sample s;
+    const int expected[] = {20, 17, 14};
+    for (size_t i = 0; i < view.size(); i++)
+    {
+        ASSERT_TRUE(view.get(i, s));
+        EXPECT_EQ(s.value, expected[i]);
+    }
+    EXPECT_FALSE(view.get(3, s));
+
+    EXPECT_EQ(ring.decimated(2, 2).size(), 2u);
+    EXPECT_EQ(ring.decimated(0, 2).size(), 0u);
+}
+
+TEST(SampleRingTest, WindowCoversTheSpan)
+{
+    Ring ring;
+    fill(ring, 21);  // Stamps 0..200
+    const Ring::View view = ring.window(200, 35);
+    ASSERT_EQ(view.size(), 4u);  // 200, 190, 180, 170
+    Ring::Sample s;
+    ASSERT_TRUE(view.get(3, s));
+    EXPECT_EQ(s.stamp_ms, 170u);
+}
+
+TEST(SampleRingTest, WindowAcrossTheStampWrap)
+{
+    Ring ring;
+    const uint32_t start = UINT32_MAX - 15;
+    for (int i = 0; i < 5; i++)
+    {
+        ring.push(start + static_cast<uint32_t>(i) * 10, i);
+    }
+    // Last stamps: 0xFFFFFFF0 + 40 wraps to 24
+    const Ring::View view = ring.window(start + 40, 25);
+    EXPECT_EQ(view.size(), 3u);
+}
+
+TEST(SampleRingTest, LappedViewFailsInsteadOfLying)
+{
+    Ring ring;
+    fill(ring, 5);
+    const Ring::View view = ring.decimated(1, 5);
+    Ring::Sample s;
+    ASSERT_TRUE(view.get(4, s));
+    EXPECT_EQ(s.value, 0);
+
+    // Overwrites everything the view pointed at
+    fill(ring, 8);
+    for (size_t i = 0; i < view.size(); i++)
+    {
+        EXPECT_FALSE(view.get(i, s));
+    }
+}
+
+// Every word of a sample carries its sequence number, a torn copy mixes two
+struct Wide
+{
+    uint32_t words[16];
+};
+
+TEST(SampleRingTest, ConcurrentReadersNeverSeeTornSamples)
+{
+    static SampleRing<Wide, 16> ring;
+    constexpr uint32_t PUSHES = 2'000'000;
+    std::atomic<bool> done{false};
+
+    std::thread producer([&done] {
+        for (uint32_t n = 1; n <= PUSHES; n++)
+        {
+            Wide w;
+            for (uint32_t& word : w.words)
+            {
+                word = n;
+            }
+            ring.push(n, w);
+        }
+        done.store(true);
+    });
+
+    auto reader = [&done](uint64_t& good, uint64_t& torn) {
+        SampleRing<Wide, 16>::Sample s;
+        uint32_t last = 0;
+        while (!done.load())
+        {
+            if (!ring.get(0, s))
+            {
+                continue;
+            }
+            for (uint32_t word : s.value.words)
+            {
+                if (word != s.stamp_ms)
+                {
+                    torn++;
+                    break;
+                }
+            }
+            // The newest sample never goes back in time
+            EXPECT_GE(s.stamp_ms, last);
+            last = s.stamp_ms;
+            good++;
+
+            const auto view = ring.decimated(3, 5);
+            for (size_t i = 0; i < view.size(); i++)
+            {
+                if (view.get(i, s) && s.value.words[15] != s.stamp_ms)
+                {
+                    torn++;
+                }
+            }
+        }
+    };
+
+    uint64_t good[2] = {0, 0};
+    uint64_t torn[2] = {0, 0};
+    std::thread second([&] { reader(good[1], torn[1]); });
+    reader(good[0], torn[0]);
+    producer.join();
+    second.join();
+
+    EXPECT_EQ(torn[0] + torn[1], 0u);
+    EXPECT_GT(good[0] + good[1], 0u);
+    EXPECT_EQ(ring.pushed(), PUSHES);
+}
+
+}  // namespace
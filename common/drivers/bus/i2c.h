@@ -11,6 +11,57 @@
 
 namespace LBR
 {
+/**
+ * @brief Result of an I2C transaction
+ */
+enum class I2cStatus : uint8_t
+{
+    OK = 0,
+    NOT_READY,  ///< Peripheral not initialized or bad arguments
+    BUSY,       ///< Bus or peripheral already in use
+    NACK,       ///< Target did not acknowledge
+    TIMEOUT,    ///< Transaction missed its deadline, bus was recovered
+    BUS_ERROR   ///< Misplaced START/STOP, arbitration loss or overrun
+};
+
+/**
+ * @brief One register access of a batched I2c::transfer
+ */
+struct I2cOp
+{
+    enum class Dir : uint8_t
+    {
+        READ,
+        WRITE
+    };
+
+    Dir dir;
+    uint8_t dev_addr;
+    uint8_t reg_addr;
+    std::span<uint8_t> rx;        ///< Destination of a READ
+    std::span<const uint8_t> tx;  ///< Payload of a WRITE
+
+    static constexpr I2cOp read(uint8_t dev_addr, uint8_t reg_addr,
+                                std::span<uint8_t> data)
+    {
+        return I2cOp{Dir::READ, dev_addr, reg_addr, data, {}};
+    }
+
+    static constexpr I2cOp write(uint8_t dev_addr, uint8_t reg_addr,
+                                 std::span<const uint8_t> data)
+    {
+        return I2cOp{Dir::WRITE, dev_addr, reg_addr, {}, data};
+    }
+
+    /**
+     * @brief A read of nothing, I2c::transfer skips it
+     */
+    constexpr bool is_empty_read() const
+    {
+        return dir == Dir::READ && rx.empty();
+    }
+};
+
 /**
  * @class I2c
  * @brief I2c driver instance
@@ -24,10 +75,10 @@ public:
      * @param data block of memory to read data into from the bus
      * @param reg_addr data register of external device to read from
      * @param dev_addr address of target device
-     * @return true if successful, false otherwise
+     * @return I2cStatus::OK if successful, error code otherwise
      */
-    virtual bool mem_read(std::span<uint8_t> data, const uint8_t reg_addr,
-                          uint8_t dev_addr) = 0;
+    virtual I2cStatus mem_read(std::span<uint8_t> data,
+                               const uint8_t reg_addr, uint8_t dev_addr) = 0;
 
     /**
      * @brief Read data from external device that uses 16-bit memory addresses
@@ -35,10 +86,10 @@ public:
      * @param data block of memory to read data into from the bus
      * @param reg_addr data register of external device to read from
      * @param dev_addr address of target device
-     * @return true if successful, false otherwise
+     * @return I2cStatus::OK if successful, error code otherwise
      */
-    virtual bool mem_read(std::span<uint8_t> data, const uint16_t reg_addr,
-                          uint8_t dev_addr) = 0;
+    virtual I2cStatus mem_read(std::span<uint8_t> data,
+                               const uint16_t reg_addr, uint8_t dev_addr) = 0;
 
     /**
      * @brief Writes data to external device that uses 8-bit memory addresses
@@ -46,10 +97,10 @@ public:
      * @param data block of memory storing data to write into the bus
      * @param reg_addr data register of external device to write to
      * @param dev_addr address of target device
-     * @return true if successful, false otherwise
+     * @return I2cStatus::OK if successful, error code otherwise
      */
-    virtual bool mem_write(std::span<const uint8_t> data,
-                           const uint8_t reg_addr, uint8_t dev_addr) = 0;
+    virtual I2cStatus mem_write(std::span<const uint8_t> data,
+                                const uint8_t reg_addr, uint8_t dev_addr) = 0;
 
     /**
      * @brief Writes data to external device that uses 16-bit memory addresses
@@ -57,28 +108,60 @@ public:
      * @param data block of memory storing data to write into the bus
      * @param reg_addr data register of external device to write to
      * @param dev_addr address of target device
-     * @return true if successful, false otherwise
+     * @return I2cStatus::OK if successful, error code otherwise
      */
-    virtual bool mem_write(std::span<const uint8_t> data,
-                           const uint16_t reg_addr, uint8_t dev_addr) = 0;
+    virtual I2cStatus mem_write(std::span<const uint8_t> data,
+                                const uint16_t reg_addr, uint8_t dev_addr) = 0;
 
     /**
      * @brief Read raw data from an I2C bus
      * 
      * @param data block of memory to read data into from the bus
      * @param dev_addr address of target device
-     * @return true if successful, false otherwise
+     * @return I2cStatus::OK if successful, error code otherwise
      */
-    virtual bool read(std::span<uint8_t> data, uint8_t dev_addr) = 0;
+    virtual I2cStatus read(std::span<uint8_t> data, uint8_t dev_addr) = 0;
 
     /**
      * @brief Write raw data to an I2C bus
      * 
      * @param data block of memory to write data into the bus
      * @param dev_addr address of target device
-     * @return true if successful, false otherwise
+     * @return I2cStatus::OK if successful, error code otherwise
+     */
+    virtual I2cStatus write(std::span<const uint8_t> data,
+                            uint8_t dev_addr) = 0;
+
+    /**
+     * @brief Runs a list of 8-bit register reads/writes back to back
+     * 
+     * @note Implementations chain the ops with repeated-START and only issue
+     *       STOP after the last one; this default just loops over mem_*
+     * @note A READ op with an empty rx span is a no-op, it does not touch
+     *       the bus and is not an error; an empty WRITE still sets the
+     *       register pointer
+     * @param ops operations to run in order, may target different devices
+     * @return I2cStatus::OK if every op succeeded, else the first error
      */
-    virtual bool write(std::span<const uint8_t> data, uint8_t dev_addr) = 0;
+    virtual I2cStatus transfer(std::span<const I2cOp> ops)
+    {
+        for (const I2cOp& op : ops)
+        {
+            if (op.is_empty_read())
+            {
+                continue;
+            }
+            const I2cStatus status =
+                (op.dir == I2cOp::Dir::READ)
+                    ? mem_read(op.rx, op.reg_addr, op.dev_addr)
+                    : mem_write(op.tx, op.reg_addr, op.dev_addr);
+            if (status != I2cStatus::OK)
+            {
+                return status;
+            }
+        }
+        return I2cStatus::OK;
+    }
 
     ~I2c() = default;
 };
@@ -8,9 +8,22 @@
 
 #pragma once
 
+#include <cstdint>
+
 namespace LBR
 {
 
+/**
+ * @struct EncoderEdge
+ * @brief Position at a timed edge, for measuring slow speeds
+ */
+struct EncoderEdge
+{
+    int ticks;      ///< Position just after the edge
+    uint32_t time;  ///< When the edge came, in getTimestampHz() units
+    uint32_t now;   ///< Timestamp of this read, same clock
+};
+
 /**
  * @class Encoder
  * @brief Generic Encoder driver interface (minimal: getTicks, getStatus).
@@ -31,6 +44,25 @@ public:
      * @return 0 for OK, nonzero for error.
      */
     virtual int getStatus() const = 0;
+
+    /**
+     * @brief Get the latest timed edge.
+     * @return false if edges are not timed or none came yet.
+     * @note Drivers may only time the first edge after each call.
+     */
+    virtual bool getEdge(EncoderEdge& edge) const
+    {
+        (void)edge;
+        return false;
+    }
+
+    /**
+     * @brief Rate of the EncoderEdge timestamps, 0 if edges are not timed.
+     */
+    virtual uint32_t getTimestampHz() const
+    {
+        return 0;
+    }
 };
 
 }  // namespace LBR
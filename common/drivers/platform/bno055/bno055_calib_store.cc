@@ -0,0 +1,158 @@
+#include "bno055_calib_store.h"
+#include <algorithm>
+#include "crc.h"
+
+namespace LBR
+{
+using LBR::Utils::crc32;
+
+static constexpr size_t CRC_OFFSET = 8;
+
+static void put_u16(uint8_t* dst, uint16_t value)
+{
+    dst[0] = value & 0xFF;
+    dst[1] = value >> 8;
+}
+
+static void put_u32(uint8_t* dst, uint32_t value)
+{
+    put_u16(dst, value & 0xFFFF);
+    put_u16(dst + 2, value >> 16);
+}
+
+static uint16_t get_u16(const uint8_t* src)
+{
+    return static_cast<uint16_t>(src[0] | (src[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t* src)
+{
+    return get_u16(src) | (static_cast<uint32_t>(get_u16(src + 2)) << 16);
+}
+
+/* Checksum skips the CRC field itself */
+static uint32_t record_crc(std::span<const uint8_t> record)
+{
+    const size_t end = Bno055CalibStore::HEADER_SIZE + Bno055Calibration::SIZE;
+    const uint32_t crc = crc32(record.first(CRC_OFFSET));
+    return crc32(record.subspan(Bno055CalibStore::HEADER_SIZE,
+                                end - Bno055CalibStore::HEADER_SIZE),
+                 crc);
+}
+
+Bno055CalibStore::Bno055CalibStore(Flash& flash) : flash_(flash) {}
+
+bool Bno055CalibStore::load(Bno055Calibration& out)
+{
+    Record record;
+    const std::span<uint8_t> bytes(record.data(), record_size());
+    bool found = false;
+    for (size_t slot = 0; slot < num_slots(); slot++)
+    {
+        if (!read_slot(slot, bytes) || erased(bytes))
+        {
+            break;
+        }
+        // A torn record is skipped, anything after it is still usable
+        Bno055Calibration cal;
+        if (decode(bytes, cal))
+        {
+            out = cal;
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool Bno055CalibStore::save(const Bno055Calibration& cal)
+{
+    if (num_slots() == 0)
+    {
+        return false;
+    }
+
+    Bno055Calibration latest;
+    if (load(latest) && latest == cal)
+    {
+        return true;
+    }
+
+    Record record;
+    const std::span<uint8_t> bytes(record.data(), record_size());
+    size_t slot = 0;
+    while (slot < num_slots() && read_slot(slot, bytes) && !erased(bytes))
+    {
+        slot++;
+    }
+    if (slot == num_slots())
+    {
+        if (!flash_.erase())
+        {
+            return false;
+        }
+        slot = 0;
+    }
+
+    encode(cal, bytes);
+    if (!flash_.write(slot * record_size(), bytes))
+    {
+        return false;
+    }
+
+    Bno055Calibration stored;
+    return read_slot(slot, bytes) && decode(bytes, stored) && stored == cal;
+}
+
+/* Smallest multiple of the write unit that fits header and payload */
+size_t Bno055CalibStore::record_size() const
+{
+    const size_t unit = std::max<size_t>(flash_.write_unit(), 1);
+    const size_t needed = HEADER_SIZE + Bno055Calibration::SIZE;
+    const size_t size = (needed + unit - 1) / unit * unit;
+    return (size <= MAX_RECORD_SIZE) ? size : 0;
+}
+
+size_t Bno055CalibStore::num_slots() const
+{
+    const size_t size = record_size();
+    return (size > 0) ? flash_.size() / size : 0;
+}
+
+bool Bno055CalibStore::read_slot(size_t slot, std::span<uint8_t> record)
+{
+    return flash_.read(slot * record.size(), record);
+}
+
+bool Bno055CalibStore::erased(std::span<const uint8_t> record)
+{
+    return std::all_of(record.begin(), record.end(),
+                       [](uint8_t b) { return b == Flash::ERASED_VALUE; });
+}
+
+bool Bno055CalibStore::decode(std::span<const uint8_t> record,
+                              Bno055Calibration& out)
+{
+    if (get_u32(&record[0]) != RECORD_MAGIC ||
+        get_u16(&record[4]) != RECORD_VERSION ||
+        get_u16(&record[6]) != Bno055Calibration::SIZE ||
+        get_u32(&record[CRC_OFFSET]) != record_crc(record))
+    {
+        return false;
+    }
+    std::copy_n(&record[HEADER_SIZE], Bno055Calibration::SIZE,
+                out.regs.begin());
+    return true;
+}
+
+void Bno055CalibStore::encode(const Bno055Calibration& cal,
+                              std::span<uint8_t> record)
+{
+    std::fill(record.begin(), record.end(), Flash::ERASED_VALUE);
+    put_u32(&record[0], RECORD_MAGIC);
+    put_u16(&record[4], RECORD_VERSION);
+    put_u16(&record[6], Bno055Calibration::SIZE);
+    std::copy(cal.regs.begin(), cal.regs.end(), &record[HEADER_SIZE]);
+    put_u32(&record[CRC_OFFSET], record_crc(record));
+}
+
+}  // namespace LBR
@@ -0,0 +1,72 @@
+/**
+ * @file bno055_calib_store.h
+ * @brief Keeps BNO055 calibration profiles in a flash region
+ * @date 10/17/2026
+ * @note Profiles are appended as checksummed records and the region is only
+ *       erased once full. The previous record stays valid until a new one
+ *       is completely written, so a power cut mid-save loses nothing. The
+ *       one exception is a cut between the wrap-around erase and the next
+ *       record, which leaves the region empty.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "bno055_imu.h"
+#include "flash.h"
+
+namespace LBR
+{
+
+/**
+ * @class Bno055CalibStore
+ * @brief Load/save of the latest calibration profile
+ * @details Record layout, little-endian:
+ *          - magic      u32  RECORD_MAGIC
+ *          - version    u16  RECORD_VERSION
+ *          - length     u16  Bno055Calibration::SIZE
+ *          - crc        u32  CRC-32 of everything above and the payload
+ *          - payload    22B  registers 0x55..0x6A
+ *          - padding to the flash write unit, left erased
+ */
+class Bno055CalibStore
+{
+public:
+    static constexpr uint32_t RECORD_MAGIC = 0x42303535;  ///< "550B"
+    static constexpr uint16_t RECORD_VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 12;
+    static constexpr size_t MAX_RECORD_SIZE = 48;
+
+    /**
+     * @param flash region reserved for profiles, erased or holding records
+     */
+    explicit Bno055CalibStore(Flash& flash);
+
+    /**
+     * @brief Finds the latest valid profile
+     * @param[out] out Output calibration profile
+     * @return true if one was found, false if the region has none
+     */
+    bool load(Bno055Calibration& out);
+
+    /**
+     * @brief Appends a profile, skipped if it matches the latest one
+     * @return true once the profile is stored and read back intact
+     */
+    bool save(const Bno055Calibration& cal);
+
+private:
+    using Record = std::array<uint8_t, MAX_RECORD_SIZE>;
+
+    size_t record_size() const;
+    size_t num_slots() const;
+    bool read_slot(size_t slot, std::span<uint8_t> record);
+    static bool erased(std::span<const uint8_t> record);
+    static bool decode(std::span<const uint8_t> record, Bno055Calibration& out);
+    static void encode(const Bno055Calibration& cal, std::span<uint8_t> record);
+
+    Flash& flash_;
+};
+
+}  // namespace LBR
@@ -5,10 +5,59 @@ namespace LBR
 {
 using LBR::Utils::DelayMs;
 
-Bno055::Bno055(LBR::I2c& i2c, uint8_t addr) : i2c_(i2c), address_(addr)
+/* Registers that only change when written: IDs and unit/mode/power/axis
+ * config on page 0, sensor config and interrupt setup on page 1.
+ * SYS_TRIGGER is left out as its bits self-clear, the calibration offsets
+ * as the fusion rewrites them while it calibrates. */
+static constexpr std::array<I2cRegRange, 6> CACHED_REGS{{
+    {0, 0x00, 0x06},  // CHIP_ID .. BL_REV_ID
+    {0, 0x3B, 0x3B},  // UNIT_SEL
+    {0, 0x3D, 0x3E},  // OPR_MODE, PWR_MODE
+    {0, 0x40, 0x42},  // TEMP_SOURCE, AXIS_MAP_CONFIG, AXIS_MAP_SIGN
+    {1, 0x08, 0x0D},  // ACC/MAG/GYR config, sleep config
+    {1, 0x0F, 0x1F},  // INT_MSK, INT_EN, interrupt thresholds
+}};
+
+Bno055::Bno055(LBR::I2c& i2c, uint8_t addr) : Bno055(i2c, i2c, addr) {}
+
+Bno055::Bno055(LBR::I2c& data_i2c, LBR::I2c& housekeeping_i2c, uint8_t addr)
+    : i2c_(housekeeping_i2c, addr, CACHED_REGS, REG_PAGE_ID),
+      data_i2c_(data_i2c),
+      address_(addr)
 {
 }
 
+/* Per BNO055 datasheet: power-on/reset boot time (also how long a self
+ * test takes), time to answer after boot, and the OPR_MODE switch time
+ * (19ms into CONFIG, 7ms out of it) */
+static constexpr uint32_t BOOT_TIME_MS = 650;
+static constexpr uint32_t SELF_TEST_TIME_MS = 650;
+static constexpr uint32_t CHIP_ID_RETRY_MS = 10;
+static constexpr uint32_t MODE_SWITCH_MS = 30;
+static constexpr uint8_t CHIP_ID_TRIES = 6;
+
+static constexpr uint8_t CHIP_ID = 0xA0;
+static constexpr uint8_t CHIP_ID_REG = 0x00;
+static constexpr uint8_t PWR_MODE_REG = 0x3E;
+static constexpr uint8_t ST_RESULT_REG = 0x36;
+static constexpr uint8_t SYS_TRIGGER_REG = 0x3F;
+static constexpr uint8_t UNIT_SEL_REG = 0x3B;
+static constexpr uint8_t ACC_CONFIG_REG = 0x08;    // Page 1
+static constexpr uint8_t GYR_CONFIG_0_REG = 0x0A;  // Page 1
+
+// UNIT_SEL bits, ORI_Android_Windows is kept at its reset value
+static constexpr uint8_t UNIT_SEL_ORI_ANDROID = 0x80;
+static constexpr uint8_t UNIT_SEL_GYR_POS = 1;
+
+static constexpr uint8_t ACC_CONFIG_BW_POS = 2;
+static constexpr uint8_t GYR_CONFIG_BW_POS = 3;
+
+// Output LSB weights per UNIT_SEL choice, converted to Bno055Data units
+static constexpr float ACCEL_LSB_PER_MG = 1.0f;
+static constexpr float MG_PER_MPS2 = 1000.0f / 9.80665f;
+static constexpr float GYRO_LSB_PER_RPS = 900.0f;
+static constexpr float DEG_PER_RAD = 57.2957795f;
+
 /**
  * @brief Set the IMU operating mode.
  * @param mode Mode enum
@@ -16,49 +65,252 @@ Bno055::Bno055(LBR::I2c& i2c, uint8_t addr) : i2c_(i2c), address_(addr)
  */
 bool Bno055::set_mode(Mode mode)
 {
-    std::array<uint8_t, 1> buf{static_cast<uint8_t>(mode)};
-    bool ok = i2c_.mem_write(buf, REG_OPR_MODE, address_);
-    // Per BNO055 datasheet, a delay is required after changing OPR_MODE
-    // to allow the sensor to switch modes and stabilize.
-    DelayMs(30);
+    bool switched = false;
+    bool ok = write_mode(mode, switched);
+    // Callers rely on the switch delay instead of adding their own
+    if (switched)
+    {
+        DelayMs(MODE_SWITCH_MS);
+    }
     return ok;
 }
 
+bool Bno055::write_mode(Mode mode, bool& switched)
+{
+    uint8_t current = 0;
+    if (i2c_.peek(REG_OPR_MODE, current) && current == mode)
+    {
+        switched = false;
+        return true;
+    }
+
+    std::array<uint8_t, 1> buf{static_cast<uint8_t>(mode)};
+    switched = true;
+    return i2c_.mem_write(buf, REG_OPR_MODE, address_) == I2cStatus::OK;
+}
+
 /**
  * @brief Initialize and configure the IMU
  * 
  */
 void Bno055::init()
 {
-    // Per BNO055 datasheet, allow time for device startup after power-on reset.
-    DelayMs(650);
+    init(IMU, Config{});
+}
+
+void Bno055::init(Mode mode, const Config& config)
+{
+    start_init(0, mode, config);
+    run_blocking(nullptr);
+}
+
+void Bno055::start_init(uint32_t now_ms)
+{
+    start_init(now_ms, IMU, Config{});
+}
+
+void Bno055::start_init(uint32_t now_ms, Mode mode, const Config& config)
+{
+    trigger_ = 0;
+    run_mode_ = mode;
+    config_ = config;
+    start_job(Stage::BOOT_WAIT, now_ms, BOOT_TIME_MS);
+}
 
-    uint8_t id = 0;
-    i2c_.mem_read(std::span<uint8_t>(&id, 1), (uint8_t)0x00,
-                  address_);  // CHIP_ID = 0x00
-    for (int i = 0; i < 5 && id != 0xA0; i++)
+bool Bno055::configure(const Config& config)
+{
+    Mode prev = CONFIG;
+    if (!get_opr_mode(prev) || !set_mode(Bno055::CONFIG))
     {
-        // Per BNO055 datasheet, allow time for device to respond after reset.
-        DelayMs(10);
-        i2c_.mem_read(std::span<uint8_t>(&id, 1), (uint8_t)0x00, address_);
+        return false;
     }
-    if (id != 0xA0)
-        return;
+    bool ok = write_config(config);
+    ok = set_mode(prev) && ok;
+    return ok;
+}
 
-    set_mode(Bno055::CONFIG);
-    // Per BNO055 datasheet, delay after switching to CONFIG mode.
-    LBR::Utils::DelayMs(25);
+bool Bno055::write_config(const Config& config)
+{
+    const uint8_t unit_sel =
+        UNIT_SEL_ORI_ANDROID | static_cast<uint8_t>(config.accel_unit) |
+        (static_cast<uint8_t>(config.gyro_unit) << UNIT_SEL_GYR_POS);
+    // Power mode bits left at normal
+    const uint8_t acc_config =
+        static_cast<uint8_t>(config.accel_range) |
+        (static_cast<uint8_t>(config.accel_bandwidth) << ACC_CONFIG_BW_POS);
+    const uint8_t gyr_config =
+        static_cast<uint8_t>(config.gyro_range) |
+        (static_cast<uint8_t>(config.gyro_bandwidth) << GYR_CONFIG_BW_POS);
+    const uint8_t page_1 = 0x01;
+    const uint8_t page_0 = 0x00;
+
+    const std::array<I2cOp, 5> ops{
+        I2cOp::write(address_, UNIT_SEL_REG,
+                     std::span<const uint8_t>(&unit_sel, 1)),
+        I2cOp::write(address_, REG_PAGE_ID,
+                     std::span<const uint8_t>(&page_1, 1)),
+        I2cOp::write(address_, ACC_CONFIG_REG,
+                     std::span<const uint8_t>(&acc_config, 1)),
+        I2cOp::write(address_, GYR_CONFIG_0_REG,
+                     std::span<const uint8_t>(&gyr_config, 1)),
+        I2cOp::write(address_, REG_PAGE_ID,
+                     std::span<const uint8_t>(&page_0, 1)),
+    };
+    if (i2c_.transfer(ops) != I2cStatus::OK)
+    {
+        return false;
+    }
+
+    scale_.accel = (config.accel_unit == AccelUnit::MG)
+                       ? ACCEL_LSB_PER_MG * MG_PER_MPS2
+                       : Bno055RawData::ACCEL_SCALE;
+    scale_.gyro = (config.gyro_unit == GyroUnit::RPS)
+                      ? GYRO_LSB_PER_RPS / DEG_PER_RAD
+                      : Bno055RawData::GYRO_SCALE;
+    return true;
+}
 
-    uint8_t pwr_mode = 0x00;
-    i2c_.mem_write(std::span<const uint8_t>(&pwr_mode, 1), (uint8_t)0x3E,
-                   address_);  // PWR_MODE = 0x3E
-    uint8_t page_id = 0x00;
-    i2c_.mem_write(std::span<const uint8_t>(&page_id, 1), (uint8_t)0x07,
-                   address_);  // PAGE_ID = 0x07
+void Bno055::start_post(uint32_t now_ms)
+{
+    trigger_ = 0x80;
+    start_job(Stage::CONFIG_MODE, now_ms, 0);
+}
 
-    set_mode(Bno055::IMU);
-    // Per BNO055 datasheet, delay after switching to IMU mode.
-    LBR::Utils::DelayMs(20);
+void Bno055::start_bist(uint32_t now_ms)
+{
+    trigger_ = 0x01;
+    start_job(Stage::CONFIG_MODE, now_ms, 0);
+}
+
+void Bno055::start_job(Stage first, uint32_t now_ms, uint32_t wait_ms)
+{
+    stage_ = first;
+    progress_ = Progress::PENDING;
+    wake_ms_ = now_ms + wait_ms;
+    tries_ = 0;
+    failed_ = false;
+}
+
+Bno055::Progress Bno055::step(uint32_t now_ms)
+{
+    // Wrap-safe, now_ms is only compared as a difference
+    if (stage_ == Stage::IDLE ||
+        static_cast<int32_t>(now_ms - wake_ms_) < 0)
+    {
+        return progress_;
+    }
+
+    bool switched = false;
+    switch (stage_)
+    {
+        case Stage::BOOT_WAIT:
+            // Registers are back at their reset values
+            i2c_.invalidate();
+            scale_ = Bno055Scale{};
+            stage_ = Stage::CHIP_ID;
+            break;
+
+        case Stage::CHIP_ID:
+        {
+            uint8_t id = 0;
+            i2c_.mem_read(std::span<uint8_t>(&id, 1), CHIP_ID_REG, address_);
+            tries_++;
+            if (id == CHIP_ID)
+            {
+                stage_ = Stage::CONFIG_MODE;
+            }
+            else if (tries_ < CHIP_ID_TRIES)
+            {
+                wake_ms_ = now_ms + CHIP_ID_RETRY_MS;
+            }
+            else
+            {
+                // No device, leave its mode alone
+                stage_ = Stage::IDLE;
+                progress_ = Progress::FAILED;
+            }
+            break;
+        }
+
+        case Stage::CONFIG_MODE:
+            failed_ |= !write_mode(Bno055::CONFIG, switched);
+            wake_ms_ = now_ms + (switched ? MODE_SWITCH_MS : 0);
+            // Init has no trigger to fire, self tests do
+            stage_ = (trigger_ == 0) ? Stage::POWER_SETUP : Stage::SELF_TEST;
+            break;
+
+        case Stage::POWER_SETUP:
+        {
+            // Normal power mode and register page 0 in one bus transaction
+            const uint8_t pwr_mode = 0x00;
+            const uint8_t page_id = 0x00;
+            const std::array<I2cOp, 2> setup{
+                I2cOp::write(address_, PWR_MODE_REG,
+                             std::span<const uint8_t>(&pwr_mode, 1)),
+                I2cOp::write(address_, REG_PAGE_ID,
+                             std::span<const uint8_t>(&page_id, 1)),
+            };
+            failed_ |= i2c_.transfer(setup) != I2cStatus::OK;
+            stage_ = Stage::SENSOR_CONFIG;
+            break;
+        }
+
+        case Stage::SENSOR_CONFIG:
+            failed_ |= !write_config(config_);
+            stage_ = Stage::RUN_MODE;
+            break;
+
+        case Stage::SELF_TEST:
+            failed_ |= i2c_.mem_write(std::span<const uint8_t>(&trigger_, 1),
+                                      SYS_TRIGGER_REG,
+                                      address_) != I2cStatus::OK;
+            wake_ms_ = now_ms + SELF_TEST_TIME_MS;
+            stage_ = Stage::SELF_TEST_RESULT;
+            break;
+
+        case Stage::SELF_TEST_RESULT:
+            failed_ |= i2c_.mem_read(std::span<uint8_t>(&st_result_, 1),
+                                     ST_RESULT_REG, address_) != I2cStatus::OK;
+            stage_ = Stage::RUN_MODE;
+            break;
+
+        case Stage::RUN_MODE:
+            failed_ |= !write_mode(run_mode_, switched);
+            wake_ms_ = now_ms + (switched ? MODE_SWITCH_MS : 0);
+            stage_ = Stage::FINISH;
+            break;
+
+        case Stage::FINISH:
+            stage_ = Stage::IDLE;
+            progress_ = failed_ ? Progress::FAILED : Progress::DONE;
+            break;
+
+        case Stage::IDLE:
+            break;
+    }
+    return progress_;
+}
+
+/* Drives the current job on a clock counted from the delays themselves,
+ * every wait is one DelayMs call */
+bool Bno055::run_blocking(uint8_t* status)
+{
+    uint32_t now_ms = 0;
+    Progress progress = Progress::PENDING;
+    while ((progress = step(now_ms)) == Progress::PENDING)
+    {
+        const uint32_t wait_ms = wake_ms_ - now_ms;
+        if (static_cast<int32_t>(wait_ms) > 0)
+        {
+            DelayMs(wait_ms);
+            now_ms += wait_ms;
+        }
+    }
+    if (progress == Progress::DONE && status != nullptr)
+    {
+        *status = st_result_;
+    }
+    return progress == Progress::DONE;
 }
 
 /**
@@ -69,20 +321,13 @@ void Bno055::deinit()
 {
     // Put device into deep suspend to save power
     set_mode(Bno055::CONFIG);
-    // Per BNO055 datasheet, delay after switching to CONFIG mode.
-    LBR::Utils::DelayMs(10);
     static constexpr uint8_t PWR_MODE_SUSPEND = 0x02;
-    static constexpr uint8_t PWR_MODE_REG = 0x3E;
     std::array<uint8_t, 1> pwr_mode{PWR_MODE_SUSPEND};
     i2c_.mem_write(pwr_mode, PWR_MODE_REG, address_);
     // Per BNO055 datasheet, delay after entering suspend mode.
     LBR::Utils::DelayMs(25);
 }
 
-static inline int16_t combine(uint8_t lsb, uint8_t msb)
-{
-    return (static_cast<int16_t>(msb) << 8) | lsb;
-}
 /**
  * @brief Read all sensor data from the IMU
  * @param[out] out Output struct for sensor data
@@ -91,46 +336,51 @@ static inline int16_t combine(uint8_t lsb, uint8_t msb)
  */
 bool Bno055::read_all(Bno055Data& out)
 {
-    uint8_t buf[6 + 6 + 6 + 6 + 8];  // ACC + GYR + LIA + GRAV + QUAT
-    size_t idx = 0;
-
-    // Read everything starting from ACC register (0x08)
-    i2c_.mem_read(std::span<uint8_t>(buf, sizeof(buf)), (uint8_t)0x08,
-                  address_);
-
-    // Parse accel
-    constexpr float ACCEL_SCALE = 100.0f;
-    out.accel.x = combine(buf[0], buf[1]) / ACCEL_SCALE;
-    out.accel.y = combine(buf[2], buf[3]) / ACCEL_SCALE;
-    out.accel.z = combine(buf[4], buf[5]) / ACCEL_SCALE;
-    idx += 12;  // Skip accel (6) + mag (6)
-
-    // Parse gyro
-    constexpr float GYRO_SCALE = 16.0f;
-    out.gyro.x = combine(buf[idx + 0], buf[idx + 1]) / GYRO_SCALE;
-    out.gyro.y = combine(buf[idx + 2], buf[idx + 3]) / GYRO_SCALE;
-    out.gyro.z = combine(buf[idx + 4], buf[idx + 5]) / GYRO_SCALE;
-    idx += 6;
-
-    // Parse linear accel
-    out.linear_accel.x = combine(buf[idx + 0], buf[idx + 1]) / ACCEL_SCALE;
-    out.linear_accel.y = combine(buf[idx + 2], buf[idx + 3]) / ACCEL_SCALE;
-    out.linear_accel.z = combine(buf[idx + 4], buf[idx + 5]) / ACCEL_SCALE;
-    idx += 6;
-
-    // Parse gravity
-    out.gravity.x = combine(buf[idx + 0], buf[idx + 1]) / ACCEL_SCALE;
-    out.gravity.y = combine(buf[idx + 2], buf[idx + 3]) / ACCEL_SCALE;
-    out.gravity.z = combine(buf[idx + 4], buf[idx + 5]) / ACCEL_SCALE;
-    idx += 6;
-
-    // Parse quaternion
-    constexpr float QUAT_SCALE = 16384.0f;
-    out.quat.w = combine(buf[idx + 0], buf[idx + 1]) / QUAT_SCALE;
-    out.quat.x = combine(buf[idx + 2], buf[idx + 3]) / QUAT_SCALE;
-    out.quat.y = combine(buf[idx + 4], buf[idx + 5]) / QUAT_SCALE;
-    out.quat.z = combine(buf[idx + 6], buf[idx + 7]) / QUAT_SCALE;
+    return read<BNO055_ALL_FIELDS>(out);
+}
 
+bool Bno055::read_raw(Bno055RawData& out)
+{
+    return read_raw<BNO055_ALL_FIELDS>(out);
+}
+
+bool Bno055::set_data_ready_interrupt(bool enable)
+{
+    static constexpr uint8_t INT_MSK_REG = 0x0F;  // Page 1, routes to INT pin
+    static constexpr uint8_t INT_EN_REG = 0x10;   // Page 1, enables source
+    static constexpr uint8_t ACC_BSX_DRDY = 0x01;
+
+    // Interrupt registers take writes in any operating mode
+    const uint8_t page_1 = 0x01;
+    const uint8_t page_0 = 0x00;
+    const uint8_t mask = enable ? ACC_BSX_DRDY : 0x00;
+    const std::span<const uint8_t> to_page_1(&page_1, 1);
+    const std::span<const uint8_t> to_page_0(&page_0, 1);
+    const std::span<const uint8_t> sources(&mask, 1);
+    const std::array<I2cOp, 4> ops{
+        I2cOp::write(address_, REG_PAGE_ID, to_page_1),
+        I2cOp::write(address_, INT_MSK_REG, sources),
+        I2cOp::write(address_, INT_EN_REG, sources),
+        I2cOp::write(address_, REG_PAGE_ID, to_page_0),
+    };
+    return i2c_.transfer(ops) == I2cStatus::OK;
+}
+
+bool Bno055::ack_interrupt()
+{
+    static constexpr uint8_t RST_INT = 0x40;
+    return data_i2c_.mem_write(std::span<const uint8_t>(&RST_INT, 1),
+                               SYS_TRIGGER_REG, address_) == I2cStatus::OK;
+}
+
+bool Bno055::read_status(Bno055Status& status)
+{
+    Bno055RawData raw;
+    if (!read_raw_from<BNO055_STATUS>(i2c_, raw))
+    {
+        return false;
+    }
+    status = raw.status;
     return true;
 }
 
@@ -138,73 +388,72 @@ bool Bno055::calibrate(uint8_t& value)
 {
     static constexpr uint8_t CALIB_STAT_REG = 0x35;  // CALIB_STAT register
     return i2c_.mem_read(std::span<uint8_t>(&value, 1), CALIB_STAT_REG,
-                         address_);
+                         address_) == I2cStatus::OK;
+}
+
+bool Bno055::read_calibration(Bno055Calibration& out)
+{
+    Mode prev = CONFIG;
+    if (!get_opr_mode(prev) || !set_mode(Bno055::CONFIG))
+    {
+        return false;
+    }
+    bool ok = i2c_.mem_read(out.regs, Bno055Calibration::FIRST_REG,
+                            address_) == I2cStatus::OK;
+    ok = set_mode(prev) && ok;
+    return ok;
+}
+
+bool Bno055::write_calibration(const Bno055Calibration& cal)
+{
+    Mode prev = CONFIG;
+    if (!get_opr_mode(prev) || !set_mode(Bno055::CONFIG))
+    {
+        return false;
+    }
+    bool ok = i2c_.mem_write(cal.regs, Bno055Calibration::FIRST_REG,
+                             address_) == I2cStatus::OK;
+    ok = set_mode(prev) && ok;
+    return ok;
 }
 
 bool Bno055::get_sys_status(uint8_t& value)
 {
     static constexpr uint8_t SYS_STATUS_REG = 0x39;  // SYS_STATUS register
     return i2c_.mem_read(std::span<uint8_t>(&value, 1), SYS_STATUS_REG,
-                         address_);
+                         address_) == I2cStatus::OK;
 }
 
 bool Bno055::get_sys_error(uint8_t& value)
 {
     static constexpr uint8_t SYS_ERR_REG = 0x3A;  // SYS_ERR register
-    return i2c_.mem_read(std::span<uint8_t>(&value, 1), SYS_ERR_REG, address_);
+    return i2c_.mem_read(std::span<uint8_t>(&value, 1), SYS_ERR_REG,
+                         address_) == I2cStatus::OK;
 }
 
 bool Bno055::run_post(uint8_t& status)
 {
-    set_mode(Bno055::CONFIG);
-    // Per BNO055 datasheet, delay after switching to CONFIG mode.
-    LBR::Utils::DelayMs(25);
-    uint8_t sys_trigger = 0x80;
-    static constexpr uint8_t SYS_TRIGGER_REG = 0x3F;  // SYS_TRIGGER register
-    i2c_.mem_write(std::span<const uint8_t>(&sys_trigger, 1), SYS_TRIGGER_REG,
-                   address_);
-    // Per BNO055 datasheet, delay for self-test completion.
-    LBR::Utils::DelayMs(650);
-    static constexpr uint8_t ST_RESULT_REG = 0x36;  // ST_RESULT register
-    bool ok =
-        i2c_.mem_read(std::span<uint8_t>(&status, 1), ST_RESULT_REG, address_);
-    set_mode(Bno055::IMU);
-    // Per BNO055 datasheet, delay after switching to IMU mode.
-    LBR::Utils::DelayMs(20);
-    return ok;
+    start_post(0);
+    return run_blocking(&status);
 }
 
 bool Bno055::run_bist(uint8_t& status)
 {
-    set_mode(Bno055::CONFIG);
-    // Per BNO055 datasheet, delay after switching to CONFIG mode.
-    LBR::Utils::DelayMs(25);
-    uint8_t sys_trigger = 0x01;
-    static constexpr uint8_t SYS_TRIGGER_REG = 0x3F;  // SYS_TRIGGER register
-    i2c_.mem_write(std::span<const uint8_t>(&sys_trigger, 1), SYS_TRIGGER_REG,
-                   address_);
-    // Per BNO055 datasheet, delay for BIST completion.
-    LBR::Utils::DelayMs(650);
-    static constexpr uint8_t ST_RESULT_REG = 0x36;  // ST_RESULT register
-    bool ok =
-        i2c_.mem_read(std::span<uint8_t>(&status, 1), ST_RESULT_REG, address_);
-    set_mode(Bno055::IMU);
-    // Per BNO055 datasheet, delay after switching to IMU mode.
-    LBR::Utils::DelayMs(20);
-    return ok;
+    start_bist(0);
+    return run_blocking(&status);
 }
 
 bool Bno055::get_chip_id(uint8_t& id)
 {
-    static constexpr uint8_t CHIP_ID_REG = 0x00;  // CHIP_ID register
-    return i2c_.mem_read(std::span<uint8_t>(&id, 1), CHIP_ID_REG, address_);
+    return i2c_.mem_read(std::span<uint8_t>(&id, 1), CHIP_ID_REG, address_) ==
+           I2cStatus::OK;
 }
 
 bool Bno055::get_opr_mode(Mode& mode)
 {
     uint8_t value = 0;
-    bool ok =
-        i2c_.mem_read(std::span<uint8_t>(&value, 1), REG_OPR_MODE, address_);
+    bool ok = i2c_.mem_read(std::span<uint8_t>(&value, 1), REG_OPR_MODE,
+                            address_) == I2cStatus::OK;
     if (ok)
     {
         mode = static_cast<Mode>(value);
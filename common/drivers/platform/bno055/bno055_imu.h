@@ -8,24 +8,75 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include "delay.h"
+#include "bno055_layout.h"
 #include "i2c.h"
+#include "i2c_reg_cache.h"
 #include "imu_math.h"
 
 namespace LBR
 {
 
+/**
+ * @struct Bno055Status
+ * @brief Health registers 0x34..0x3A, read along with the data
+ */
+struct Bno055Status
+{
+    /* SYS_STATUS values */
+    static constexpr uint8_t SYS_IDLE = 0x00;
+    static constexpr uint8_t SYS_ERROR = 0x01;
+    static constexpr uint8_t SYS_FUSION_RUNNING = 0x05;
+    static constexpr uint8_t SYS_RUNNING_NO_FUSION = 0x06;
+
+    static constexpr uint8_t ST_ALL_PASSED = 0x0F;  ///< MCU, GYR, MAG, ACC
+    static constexpr uint8_t INT_ACC_BSX_DRDY = 0x01;
+
+    int8_t temp;  ///< Degrees C with the reset UNIT_SEL
+    uint8_t calib_stat;
+    uint8_t st_result;
+    uint8_t int_sta;
+    uint8_t sys_clk_status;
+    uint8_t sys_status;
+    uint8_t sys_err;
+
+    /**
+     * @return true if the sensor is running without a reported error, so
+     *         the data read with this status can be trusted
+     */
+    bool valid() const
+    {
+        return sys_err == 0 && (sys_status == SYS_FUSION_RUNNING ||
+                                sys_status == SYS_RUNNING_NO_FUSION);
+    }
+
+    /**
+     * @param fields Bno055::CALIB_* masks that must all read 3
+     */
+    bool calibrated(uint8_t fields) const
+    {
+        return (calib_stat & fields) == fields;
+    }
+
+    bool self_test_passed() const
+    {
+        return (st_result & ST_ALL_PASSED) == ST_ALL_PASSED;
+    }
+};
+
 /**
  * @struct Bno055Data
  * @brief Sensor data from BNO055 IMU
  * @details
  *  - accel: Acceleration (m/s^2)
- *  - gyro: Angular velocity (rad/s)
+ *  - gyro: Angular velocity (dps)
  *  - linear_accel: Linear acceleration (m/s^2, gravity removed)
  *  - gravity: Gravity vector (m/s^2)
  *  - quat: Orientation (unit quaternion)
+ *  - status: Health registers, only filled by BNO055_STATUS reads
  */
 struct Bno055Data
 {
@@ -34,6 +85,93 @@ struct Bno055Data
     Vec3 linear_accel;
     Vec3 gravity;
     Quaternion quat;
+    Bno055Status status;
+};
+
+/**
+ * @struct Bno055Scale
+ * @brief Counts per Bno055Data unit, set by the UNIT_SEL the device uses
+ * @note Range settings only move the clipping point, the output registers
+ *       keep the same LSB weight
+ */
+struct Bno055Scale
+{
+    float accel{100.0f};  ///< LSB per m/s^2
+    float gyro{16.0f};    ///< LSB per dps
+};
+
+/**
+ * @struct Bno055RawData
+ * @brief Sensor data from BNO055 IMU as raw register counts
+ * @details Half the size of Bno055Data and filled without any float math, so
+ *          buffered samples and telemetry can stay in counts. Convert only
+ *          when a consumer needs units.
+ */
+struct Bno055RawData
+{
+    /* Default UNIT_SEL (m/s^2, dps) */
+    static constexpr float ACCEL_SCALE = 100.0f;   ///< LSB per m/s^2
+    static constexpr float GYRO_SCALE = 16.0f;     ///< LSB per dps
+    static constexpr float QUAT_SCALE = 16384.0f;  ///< LSB per unit
+    static constexpr float GYRO_RAD_SCALE =
+        GYRO_SCALE * 57.2957795f;  ///< LSB per rad/s, for OrientationFilter
+
+    RawVec3 accel;
+    RawVec3 gyro;
+    RawVec3 linear_accel;
+    RawVec3 gravity;
+    RawQuaternion quat;
+    Bno055Status status;
+
+    /**
+     * @brief Convert the selected fields to units
+     * @tparam Fields mask of Bno055Field values
+     * @param[out] out Output struct, fields outside the mask are untouched
+     * @param scale Bno055::scale() of the device the counts came from
+     */
+    template <uint8_t Fields = BNO055_ALL_FIELDS>
+    void convert(Bno055Data& out, const Bno055Scale& scale = {}) const
+    {
+        if constexpr (Fields & BNO055_ACCEL)
+        {
+            out.accel = to_vec3(accel, scale.accel);
+        }
+        if constexpr (Fields & BNO055_GYRO)
+        {
+            out.gyro = to_vec3(gyro, scale.gyro);
+        }
+        if constexpr (Fields & BNO055_QUAT)
+        {
+            out.quat = to_quaternion(quat, QUAT_SCALE);
+        }
+        if constexpr (Fields & BNO055_LINEAR_ACCEL)
+        {
+            out.linear_accel = to_vec3(linear_accel, scale.accel);
+        }
+        if constexpr (Fields & BNO055_GRAVITY)
+        {
+            out.gravity = to_vec3(gravity, scale.accel);
+        }
+        if constexpr (Fields & BNO055_STATUS)
+        {
+            out.status = status;
+        }
+    }
+};
+
+/**
+ * @struct Bno055Calibration
+ * @brief Calibration profile, the accel/mag/gyro offsets and accel/mag
+ *        radii as laid out in registers 0x55..0x6A
+ */
+struct Bno055Calibration
+{
+    static constexpr uint8_t FIRST_REG = 0x55;  ///< ACC_OFFSET_X_LSB
+    static constexpr size_t SIZE = 22;
+
+    std::array<uint8_t, SIZE> regs;
+
+    bool operator==(const Bno055Calibration&) const = default;
 };
 
 /**
@@ -49,16 +187,136 @@ public:
     /**
      * @enum Mode
      * @brief IMU operating modes
+     * @details Sensor-only modes up to AMG output raw data at the configured
+     *          rates. Fusion modes from IMU on fix the ranges and rates
+     *          themselves and ignore Config.
      */
     enum Mode : uint8_t
     {
         CONFIG = 0x00,
+        ACCONLY = 0x01,
+        MAGONLY = 0x02,
+        GYRONLY = 0x03,
+        ACCMAG = 0x04,
+        ACCGYRO = 0x05,
+        MAGGYRO = 0x06,
+        AMG = 0x07,  ///< Raw accel, mag and gyro, no fusion
         IMU = 0x08,
+        COMPASS = 0x09,
+        M4G = 0x0A,
+        NDOF_FMC_OFF = 0x0B,
         NDOF = 0x0C
     };
 
+    /**
+     * @enum AccelRange
+     * @brief ACC_Config g-range
+     */
+    enum class AccelRange : uint8_t
+    {
+        G2 = 0,
+        G4,
+        G8,
+        G16
+    };
+
+    /**
+     * @enum AccelBandwidth
+     * @brief ACC_Config filter bandwidth, output rate is twice this
+     */
+    enum class AccelBandwidth : uint8_t
+    {
+        HZ_7_81 = 0,
+        HZ_15_63,
+        HZ_31_25,
+        HZ_62_5,
+        HZ_125,
+        HZ_250,
+        HZ_500,
+        HZ_1000
+    };
+
+    /**
+     * @enum GyroRange
+     * @brief GYR_Config_0 range
+     */
+    enum class GyroRange : uint8_t
+    {
+        DPS_2000 = 0,
+        DPS_1000,
+        DPS_500,
+        DPS_250,
+        DPS_125
+    };
+
+    /**
+     * @enum GyroBandwidth
+     * @brief GYR_Config_0 filter bandwidth, not monotonic in the encoding
+     */
+    enum class GyroBandwidth : uint8_t
+    {
+        HZ_523 = 0,
+        HZ_230,
+        HZ_116,
+        HZ_47,
+        HZ_23,
+        HZ_12,
+        HZ_64,
+        HZ_32
+    };
+
+    /**
+     * @enum AccelUnit
+     * @brief UNIT_SEL acceleration unit of the output registers
+     */
+    enum class AccelUnit : uint8_t
+    {
+        MPS2 = 0,  ///< 100 LSB per m/s^2
+        MG = 1     ///< 1 LSB per mg
+    };
+
+    /**
+     * @enum GyroUnit
+     * @brief UNIT_SEL angular rate unit of the output registers
+     */
+    enum class GyroUnit : uint8_t
+    {
+        DPS = 0,  ///< 16 LSB per dps
+        RPS = 1   ///< 900 LSB per rad/s
+    };
+
+    /**
+     * @struct Config
+     * @brief Sensor ranges, bandwidths and output units
+     * @note Defaults are the reset values
+     */
+    struct Config
+    {
+        AccelRange accel_range{AccelRange::G4};
+        AccelBandwidth accel_bandwidth{AccelBandwidth::HZ_62_5};
+        GyroRange gyro_range{GyroRange::DPS_2000};
+        GyroBandwidth gyro_bandwidth{GyroBandwidth::HZ_32};
+        AccelUnit accel_unit{AccelUnit::MPS2};
+        GyroUnit gyro_unit{GyroUnit::DPS};
+    };
+
+    /**
+     * @brief Widest ranges at the fastest rates, for the high-g phases
+     */
+    static constexpr Config HIGH_RATE_CONFIG{
+        AccelRange::G16, AccelBandwidth::HZ_1000, GyroRange::DPS_2000,
+        GyroBandwidth::HZ_523, AccelUnit::MPS2, GyroUnit::DPS};
+
     static constexpr uint8_t REG_OPR_MODE =
         0x3D;  ///< OPR_MODE register address
+    static constexpr uint8_t REG_PAGE_ID =
+        0x07;  ///< PAGE_ID register address, present on every page
+
+    /* CALIB_STAT fields, 3 = fully calibrated */
+    static constexpr uint8_t CALIB_SYS = 0xC0;
+    static constexpr uint8_t CALIB_GYR = 0x30;
+    static constexpr uint8_t CALIB_ACC = 0x0C;
+    static constexpr uint8_t CALIB_MAG = 0x03;
 
     static constexpr uint8_t ADDR_PRIMARY = 0x28;    ///< Default I2C Address
     static constexpr uint8_t ADDR_ALTERNATE = 0x29;  ///< Alternate I2C Address
@@ -70,18 +328,112 @@ public:
      */
     explicit Bno055(LBR::I2c& i2c, uint8_t addr = ADDR_PRIMARY);
 
+    /**
+     * @brief Construct a Bno055 that splits its traffic over two interfaces
+     * @details Sample reads (read(), read_raw(), read_all()) and
+     *          ack_interrupt() go through data_i2c, everything else
+     *          (startup, modes and config, calibration, status) through
+     *          housekeeping_i2c, e.g. a HIGH and a LOW I2cClient of one
+     *          I2cArbiter. Both must reach the same device.
+     * @param data_i2c Interface for the per-sample traffic
+     * @param housekeeping_i2c Interface for the rest
+     * @param addr I2C address (default: ADDR_PRIMARY)
+     */
+    Bno055(LBR::I2c& data_i2c, LBR::I2c& housekeeping_i2c,
+           uint8_t addr = ADDR_PRIMARY);
+
     /**
      * @brief Set the IMU operating mode.
+     * @note Returns at once, without the mode-switch delay, if the device is
+     *       already known to be in mode
      * @param mode Mode enum
      * @return true if successful, false otherwise
      */
     bool set_mode(Mode mode);
 
     /**
-     * @brief Initialize and configure the IMU
+     * @brief Initialize and configure the IMU, ending in IMU mode with the
+     *        reset ranges and units
+     * @note Blocks for the whole startup, see start_init() to overlap it
      */
     void init();
 
+    /**
+     * @brief Initialize the IMU with config, ending in mode
+     * @note Blocks for the whole startup, see start_init() to overlap it
+     */
+    void init(Mode mode, const Config& config);
+
+    /**
+     * @brief Apply ranges, bandwidths and units
+     * @note Passes through CONFIG mode and returns to the previous one.
+     *       Fusion modes override the ranges and bandwidths while running.
+     * @return true if successful, false otherwise
+     */
+    bool configure(const Config& config);
+
+    /**
+     * @return counts per unit of the units the device outputs
+     */
+    const Bno055Scale& scale() const
+    {
+        return scale_;
+    }
+
+    /**
+     * @enum Progress
+     * @brief State of a job started by start_init/start_post/start_bist
+     */
+    enum class Progress : uint8_t
+    {
+        PENDING,  ///< Call step() again later
+        DONE,
+        FAILED
+    };
+
+    /**
+     * @brief Begin the init() sequence without blocking
+     * @param now_ms monotonic millisecond clock, same source as step()
+     */
+    void start_init(uint32_t now_ms);
+
+    /**
+     * @brief Begin the init(mode, config) sequence without blocking
+     * @param now_ms monotonic millisecond clock, same source as step()
+     */
+    void start_init(uint32_t now_ms, Mode mode, const Config& config);
+
+    /**
+     * @brief Begin the run_post() sequence without blocking
+     * @param now_ms monotonic millisecond clock, same source as step()
+     */
+    void start_post(uint32_t now_ms);
+
+    /**
+     * @brief Begin the run_bist() sequence without blocking
+     * @param now_ms monotonic millisecond clock, same source as step()
+     */
+    void start_bist(uint32_t now_ms);
+
+    /**
+     * @brief Advance the current job
+     * @details Returns at once while the job waits on the sensor, so it can
+     *          be called from a loop that brings up other peripherals. Each
+     *          call does at most one bus transaction.
+     * @param now_ms monotonic millisecond clock, may wrap
+     * @return PENDING until the job ends, then its result until a new job
+     *         starts
+     */
+    Progress step(uint32_t now_ms);
+
+    /**
+     * @return ST_RESULT read by the last POST/BIST job
+     */
+    uint8_t self_test_result() const
+    {
+        return st_result_;
+    }
+
     /**
      * @brief Deinitialize the IMU and put it in low-power mode
      * @note @TJMalaska Check this function
@@ -95,6 +447,50 @@ public:
      */
     bool read_all(Bno055Data& out);
 
+    /**
+     * @brief Read only the selected output fields in one bus transaction
+     * @details The register windows are planned at compile time, see
+     *          bno055_layout.h, and only the selected fields are decoded.
+     * @tparam Fields mask of Bno055Field values
+     * @param[out] out Output struct, fields outside the mask are untouched
+     * @return true if successful, false otherwise
+     */
+    template <uint8_t Fields>
+    bool read(Bno055Data& out);
+
+    /**
+     * @brief Read all sensor data from the IMU as raw counts
+     * @param[out] out Output struct for raw sensor data
+     * @return true if successful, false otherwise
+     */
+    bool read_raw(Bno055RawData& out);
+
+    /**
+     * @brief Read only the selected output fields as raw counts
+     * @tparam Fields mask of Bno055Field values
+     * @param[out] out Output struct, fields outside the mask are untouched
+     * @return true if successful, false otherwise
+     */
+    template <uint8_t Fields>
+    bool read_raw(Bno055RawData& out);
+
+    /**
+     * @brief Route the data-ready interrupt to the INT pin
+     * @details Sets ACC_BSX_DRDY in INT_MSK and INT_EN on page 1. It fires
+     *          for every fused sample in fusion modes and for every
+     *          accelerometer sample otherwise. INT stays high until
+     *          ack_interrupt(). Other interrupt sources are disabled.
+     * @param enable false to mask the interrupt again
+     * @return true if successful, false otherwise
+     */
+    bool set_data_ready_interrupt(bool enable = true);
+
+    /**
+     * @brief Release the INT pin so the next sample raises a new edge
+     * @return true if successful, false otherwise
+     */
+    bool ack_interrupt();
+
     /**
      * @brief Get IMU calibration status
      * @param[out] value Output calibration status
@@ -102,6 +498,33 @@ public:
      */
     bool calibrate(uint8_t& value);
 
+    /**
+     * @brief Read the calibration profile the fusion has converged to
+     * @note Passes through CONFIG mode, the profile is only readable there,
+     *       and returns to the previous mode
+     * @param[out] out Output calibration profile
+     * @return true if successful, false otherwise
+     */
+    bool read_calibration(Bno055Calibration& out);
+
+    /**
+     * @brief Restore a calibration profile saved by read_calibration()
+     * @note Passes through CONFIG mode, the profile is only writable there,
+     *       and returns to the previous mode
+     * @param cal Calibration profile
+     * @return true if successful, false otherwise
+     */
+    bool write_calibration(const Bno055Calibration& cal);
+
+    /**
+     * @brief Read all health registers in one transaction
+     * @note For health alongside data every cycle, add BNO055_STATUS to the
+     *       read<Fields>() mask instead
+     * @param[out] status Output health registers
+     * @return true if successful, false otherwise
+     */
+    bool read_status(Bno055Status& status);
+
     /**
      * @brief Get IMU system status
      * @param[out] value Output system status
@@ -145,8 +568,144 @@ public:
     bool get_opr_mode(Mode& mode);
 
 private:
-    LBR::I2c& i2c_;    ///< Reference to I2c interface
-    uint8_t address_;  ///< I2C address
+    /**
+     * @brief Steps of the init and self-test jobs, in the order they run
+     */
+    enum class Stage : uint8_t
+    {
+        IDLE,
+        BOOT_WAIT,
+        CHIP_ID,
+        CONFIG_MODE,
+        POWER_SETUP,
+        SENSOR_CONFIG,
+        SELF_TEST,
+        SELF_TEST_RESULT,
+        RUN_MODE,
+        FINISH
+    };
+
+    /**
+     * @brief Write OPR_MODE unless the device is known to be in mode
+     * @param[out] switched true if the mode-switch delay is owed
+     */
+    bool write_mode(Mode mode, bool& switched);
+
+    /**
+     * @brief Write UNIT_SEL and the page-1 sensor config, CONFIG mode only
+     */
+    bool write_config(const Config& config);
+
+    void start_job(Stage first, uint32_t now_ms, uint32_t wait_ms);
+
+    template <uint8_t Fields>
+    bool read_raw_from(LBR::I2c& i2c, Bno055RawData& out);
+    bool run_blocking(uint8_t* status);
+
+    static int16_t decode_int16(const uint8_t* data)
+    {
+        return static_cast<int16_t>((data[1] << 8) | data[0]);
+    }
+
+    static RawVec3 decode_vec3(const uint8_t* data)
+    {
+        return RawVec3{decode_int16(data), decode_int16(data + 2),
+                       decode_int16(data + 4)};
+    }
+
+    static Bno055Status decode_status(const uint8_t* data)
+    {
+        return Bno055Status{static_cast<int8_t>(data[0]), data[1], data[2],
+                            data[3], data[4], data[5], data[6]};
+    }
+
+    LBR::I2cRegCache i2c_;  ///< I2c interface with config registers shadowed
+    /* Sample reads skip the shadow, no output or status register is cached
+     * and they never switch the page */
+    LBR::I2c& data_i2c_;
+    uint8_t address_;       ///< I2C address
+
+    Stage stage_{Stage::IDLE};
+    Progress progress_{Progress::DONE};
+    uint32_t wake_ms_{0};     ///< Next stage runs once now_ms reaches it
+    uint8_t tries_{0};        ///< CHIP_ID reads so far
+    uint8_t trigger_{0};      ///< SYS_TRIGGER value of the self-test job
+    uint8_t st_result_{0};
+    bool failed_{false};
+
+    Mode run_mode_{IMU};  ///< Mode init ends in and self tests return to
+    Config config_{};     ///< Applied by the init job
+    Bno055Scale scale_{};
 };
 
+template <uint8_t Fields>
+bool Bno055::read(Bno055Data& out)
+{
+    Bno055RawData raw;
+    if (!read_raw<Fields>(raw))
+    {
+        return false;
+    }
+    raw.convert<Fields>(out, scale_);
+    return true;
+}
+
+template <uint8_t Fields>
+bool Bno055::read_raw(Bno055RawData& out)
+{
+    return read_raw_from<Fields>(data_i2c_, out);
+}
+
+template <uint8_t Fields>
+bool Bno055::read_raw_from(LBR::I2c& i2c, Bno055RawData& out)
+{
+    static_assert(Fields != 0 && (Fields & ~BNO055_FULL_STATUS) == 0,
+                  "Fields must be a non-empty mask of Bno055Field");
+    static constexpr Bno055Layout::Plan PLAN = Bno055Layout::plan(Fields);
+
+    std::array<uint8_t, PLAN.bytes> buf;
+    std::array<I2cOp, PLAN.num_windows> ops;
+    for (size_t i = 0; i < PLAN.num_windows; i++)
+    {
+        const Bno055Layout::Window& window = PLAN.windows[i];
+        ops[i] = I2cOp::read(
+            address_, window.reg_addr,
+            std::span<uint8_t>(buf.data() + window.offset, window.len));
+    }
+    if (i2c.transfer(ops) != I2cStatus::OK)
+    {
+        return false;
+    }
+
+    if constexpr (Fields & BNO055_ACCEL)
+    {
+        out.accel = decode_vec3(&buf[PLAN.offset_of(BNO055_ACCEL)]);
+    }
+    if constexpr (Fields & BNO055_GYRO)
+    {
+        out.gyro = decode_vec3(&buf[PLAN.offset_of(BNO055_GYRO)]);
+    }
+    if constexpr (Fields & BNO055_QUAT)
+    {
+        const uint8_t* q = &buf[PLAN.offset_of(BNO055_QUAT)];
+        out.quat = RawQuaternion{decode_int16(q), decode_int16(q + 2),
+                                 decode_int16(q + 4), decode_int16(q + 6)};
+    }
+    if constexpr (Fields & BNO055_LINEAR_ACCEL)
+    {
+        out.linear_accel =
+            decode_vec3(&buf[PLAN.offset_of(BNO055_LINEAR_ACCEL)]);
+    }
+    if constexpr (Fields & BNO055_GRAVITY)
+    {
+        out.gravity = decode_vec3(&buf[PLAN.offset_of(BNO055_GRAVITY)]);
+    }
+    if constexpr (Fields & BNO055_STATUS)
+    {
+        out.status = decode_status(&buf[PLAN.offset_of(BNO055_STATUS)]);
+    }
+
+    return true;
+}
+
 }  // namespace LBR
\ No newline at end of file
@@ -0,0 +1,146 @@
+/**
+ * @file bno055_layout.h
+ * @brief Compile-time planning of BNO055 output register reads
+ * @date 10/17/2026
+ * @note Turns a field mask into the fewest contiguous register windows that
+ *       cover it, so a read only moves the bytes it needs
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace LBR
+{
+
+/**
+ * @brief Output fields of the BNO055 data block, combinable as a mask
+ */
+enum Bno055Field : uint8_t
+{
+    BNO055_ACCEL = 0x01,         ///< ACC_DATA, 0x08
+    BNO055_GYRO = 0x02,          ///< GYR_DATA, 0x14
+    BNO055_QUAT = 0x04,          ///< QUA_DATA, 0x20
+    BNO055_LINEAR_ACCEL = 0x08,  ///< LIA_DATA, 0x28
+    BNO055_GRAVITY = 0x10,       ///< GRV_DATA, 0x2E
+    BNO055_ALL_FIELDS = 0x1F,    ///< Every output vector, no status
+    BNO055_STATUS = 0x20,        ///< TEMP .. SYS_ERR, 0x34
+    BNO055_FULL_STATUS = BNO055_ALL_FIELDS | BNO055_STATUS
+};
+
+namespace Bno055Layout
+{
+
+/**
+ * @brief Register block of one output field
+ */
+struct Block
+{
+    uint8_t field;
+    uint8_t reg_addr;
+    uint8_t len;
+};
+
+/* Sorted by address */
+inline constexpr std::array<Block, 6> BLOCKS{{
+    {BNO055_ACCEL, 0x08, 6},
+    {BNO055_GYRO, 0x14, 6},
+    {BNO055_QUAT, 0x20, 8},
+    {BNO055_LINEAR_ACCEL, 0x28, 6},
+    {BNO055_GRAVITY, 0x2E, 6},
+    {BNO055_STATUS, 0x34, 7},
+}};
+
+/* Extra bytes a separate window costs in a chained transfer: repeated START
+ * with the write address, register pointer, read address */
+inline constexpr size_t WINDOW_OVERHEAD = 3;
+
+/**
+ * @brief One contiguous register read, landing at offset in the buffer
+ */
+struct Window
+{
+    uint8_t reg_addr;
+    uint8_t len;
+    uint8_t offset;
+};
+
+struct Plan
+{
+    std::array<Window, BLOCKS.size()> windows{};
+    size_t num_windows{0};
+    size_t bytes{0};  ///< Buffer size, sum of window lengths
+
+    /**
+     * @return buffer offset of a field's first byte
+     */
+    constexpr size_t offset_of(uint8_t field) const
+    {
+        for (const Block& block : BLOCKS)
+        {
+            if (block.field != field)
+            {
+                continue;
+            }
+            for (size_t i = 0; i < num_windows; i++)
+            {
+                const Window& w = windows[i];
+                if (block.reg_addr >= w.reg_addr &&
+                    block.reg_addr < w.reg_addr + w.len)
+                {
+                    return w.offset + (block.reg_addr - w.reg_addr);
+                }
+            }
+        }
+        return 0;
+    }
+};
+
+/**
+ * @brief Groups the requested blocks into windows, bridging a gap whenever
+ *        reading through it is cheaper than opening a new window
+ */
+constexpr Plan plan(uint8_t fields)
+{
+    Plan result{};
+    for (const Block& block : BLOCKS)
+    {
+        if (!(fields & block.field))
+        {
+            continue;
+        }
+
+        if (result.num_windows > 0)
+        {
+            Window& last = result.windows[result.num_windows - 1];
+            const size_t end = last.reg_addr + last.len;
+            const size_t gap = block.reg_addr - end;
+            if (gap <= WINDOW_OVERHEAD)
+            {
+                const size_t grow = gap + block.len;
+                last.len += grow;
+                result.bytes += grow;
+                continue;
+            }
+        }
+
+        result.windows[result.num_windows++] =
+            Window{block.reg_addr, block.len, static_cast<uint8_t>(result.bytes)};
+        result.bytes += block.len;
+    }
+    return result;
+}
+
+// The two windows PPS uses, and the full set bridging QUA/LIA/GRV
+static_assert(plan(BNO055_QUAT | BNO055_ACCEL).bytes == 14);
+static_assert(plan(BNO055_QUAT | BNO055_ACCEL).num_windows == 2);
+static_assert(plan(BNO055_ALL_FIELDS).num_windows == 3);
+static_assert(plan(BNO055_ALL_FIELDS).bytes == 32);
+// Status directly follows GRV, so it rides on the last window
+static_assert(plan(BNO055_FULL_STATUS).num_windows == 3);
+static_assert(plan(BNO055_FULL_STATUS).bytes == 39);
+
+}  // namespace Bno055Layout
+}  // namespace LBR
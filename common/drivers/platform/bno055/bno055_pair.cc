@@ -0,0 +1,158 @@
+#include "bno055_pair.h"
+#include <cmath>
+#include <cstdlib>
+#include <numbers>
+
+namespace LBR
+{
+
+static float dot(const Quaternion& a, const Quaternion& b)
+{
+    return a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+Bno055Pair::Bno055Pair(Bno055& primary, Bno055& alternate,
+                       const Bno055PairParams& params)
+    : imus_{{{&primary}, {&alternate}}},
+      params_(params),
+      min_dot_(std::cos(params.max_angle_deg * std::numbers::pi_v<float> /
+                        360.0f))
+{
+}
+
+bool Bno055Pair::update(uint32_t now_ms)
+{
+    // Alternate the order so neither sensor is always the older one
+    poll(imus_[first_], now_ms);
+    poll(imus_[first_ ^ 1], now_ms);
+    first_ ^= 1;
+
+    const bool ok0 = healthy(0, now_ms);
+    const bool ok1 = healthy(1, now_ms);
+    const bool fresh = (ok0 && imus_[0].fresh) || (ok1 && imus_[1].fresh);
+
+    if (ok0 && ok1)
+    {
+        const Channel& a = imus_[0];
+        const Channel& b = imus_[1];
+        // Wrap-safe like healthy(), positive when a is the newer one
+        const int32_t skew = static_cast<int32_t>(a.stamp_ms - b.stamp_ms);
+        if (static_cast<uint32_t>(std::abs(skew)) > params_.max_skew_ms)
+        {
+            use((skew > 0) ? 0 : 1);
+        }
+        else if (agree(a.data, b.data))
+        {
+            combine();
+        }
+        else
+        {
+            disagreements_++;
+            if (has_output_)
+            {
+                use(vote());
+            }
+            else
+            {
+                source_ = Source::NONE;
+            }
+        }
+    }
+    else if (ok0 || ok1)
+    {
+        use(ok0 ? 0 : 1);
+    }
+    else
+    {
+        source_ = Source::NONE;
+    }
+
+    return fresh && source_ != Source::NONE;
+}
+
+bool Bno055Pair::healthy(size_t idx, uint32_t now_ms) const
+{
+    const Channel& ch = imus_[idx];
+    return ch.has_sample && ch.data.status.valid() &&
+           now_ms - ch.stamp_ms <= params_.stale_ms;
+}
+
+void Bno055Pair::poll(Channel& ch, uint32_t now_ms)
+{
+    ch.fresh = false;
+    Bno055Data sample;
+    if (!ch.imu->read<FIELDS>(sample))
+    {
+        // Still try to release INT, a latched line hides the next edge
+        ch.imu->ack_interrupt();
+        return;
+    }
+
+    // Status is always current, the data only counts once per new sample
+    ch.data.status = sample.status;
+    if (sample.status.int_sta & Bno055Status::INT_ACC_BSX_DRDY)
+    {
+        ch.imu->ack_interrupt();
+        ch.data = sample;
+        ch.stamp_ms = now_ms;
+        ch.has_sample = true;
+        ch.fresh = true;
+    }
+}
+
+bool Bno055Pair::agree(const Bno055Data& a, const Bno055Data& b) const
+{
+    // Same rotation for q and -q
+    if (std::fabs(dot(a.quat, b.quat)) < min_dot_)
+    {
+        return false;
+    }
+
+    const float dx = a.accel.x - b.accel.x;
+    const float dy = a.accel.y - b.accel.y;
+    const float dz = a.accel.z - b.accel.z;
+    return dx * dx + dy * dy + dz * dz <=
+           params_.max_accel_diff * params_.max_accel_diff;
+}
+
+/* With two sensors a disagreement has no majority, continuity with the
+ * previous output breaks the tie */
+size_t Bno055Pair::vote() const
+{
+    const float d0 = std::fabs(dot(imus_[0].data.quat, out_.quat));
+    const float d1 = std::fabs(dot(imus_[1].data.quat, out_.quat));
+    return (d1 > d0) ? 1 : 0;
+}
+
+void Bno055Pair::use(size_t idx)
+{
+    out_ = imus_[idx].data;
+    source_ = (idx == 0) ? Source::PRIMARY : Source::ALTERNATE;
+    has_output_ = true;
+}
+
+void Bno055Pair::combine()
+{
+    const Bno055Data& a = imus_[0].data;
+    Quaternion b = imus_[1].data.quat;
+    if (dot(a.quat, b) < 0.0f)
+    {
+        b = Quaternion{-b.w, -b.x, -b.y, -b.z};
+    }
+
+    Quaternion q{a.quat.w + b.w, a.quat.x + b.x, a.quat.y + b.y,
+                 a.quat.z + b.z};
+    const float norm = std::sqrt(dot(q, q));
+    q = Quaternion{q.w / norm, q.x / norm, q.y / norm, q.z / norm};
+
+    const Vec3& b_accel = imus_[1].data.accel;
+    out_ = a;
+    out_.quat = q;
+    out_.accel = Vec3{(a.accel.x + b_accel.x) * 0.5f,
+                      (a.accel.y + b_accel.y) * 0.5f,
+                      (a.accel.z + b_accel.z) * 0.5f};
+    source_ = Source::BOTH;
+    has_output_ = true;
+}
+
+}  // namespace LBR
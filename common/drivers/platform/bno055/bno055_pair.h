@@ -0,0 +1,137 @@
+/**
+ * @file bno055_pair.h
+ * @brief Redundant BNO055 pair combined into one orientation source
+ * @date 10/17/2026
+ * @note Both sensors share the bus at ADDR_PRIMARY and ADDR_ALTERNATE and
+ *       must have the data-ready interrupt enabled, INT_STA is how a new
+ *       sample is told apart from a repeated one
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "bno055_imu.h"
+
+namespace LBR
+{
+
+/**
+ * @struct Bno055PairParams
+ * @brief Fault and agreement limits, defaults suit the 100Hz fusion rate
+ */
+struct Bno055PairParams
+{
+    uint32_t stale_ms = 30;        ///< No new sample for this long drops a sensor
+    uint32_t max_skew_ms = 10;     ///< Samples further apart are not combined
+    float max_angle_deg = 10.0f;   ///< Orientation disagreement limit
+    float max_accel_diff = 3.0f;   ///< Acceleration disagreement limit, m/s^2
+};
+
+/**
+ * @class Bno055Pair
+ * @brief Reads two BNO055s and outputs one sample
+ * @details Each update polls both sensors, alternating which goes first.
+ *          A sensor counts as healthy while its status is valid() and its
+ *          last new sample is younger than stale_ms. Then:
+ *          - both healthy, time-aligned and agreeing: quaternions and
+ *            accelerations are averaged
+ *          - both healthy but disagreeing: the one closer to the previous
+ *            output wins, with no previous output there is no sample
+ *          - one healthy: it is used alone
+ */
+class Bno055Pair
+{
+public:
+    static constexpr size_t NUM_IMUS = 2;
+    static constexpr uint8_t FIELDS =
+        BNO055_QUAT | BNO055_ACCEL | BNO055_STATUS;
+
+    /**
+     * @enum Source
+     * @brief Which sensors the current output came from
+     */
+    enum class Source : uint8_t
+    {
+        NONE,
+        PRIMARY,
+        ALTERNATE,
+        BOTH
+    };
+
+    /**
+     * @param primary sensor whose INT paces the caller
+     * @param alternate second sensor, may be absent and then never healthy
+     */
+    Bno055Pair(Bno055& primary, Bno055& alternate,
+               const Bno055PairParams& params = {});
+
+    /**
+     * @brief Polls both sensors and recombines
+     * @note Call on the primary data-ready interrupt, and on a timeout too
+     *       so a primary with a stuck INT line still gets acknowledged
+     * @return true if a new sample is available in data()
+     */
+    bool update(uint32_t now_ms);
+
+    /**
+     * @brief Combined orientation and acceleration, status of the sensor
+     *        that was used (the primary when both were)
+     */
+    const Bno055Data& data() const
+    {
+        return out_;
+    }
+
+    Source source() const
+    {
+        return source_;
+    }
+
+    /**
+     * @brief Last sample of one sensor, including its status
+     * @param idx 0 for the primary, 1 for the alternate
+     */
+    const Bno055Data& sample(size_t idx) const
+    {
+        return imus_[idx].data;
+    }
+
+    bool healthy(size_t idx, uint32_t now_ms) const;
+
+    /**
+     * @brief Number of updates where both sensors were healthy but disagreed
+     */
+    uint32_t disagreements() const
+    {
+        return disagreements_;
+    }
+
+private:
+    struct Channel
+    {
+        Bno055* imu;
+        Bno055Data data{};
+        uint32_t stamp_ms{0};
+        bool has_sample{false};
+        bool fresh{false};
+    };
+
+    static void poll(Channel& ch, uint32_t now_ms);
+    bool agree(const Bno055Data& a, const Bno055Data& b) const;
+    size_t vote() const;
+    void use(size_t idx);
+    void combine();
+
+    std::array<Channel, NUM_IMUS> imus_;
+    Bno055PairParams params_;
+    float min_dot_;  ///< cos(max_angle_deg / 2), compared to |q1 . q2|
+    Bno055Data out_{};
+    Source source_{Source::NONE};
+    bool has_output_{false};
+    uint8_t first_{0};
+    uint32_t disagreements_{0};
+};
+
+}  // namespace LBR
@@ -0,0 +1,348 @@
+#include "sim_bno055.h"
+#include <algorithm>
+#include <cmath>
+
+namespace LBR::Sim
+{
+
+// Page 0
+static constexpr uint8_t REG_CHIP_ID = 0x00;
+static constexpr uint8_t REG_PAGE_ID = 0x07;
+static constexpr uint8_t REG_CALIB_STAT = 0x35;
+static constexpr uint8_t REG_ST_RESULT = 0x36;
+static constexpr uint8_t REG_INT_STA = 0x37;
+static constexpr uint8_t REG_SYS_STATUS = 0x39;
+static constexpr uint8_t REG_SYS_ERR = 0x3A;
+static constexpr uint8_t REG_STATUS_LAST = REG_SYS_ERR;
+static constexpr uint8_t REG_UNIT_SEL = 0x3B;
+static constexpr uint8_t REG_OPR_MODE = 0x3D;
+static constexpr uint8_t REG_SYS_TRIGGER = 0x3F;
+static constexpr uint8_t REG_AXIS_MAP_CONFIG = 0x41;
+
+// Page 1
+static constexpr uint8_t REG_ACC_CONFIG = 0x08;
+static constexpr uint8_t REG_MAG_CONFIG = 0x09;
+static constexpr uint8_t REG_GYR_CONFIG_0 = 0x0A;
+static constexpr uint8_t REG_INT_MSK = 0x0F;
+static constexpr uint8_t REG_INT_EN = 0x10;
+
+static constexpr uint8_t MODE_CONFIG = 0x00;
+static constexpr uint8_t MODE_FUSION_FIRST = 0x08;  // IMU..NDOF
+
+static constexpr uint8_t TRIGGER_SELF_TEST = 0x01;
+static constexpr uint8_t TRIGGER_RST_SYS = 0x20;
+static constexpr uint8_t TRIGGER_RST_INT = 0x40;
+static constexpr uint8_t TRIGGER_CLK_SEL = 0x80;
+
+static constexpr uint8_t INT_ACC_BSX_DRDY = 0x01;
+
+static constexpr uint8_t SYS_STATUS_IDLE = 0x00;
+static constexpr uint8_t SYS_STATUS_ERROR = 0x01;
+static constexpr uint8_t SYS_STATUS_FUSION = 0x05;
+static constexpr uint8_t SYS_STATUS_NO_FUSION = 0x06;
+
+static void put_int16(std::array<uint8_t, SimBno055Sample::LEN>& regs,
+                      uint8_t reg_addr, float value)
+{
+    const float clamped = std::clamp(std::round(value), -32768.0f, 32767.0f);
+    const uint16_t raw = static_cast<uint16_t>(static_cast<int16_t>(clamped));
+    const size_t idx = reg_addr - SimBno055Sample::FIRST_REG;
+    regs[idx] = raw & 0xFF;
+    regs[idx + 1] = raw >> 8;
+}
+
+static void put_vec3(std::array<uint8_t, SimBno055Sample::LEN>& regs,
+                     uint8_t reg_addr, const Vec3& v, float scale)
+{
+    put_int16(regs, reg_addr, v.x * scale);
+    put_int16(regs, reg_addr + 2, v.y * scale);
+    put_int16(regs, reg_addr + 4, v.z * scale);
+}
+
+SimBno055Sample SimBno055Sample::from(const Bno055Data& data, int8_t temp_c)
+{
+    constexpr float ACCEL_SCALE = Bno055RawData::ACCEL_SCALE;
+    constexpr float GYRO_SCALE = Bno055RawData::GYRO_SCALE;
+    constexpr float QUAT_SCALE = Bno055RawData::QUAT_SCALE;
+
+    SimBno055Sample sample{};
+    put_vec3(sample.regs, 0x08, data.accel, ACCEL_SCALE);
+    put_vec3(sample.regs, 0x14, data.gyro, GYRO_SCALE);
+    put_int16(sample.regs, 0x20, data.quat.w * QUAT_SCALE);
+    put_int16(sample.regs, 0x22, data.quat.x * QUAT_SCALE);
+    put_int16(sample.regs, 0x24, data.quat.y * QUAT_SCALE);
+    put_int16(sample.regs, 0x26, data.quat.z * QUAT_SCALE);
+    put_vec3(sample.regs, 0x28, data.linear_accel, ACCEL_SCALE);
+    put_vec3(sample.regs, 0x2E, data.gravity, ACCEL_SCALE);
+    sample.regs[0x34 - FIRST_REG] = static_cast<uint8_t>(temp_c);
+    return sample;
+}
+
+SimBno055::SimBno055()
+{
+    reset();
+}
+
+void SimBno055::reset()
+{
+    for (auto& page : _regs)
+    {
+        page.fill(0);
+    }
+
+    auto& p0 = _regs[0];
+    p0[REG_CHIP_ID] = 0xA0;
+    p0[0x01] = 0xFB;  // ACC_ID
+    p0[0x02] = 0x32;  // MAG_ID
+    p0[0x03] = 0x0F;  // GYR_ID
+    p0[0x04] = 0x11;  // SW_REV_ID_LSB
+    p0[0x05] = 0x03;  // SW_REV_ID_MSB
+    p0[0x06] = 0x15;  // BL_REV_ID
+    p0[REG_ST_RESULT] = 0x0F;  // POST passed
+    p0[REG_UNIT_SEL] = 0x80;
+    p0[REG_AXIS_MAP_CONFIG] = 0x24;
+
+    auto& p1 = _regs[1];
+    p1[REG_PAGE_ID] = 0x01;
+    p1[REG_ACC_CONFIG] = 0x0D;
+    p1[REG_MAG_CONFIG] = 0x6D;
+    p1[REG_GYR_CONFIG_0] = 0x38;
+
+    _restart = true;
+}
+
+void SimBno055::play(std::span<const SimBno055Sample> stream,
+                     uint32_t period_us, bool loop)
+{
+    _stream = stream;
+    _period_us = (period_us > 0) ? period_us : 1;
+    _loop = loop;
+    _restart = true;
+}
+
+void SimBno055::set_calib_stat(uint8_t value)
+{
+    _regs[0][REG_CALIB_STAT] = value;
+}
+
+void SimBno055::set_sys_error(uint8_t sys_err)
+{
+    _regs[0][REG_SYS_ERR] = sys_err;
+    update_sys_status();
+}
+
+uint8_t SimBno055::reg(uint8_t page, uint8_t reg_addr) const
+{
+    if (page >= NUM_PAGES || reg_addr >= PAGE_SIZE)
+    {
+        return 0;
+    }
+    return _regs[page][reg_addr];
+}
+
+bool SimBno055::int_pin() const
+{
+    return (_regs[0][REG_INT_STA] & _regs[1][REG_INT_MSK]) != 0;
+}
+
+uint8_t SimBno055::mode() const
+{
+    return _regs[0][REG_OPR_MODE] & 0x0F;
+}
+
+I2cStatus SimBno055::read(uint16_t reg_addr, std::span<uint8_t> data)
+{
+    if (_now_us < _ready_us)
+    {
+        return I2cStatus::NACK;
+    }
+
+    const auto& page = _regs[_regs[0][REG_PAGE_ID] & 0x01];
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        const size_t reg = reg_addr + i;
+        data[i] = (reg < PAGE_SIZE) ? page[reg] : 0;
+    }
+    return I2cStatus::OK;
+}
+
+I2cStatus SimBno055::write(uint16_t reg_addr, std::span<const uint8_t> data)
+{
+    if (_now_us < _ready_us)
+    {
+        return I2cStatus::NACK;
+    }
+
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        const size_t reg = reg_addr + i;
+        if (reg < PAGE_SIZE && writable(static_cast<uint8_t>(reg)))
+        {
+            write_reg(static_cast<uint8_t>(reg), data[i]);
+        }
+    }
+    return I2cStatus::OK;
+}
+
+void SimBno055::advance(uint64_t now_us)
+{
+    _now_us = now_us;
+    if (_restart)
+    {
+        _start_us = now_us;
+        _period_idx = UINT64_MAX;
+        _restart = false;
+    }
+    if (mode() != MODE_CONFIG)
+    {
+        // Each output period is a new sample, latched in INT_STA if enabled
+        const uint64_t period_idx = (_now_us - _start_us) / _period_us;
+        if (period_idx != _period_idx)
+        {
+            _period_idx = period_idx;
+            if (_regs[1][REG_INT_EN] & INT_ACC_BSX_DRDY)
+            {
+                _regs[0][REG_INT_STA] |= INT_ACC_BSX_DRDY;
+            }
+        }
+        load_sample();
+    }
+}
+
+/* Outside CONFIG mode only OPR_MODE, PAGE_ID, SYS_TRIGGER and the interrupt
+ * mask/enable take writes, everything else is silently dropped */
+bool SimBno055::writable(uint8_t reg_addr) const
+{
+    const uint8_t page = _regs[0][REG_PAGE_ID] & 0x01;
+    if (reg_addr == REG_PAGE_ID)
+    {
+        return true;
+    }
+    if (page == 0)
+    {
+        if (reg_addr == REG_OPR_MODE || reg_addr == REG_SYS_TRIGGER)
+        {
+            return true;
+        }
+        // IDs and outputs are read-only
+        if (reg_addr <= REG_STATUS_LAST)
+        {
+            return false;
+        }
+    }
+    else if (reg_addr == REG_INT_MSK || reg_addr == REG_INT_EN)
+    {
+        return true;
+    }
+    return mode() == MODE_CONFIG;
+}
+
+void SimBno055::write_reg(uint8_t reg_addr, uint8_t value)
+{
+    if (reg_addr == REG_PAGE_ID)
+    {
+        _regs[0][REG_PAGE_ID] = value & 0x01;
+        _regs[1][REG_PAGE_ID] = value & 0x01;
+        return;
+    }
+
+    const uint8_t page = _regs[0][REG_PAGE_ID];
+    if (page == 1)
+    {
+        _regs[1][reg_addr] = value;
+        return;
+    }
+
+    switch (reg_addr)
+    {
+        case REG_OPR_MODE:
+            set_mode(value & 0x0F);
+            break;
+        case REG_SYS_TRIGGER:
+            if (value & TRIGGER_RST_SYS)
+            {
+                reset();
+                _ready_us = _now_us + BOOT_TIME_US;
+                return;
+            }
+            if ((value & TRIGGER_SELF_TEST) && mode() == MODE_CONFIG)
+            {
+                _regs[0][REG_ST_RESULT] = 0x0F;
+            }
+            if (value & TRIGGER_RST_INT)
+            {
+                _regs[0][REG_INT_STA] = 0;
+            }
+            // Trigger bits self-clear, CLK_SEL sticks
+            _regs[0][REG_SYS_TRIGGER] = value & TRIGGER_CLK_SEL;
+            break;
+        default:
+            _regs[0][reg_addr] = value;
+            break;
+    }
+}
+
+void SimBno055::set_mode(uint8_t mode)
+{
+    if (mode != this->mode())
+    {
+        _mode_switches++;
+    }
+    _regs[0][REG_OPR_MODE] = mode;
+
+    if (mode == MODE_CONFIG)
+    {
+        // Outputs read zero while fusion is halted
+        std::fill_n(&_regs[0][SimBno055Sample::FIRST_REG],
+                    SimBno055Sample::LEN, 0);
+    }
+    else
+    {
+        _restart = true;
+    }
+    update_sys_status();
+}
+
+/* SYS_STATUS follows the mode, a pending SYS_ERR overrides it */
+void SimBno055::update_sys_status()
+{
+    const uint8_t mode = this->mode();
+    if (_regs[0][REG_SYS_ERR] != 0)
+    {
+        _regs[0][REG_SYS_STATUS] = SYS_STATUS_ERROR;
+    }
+    else if (mode == MODE_CONFIG)
+    {
+        _regs[0][REG_SYS_STATUS] = SYS_STATUS_IDLE;
+    }
+    else
+    {
+        _regs[0][REG_SYS_STATUS] = (mode >= MODE_FUSION_FIRST)
+                                       ? SYS_STATUS_FUSION
+                                       : SYS_STATUS_NO_FUSION;
+    }
+}
+
+void SimBno055::load_sample()
+{
+    if (_stream.empty())
+    {
+        return;
+    }
+
+    size_t idx = static_cast<size_t>((_now_us - _start_us) / _period_us);
+    if (_loop)
+    {
+        idx %= _stream.size();
+    }
+    else
+    {
+        idx = std::min(idx, _stream.size() - 1);
+    }
+
+    const SimBno055Sample& sample = _stream[idx];
+    std::copy(sample.regs.begin(), sample.regs.end(),
+              &_regs[0][SimBno055Sample::FIRST_REG]);
+}
+
+}  // namespace LBR::Sim
@@ -0,0 +1,131 @@
+/**
+ * @file sim_bno055.h
+ * @brief Behavioral BNO055 model for the host I2C simulator
+ * @date 10/17/2026
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include "bno055_imu.h"
+#include "sim_i2c.h"
+
+namespace LBR
+{
+namespace Sim
+{
+
+/**
+ * @brief One recorded output frame, raw page 0 registers 0x08..0x34
+ *        (ACC, MAG, GYR, EUL, QUA, LIA, GRV, TEMP)
+ */
+struct SimBno055Sample
+{
+    static constexpr uint8_t FIRST_REG = 0x08;
+    static constexpr size_t LEN = 0x35 - FIRST_REG;
+
+    std::array<uint8_t, LEN> regs{};
+
+    /**
+     * @brief Encodes driver-side values with the default units (m/s^2, dps,
+     *        unit quaternion), MAG and EUL stay zero
+     */
+    static SimBno055Sample from(const Bno055Data& data, int8_t temp_c = 25);
+};
+
+/**
+ * @class SimBno055
+ * @brief Register-level BNO055 model
+ * @details Models what the drivers rely on:
+ *          - ID registers and datasheet reset values on pages 0 and 1
+ *          - PAGE_ID switching and OPR_MODE with SYS_STATUS following it
+ *          - write lock of config registers outside CONFIG mode
+ *          - data block replay from a recorded stream while in a fusion or
+ *            sensor mode, zeroed in CONFIG mode
+ *          - CALIB_STAT set by the test
+ *          - data-ready latched in INT_STA once per output period and
+ *            driven on the INT pin through INT_MSK
+ *          - SYS_TRIGGER self-test, interrupt reset and system reset, the
+ *            latter NACKing for the 650ms boot time
+ */
+class SimBno055 : public SimI2cDevice
+{
+public:
+    static constexpr uint32_t BOOT_TIME_US = 650'000;
+
+    SimBno055();
+
+    /**
+     * @brief Puts every register back to its reset value
+     */
+    void reset();
+
+    /**
+     * @brief Replays a stream into the data registers, one sample per period
+     *
+     * @param stream samples, must outlive playback
+     * @param period_us output data period, 10ms for the 100Hz fusion rate
+     * @param loop restart at the end instead of holding the last sample
+     */
+    void play(std::span<const SimBno055Sample> stream,
+              uint32_t period_us = 10'000, bool loop = true);
+
+    void set_calib_stat(uint8_t value);
+
+    /**
+     * @brief Reports a system error, SYS_STATUS reads 1 until it is cleared
+     *        with 0 or the device is reset
+     *
+     * @param sys_err SYS_ERR code
+     */
+    void set_sys_error(uint8_t sys_err);
+
+    /**
+     * @brief Direct register access for test checks, no side effects
+     */
+    uint8_t reg(uint8_t page, uint8_t reg_addr) const;
+
+    uint8_t mode() const;
+
+    /**
+     * @brief Level of the INT pin, high until SYS_TRIGGER.RST_INT
+     */
+    bool int_pin() const;
+
+    uint32_t mode_switches() const
+    {
+        return _mode_switches;
+    }
+
+    I2cStatus read(uint16_t reg_addr, std::span<uint8_t> data) override;
+    I2cStatus write(uint16_t reg_addr, std::span<const uint8_t> data) override;
+    void advance(uint64_t now_us) override;
+
+private:
+    static constexpr size_t NUM_PAGES = 2;
+    static constexpr size_t PAGE_SIZE = 0x80;
+
+    bool writable(uint8_t reg_addr) const;
+    void write_reg(uint8_t reg_addr, uint8_t value);
+    void set_mode(uint8_t mode);
+    void update_sys_status();
+    void load_sample();
+
+    std::array<std::array<uint8_t, PAGE_SIZE>, NUM_PAGES> _regs{};
+    uint64_t _now_us{0};
+    uint64_t _ready_us{0};
+    uint32_t _mode_switches{0};
+
+    std::span<const SimBno055Sample> _stream{};
+    uint32_t _period_us{10'000};
+    bool _loop{true};
+    bool _restart{false};
+    uint64_t _start_us{0};
+    uint64_t _period_idx{UINT64_MAX};
+};
+
+}  // namespace Sim
+}  // namespace LBR
@@ -0,0 +1,86 @@
+#include "sim_flash.h"
+#include <algorithm>
+
+namespace LBR::Sim
+{
+
+SimFlash::SimFlash(std::span<uint8_t> storage, size_t write_unit)
+    : _storage(storage), _write_unit(std::max<size_t>(write_unit, 1))
+{
+    std::fill(_storage.begin(), _storage.end(), ERASED_VALUE);
+}
+
+size_t SimFlash::size() const
+{
+    return _storage.size();
+}
+
+size_t SimFlash::write_unit() const
+{
+    return _write_unit;
+}
+
+bool SimFlash::read(size_t offset, std::span<uint8_t> data)
+{
+    if (offset + data.size() > _storage.size())
+    {
+        return false;
+    }
+    std::copy_n(_storage.begin() + offset, data.size(), data.begin());
+    return true;
+}
+
+bool SimFlash::write(size_t offset, std::span<const uint8_t> data)
+{
+    if (offset % _write_unit != 0 || data.size() % _write_unit != 0 ||
+        offset + data.size() > _storage.size())
+    {
+        _stats.rejected++;
+        return false;
+    }
+
+    for (size_t i = 0; i < data.size(); i += _write_unit)
+    {
+        const auto unit = _storage.subspan(offset + i, _write_unit);
+        if (!std::all_of(unit.begin(), unit.end(),
+                         [](uint8_t b) { return b == ERASED_VALUE; }))
+        {
+            _stats.rejected++;
+            return false;
+        }
+        if (_power_loss_in == 0)
+        {
+            return false;
+        }
+        if (_power_loss_in != SIZE_MAX)
+        {
+            _power_loss_in--;
+        }
+        std::copy_n(data.begin() + i, _write_unit, unit.begin());
+        _stats.writes++;
+    }
+    return true;
+}
+
+bool SimFlash::erase()
+{
+    if (_power_loss_in == 0)
+    {
+        return false;
+    }
+    std::fill(_storage.begin(), _storage.end(), ERASED_VALUE);
+    _stats.erases++;
+    return true;
+}
+
+void SimFlash::inject_power_loss(size_t units)
+{
+    _power_loss_in = units;
+}
+
+void SimFlash::restore_power()
+{
+    _power_loss_in = SIZE_MAX;
+}
+
+}  // namespace LBR::Sim
@@ -0,0 +1,72 @@
+/**
+ * @file sim_flash.h
+ * @brief Host-side flash region with NOR program/erase rules
+ * @date 10/17/2026
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include "flash.h"
+
+namespace LBR
+{
+namespace Sim
+{
+
+/**
+ * @brief Operation counts of a SimFlash
+ */
+struct SimFlashStats
+{
+    uint32_t erases;
+    uint32_t writes;    ///< Write units programmed
+    uint32_t rejected;  ///< Writes refused for alignment or erase state
+};
+
+/**
+ * @class SimFlash
+ * @brief Flash over caller-owned RAM
+ * @details Like the STM32L4 a write unit can only be programmed while
+ *          erased, and a power cut can be injected to leave a write torn.
+ */
+class SimFlash : public Flash
+{
+public:
+    /**
+     * @param storage backing bytes, must outlive the flash, starts erased
+     * @param write_unit programming granularity
+     */
+    explicit SimFlash(std::span<uint8_t> storage, size_t write_unit = 8);
+
+    size_t size() const override;
+    size_t write_unit() const override;
+    bool read(size_t offset, std::span<uint8_t> data) override;
+    bool write(size_t offset, std::span<const uint8_t> data) override;
+    bool erase() override;
+
+    /**
+     * @brief Cuts power after units more write units, the write in progress
+     *        fails and everything it did not reach stays erased. Writes
+     *        and erases keep failing until restore_power().
+     */
+    void inject_power_loss(size_t units);
+
+    void restore_power();
+
+    const SimFlashStats& stats() const
+    {
+        return _stats;
+    }
+
+private:
+    std::span<uint8_t> _storage;
+    size_t _write_unit;
+    size_t _power_loss_in{SIZE_MAX};
+    SimFlashStats _stats{};
+};
+
+}  // namespace Sim
+}  // namespace LBR
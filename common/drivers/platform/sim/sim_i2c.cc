@@ -0,0 +1,241 @@
+#include "sim_i2c.h"
+
+namespace LBR::Sim
+{
+
+/* 8 data bits plus ACK per byte */
+static constexpr uint32_t BITS_PER_BYTE = 9;
+/* START and STOP conditions */
+static constexpr uint32_t FRAME_BITS = 2;
+/* Repeated START between chained accesses */
+static constexpr uint32_t RESTART_BITS = 1;
+
+SimI2c::SimI2c(uint32_t bus_hz) : _bus_hz(bus_hz) {}
+
+bool SimI2c::attach(SimI2cDevice& device, uint8_t dev_addr)
+{
+    if (find(dev_addr))
+    {
+        return false;
+    }
+    for (Slot& slot : _slots)
+    {
+        if (!slot.device)
+        {
+            slot = Slot{&device, dev_addr, 0, 0, 0};
+            return true;
+        }
+    }
+    return false;
+}
+
+void SimI2c::inject_nack(uint8_t dev_addr, uint32_t count)
+{
+    if (Slot* slot = find(dev_addr))
+    {
+        slot->nack_count = count;
+    }
+}
+
+void SimI2c::set_latency(uint8_t dev_addr, uint32_t latency_us)
+{
+    if (Slot* slot = find(dev_addr))
+    {
+        slot->latency_us = latency_us;
+    }
+}
+
+void SimI2c::advance_time(uint64_t us)
+{
+    _now_us += us;
+    // Devices also see time pass between accesses, so pins they drive
+    // follow it
+    for (Slot& slot : _slots)
+    {
+        if (slot.device != nullptr)
+        {
+            slot.device->advance(_now_us);
+        }
+    }
+}
+
+I2cStatus SimI2c::mem_read(std::span<uint8_t> data, const uint8_t reg_addr,
+                           uint8_t dev_addr)
+{
+    open();
+    return access_read(dev_addr, reg_addr, 1, data);
+}
+
+I2cStatus SimI2c::mem_read(std::span<uint8_t> data, const uint16_t reg_addr,
+                           uint8_t dev_addr)
+{
+    open();
+    return access_read(dev_addr, reg_addr, 2, data);
+}
+
+I2cStatus SimI2c::mem_write(std::span<const uint8_t> data,
+                            const uint8_t reg_addr, uint8_t dev_addr)
+{
+    open();
+    return access_write(dev_addr, reg_addr, 1, data);
+}
+
+I2cStatus SimI2c::mem_write(std::span<const uint8_t> data,
+                            const uint16_t reg_addr, uint8_t dev_addr)
+{
+    open();
+    return access_write(dev_addr, reg_addr, 2, data);
+}
+
+I2cStatus SimI2c::read(std::span<uint8_t> data, uint8_t dev_addr)
+{
+    Slot* slot = find(dev_addr);
+    const uint16_t reg_addr = slot ? slot->pointer : 0;
+    open();
+    return access_read(dev_addr, reg_addr, 0, data);
+}
+
+/* First byte sets the register pointer, the rest is written from there */
+I2cStatus SimI2c::write(std::span<const uint8_t> data, uint8_t dev_addr)
+{
+    open();
+    if (data.empty())
+    {
+        return access_write(dev_addr, 0, 0, data);
+    }
+    return access_write(dev_addr, data[0], 1, data.subspan(1));
+}
+
+/* One START and STOP around all ops, like HwI2c::transfer */
+I2cStatus SimI2c::transfer(std::span<const I2cOp> ops)
+{
+    I2cStatus status = I2cStatus::OK;
+    bool opened = false;
+    for (size_t i = 0; i < ops.size() && status == I2cStatus::OK; i++)
+    {
+        const I2cOp& op = ops[i];
+        // Zero-length reads never reach the bus
+        if (op.is_empty_read())
+        {
+            continue;
+        }
+        if (opened)
+        {
+            charge(RESTART_BITS, 0);
+        }
+        else
+        {
+            open();
+            opened = true;
+        }
+        status = (op.dir == I2cOp::Dir::READ)
+                     ? access_read(op.dev_addr, op.reg_addr, 1, op.rx)
+                     : access_write(op.dev_addr, op.reg_addr, 1, op.tx);
+    }
+    // A NACK ends the transaction with a STOP, the remaining ops never run
+    return status;
+}
+
+SimI2c::Slot* SimI2c::find(uint8_t dev_addr)
+{
+    for (Slot& slot : _slots)
+    {
+        if (slot.device && slot.dev_addr == dev_addr)
+        {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+/* START now, the STOP is charged up front */
+void SimI2c::open()
+{
+    _stats.transactions++;
+    _xfer_start_us = _now_us;
+    _xfer_bits = 0;
+    _xfer_latency_us = 0;
+    charge(FRAME_BITS, 0);
+}
+
+/* Bus time is kept in bits since the START, so chained accesses round once */
+void SimI2c::charge(uint64_t bits, uint32_t latency_us)
+{
+    _xfer_bits += bits;
+    _xfer_latency_us += latency_us;
+    _now_us = _xfer_start_us +
+              (_xfer_bits * 1'000'000 + _bus_hz - 1) / _bus_hz +
+              _xfer_latency_us;
+}
+
+/* Charges one access, bytes after the address byte, and picks its target,
+ * nullptr if the address phase is NACKed */
+SimI2c::Slot* SimI2c::begin(uint8_t dev_addr, size_t bytes)
+{
+    Slot* slot = find(dev_addr);
+    const bool nack = !slot || slot->nack_count > 0;
+    if (nack)
+    {
+        if (slot)
+        {
+            slot->nack_count--;
+        }
+        _stats.nacks++;
+        charge(BITS_PER_BYTE, 0);  // Only the address byte goes out
+        return nullptr;
+    }
+
+    charge((1 + bytes) * BITS_PER_BYTE, slot->latency_us);
+    return slot;
+}
+
+I2cStatus SimI2c::access_read(uint8_t dev_addr, uint16_t reg_addr,
+                              size_t reg_len, std::span<uint8_t> data)
+{
+    // Register pointer, then repeated START, address + data
+    const size_t bytes = reg_len + ((reg_len > 0) ? 1 : 0) + data.size();
+    Slot* slot = begin(dev_addr, bytes);
+    if (!slot)
+    {
+        return I2cStatus::NACK;
+    }
+
+    slot->device->advance(_now_us);
+    const I2cStatus status = slot->device->read(reg_addr, data);
+    if (status == I2cStatus::OK)
+    {
+        _stats.bytes += data.size();
+        slot->pointer = reg_addr + data.size();
+    }
+    return status;
+}
+
+I2cStatus SimI2c::access_write(uint8_t dev_addr, uint16_t reg_addr,
+                               size_t reg_len, std::span<const uint8_t> data)
+{
+    Slot* slot = begin(dev_addr, reg_len + data.size());
+    if (!slot)
+    {
+        return I2cStatus::NACK;
+    }
+
+    slot->device->advance(_now_us);
+    if (reg_len > 0)
+    {
+        slot->pointer = reg_addr;
+    }
+    if (data.empty())
+    {
+        return I2cStatus::OK;
+    }
+
+    const I2cStatus status = slot->device->write(reg_addr, data);
+    if (status == I2cStatus::OK)
+    {
+        _stats.bytes += data.size();
+        slot->pointer = reg_addr + data.size();
+    }
+    return status;
+}
+
+}  // namespace LBR::Sim
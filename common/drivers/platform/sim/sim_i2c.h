@@ -0,0 +1,178 @@
+/**
+ * @file sim_i2c.h
+ * @brief Host-side I2C bus that routes transactions to device models
+ * @date 10/17/2026
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include "i2c.h"
+
+namespace LBR
+{
+namespace Sim
+{
+
+/**
+ * @class SimI2cDevice
+ * @brief Behavioral model of a register-mapped I2C target
+ */
+class SimI2cDevice
+{
+public:
+    /**
+     * @brief Serves a register read
+     *
+     * @param reg_addr first register
+     * @param data bytes to fill
+     * @return I2cStatus::OK, or an error the target would cause on the bus
+     */
+    virtual I2cStatus read(uint16_t reg_addr, std::span<uint8_t> data) = 0;
+
+    /**
+     * @brief Accepts a register write
+     *
+     * @param reg_addr first register
+     * @param data bytes written
+     * @return I2cStatus::OK, or an error the target would cause on the bus
+     */
+    virtual I2cStatus write(uint16_t reg_addr,
+                            std::span<const uint8_t> data) = 0;
+
+    /**
+     * @brief Lets the model catch up with simulated time before an access
+     *
+     * @param now_us bus time in microseconds
+     */
+    virtual void advance(uint64_t now_us)
+    {
+        (void)now_us;
+    }
+
+    virtual ~SimI2cDevice() = default;
+};
+
+/**
+ * @brief Bus activity counters
+ */
+struct SimI2cStats
+{
+    uint32_t transactions{0};
+    uint32_t bytes{0};
+    uint32_t nacks{0};
+};
+
+/**
+ * @class SimI2c
+ * @brief LBR::I2c implementation for NATIVE builds
+ * @details Each target address maps to a SimI2cDevice. A transaction costs
+ *          its bit time at the configured bus speed plus the per-device
+ *          latency, and advances a simulated clock by that much, so drivers
+ *          can be benchmarked in bus time without a board. Addresses with
+ *          no model NACK like an empty bus.
+ *
+ *          transfer() chains its ops like HwI2c: one START and STOP for the
+ *          batch and a repeated START between ops, counted as a single
+ *          transaction. A NACK ends the batch.
+ */
+class SimI2c : public I2c
+{
+public:
+    static constexpr size_t MAX_DEVICES = 8;
+
+    /**
+     * @param bus_hz SCL frequency used for timing
+     */
+    explicit SimI2c(uint32_t bus_hz = 100'000);
+
+    /**
+     * @brief Places a device model on the bus
+     *
+     * @param device model to route to, must outlive the bus
+     * @param dev_addr 7-bit address it answers to
+     * @return false if the address is taken or the bus is full
+     */
+    bool attach(SimI2cDevice& device, uint8_t dev_addr);
+
+    /**
+     * @brief Makes the next transactions to a device fail with NACK
+     *
+     * @param dev_addr target address
+     * @param count number of address phases to NACK, one per access
+     */
+    void inject_nack(uint8_t dev_addr, uint32_t count);
+
+    /**
+     * @brief Adds a fixed delay to every access of a device, e.g. clock
+     *        stretching
+     *
+     * @param dev_addr target address
+     * @param latency_us extra bus time per access, per op of a transfer()
+     */
+    void set_latency(uint8_t dev_addr, uint32_t latency_us);
+
+    /**
+     * @brief Moves simulated time forward, stands in for sleeping, and
+     *        advances every attached device to it
+     *
+     * @param us microseconds to add
+     */
+    void advance_time(uint64_t us);
+
+    uint64_t now_us() const
+    {
+        return _now_us;
+    }
+
+    const SimI2cStats& stats() const
+    {
+        return _stats;
+    }
+
+    I2cStatus mem_read(std::span<uint8_t> data, const uint8_t reg_addr,
+                       uint8_t dev_addr) override;
+    I2cStatus mem_read(std::span<uint8_t> data, const uint16_t reg_addr,
+                       uint8_t dev_addr) override;
+    I2cStatus mem_write(std::span<const uint8_t> data, const uint8_t reg_addr,
+                        uint8_t dev_addr) override;
+    I2cStatus mem_write(std::span<const uint8_t> data, const uint16_t reg_addr,
+                        uint8_t dev_addr) override;
+    I2cStatus read(std::span<uint8_t> data, uint8_t dev_addr) override;
+    I2cStatus write(std::span<const uint8_t> data, uint8_t dev_addr) override;
+    I2cStatus transfer(std::span<const I2cOp> ops) override;
+
+private:
+    struct Slot
+    {
+        SimI2cDevice* device{nullptr};
+        uint8_t dev_addr{0};
+        uint16_t pointer{0};  ///< Register pointer for raw read/write
+        uint32_t nack_count{0};
+        uint32_t latency_us{0};
+    };
+
+    Slot* find(uint8_t dev_addr);
+    void open();
+    void charge(uint64_t bits, uint32_t latency_us);
+    Slot* begin(uint8_t dev_addr, size_t bytes);
+    I2cStatus access_read(uint8_t dev_addr, uint16_t reg_addr, size_t reg_len,
+                          std::span<uint8_t> data);
+    I2cStatus access_write(uint8_t dev_addr, uint16_t reg_addr,
+                           size_t reg_len, std::span<const uint8_t> data);
+
+    uint32_t _bus_hz;
+    uint64_t _now_us{0};
+    // Transaction in progress, see charge()
+    uint64_t _xfer_start_us{0};
+    uint64_t _xfer_bits{0};
+    uint64_t _xfer_latency_us{0};
+    std::array<Slot, MAX_DEVICES> _slots{};
+    SimI2cStats _stats{};
+};
+
+}  // namespace Sim
+}  // namespace LBR
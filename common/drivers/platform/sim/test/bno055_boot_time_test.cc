@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include "bno055_imu.h"
+#include "sim_bno055.h"
+#include "sim_i2c.h"
+
+using namespace LBR;
+using namespace LBR::Sim;
+
+namespace
+{
+
+constexpr uint8_t SYS_TRIGGER_REG = 0x3F;
+constexpr uint8_t RST_SYS = 0x20;
+// Longest a single step() may hold the bus, well under one loop pass
+constexpr uint64_t MAX_STEP_BUS_US = 1000;
+
+/* Board bring-up on a 1ms fake clock, the bus clock follows it. The rest of
+ * bsp_init (GPIO, PWM, encoder, motor) is board_ms of work, one ms a pass. */
+struct Rig
+{
+    Rig()
+    {
+        EXPECT_TRUE(bus.attach(dev, Bno055::ADDR_PRIMARY));
+        // Power-on: the sensor is still booting
+        const uint8_t reset = RST_SYS;
+        EXPECT_EQ(bus.mem_write(std::span<const uint8_t>(&reset, 1),
+                                SYS_TRIGGER_REG, Bno055::ADDR_PRIMARY),
+                  I2cStatus::OK);
+    }
+
+    void tick()
+    {
+        now_ms++;
+        bus.advance_time(1000);
+    }
+
+    // One pass of the job, which must never block
+    Bno055::Progress step()
+    {
+        const uint64_t start_us = bus.now_us();
+        const Bno055::Progress progress = imu.step(now_ms);
+        EXPECT_LT(bus.now_us() - start_us, MAX_STEP_BUS_US);
+        return progress;
+    }
+
+    Bno055::Progress finish()
+    {
+        Bno055::Progress progress;
+        while ((progress = step()) == Bno055::Progress::PENDING)
+        {
+            tick();
+        }
+        return progress;
+    }
+
+    SimI2c bus{400'000};
+    SimBno055 dev;
+    Bno055 imu{bus};
+    uint32_t now_ms{0};
+};
+
+// Before: the IMU starts up on its own, then the rest of the board
+uint32_t sequential(Rig& rig, uint32_t board_ms)
+{
+    rig.imu.start_init(rig.now_ms);
+    EXPECT_EQ(rig.finish(), Bno055::Progress::DONE);
+    for (uint32_t i = 0; i < board_ms; i++)
+    {
+        rig.tick();
+    }
+    return rig.now_ms;
+}
+
+// After: the board comes up while the IMU boots
+uint32_t overlapped(Rig& rig, uint32_t board_ms)
+{
+    rig.imu.start_init(rig.now_ms);
+    Bno055::Progress progress = Bno055::Progress::PENDING;
+    uint32_t board_left = board_ms;
+    while (true)
+    {
+        if (progress == Bno055::Progress::PENDING)
+        {
+            progress = rig.step();
+        }
+        if (board_left == 0 && progress != Bno055::Progress::PENDING)
+        {
+            break;
+        }
+        if (board_left > 0)
+        {
+            board_left--;
+        }
+        rig.tick();
+    }
+    EXPECT_EQ(progress, Bno055::Progress::DONE);
+    return rig.now_ms;
+}
+
+TEST(Bno055BootTime, StartupWaitsOutTheSensorBoot)
+{
+    Rig rig;
+    EXPECT_GE(sequential(rig, 0), SimBno055::BOOT_TIME_US / 1000);
+    EXPECT_EQ(rig.dev.mode(), Bno055::IMU);
+}
+
+TEST(Bno055BootTime, OverlapHidesBoardBringUp)
+{
+    Rig alone;
+    const uint32_t imu_ms = sequential(alone, 0);
+
+    std::printf("IMU startup %u ms\n", imu_ms);
+    std::printf("%8s %13s %13s\n", "board", "sequential", "overlapped");
+    for (uint32_t board_ms : {0u, 50u, 300u, 700u, 1000u})
+    {
+        Rig before;
+        Rig after;
+        const uint32_t sequential_ms = sequential(before, board_ms);
+        const uint32_t overlapped_ms = overlapped(after, board_ms);
+        std::printf("%5u ms %10u ms %10u ms\n", board_ms, sequential_ms,
+                    overlapped_ms);
+
+        EXPECT_EQ(sequential_ms, imu_ms + board_ms);
+        EXPECT_EQ(overlapped_ms, std::max(imu_ms, board_ms));
+        EXPECT_EQ(after.dev.mode(), Bno055::IMU);
+    }
+}
+
+TEST(Bno055BootTime, SelfTestsDontBlock)
+{
+    Rig rig;
+    sequential(rig, 0);
+
+    rig.imu.start_post(rig.now_ms);
+    uint32_t start_ms = rig.now_ms;
+    EXPECT_EQ(rig.finish(), Bno055::Progress::DONE);
+    EXPECT_GT(rig.now_ms, start_ms);
+    EXPECT_EQ(rig.dev.mode(), Bno055::IMU);
+
+    rig.imu.start_bist(rig.now_ms);
+    start_ms = rig.now_ms;
+    EXPECT_EQ(rig.finish(), Bno055::Progress::DONE);
+    EXPECT_GT(rig.now_ms, start_ms);
+    EXPECT_EQ(rig.dev.mode(), Bno055::IMU);
+}
+
+}  // namespace
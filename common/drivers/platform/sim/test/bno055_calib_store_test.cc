@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <vector>
+#include "bno055_calib_store.h"
+#include "sim_bno055.h"
+#include "sim_flash.h"
+#include "sim_i2c.h"
+
+using namespace LBR;
+using namespace LBR::Sim;
+
+namespace
+{
+
+constexpr size_t REGION_SIZE = 2048;   // One STM32L4 page
+constexpr size_t RECORD_SIZE = 40;     // 12B header + 22B payload, to 8B
+constexpr size_t NUM_SLOTS = REGION_SIZE / RECORD_SIZE;
+
+Bno055Calibration profile(uint8_t seed)
+{
+    Bno055Calibration cal{};
+    for (size_t i = 0; i < cal.regs.size(); i++)
+    {
+        cal.regs[i] = static_cast<uint8_t>(seed + 3 * i);
+    }
+    return cal;
+}
+
+class Bno055CalibStoreTest : public ::testing::Test
+{
+protected:
+    std::vector<uint8_t> region = std::vector<uint8_t>(REGION_SIZE);
+    SimFlash flash{region};
+    Bno055CalibStore store{flash};
+};
+
+TEST_F(Bno055CalibStoreTest, EmptyRegionHasNoProfile)
+{
+    Bno055Calibration out{};
+    EXPECT_FALSE(store.load(out));
+}
+
+TEST_F(Bno055CalibStoreTest, ProfileSurvivesAReboot)
+{
+    ASSERT_TRUE(store.save(profile(1)));
+
+    Bno055CalibStore rebooted(flash);
+    Bno055Calibration out{};
+    ASSERT_TRUE(rebooted.load(out));
+    EXPECT_EQ(out, profile(1));
+    EXPECT_EQ(flash.stats().rejected, 0u);
+}
+
+TEST_F(Bno055CalibStoreTest, SameProfileIsNotRewritten)
+{
+    ASSERT_TRUE(store.save(profile(1)));
+    const uint32_t writes = flash.stats().writes;
+    ASSERT_TRUE(store.save(profile(1)));
+    EXPECT_EQ(flash.stats().writes, writes);
+}
+
+TEST_F(Bno055CalibStoreTest, LatestProfileWins)
+{
+    ASSERT_TRUE(store.save(profile(1)));
+    ASSERT_TRUE(store.save(profile(2)));
+    ASSERT_TRUE(store.save(profile(1)));
+
+    Bno055Calibration out{};
+    ASSERT_TRUE(store.load(out));
+    EXPECT_EQ(out, profile(1));
+}
+
+TEST_F(Bno055CalibStoreTest, TornSaveKeepsThePreviousProfile)
+{
+    // Cut power at every write unit of the record
+    for (size_t units = 0; units < RECORD_SIZE / flash.write_unit(); units++)
+    {
+        std::fill(region.begin(), region.end(), Flash::ERASED_VALUE);
+        ASSERT_TRUE(store.save(profile(1)));
+
+        flash.inject_power_loss(units);
+        EXPECT_FALSE(store.save(profile(2))) << "units " << units;
+        flash.restore_power();
+
+        Bno055Calibration out{};
+        ASSERT_TRUE(store.load(out)) << "units " << units;
+        EXPECT_EQ(out, profile(1)) << "units " << units;
+
+        // The next save goes past the torn record
+        ASSERT_TRUE(store.save(profile(2)));
+        ASSERT_TRUE(store.load(out));
+        EXPECT_EQ(out, profile(2));
+    }
+}
+
+TEST_F(Bno055CalibStoreTest, CorruptLatestFallsBackToThePrevious)
+{
+    ASSERT_TRUE(store.save(profile(1)));
+    ASSERT_TRUE(store.save(profile(2)));
+    region[RECORD_SIZE + Bno055CalibStore::HEADER_SIZE] ^= 0x01;
+
+    Bno055Calibration out{};
+    ASSERT_TRUE(store.load(out));
+    EXPECT_EQ(out, profile(1));
+}
+
+TEST_F(Bno055CalibStoreTest, FullRegionIsErasedOnce)
+{
+    for (size_t i = 0; i < NUM_SLOTS; i++)
+    {
+        ASSERT_TRUE(store.save(profile(static_cast<uint8_t>(i))));
+    }
+    EXPECT_EQ(flash.stats().erases, 0u);
+
+    ASSERT_TRUE(store.save(profile(200)));
+    EXPECT_EQ(flash.stats().erases, 1u);
+    Bno055Calibration out{};
+    ASSERT_TRUE(store.load(out));
+    EXPECT_EQ(out, profile(200));
+    EXPECT_EQ(flash.stats().rejected, 0u);
+}
+
+TEST_F(Bno055CalibStoreTest, FailedEraseKeepsTheProfiles)
+{
+    for (size_t i = 0; i < NUM_SLOTS; i++)
+    {
+        ASSERT_TRUE(store.save(profile(static_cast<uint8_t>(i))));
+    }
+
+    flash.inject_power_loss(0);
+    EXPECT_FALSE(store.save(profile(200)));
+    flash.restore_power();
+
+    Bno055Calibration out{};
+    ASSERT_TRUE(store.load(out));
+    EXPECT_EQ(out, profile(NUM_SLOTS - 1));
+}
+
+TEST_F(Bno055CalibStoreTest, RestoresTheSensorAfterAReboot)
+{
+    SimI2c bus{400'000};
+    SimBno055 dev;
+    ASSERT_TRUE(bus.attach(dev, Bno055::ADDR_PRIMARY));
+    auto start = [&bus](Bno055& imu) {
+        uint32_t now_ms = 0;
+        imu.start_init(now_ms);
+        Bno055::Progress progress;
+        while ((progress = imu.step(now_ms)) == Bno055::Progress::PENDING)
+        {
+            now_ms++;
+            bus.advance_time(1000);
+        }
+        return progress;
+    };
+
+    Bno055 imu(bus);
+    ASSERT_EQ(start(imu), Bno055::Progress::DONE);
+    ASSERT_TRUE(imu.write_calibration(profile(7)));
+    Bno055Calibration learned{};
+    ASSERT_TRUE(imu.read_calibration(learned));
+    ASSERT_TRUE(store.save(learned));
+
+    // Power cycle: the sensor forgets, the flash does not
+    dev.reset();
+    Bno055 rebooted(bus);
+    ASSERT_EQ(start(rebooted), Bno055::Progress::DONE);
+    Bno055Calibration lost{};
+    ASSERT_TRUE(rebooted.read_calibration(lost));
+    EXPECT_NE(lost, profile(7));
+
+    Bno055Calibration saved{};
+    ASSERT_TRUE(Bno055CalibStore(flash).load(saved));
+    ASSERT_TRUE(rebooted.write_calibration(saved));
+
+    Bno055Calibration back{};
+    ASSERT_TRUE(rebooted.read_calibration(back));
+    EXPECT_EQ(back, profile(7));
+}
+
+}  // namespace
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include "bno055_imu.h"
+#include "sim_bno055.h"
+#include "sim_i2c.h"
+
+using namespace LBR;
+using namespace LBR::Sim;
+
+namespace
+{
+
+constexpr uint32_t BUS_HZ = 400'000;
+constexpr uint32_t SAMPLES = 20'000;
+constexpr uint8_t ACC_DATA_REG = 0x08;
+constexpr size_t BURST_BYTES = 32;  // read_all() before field masks
+
+struct BusCost
+{
+    double bytes;
+    double bus_us;
+    double transactions;
+};
+
+class Bno055FieldsBench : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(bus.attach(dev, Bno055::ADDR_PRIMARY));
+        Bno055Data data{};
+        data.accel = {1.0f, -2.0f, 9.81f};
+        data.quat = {1.0f, 0.0f, 0.0f, 0.0f};
+        data.gravity = {0.0f, 0.0f, 9.81f};
+        stream[0] = SimBno055Sample::from(data);
+        dev.play(stream);
+        uint32_t now_ms = 0;
+        imu.start_init(now_ms);
+        Bno055::Progress progress;
+        while ((progress = imu.step(now_ms)) == Bno055::Progress::PENDING)
+        {
+            now_ms++;
+            bus.advance_time(1000);
+        }
+        ASSERT_EQ(progress, Bno055::Progress::DONE);
+    }
+
+    // Per-sample bus cost of read<Fields>(), host time is printed only
+    template <uint8_t Fields>
+    BusCost measure(const char* name)
+    {
+        const SimI2cStats start = bus.stats();
+        const uint64_t start_us = bus.now_us();
+        const auto host_start = std::chrono::steady_clock::now();
+        Bno055Data out{};
+        for (uint32_t i = 0; i < SAMPLES; i++)
+        {
+            EXPECT_TRUE(imu.read<Fields>(out));
+        }
+        const auto host_ns = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - host_start);
+
+        const BusCost cost{
+            static_cast<double>(bus.stats().bytes - start.bytes) / SAMPLES,
+            static_cast<double>(bus.now_us() - start_us) / SAMPLES,
+            static_cast<double>(bus.stats().transactions -
+                                start.transactions) /
+                SAMPLES};
+        std::printf("%-14s %5.1f bytes %7.1f bus us %7.1f host ns /sample\n",
+                    name, cost.bytes, cost.bus_us, host_ns.count() / SAMPLES);
+        return cost;
+    }
+
+    SimI2c bus{BUS_HZ};
+    SimBno055 dev;
+    Bno055 imu{bus};
+    std::array<SimBno055Sample, 1> stream{};
+};
+
+TEST_F(Bno055FieldsBench, MaskedReadsMoveOnlyTheirFields)
+{
+    // Reference: one burst from ACC_DATA, what read_all() used to move
+    std::array<uint8_t, BURST_BYTES> block{};
+    const uint32_t start_bytes = bus.stats().bytes;
+    const uint64_t start_us = bus.now_us();
+    for (uint32_t i = 0; i < SAMPLES; i++)
+    {
+        ASSERT_EQ(bus.mem_read(block, ACC_DATA_REG, Bno055::ADDR_PRIMARY),
+                  I2cStatus::OK);
+    }
+    const BusCost burst{
+        static_cast<double>(bus.stats().bytes - start_bytes) / SAMPLES,
+        static_cast<double>(bus.now_us() - start_us) / SAMPLES, 1.0};
+    std::printf("%-14s %5.1f bytes %7.1f bus us\n", "32B burst", burst.bytes,
+                burst.bus_us);
+
+    const BusCost quat_accel = measure<BNO055_QUAT | BNO055_ACCEL>(
+        "QUAT|ACCEL");
+    const BusCost quat = measure<BNO055_QUAT>("QUAT");
+    const BusCost accel = measure<BNO055_ACCEL>("ACCEL");
+    const BusCost quat_lia_grv =
+        measure<BNO055_QUAT | BNO055_LINEAR_ACCEL | BNO055_GRAVITY>(
+            "QUAT|LIA|GRV");
+    const BusCost all = measure<BNO055_ALL_FIELDS>("ALL");
+
+    // Bytes follow the plan, windows chain into a single transaction
+    EXPECT_DOUBLE_EQ(quat_accel.bytes,
+                     Bno055Layout::plan(BNO055_QUAT | BNO055_ACCEL).bytes);
+    EXPECT_DOUBLE_EQ(quat.bytes, 8.0);
+    EXPECT_DOUBLE_EQ(accel.bytes, 6.0);
+    EXPECT_DOUBLE_EQ(all.bytes,
+                     Bno055Layout::plan(BNO055_ALL_FIELDS).bytes);
+    for (const BusCost& cost : {quat_accel, quat, accel, quat_lia_grv, all})
+    {
+        EXPECT_DOUBLE_EQ(cost.transactions, 1.0);
+    }
+
+    EXPECT_LT(quat.bus_us, quat_accel.bus_us);
+    EXPECT_LT(accel.bus_us, quat_accel.bus_us);
+    EXPECT_LT(quat_accel.bus_us, burst.bus_us);
+    EXPECT_LT(quat_lia_grv.bus_us, burst.bus_us);
+    // Three windows pay their repeated STARTs and register pointers
+    EXPECT_GT(all.bus_us, burst.bus_us);
+
+    Bno055Data out{};
+    ASSERT_TRUE(imu.read<BNO055_QUAT | BNO055_ACCEL>(out));
+    EXPECT_NEAR(out.accel.z, 9.81f, 0.01f);
+    EXPECT_NEAR(out.quat.w, 1.0f, 1e-3f);
+}
+
+}  // namespace
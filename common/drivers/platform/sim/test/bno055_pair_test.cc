@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include "bno055_pair.h"
+#include "sim_bno055.h"
+#include "sim_i2c.h"
+
+using namespace LBR;
+using namespace LBR::Sim;
+
+namespace
+{
+
+constexpr uint32_t PERIOD_MS = 10;  // 100Hz fusion output
+constexpr float DEG_TO_RAD = 3.14159265f / 180.0f;
+
+Bno055Data sample_about_x(float angle_deg, const Vec3& accel)
+{
+    Bno055Data data{};
+    const float half = angle_deg * DEG_TO_RAD / 2.0f;
+    data.quat = {std::cos(half), std::sin(half), 0.0f, 0.0f};
+    data.accel = accel;
+    return data;
+}
+
+float angle_about_x_deg(const Quaternion& q)
+{
+    return 2.0f * std::atan2(q.x, q.w) / DEG_TO_RAD;
+}
+
+/* Two fake sensors on one bus, polled once per output period like the
+ * flight loop does on the primary's INT */
+class Bno055PairTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(bus.attach(primary_dev, Bno055::ADDR_PRIMARY));
+        ASSERT_TRUE(bus.attach(alternate_dev, Bno055::ADDR_ALTERNATE));
+        level[0] = SimBno055Sample::from(
+            sample_about_x(0.0f, {0.0f, 0.0f, 9.8f}));
+        tilted[0] = SimBno055Sample::from(
+            sample_about_x(4.0f, {0.2f, 0.0f, 9.6f}));
+        broken[0] = SimBno055Sample::from(
+            sample_about_x(90.0f, {0.0f, 9.8f, 0.0f}));
+
+        for (Bno055* imu : {&primary, &alternate})
+        {
+            imu->start_init(now_ms);
+            Bno055::Progress progress;
+            while ((progress = imu->step(now_ms)) ==
+                   Bno055::Progress::PENDING)
+            {
+                tick(1);
+            }
+            ASSERT_EQ(progress, Bno055::Progress::DONE);
+            ASSERT_TRUE(imu->set_data_ready_interrupt());
+            ASSERT_TRUE(imu->ack_interrupt());
+        }
+        primary_dev.play(level);
+        alternate_dev.play(tilted);
+    }
+
+    void tick(uint32_t ms)
+    {
+        now_ms += ms;
+        bus.advance_time(ms * 1000);
+    }
+
+    // Updates once per output period, returns how many had a new sample
+    uint32_t run(uint32_t periods)
+    {
+        uint32_t fresh = 0;
+        for (uint32_t i = 0; i < periods; i++)
+        {
+            tick(PERIOD_MS);
+            fresh += pair.update(now_ms) ? 1 : 0;
+        }
+        return fresh;
+    }
+
+    SimI2c bus{400'000};
+    SimBno055 primary_dev;
+    SimBno055 alternate_dev;
+    Bno055 primary{bus};
+    Bno055 alternate{bus, Bno055::ADDR_ALTERNATE};
+    Bno055Pair pair{primary, alternate};
+    std::array<SimBno055Sample, 1> level{};
+    std::array<SimBno055Sample, 1> tilted{};
+    std::array<SimBno055Sample, 1> broken{};
+    uint32_t now_ms{0};
+};
+
+TEST_F(Bno055PairTest, AgreeingSensorsAreAveraged)
+{
+    EXPECT_EQ(run(10), 10u);
+    EXPECT_EQ(pair.source(), Bno055Pair::Source::BOTH);
+    EXPECT_NEAR(angle_about_x_deg(pair.data().quat), 2.0f, 0.05f);
+    EXPECT_NEAR(pair.data().accel.x, 0.1f, 0.01f);
+    EXPECT_NEAR(pair.data().accel.z, 9.7f, 0.01f);
+    EXPECT_EQ(pair.disagreements(), 0u);
+}
+
+TEST_F(Bno055PairTest, OutlierLosesToContinuity)
+{
+    run(5);
+    alternate_dev.play(broken);
+    EXPECT_EQ(run(10), 10u);
+    EXPECT_EQ(pair.source(), Bno055Pair::Source::PRIMARY);
+    EXPECT_NEAR(angle_about_x_deg(pair.data().quat), 0.0f, 0.05f);
+    EXPECT_EQ(pair.disagreements(), 10u);
+
+    alternate_dev.play(tilted);
+    run(5);
+    EXPECT_EQ(pair.source(), Bno055Pair::Source::BOTH);
+}
+
+TEST_F(Bno055PairTest, DisagreementWithNoHistoryGivesNoSample)
+{
+    alternate_dev.play(broken);
+    EXPECT_EQ(run(3), 0u);
+    EXPECT_EQ(pair.source(), Bno055Pair::Source::NONE);
+}
+
+TEST_F(Bno055PairTest, SysErrDropsTheSensor)
+{
+    run(5);
+    primary_dev.set_sys_error(0x03);
+    EXPECT_EQ(run(5), 5u);
+    EXPECT_FALSE(pair.healthy(0, now_ms));
+    EXPECT_EQ(pair.source(), Bno055Pair::Source::ALTERNATE);
+    EXPECT_NEAR(angle_about_x_deg(pair.data().quat), 4.0f, 0.05f);
+
+    primary_dev.set_sys_error(0);
+    run(2);
+    EXPECT_EQ(pair.source(), Bno055Pair::Source::BOTH);
+}
+
+TEST_F(Bno055PairTest, StaleSensorIsDropped)
+{
+    run(5);
+    // Output frozen: no new sample after the first one of the stream
+    primary_dev.play(level, 1'000'000, false);
+    run(1);
+    EXPECT_TRUE(pair.healthy(0, now_ms));
+    run(4);
+    EXPECT_FALSE(pair.healthy(0, now_ms));
+    EXPECT_EQ(pair.source(), Bno055Pair::Source::ALTERNATE);
+}
+
+TEST_F(Bno055PairTest, SkewIsMeasuredAcrossTheMillisecondWrap)
+{
+    // Sensors 5 ms out of phase, polled every 5 ms, so their samples are
+    // stamped on alternate updates
+    primary_dev.play(level);
+    tick(5);
+    alternate_dev.play(tilted);
+    now_ms = UINT32_MAX - 40;
+    for (int i = 0; i < 20; i++)
+    {
+        tick(5);
+        pair.update(now_ms);
+        if (i >= 2)
+        {
+            ASSERT_EQ(pair.source(), Bno055Pair::Source::BOTH)
+                << "now_ms " << now_ms;
+        }
+    }
+    EXPECT_LT(now_ms, 100u);
+}
+
+TEST_F(Bno055PairTest, BusFaultOnOneSensorKeepsTheOther)
+{
+    run(5);
+    bus.inject_nack(Bno055::ADDR_ALTERNATE, 1000);
+    run(5);
+    EXPECT_FALSE(pair.healthy(1, now_ms));
+    EXPECT_EQ(pair.source(), Bno055Pair::Source::PRIMARY);
+
+    bus.inject_nack(Bno055::ADDR_ALTERNATE, 0);
+    run(2);
+    EXPECT_EQ(pair.source(), Bno055Pair::Source::BOTH);
+}
+
+TEST_F(Bno055PairTest, MissingAlternateRunsOnThePrimary)
+{
+    SimI2c solo_bus{400'000};
+    SimBno055 solo_dev;
+    ASSERT_TRUE(solo_bus.attach(solo_dev, Bno055::ADDR_PRIMARY));
+    Bno055 solo(solo_bus);
+    Bno055 absent(solo_bus, Bno055::ADDR_ALTERNATE);
+    uint32_t t_ms = 0;
+    solo.start_init(t_ms);
+    while (solo.step(t_ms) == Bno055::Progress::PENDING)
+    {
+        t_ms++;
+        solo_bus.advance_time(1000);
+    }
+    ASSERT_TRUE(solo.set_data_ready_interrupt());
+    ASSERT_TRUE(solo.ack_interrupt());
+    solo_dev.play(level);
+
+    Bno055Pair single(solo, absent);
+    uint32_t fresh = 0;
+    for (int i = 0; i < 5; i++)
+    {
+        t_ms += PERIOD_MS;
+        solo_bus.advance_time(PERIOD_MS * 1000);
+        fresh += single.update(t_ms) ? 1 : 0;
+    }
+    EXPECT_EQ(fresh, 5u);
+    EXPECT_EQ(single.source(), Bno055Pair::Source::PRIMARY);
+}
+
+}  // namespace
@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+#include <array>
+#include "bno055_imu.h"
+#include "sim_bno055.h"
+#include "sim_i2c.h"
+
+using namespace LBR;
+using namespace LBR::Sim;
+
+namespace
+{
+
+constexpr uint8_t SYS_TRIGGER_REG = 0x3F;
+constexpr uint8_t RST_SYS = 0x20;
+
+class SimBno055Test : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(bus.attach(dev, Bno055::ADDR_PRIMARY));
+
+        Bno055Data data{};
+        data.accel = {1.0f, -2.0f, 9.81f};
+        data.gyro = {10.0f, 0.0f, -5.0f};
+        data.quat = {1.0f, 0.0f, 0.0f, 0.0f};
+        stream[0] = SimBno055Sample::from(data);
+        data.accel.x = 3.0f;
+        stream[1] = SimBno055Sample::from(data);
+        dev.play(stream);
+    }
+
+    // One millisecond per pass, the bus clock follows the fake clock
+    Bno055::Progress run_job(Bno055& imu)
+    {
+        Bno055::Progress progress;
+        while ((progress = imu.step(now_ms)) == Bno055::Progress::PENDING)
+        {
+            now_ms++;
+            bus.advance_time(1000);
+        }
+        return progress;
+    }
+
+    SimI2c bus{400'000};
+    SimBno055 dev;
+    std::array<SimBno055Sample, 2> stream{};
+    uint32_t now_ms{0};
+};
+
+TEST_F(SimBno055Test, InitEndsInImuMode)
+{
+    Bno055 imu(bus);
+    imu.start_init(now_ms);
+    EXPECT_EQ(run_job(imu), Bno055::Progress::DONE);
+    EXPECT_EQ(dev.mode(), Bno055::IMU);
+
+    uint8_t id = 0;
+    ASSERT_TRUE(imu.get_chip_id(id));
+    EXPECT_EQ(id, 0xA0);
+}
+
+TEST_F(SimBno055Test, ReadAllReplaysTheStream)
+{
+    Bno055 imu(bus);
+    imu.start_init(now_ms);
+    ASSERT_EQ(run_job(imu), Bno055::Progress::DONE);
+
+    // Playback starts over at the next access, one sample per 10ms period
+    dev.play(stream);
+    Bno055Data first{};
+    ASSERT_TRUE(imu.read_all(first));
+    EXPECT_NEAR(first.accel.y, -2.0f, 0.01f);
+    EXPECT_NEAR(first.accel.z, 9.81f, 0.01f);
+    EXPECT_NEAR(first.gyro.x, 10.0f, 0.1f);
+    EXPECT_NEAR(first.gyro.z, -5.0f, 0.1f);
+    EXPECT_NEAR(first.quat.w, 1.0f, 1e-3f);
+
+    bus.advance_time(10'000);
+    Bno055Data second{};
+    ASSERT_TRUE(imu.read_all(second));
+    EXPECT_NEAR(first.accel.x, 1.0f, 0.01f);
+    EXPECT_NEAR(second.accel.x, 3.0f, 0.01f);
+}
+
+TEST_F(SimBno055Test, InjectedNackFailsOneRead)
+{
+    Bno055 imu(bus);
+    imu.start_init(now_ms);
+    ASSERT_EQ(run_job(imu), Bno055::Progress::DONE);
+
+    Bno055Data out{};
+    bus.inject_nack(Bno055::ADDR_PRIMARY, 1);
+    EXPECT_FALSE(imu.read_all(out));
+    EXPECT_EQ(bus.stats().nacks, 1u);
+    EXPECT_TRUE(imu.read_all(out));
+}
+
+TEST_F(SimBno055Test, AbsentDeviceNacks)
+{
+    Bno055 imu(bus, Bno055::ADDR_ALTERNATE);
+    imu.start_init(now_ms);
+    EXPECT_EQ(run_job(imu), Bno055::Progress::FAILED);
+    EXPECT_GT(bus.stats().nacks, 0u);
+    // The missing sensor never touched the one that is there
+    EXPECT_EQ(dev.mode_switches(), 0u);
+}
+
+TEST_F(SimBno055Test, StartupRetriesChipIdThroughNacks)
+{
+    Bno055 imu(bus);
+    bus.inject_nack(Bno055::ADDR_PRIMARY, 3);
+    imu.start_init(now_ms);
+    EXPECT_EQ(run_job(imu), Bno055::Progress::DONE);
+    EXPECT_EQ(bus.stats().nacks, 3u);
+    EXPECT_EQ(dev.mode(), Bno055::IMU);
+}
+
+TEST_F(SimBno055Test, StartupFailsOnPersistentNack)
+{
+    Bno055 imu(bus);
+    bus.inject_nack(Bno055::ADDR_PRIMARY, 1000);
+    imu.start_init(now_ms);
+    EXPECT_EQ(run_job(imu), Bno055::Progress::FAILED);
+    EXPECT_EQ(dev.mode(), Bno055::CONFIG);
+}
+
+TEST_F(SimBno055Test, NackMidStartupFailsTheJob)
+{
+    Bno055 imu(bus);
+    imu.start_init(now_ms);
+    // Past the boot wait and CHIP_ID, then the bus drops out for good
+    while (bus.stats().transactions == 0 &&
+           imu.step(now_ms) == Bno055::Progress::PENDING)
+    {
+        now_ms++;
+        bus.advance_time(1000);
+    }
+    bus.inject_nack(Bno055::ADDR_PRIMARY, 1000);
+    EXPECT_EQ(run_job(imu), Bno055::Progress::FAILED);
+}
+
+TEST_F(SimBno055Test, RebootNacksForTheBootTime)
+{
+    Bno055 imu(bus);
+    const uint8_t reset = RST_SYS;
+    ASSERT_EQ(bus.mem_write(std::span<const uint8_t>(&reset, 1),
+                            SYS_TRIGGER_REG, Bno055::ADDR_PRIMARY),
+              I2cStatus::OK);
+    uint8_t id = 0;
+    EXPECT_FALSE(imu.get_chip_id(id));
+
+    // start_init waits out the boot time before its first access
+    imu.start_init(now_ms);
+    EXPECT_EQ(run_job(imu), Bno055::Progress::DONE);
+    EXPECT_GE(now_ms, SimBno055::BOOT_TIME_US / 1000);
+}
+
+TEST_F(SimBno055Test, LatencyAddsBusTimePerAccess)
+{
+    Bno055 imu(bus);
+    imu.start_init(now_ms);
+    ASSERT_EQ(run_job(imu), Bno055::Progress::DONE);
+
+    // CALIB_STAT is never cached, every call is one register read
+    uint8_t calib = 0;
+    uint64_t start = bus.now_us();
+    ASSERT_TRUE(imu.calibrate(calib));
+    const uint64_t plain_us = bus.now_us() - start;
+
+    constexpr uint32_t LATENCY_US = 500;
+    bus.set_latency(Bno055::ADDR_PRIMARY, LATENCY_US);
+    start = bus.now_us();
+    ASSERT_TRUE(imu.calibrate(calib));
+    EXPECT_EQ(bus.now_us() - start, plain_us + LATENCY_US);
+}
+
+TEST_F(SimBno055Test, LatencyDelaysStartupClock)
+{
+    // Clock stretching makes each startup access slower, not the result
+    bus.set_latency(Bno055::ADDR_PRIMARY, 2000);
+    Bno055 imu(bus);
+    imu.start_init(now_ms);
+    EXPECT_EQ(run_job(imu), Bno055::Progress::DONE);
+    EXPECT_EQ(dev.mode(), Bno055::IMU);
+}
+
+TEST_F(SimBno055Test, DataReadyInterruptFollowsOutputRate)
+{
+    Bno055 imu(bus);
+    imu.start_init(now_ms);
+    ASSERT_EQ(run_job(imu), Bno055::Progress::DONE);
+    ASSERT_TRUE(imu.set_data_ready_interrupt());
+    ASSERT_TRUE(imu.ack_interrupt());
+    EXPECT_FALSE(dev.int_pin());
+
+    bus.advance_time(10'000);
+    EXPECT_TRUE(dev.int_pin());
+    ASSERT_TRUE(imu.ack_interrupt());
+    EXPECT_FALSE(dev.int_pin());
+}
+
+TEST_F(SimBno055Test, CalibrationProfileRoundTrips)
+{
+    Bno055 imu(bus);
+    imu.start_init(now_ms);
+    ASSERT_EQ(run_job(imu), Bno055::Progress::DONE);
+
+    Bno055Calibration cal{};
+    for (size_t i = 0; i < cal.regs.size(); i++)
+    {
+        cal.regs[i] = static_cast<uint8_t>(i + 1);
+    }
+    ASSERT_TRUE(imu.write_calibration(cal));
+    // Written in CONFIG mode, back in IMU mode afterwards
+    EXPECT_EQ(dev.mode(), Bno055::IMU);
+
+    Bno055Calibration back{};
+    ASSERT_TRUE(imu.read_calibration(back));
+    EXPECT_EQ(back, cal);
+}
+
+}  // namespace
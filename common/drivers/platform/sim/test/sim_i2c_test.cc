@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include "sim_i2c.h"
+
+using namespace LBR;
+using namespace LBR::Sim;
+
+namespace
+{
+
+constexpr uint8_t DEV_ADDR = 0x10;
+constexpr uint32_t BUS_HZ = 100'000;  // 10us per bit
+
+// Plain register file, reads back what was written
+class RegFile : public SimI2cDevice
+{
+public:
+    I2cStatus read(uint16_t reg_addr, std::span<uint8_t> data) override
+    {
+        std::copy_n(regs.begin() + reg_addr, data.size(), data.begin());
+        return I2cStatus::OK;
+    }
+
+    I2cStatus write(uint16_t reg_addr, std::span<const uint8_t> data) override
+    {
+        std::copy(data.begin(), data.end(), regs.begin() + reg_addr);
+        return I2cStatus::OK;
+    }
+
+    std::array<uint8_t, 256> regs{};
+};
+
+class SimI2cTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(bus.attach(dev, DEV_ADDR));
+        for (size_t i = 0; i < dev.regs.size(); i++)
+        {
+            dev.regs[i] = static_cast<uint8_t>(i);
+        }
+    }
+
+    SimI2c bus{BUS_HZ};
+    RegFile dev;
+};
+
+TEST_F(SimI2cTest, MemReadCostsOneTransaction)
+{
+    std::array<uint8_t, 4> buf{};
+    ASSERT_EQ(bus.mem_read(buf, static_cast<uint8_t>(0x20), DEV_ADDR),
+              I2cStatus::OK);
+    EXPECT_EQ(buf[0], 0x20);
+    EXPECT_EQ(buf[3], 0x23);
+
+    // START + address, register, repeated START + address, 4 data, STOP
+    EXPECT_EQ(bus.now_us(), (2 + 7 * 9) * 10u);
+    EXPECT_EQ(bus.stats().transactions, 1u);
+    EXPECT_EQ(bus.stats().bytes, 4u);
+}
+
+TEST_F(SimI2cTest, TransferChainsOpsInOneTransaction)
+{
+    std::array<uint8_t, 2> first{};
+    std::array<uint8_t, 6> second{};
+    const std::array<I2cOp, 2> ops{
+        I2cOp::read(DEV_ADDR, 0x08, first),
+        I2cOp::read(DEV_ADDR, 0x20, second),
+    };
+    ASSERT_EQ(bus.transfer(ops), I2cStatus::OK);
+    EXPECT_EQ(first[1], 0x09);
+    EXPECT_EQ(second[5], 0x25);
+
+    // One START/STOP, a repeated START between the ops
+    constexpr uint32_t bits = 2 + (3 + 2) * 9 + 1 + (3 + 6) * 9;
+    EXPECT_EQ(bus.now_us(), bits * 10u);
+    EXPECT_EQ(bus.stats().transactions, 1u);
+    EXPECT_EQ(bus.stats().bytes, 8u);
+}
+
+TEST_F(SimI2cTest, TransferSkipsZeroLengthReads)
+{
+    std::array<uint8_t, 2> buf{};
+    const std::array<I2cOp, 3> ops{
+        I2cOp::read(DEV_ADDR, 0x00, {}),
+        I2cOp::read(DEV_ADDR, 0x08, buf),
+        I2cOp::read(DEV_ADDR, 0x10, {}),
+    };
+    ASSERT_EQ(bus.transfer(ops), I2cStatus::OK);
+    EXPECT_EQ(buf[1], 0x09);
+    // Billed as the one read that moves data
+    EXPECT_EQ(bus.now_us(), (2 + (3 + 2) * 9) * 10u);
+
+    const std::array<I2cOp, 1> nothing{I2cOp::read(DEV_ADDR, 0x00, {})};
+    EXPECT_EQ(bus.transfer(nothing), I2cStatus::OK);
+    EXPECT_EQ(bus.stats().transactions, 1u);
+}
+
+TEST_F(SimI2cTest, TransferIsCheaperThanSeparateAccesses)
+{
+    std::array<uint8_t, 2> buf{};
+    const std::array<I2cOp, 3> ops{
+        I2cOp::read(DEV_ADDR, 0x00, buf),
+        I2cOp::read(DEV_ADDR, 0x10, buf),
+        I2cOp::read(DEV_ADDR, 0x20, buf),
+    };
+    ASSERT_EQ(bus.transfer(ops), I2cStatus::OK);
+    const uint64_t chained_us = bus.now_us();
+
+    for (const I2cOp& op : ops)
+    {
+        ASSERT_EQ(bus.mem_read(op.rx, op.reg_addr, DEV_ADDR), I2cStatus::OK);
+    }
+    const uint64_t separate_us = bus.now_us() - chained_us;
+
+    // Three START/STOP pairs against one pair and two repeated STARTs
+    EXPECT_EQ(separate_us - chained_us, 2 * 10u);
+    EXPECT_EQ(bus.stats().transactions, 4u);
+}
+
+TEST_F(SimI2cTest, TransferWritesThenReadsBack)
+{
+    const std::array<uint8_t, 2> payload{0xAB, 0xCD};
+    std::array<uint8_t, 2> back{};
+    const std::array<I2cOp, 2> ops{
+        I2cOp::write(DEV_ADDR, 0x40, payload),
+        I2cOp::read(DEV_ADDR, 0x40, back),
+    };
+    ASSERT_EQ(bus.transfer(ops), I2cStatus::OK);
+    EXPECT_EQ(back, payload);
+}
+
+TEST_F(SimI2cTest, NackEndsTheBatch)
+{
+    std::array<uint8_t, 2> first{};
+    std::array<uint8_t, 2> second{};
+    const std::array<I2cOp, 2> ops{
+        I2cOp::read(DEV_ADDR, 0x08, first),
+        I2cOp::read(DEV_ADDR, 0x20, second),
+    };
+    bus.inject_nack(DEV_ADDR, 1);
+    EXPECT_EQ(bus.transfer(ops), I2cStatus::NACK);
+    EXPECT_EQ(bus.stats().nacks, 1u);
+    EXPECT_EQ(bus.stats().bytes, 0u);
+    // Only the NACKed address byte went out
+    EXPECT_EQ(bus.now_us(), (2 + 9) * 10u);
+
+    EXPECT_EQ(bus.transfer(ops), I2cStatus::OK);
+    EXPECT_EQ(second[0], 0x20);
+}
+
+TEST_F(SimI2cTest, LatencyIsChargedPerOp)
+{
+    std::array<uint8_t, 2> buf{};
+    const std::array<I2cOp, 2> ops{
+        I2cOp::read(DEV_ADDR, 0x00, buf),
+        I2cOp::read(DEV_ADDR, 0x10, buf),
+    };
+    ASSERT_EQ(bus.transfer(ops), I2cStatus::OK);
+    const uint64_t plain_us = bus.now_us();
+
+    bus.set_latency(DEV_ADDR, 100);
+    ASSERT_EQ(bus.transfer(ops), I2cStatus::OK);
+    EXPECT_EQ(bus.now_us() - plain_us, plain_us + 2 * 100u);
+}
+
+TEST_F(SimI2cTest, ChainedTimeRoundsOnce)
+{
+    // 2.5us per bit: per-op rounding would drift up, the batch rounds once
+    SimI2c fast{400'000};
+    ASSERT_TRUE(fast.attach(dev, DEV_ADDR));
+    std::array<uint8_t, 1> buf{};
+    const std::array<I2cOp, 4> ops{
+        I2cOp::read(DEV_ADDR, 0x00, buf),
+        I2cOp::read(DEV_ADDR, 0x01, buf),
+        I2cOp::read(DEV_ADDR, 0x02, buf),
+        I2cOp::read(DEV_ADDR, 0x03, buf),
+    };
+    ASSERT_EQ(fast.transfer(ops), I2cStatus::OK);
+    constexpr uint64_t bits = 2 + 4 * 4 * 9 + 3;
+    EXPECT_EQ(fast.now_us(), (bits * 5 + 1) / 2);
+}
+
+}  // namespace
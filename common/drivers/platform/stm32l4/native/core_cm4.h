@@ -0,0 +1,101 @@
+/**
+ * @file core_cm4.h
+ * @brief Host stand-in for the CMSIS Cortex-M4 core header
+ * @date 10/17/2026
+ * @details Shadows mcu_support/CMSIS/include/core_cm4.h in NATIVE builds.
+ *          The core peripherals the drivers touch (NVIC, DWT, PRIMASK) are
+ *          plain host state that tests can inspect and drive. Included by
+ *          stm32l476xx.h inside its extern "C" block.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define __I volatile const
+#define __O volatile
+#define __IO volatile
+#define __IM volatile const
+#define __OM volatile
+#define __IOM volatile
+
+typedef struct
+{
+    __IOM uint32_t CTRL;
+    __IOM uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+    __IOM uint32_t DHCSR;
+    __IOM uint32_t DCRSR;
+    __IOM uint32_t DCRDR;
+    __IOM uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define DWT_CTRL_CYCCNTENA_Msk (1UL)
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+
+/**
+ * @brief Enable bits and priorities of the external interrupts
+ */
+typedef struct
+{
+    uint8_t enabled[128];
+    uint8_t priority[128];
+} NativeNvic;
+
+extern DWT_Type native_dwt;
+extern CoreDebug_Type native_core_debug;
+extern NativeNvic native_nvic;
+extern uint32_t native_primask;
+
+#define DWT (&native_dwt)
+#define CoreDebug (&native_core_debug)
+
+static inline void NVIC_EnableIRQ(IRQn_Type irqn)
+{
+    native_nvic.enabled[irqn] = 1;
+}
+
+static inline void NVIC_DisableIRQ(IRQn_Type irqn)
+{
+    native_nvic.enabled[irqn] = 0;
+}
+
+static inline uint32_t NVIC_GetEnableIRQ(IRQn_Type irqn)
+{
+    return native_nvic.enabled[irqn];
+}
+
+static inline void NVIC_SetPriority(IRQn_Type irqn, uint32_t priority)
+{
+    native_nvic.priority[irqn] = (uint8_t)priority;
+}
+
+static inline uint32_t NVIC_GetPriority(IRQn_Type irqn)
+{
+    return native_nvic.priority[irqn];
+}
+
+static inline uint32_t __get_PRIMASK(void)
+{
+    return native_primask;
+}
+
+static inline void __set_PRIMASK(uint32_t primask)
+{
+    native_primask = primask;
+}
+
+static inline void __disable_irq(void)
+{
+    native_primask = 1;
+}
+
+static inline void __enable_irq(void)
+{
+    native_primask = 0;
+}
+
+static inline void __NOP(void) {}
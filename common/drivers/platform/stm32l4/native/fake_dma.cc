@@ -0,0 +1,209 @@
+/**
+ * @file fake_dma.cc
+ * @brief Register-level model of the STM32L4 DMA controller for host tests
+ * @date 10/17/2026
+ */
+
+#include "fake_dma.h"
+#include <sys/mman.h>
+#include <initializer_list>
+
+namespace LBR
+{
+namespace Native
+{
+
+static constexpr size_t MEMORY_SIZE = 64 * 1024;
+
+// Flags of channel 1, the others sit 4 bits apart
+static constexpr uint32_t CH_FLAGS =
+    DMA_ISR_GIF1 | DMA_ISR_TCIF1 | DMA_ISR_HTIF1 | DMA_ISR_TEIF1;
+
+static std::span<uint8_t> map_low_memory()
+{
+#ifdef MAP_32BIT
+    void* mem = mmap(nullptr, MEMORY_SIZE, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+    if (mem != MAP_FAILED)
+    {
+        return {static_cast<uint8_t*>(mem), MEMORY_SIZE};
+    }
+#endif
+    return {};
+}
+
+FakeDma::FakeDma(DMA_TypeDef& regs, std::span<DMA_Channel_TypeDef> channels,
+                 DMA_Request_TypeDef& cselr)
+    : _regs(regs), _channels(channels.first(NUM_DMA_CHANNELS)), _cselr(cselr)
+{
+    for (FakeReg* reg : {&_regs.ISR, &_regs.IFCR})
+    {
+        reg->value = 0;
+        reg->model = this;
+    }
+    for (DMA_Channel_TypeDef& ch : _channels)
+    {
+        // CPAR and CMAR have no side effects and stay plain memory
+        for (FakeReg* reg : {&ch.CCR, &ch.CNDTR, &ch.CPAR, &ch.CMAR})
+        {
+            reg->value = 0;
+        }
+        ch.CCR.model = this;
+        ch.CNDTR.model = this;
+    }
+}
+
+FakeDma::~FakeDma()
+{
+    _regs.ISR.model = nullptr;
+    _regs.IFCR.model = nullptr;
+    for (DMA_Channel_TypeDef& ch : _channels)
+    {
+        ch.CCR.model = nullptr;
+        ch.CNDTR.model = nullptr;
+    }
+}
+
+std::span<uint8_t> FakeDma::memory()
+{
+    static const std::span<uint8_t> mem = map_low_memory();
+    return mem;
+}
+
+bool FakeDma::request(uint8_t channel, uint8_t sel, FakeReg& src)
+{
+    if (channel == 0 || channel > _channels.size())
+    {
+        return false;
+    }
+    const size_t idx = channel - 1;
+    DMA_Channel_TypeDef& ch = _channels[idx];
+
+    const uint32_t routed = (_cselr.CSELR >> (idx * 4)) & 0xFUL;
+    if (routed != sel || !(ch.CCR.value & DMA_CCR_EN) || ch.CNDTR.value == 0)
+    {
+        return false;
+    }
+
+    // Peripheral and memory side each have to name a reachable address
+    const uint32_t periph =
+        static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&src));
+    uint8_t* dst = reach(_latch[idx].mem_addr);
+    if (dst == nullptr || ch.CPAR.value != periph)
+    {
+        ch.CCR.value &= ~DMA_CCR_EN;
+        set_flags(idx, DMA_ISR_TEIF1);
+        return false;
+    }
+
+    *dst = static_cast<uint8_t>(src.value);
+    if (ch.CCR.value & DMA_CCR_MINC)
+    {
+        _latch[idx].mem_addr++;
+    }
+    ch.CNDTR.value--;
+
+    if (ch.CNDTR.value == _latch[idx].count / 2)
+    {
+        set_flags(idx, DMA_ISR_HTIF1);
+    }
+    if (ch.CNDTR.value == 0)
+    {
+        set_flags(idx, DMA_ISR_TCIF1);
+        if (ch.CCR.value & DMA_CCR_CIRC)
+        {
+            ch.CNDTR.value = _latch[idx].count;
+            _latch[idx].mem_addr = ch.CMAR.value;
+        }
+    }
+    return true;
+}
+
+bool FakeDma::irq_pending(uint8_t channel) const
+{
+    if (channel == 0 || channel > _channels.size())
+    {
+        return false;
+    }
+    const size_t idx = channel - 1;
+    const uint32_t ccr = _channels[idx].CCR.value;
+    const uint32_t isr = _regs.ISR.value >> (idx * 4);
+    return ((ccr & DMA_CCR_TCIE) && (isr & DMA_ISR_TCIF1)) ||
+           ((ccr & DMA_CCR_HTIE) && (isr & DMA_ISR_HTIF1)) ||
+           ((ccr & DMA_CCR_TEIE) && (isr & DMA_ISR_TEIF1));
+}
+
+uint32_t FakeDma::on_read(FakeReg& reg)
+{
+    if (&reg == &_regs.IFCR)
+    {
+        // Write-only
+        return 0;
+    }
+    return reg.value;
+}
+
+void FakeDma::on_write(FakeReg& reg, uint32_t value)
+{
+    if (&reg == &_regs.IFCR)
+    {
+        for (size_t idx = 0; idx < _channels.size(); idx++)
+        {
+            if (value & (DMA_IFCR_CGIF1 << (idx * 4)))
+            {
+                value |= CH_FLAGS << (idx * 4);
+            }
+        }
+        _regs.ISR.value &= ~value;
+        return;
+    }
+
+    for (size_t idx = 0; idx < _channels.size(); idx++)
+    {
+        DMA_Channel_TypeDef& ch = _channels[idx];
+        if (&reg == &ch.CCR)
+        {
+            write_ccr(idx, value);
+            return;
+        }
+        if (&reg == &ch.CNDTR)
+        {
+            if (!(ch.CCR.value & DMA_CCR_EN))
+            {
+                ch.CNDTR.value = value & DMA_CNDTR_NDT;
+            }
+            return;
+        }
+    }
+    // ISR is read-only
+}
+
+uint8_t* FakeDma::reach(uint32_t addr) const
+{
+    const std::span<uint8_t> mem = memory();
+    const uintptr_t base = reinterpret_cast<uintptr_t>(mem.data());
+    if (mem.empty() || addr < base || addr >= base + mem.size())
+    {
+        return nullptr;
+    }
+    return mem.data() + (addr - base);
+}
+
+void FakeDma::set_flags(size_t idx, uint32_t flags)
+{
+    _regs.ISR.value |= (flags | DMA_ISR_GIF1) << (idx * 4);
+}
+
+void FakeDma::write_ccr(size_t idx, uint32_t value)
+{
+    DMA_Channel_TypeDef& ch = _channels[idx];
+    const bool enabling = !(ch.CCR.value & DMA_CCR_EN) && (value & DMA_CCR_EN);
+    ch.CCR.value = value;
+    if (enabling)
+    {
+        _latch[idx] = Latch{ch.CMAR.value, ch.CNDTR.value};
+    }
+}
+
+}  // namespace Native
+}  // namespace LBR
@@ -0,0 +1,101 @@
+/**
+ * @file fake_dma.h
+ * @brief Register-level model of the STM32L4 DMA controller for host tests
+ * @date 10/17/2026
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include "fake_reg.h"
+#include <stm32l476xx.h>
+
+namespace LBR
+{
+namespace Native
+{
+
+/**
+ * @class FakeDma
+ * @brief Takes over a DMA controller and its channels
+ * @details Follows RM0351 for peripheral-to-memory byte transfers. Setting
+ *          EN in CCR latches CMAR and CNDTR, each request serviced then
+ *          writes one byte, counts CNDTR down and raises HTIF at half and
+ *          TCIF at zero. Writes to IFCR clear flags, CGIFx all four of its
+ *          channel. CNDTR is read-only while the channel is enabled.
+ *
+ *          A request is serviced only if CSELR routes the peripheral to the
+ *          channel and CPAR holds the register it comes from. A memory
+ *          address outside memory() is a bus error: TEIF is raised and the
+ *          channel disabled, as the hardware does.
+ *
+ *          Interrupts are not raised on their own, tests poll irq_pending()
+ *          and call the driver's handler.
+ */
+class FakeDma : public RegModel
+{
+public:
+    /**
+     * @param regs controller flag registers, e.g. *DMA1
+     * @param channels channel registers, channel 1 first
+     * @param cselr request selection register of the controller
+     */
+    FakeDma(DMA_TypeDef& regs, std::span<DMA_Channel_TypeDef> channels,
+            DMA_Request_TypeDef& cselr);
+    ~FakeDma() override;
+
+    FakeDma(const FakeDma&) = delete;
+    FakeDma& operator=(const FakeDma&) = delete;
+
+    /**
+     * @brief Host memory the DMA can reach
+     * @details CMAR holds 32 bits, so buffers handed to a DMA driver come
+     *          from this block, mapped below 4 GiB. Empty if the host
+     *          cannot map it.
+     */
+    static std::span<uint8_t> memory();
+
+    /**
+     * @brief A peripheral asks a channel for one byte
+     *
+     * @param channel channel number, 1-based as in the reference manual
+     * @param sel request number the peripheral has in CSELR
+     * @param src data register the byte is read from
+     * @return true if the byte was moved, the peripheral then sees its
+     *         data register read
+     */
+    bool request(uint8_t channel, uint8_t sel, FakeReg& src);
+
+    /**
+     * @brief A flag of the channel is set with its interrupt enabled in CCR
+     */
+    bool irq_pending(uint8_t channel) const;
+
+    uint32_t on_read(FakeReg& reg) override;
+    void on_write(FakeReg& reg, uint32_t value) override;
+
+private:
+    /**
+     * @brief Addresses latched when the channel was enabled
+     */
+    struct Latch
+    {
+        uint32_t mem_addr{0};
+        uint32_t count{0};
+    };
+
+    uint8_t* reach(uint32_t addr) const;
+    void set_flags(size_t idx, uint32_t flags);
+    void write_ccr(size_t idx, uint32_t value);
+
+    DMA_TypeDef& _regs;
+    std::span<DMA_Channel_TypeDef> _channels;
+    DMA_Request_TypeDef& _cselr;
+    std::array<Latch, NUM_DMA_CHANNELS> _latch{};
+};
+
+}  // namespace Native
+}  // namespace LBR
@@ -0,0 +1,74 @@
+/**
+ * @file fake_exti.cc
+ * @brief Model of the STM32L4 EXTI lines 0-15 and the pins behind them
+ * @date 10/17/2026
+ */
+
+#include "fake_exti.h"
+
+namespace LBR
+{
+namespace Native
+{
+
+FakeExti::FakeExti(EXTI_TypeDef& regs) : _regs(regs)
+{
+    _regs.PR1.value = 0;
+    _regs.PR1.model = this;
+}
+
+FakeExti::~FakeExti()
+{
+    _regs.PR1.model = nullptr;
+}
+
+void FakeExti::set_pin(GPIO_TypeDef& port, uint8_t pin, bool level)
+{
+    const uint32_t bit = 1u << pin;
+    const bool was = port.IDR & bit;
+    if (level)
+    {
+        port.IDR |= bit;
+    }
+    else
+    {
+        port.IDR &= ~bit;
+    }
+    if (was == level)
+    {
+        return;
+    }
+
+    // The line listens to one port, picked in SYSCFG_EXTICR
+    const uint32_t shift = (pin % 4u) * 4u;
+    const uint32_t routed = (SYSCFG->EXTICR[pin / 4u] >> shift) & 0xFu;
+    if (routed >= NUM_GPIO_PORTS || &port != &gpio[routed])
+    {
+        return;
+    }
+
+    const uint32_t trigger = level ? _regs.RTSR1 : _regs.FTSR1;
+    if (trigger & bit)
+    {
+        _regs.PR1.value |= bit;
+    }
+}
+
+uint32_t FakeExti::pending() const
+{
+    return _regs.PR1.value & _regs.IMR1;
+}
+
+uint32_t FakeExti::on_read(FakeReg& reg)
+{
+    return reg.value;
+}
+
+void FakeExti::on_write(FakeReg& reg, uint32_t value)
+{
+    // rc_w1
+    reg.value &= ~value;
+}
+
+}  // namespace Native
+}  // namespace LBR
@@ -0,0 +1,62 @@
+/**
+ * @file fake_exti.h
+ * @brief Model of the STM32L4 EXTI lines 0-15 and the pins behind them
+ * @date 10/17/2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "fake_reg.h"
+#include <stm32l476xx.h>
+
+namespace LBR
+{
+namespace Native
+{
+
+/**
+ * @class FakeExti
+ * @brief Takes over EXTI PR1 and latches edges of the input pins
+ * @details Follows RM0351: an edge on a pin routed to its line through
+ *          SYSCFG_EXTICR sets the line in PR1 if RTSR1 or FTSR1 selects
+ *          that edge, masked or not. Writing 1 to a PR1 bit clears it.
+ *
+ *          Interrupts are not raised on their own, tests poll pending()
+ *          and call HwGpio::exti_irq_handler().
+ */
+class FakeExti : public RegModel
+{
+public:
+    /**
+     * @param regs EXTI block the drivers are pointed at, e.g. *EXTI
+     */
+    explicit FakeExti(EXTI_TypeDef& regs);
+    ~FakeExti() override;
+
+    FakeExti(const FakeExti&) = delete;
+    FakeExti& operator=(const FakeExti&) = delete;
+
+    /**
+     * @brief Drives an input pin, its level shows in IDR
+     *
+     * @param port one of the GPIOx ports
+     * @param pin pin number, 0-15
+     * @param level new level
+     */
+    void set_pin(GPIO_TypeDef& port, uint8_t pin, bool level);
+
+    /**
+     * @brief Lines pending in PR1 and unmasked in IMR1
+     */
+    uint32_t pending() const;
+
+    uint32_t on_read(FakeReg& reg) override;
+    void on_write(FakeReg& reg, uint32_t value) override;
+
+private:
+    EXTI_TypeDef& _regs;
+};
+
+}  // namespace Native
+}  // namespace LBR
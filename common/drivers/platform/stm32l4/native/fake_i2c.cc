@@ -0,0 +1,432 @@
+/**
+ * @file fake_i2c.cc
+ * @brief Register-level model of the STM32L4 I2C master for host tests
+ * @date 10/17/2026
+ */
+
+#include "fake_i2c.h"
+#include <algorithm>
+#include <initializer_list>
+
+namespace LBR
+{
+namespace Native
+{
+
+// ICR bits sit at the positions of the ISR flags they clear
+static constexpr uint32_t ICR_MASK =
+    I2C_ICR_ADDRCF | I2C_ICR_NACKCF | I2C_ICR_STOPCF | I2C_ICR_BERRCF |
+    I2C_ICR_ARLOCF | I2C_ICR_OVRCF | I2C_ICR_PECCF | I2C_ICR_TIMOUTCF |
+    I2C_ICR_ALERTCF;
+
+// DMA request number of I2Cx_RX in DMA1_CSELR (RM0351 table 44)
+static constexpr uint8_t DMA_REQ_I2C = 3;
+
+static constexpr uint32_t ERR_FLAGS = I2C_ISR_BERR | I2C_ISR_ARLO |
+                                      I2C_ISR_OVR | I2C_ISR_PECERR |
+                                      I2C_ISR_TIMEOUT;
+
+FakeI2c::FakeI2c(I2C_TypeDef& regs) : _regs(regs)
+{
+    for (FakeReg* reg : {&_regs.CR1, &_regs.CR2, &_regs.OAR1, &_regs.OAR2,
+                         &_regs.TIMINGR, &_regs.TIMEOUTR, &_regs.ISR,
+                         &_regs.ICR, &_regs.PECR, &_regs.RXDR, &_regs.TXDR})
+    {
+        reg->value = 0;
+        reg->model = this;
+    }
+    _regs.ISR.value = I2C_ISR_TXE;
+}
+
+FakeI2c::~FakeI2c()
+{
+    for (FakeReg* reg : {&_regs.CR1, &_regs.CR2, &_regs.OAR1, &_regs.OAR2,
+                         &_regs.TIMINGR, &_regs.TIMEOUTR, &_regs.ISR,
+                         &_regs.ICR, &_regs.PECR, &_regs.RXDR, &_regs.TXDR})
+    {
+        reg->model = nullptr;
+    }
+}
+
+bool FakeI2c::attach(Sim::SimI2cDevice& device, uint8_t dev_addr,
+                     uint8_t reg_bytes)
+{
+    if (find(dev_addr) != nullptr)
+    {
+        return false;
+    }
+    for (Slot& slot : _slots)
+    {
+        if (slot.device == nullptr)
+        {
+            slot = Slot{&device, dev_addr, reg_bytes, 0, 0};
+            return true;
+        }
+    }
+    return false;
+}
+
+void FakeI2c::connect_dma(FakeDma& dma, uint8_t channel)
+{
+    _dma = &dma;
+    _dma_channel = channel;
+}
+
+void FakeI2c::inject_nack(uint8_t dev_addr, uint32_t count)
+{
+    Slot* slot = find(dev_addr);
+    if (slot != nullptr)
+    {
+        slot->nack_count = count;
+    }
+}
+
+void FakeI2c::inject_error(uint32_t isr_flag, uint32_t after_bytes)
+{
+    _error_flag = isr_flag;
+    _error_after = after_bytes;
+    if (after_bytes == 0)
+    {
+        _regs.ISR.value |= isr_flag;
+        _hung = true;
+    }
+}
+
+void FakeI2c::hold_bus(uint32_t after_bytes)
+{
+    // BUSY as the error flag, the transfer just stops
+    inject_error(I2C_ISR_BUSY, after_bytes);
+}
+
+bool FakeI2c::ev_pending() const
+{
+    const uint32_t cr1 = _regs.CR1.value;
+    const uint32_t isr = _regs.ISR.value;
+    return ((cr1 & I2C_CR1_TXIE) && (isr & I2C_ISR_TXIS)) ||
+           ((cr1 & I2C_CR1_RXIE) && (isr & I2C_ISR_RXNE)) ||
+           ((cr1 & I2C_CR1_STOPIE) && (isr & I2C_ISR_STOPF)) ||
+           ((cr1 & I2C_CR1_TCIE) && (isr & (I2C_ISR_TC | I2C_ISR_TCR))) ||
+           ((cr1 & I2C_CR1_NACKIE) && (isr & I2C_ISR_NACKF));
+}
+
+bool FakeI2c::er_pending() const
+{
+    return (_regs.CR1.value & I2C_CR1_ERRIE) &&
+           (_regs.ISR.value & ERR_FLAGS);
+}
+
+uint32_t FakeI2c::on_read(FakeReg& reg)
+{
+    if (&reg == &_regs.RXDR)
+    {
+        const uint32_t byte = reg.value;
+        if (_regs.ISR.value & I2C_ISR_RXNE)
+        {
+            _regs.ISR.value &= ~I2C_ISR_RXNE;
+            pump();
+        }
+        return byte;
+    }
+    if (&reg == &_regs.ICR || &reg == &_regs.TXDR)
+    {
+        // Write-only
+        return 0;
+    }
+    return reg.value;
+}
+
+void FakeI2c::on_write(FakeReg& reg, uint32_t value)
+{
+    if (&reg == &_regs.CR1)
+    {
+        write_cr1(value);
+    }
+    else if (&reg == &_regs.CR2)
+    {
+        write_cr2(value);
+    }
+    else if (&reg == &_regs.ICR)
+    {
+        _regs.ISR.value &= ~(value & ICR_MASK);
+    }
+    else if (&reg == &_regs.ISR)
+    {
+        // Only TXE is writable, setting it flushes TXDR
+        _regs.ISR.value |= value & I2C_ISR_TXE;
+    }
+    else if (&reg == &_regs.TXDR)
+    {
+        write_txdr(value);
+    }
+    else if (&reg != &_regs.RXDR)
+    {
+        reg.value = value;
+    }
+}
+
+FakeI2c::Slot* FakeI2c::find(uint8_t dev_addr)
+{
+    for (Slot& slot : _slots)
+    {
+        if (slot.device != nullptr && slot.dev_addr == dev_addr)
+        {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+void FakeI2c::reset_state()
+{
+    _regs.ISR.value = I2C_ISR_TXE;
+    _tx_bytes.clear();
+    _target = nullptr;
+    _active = false;
+    _remaining = 0;
+    _dma_held = false;
+    _hung = false;
+    _error_flag = 0;
+    _error_after = 0;
+}
+
+void FakeI2c::write_cr1(uint32_t value)
+{
+    const bool was_enabled = _regs.CR1.value & I2C_CR1_PE;
+    _regs.CR1.value = value;
+
+    // PE low is the software reset: flags and state machine, not CR2
+    if (!(value & I2C_CR1_PE) || !was_enabled)
+    {
+        if (was_enabled)
+        {
+            _stats.resets++;
+        }
+        reset_state();
+        return;
+    }
+    pump();
+}
+
+void FakeI2c::write_cr2(uint32_t value)
+{
+    _regs.CR2.value = value & ~(I2C_CR2_START | I2C_CR2_STOP);
+
+    if ((_regs.ISR.value & I2C_ISR_TCR) && (value & I2C_CR2_NBYTES) &&
+        !(value & I2C_CR2_START))
+    {
+        // Non-zero NBYTES while TCR is set clears it and goes on
+        _regs.ISR.value &= ~I2C_ISR_TCR;
+        _remaining = (value & I2C_CR2_NBYTES) >> I2C_CR2_NBYTES_Pos;
+        _reload = value & I2C_CR2_RELOAD;
+        _autoend = value & I2C_CR2_AUTOEND;
+        _cr2_log.push_back(value);
+        _stats.reloads++;
+        _dma_held = false;
+        pump();
+        return;
+    }
+
+    if (value & I2C_CR2_START)
+    {
+        start(value);
+    }
+    else if ((value & I2C_CR2_STOP) && _active && !_hung)
+    {
+        stop();
+    }
+}
+
+void FakeI2c::write_txdr(uint32_t value)
+{
+    if (!_active || _read || !(_regs.ISR.value & I2C_ISR_TXIS))
+    {
+        _stats.stray_writes++;
+        return;
+    }
+
+    _regs.ISR.value &= ~(I2C_ISR_TXIS | I2C_ISR_TXE);
+    _tx_bytes.push_back(static_cast<uint8_t>(value));
+    _remaining--;
+    moved_byte();
+    if (_hung)
+    {
+        return;
+    }
+
+    _regs.ISR.value |= I2C_ISR_TXE;
+    if (_remaining == 0)
+    {
+        chunk_done();
+    }
+    else
+    {
+        _regs.ISR.value |= I2C_ISR_TXIS;
+    }
+}
+
+void FakeI2c::start(uint32_t cr2)
+{
+    _cr2_log.push_back(cr2);
+    _stats.starts++;
+    if (!(_regs.CR1.value & I2C_CR1_PE) || _hung)
+    {
+        return;
+    }
+
+    // A repeated START ends the write phase before it
+    flush_write();
+
+    _regs.ISR.value &= ~I2C_ISR_TC;
+    _regs.ISR.value |= I2C_ISR_BUSY;
+    _dma_held = false;
+    _active = true;
+    _read = cr2 & I2C_CR2_RD_WRN;
+    _reload = cr2 & I2C_CR2_RELOAD;
+    _autoend = cr2 & I2C_CR2_AUTOEND;
+    _remaining = (cr2 & I2C_CR2_NBYTES) >> I2C_CR2_NBYTES_Pos;
+    _target = find(static_cast<uint8_t>((cr2 & I2C_CR2_SADD) >> 1));
+
+    if (_target == nullptr || _target->nack_count > 0)
+    {
+        if (_target != nullptr)
+        {
+            _target->nack_count--;
+        }
+        // Address not acknowledged, STOP follows at once with AUTOEND
+        _stats.nacks++;
+        _target = nullptr;
+        _remaining = 0;
+        _regs.ISR.value |= I2C_ISR_NACKF;
+        if (_autoend)
+        {
+            stop();
+        }
+        return;
+    }
+
+    if (_remaining == 0)
+    {
+        chunk_done();
+        return;
+    }
+    pump();
+}
+
+void FakeI2c::stop()
+{
+    flush_write();
+    _stats.stops++;
+    _active = false;
+    _target = nullptr;
+    _remaining = 0;
+    _regs.ISR.value &= ~(I2C_ISR_BUSY | I2C_ISR_TC);
+    _regs.ISR.value |= I2C_ISR_STOPF;
+}
+
+void FakeI2c::pump()
+{
+    if (!_active || _hung || _target == nullptr)
+    {
+        return;
+    }
+
+    if (!_read)
+    {
+        if (_remaining > 0)
+        {
+            _regs.ISR.value |= I2C_ISR_TXIS;
+        }
+        return;
+    }
+
+    for (;;)
+    {
+        // One byte waits in RXDR until it is read
+        if ((_regs.ISR.value & I2C_ISR_RXNE) && !_dma_held && dma_read())
+        {
+            _regs.ISR.value &= ~I2C_ISR_RXNE;
+        }
+        if ((_regs.ISR.value & I2C_ISR_RXNE) || _remaining == 0 || !_active)
+        {
+            return;
+        }
+
+        uint8_t byte = 0;
+        _target->device->read(_target->pointer++,
+                              std::span<uint8_t>(&byte, 1));
+        _regs.RXDR.value = byte;
+        _regs.ISR.value |= I2C_ISR_RXNE;
+        _remaining--;
+        moved_byte();
+        if (_hung)
+        {
+            return;
+        }
+        if (_remaining == 0)
+        {
+            chunk_done();
+            _dma_held = _late_dma && _reload;
+        }
+    }
+}
+
+void FakeI2c::chunk_done()
+{
+    if (_reload)
+    {
+        _regs.ISR.value |= I2C_ISR_TCR;
+    }
+    else if (_autoend)
+    {
+        stop();
+    }
+    else
+    {
+        _regs.ISR.value |= I2C_ISR_TC;
+    }
+}
+
+void FakeI2c::moved_byte()
+{
+    if (_error_after > 0 && --_error_after == 0)
+    {
+        _regs.ISR.value |= _error_flag;
+        _hung = true;
+    }
+}
+
+bool FakeI2c::dma_read()
+{
+    return _dma != nullptr && (_regs.CR1.value & I2C_CR1_RXDMAEN) &&
+           _dma->request(_dma_channel, DMA_REQ_I2C, _regs.RXDR);
+}
+
+void FakeI2c::flush_write()
+{
+    if (_target == nullptr || _read || _tx_bytes.empty())
+    {
+        _tx_bytes.clear();
+        return;
+    }
+
+    const size_t reg_bytes =
+        std::min<size_t>(_target->reg_bytes, _tx_bytes.size());
+    uint16_t pointer = 0;
+    for (size_t i = 0; i < reg_bytes; i++)
+    {
+        pointer = static_cast<uint16_t>((pointer << 8) | _tx_bytes[i]);
+    }
+    _target->pointer = pointer;
+
+    const std::span<const uint8_t> data =
+        std::span<const uint8_t>(_tx_bytes).subspan(reg_bytes);
+    if (!data.empty())
+    {
+        _target->device->write(_target->pointer, data);
+        _target->pointer += data.size();
+    }
+    _tx_bytes.clear();
+}
+
+}  // namespace Native
+}  // namespace LBR
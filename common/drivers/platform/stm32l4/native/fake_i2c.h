@@ -0,0 +1,205 @@
+/**
+ * @file fake_i2c.h
+ * @brief Register-level model of the STM32L4 I2C master for host tests
+ * @date 10/17/2026
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "fake_dma.h"
+#include "fake_reg.h"
+#include "sim_i2c.h"
+#include <stm32l476xx.h>
+
+namespace LBR
+{
+namespace Native
+{
+
+/**
+ * @brief Bus activity counters
+ */
+struct FakeI2cStats
+{
+    uint32_t starts{0};  ///< START and repeated START conditions
+    uint32_t reloads{0};
+    uint32_t stops{0};
+    uint32_t nacks{0};
+    uint32_t stray_writes{0};  ///< TXDR writes without TXIS
+    uint32_t resets{0};        ///< PE cleared while set
+};
+
+/**
+ * @class FakeI2c
+ * @brief Takes over an I2C_TypeDef and answers like the peripheral
+ * @details Follows RM0351 master mode: a CR2 write with START addresses
+ *          the target, TXIS asks for each byte and RXNE holds each one
+ *          received. A chunk of NBYTES ends in TCR with RELOAD, in a STOP
+ *          with AUTOEND and in TC otherwise, and writing NBYTES while TCR
+ *          is set starts the next chunk. Clearing PE resets the flags.
+ *
+ *          Targets are SimI2cDevice register models. The first bytes of a
+ *          write phase set the register pointer, the rest are written
+ *          from there, and reads continue from the pointer.
+ *
+ *          With RXDMAEN set a connected DMA channel reads each received
+ *          byte out of RXDR, and the bus stalls if the channel refuses.
+ *
+ *          Everything happens on register access, with no bus timing.
+ *          Interrupts are not raised on their own, tests poll
+ *          ev_pending() and er_pending() and call the driver's handlers.
+ */
+class FakeI2c : public RegModel
+{
+public:
+    static constexpr size_t MAX_DEVICES = 4;
+
+    /**
+     * @param regs register block the driver is pointed at, e.g. *I2C1
+     */
+    explicit FakeI2c(I2C_TypeDef& regs);
+    ~FakeI2c() override;
+
+    FakeI2c(const FakeI2c&) = delete;
+    FakeI2c& operator=(const FakeI2c&) = delete;
+
+    /**
+     * @brief Places a target on the bus
+     *
+     * @param device model to route to, must outlive the fake
+     * @param dev_addr 7-bit address it answers to
+     * @param reg_bytes register pointer width in bytes
+     * @return false if the address is taken or the bus is full
+     */
+    bool attach(Sim::SimI2cDevice& device, uint8_t dev_addr,
+                uint8_t reg_bytes = 1);
+
+    /**
+     * @brief Wires RX requests to a DMA channel, taken while RXDMAEN is set
+     *
+     * @param dma controller model
+     * @param channel channel number the instance can request, 1-based
+     */
+    void connect_dma(FakeDma& dma, uint8_t channel);
+
+    /**
+     * @brief Serves the DMA request for the last byte of a RELOAD chunk
+     *        only after the next NBYTES write, so the ISR shows that byte's
+     *        RXNE together with TCR
+     */
+    void late_dma(bool late)
+    {
+        _late_dma = late;
+    }
+
+    /**
+     * @brief NACKs the next address phases of a target
+     *
+     * @param dev_addr target address
+     * @param count number of START conditions to NACK
+     */
+    void inject_nack(uint8_t dev_addr, uint32_t count);
+
+    /**
+     * @brief Raises an error flag once more bytes have moved, after which
+     *        the bus makes no progress until PE is cleared
+     *
+     * @param isr_flag I2C_ISR_BERR, I2C_ISR_ARLO, I2C_ISR_OVR or
+     *        I2C_ISR_TIMEOUT
+     * @param after_bytes data bytes still moved first, 0 raises it now
+     */
+    void inject_error(uint32_t isr_flag, uint32_t after_bytes = 0);
+
+    /**
+     * @brief A target holds the lines low, BUSY stays set and nothing moves
+     *        until PE is cleared, as if recover() clocked it free
+     *
+     * @param after_bytes data bytes still moved first, 0 holds it now;
+     *        a write then never sees TXIS again
+     */
+    void hold_bus(uint32_t after_bytes = 0);
+
+    /**
+     * @brief CR2 as written at every START and every NBYTES reload
+     */
+    std::span<const uint32_t> cr2_log() const
+    {
+        return _cr2_log;
+    }
+
+    void clear_log()
+    {
+        _cr2_log.clear();
+    }
+
+    /**
+     * @brief An event flag is set with its interrupt enabled in CR1
+     */
+    bool ev_pending() const;
+
+    /**
+     * @brief An error flag is set with ERRIE in CR1
+     */
+    bool er_pending() const;
+
+    const FakeI2cStats& stats() const
+    {
+        return _stats;
+    }
+
+    uint32_t on_read(FakeReg& reg) override;
+    void on_write(FakeReg& reg, uint32_t value) override;
+
+private:
+    struct Slot
+    {
+        Sim::SimI2cDevice* device{nullptr};
+        uint8_t dev_addr{0};
+        uint8_t reg_bytes{1};
+        uint16_t pointer{0};
+        uint32_t nack_count{0};
+    };
+
+    Slot* find(uint8_t dev_addr);
+    void reset_state();
+    void write_cr1(uint32_t value);
+    void write_cr2(uint32_t value);
+    void write_txdr(uint32_t value);
+    void start(uint32_t cr2);
+    void stop();
+    void pump();
+    void chunk_done();
+    void moved_byte();
+    void flush_write();
+    bool dma_read();
+
+    I2C_TypeDef& _regs;
+    FakeDma* _dma{nullptr};
+    uint8_t _dma_channel{0};
+    std::array<Slot, MAX_DEVICES> _slots{};
+    std::vector<uint32_t> _cr2_log;
+    std::vector<uint8_t> _tx_bytes;  ///< Write phase so far
+    FakeI2cStats _stats{};
+
+    // Transfer in progress
+    Slot* _target{nullptr};
+    bool _active{false};
+    bool _read{false};
+    bool _reload{false};
+    bool _autoend{false};
+    size_t _remaining{0};  ///< Bytes left in the NBYTES chunk
+
+    bool _late_dma{false};
+    bool _dma_held{false};  ///< RXNE kept from the channel until a reload
+    bool _hung{false};
+    uint32_t _error_flag{0};
+    uint32_t _error_after{0};
+};
+
+}  // namespace Native
+}  // namespace LBR
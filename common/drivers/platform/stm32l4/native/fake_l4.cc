@@ -0,0 +1,165 @@
+/**
+ * @file fake_l4.cc
+ * @brief Host objects behind the NATIVE STM32L476 device and HAL headers
+ * @date 10/17/2026
+ */
+
+#include "fake_l4.h"
+#include <cstring>
+#include <initializer_list>
+#include "stm32l4xx_hal.h"
+
+DWT_Type native_dwt;
+CoreDebug_Type native_core_debug;
+NativeNvic native_nvic;
+uint32_t native_primask;
+uint32_t SystemCoreClock;
+
+namespace LBR
+{
+namespace Native
+{
+
+static constexpr uint32_t RESET_CLOCK_HZ = 80'000'000;
+
+I2C_TypeDef i2c1;
+I2C_TypeDef i2c2;
+I2C_TypeDef i2c3;
+DMA_TypeDef dma1;
+DMA_Channel_TypeDef dma1_channel[NUM_DMA_CHANNELS];
+DMA_Request_TypeDef dma1_cselr;
+GPIO_TypeDef gpio[NUM_GPIO_PORTS];
+EXTI_TypeDef exti;
+SYSCFG_TypeDef syscfg;
+RCC_TypeDef rcc;
+TIM_TypeDef tim1;
+TIM_TypeDef tim2;
+TIM_TypeDef tim3;
+TIM_TypeDef tim4;
+TIM_TypeDef tim5;
+TIM_TypeDef tim6;
+TIM_TypeDef tim7;
+TIM_TypeDef tim8;
+TIM_TypeDef tim15;
+TIM_TypeDef tim16;
+TIM_TypeDef tim17;
+
+static uint64_t now_us_{0};
+static uint32_t tick_step_us_{1};
+static uint32_t hclk_hz_{RESET_CLOCK_HZ};
+static uint32_t pclk1_hz_{RESET_CLOCK_HZ};
+
+static void clear(std::initializer_list<FakeReg*> regs)
+{
+    for (FakeReg* reg : regs)
+    {
+        if (reg->model == nullptr)
+        {
+            reg->value = 0;
+        }
+    }
+}
+
+static void clear_i2c(I2C_TypeDef& i2c)
+{
+    clear({&i2c.CR1, &i2c.CR2, &i2c.OAR1, &i2c.OAR2, &i2c.TIMINGR,
+           &i2c.TIMEOUTR, &i2c.ISR, &i2c.ICR, &i2c.PECR, &i2c.RXDR,
+           &i2c.TXDR});
+}
+
+static void clear_exti(EXTI_TypeDef& regs)
+{
+    regs.IMR1 = 0;
+    regs.EMR1 = 0;
+    regs.RTSR1 = 0;
+    regs.FTSR1 = 0;
+    regs.SWIER1 = 0;
+    clear({&regs.PR1});
+    regs.IMR2 = 0;
+    regs.EMR2 = 0;
+    regs.RTSR2 = 0;
+    regs.FTSR2 = 0;
+    regs.SWIER2 = 0;
+    regs.PR2 = 0;
+}
+
+static void clear_tim(TIM_TypeDef& tim)
+{
+    clear({&tim.CR1, &tim.CR2, &tim.SMCR, &tim.DIER, &tim.SR, &tim.EGR,
+           &tim.CCMR1, &tim.CCMR2, &tim.CCER, &tim.CNT, &tim.PSC, &tim.ARR,
+           &tim.RCR, &tim.CCR1, &tim.CCR2, &tim.CCR3, &tim.CCR4, &tim.BDTR,
+           &tim.DCR, &tim.DMAR, &tim.OR1, &tim.CCMR3, &tim.CCR5, &tim.CCR6,
+           &tim.OR2, &tim.OR3});
+}
+
+void reset()
+{
+    clear_i2c(i2c1);
+    clear_i2c(i2c2);
+    clear_i2c(i2c3);
+    clear({&dma1.ISR, &dma1.IFCR});
+    for (DMA_Channel_TypeDef& ch : dma1_channel)
+    {
+        clear({&ch.CCR, &ch.CNDTR, &ch.CPAR, &ch.CMAR});
+    }
+    std::memset(&dma1_cselr, 0, sizeof(dma1_cselr));
+    std::memset(gpio, 0, sizeof(gpio));
+    clear_exti(exti);
+    std::memset(&syscfg, 0, sizeof(syscfg));
+    std::memset(&rcc, 0, sizeof(rcc));
+    for (TIM_TypeDef* tim : {&tim1, &tim2, &tim3, &tim4, &tim5, &tim6, &tim7,
+                             &tim8, &tim15, &tim16, &tim17})
+    {
+        clear_tim(*tim);
+    }
+
+    std::memset(&native_dwt, 0, sizeof(native_dwt));
+    std::memset(&native_core_debug, 0, sizeof(native_core_debug));
+    std::memset(&native_nvic, 0, sizeof(native_nvic));
+    native_primask = 0;
+
+    now_us_ = 0;
+    tick_step_us_ = 1;
+    set_clocks(RESET_CLOCK_HZ, RESET_CLOCK_HZ);
+}
+
+void set_tick_step(uint32_t us)
+{
+    tick_step_us_ = us;
+}
+
+void advance_us(uint64_t us)
+{
+    now_us_ += us;
+}
+
+uint64_t now_us()
+{
+    return now_us_;
+}
+
+void set_clocks(uint32_t hclk_hz, uint32_t pclk1_hz)
+{
+    SystemCoreClock = hclk_hz;
+    hclk_hz_ = hclk_hz;
+    pclk1_hz_ = pclk1_hz;
+}
+
+}  // namespace Native
+}  // namespace LBR
+
+uint32_t HAL_GetTick(void)
+{
+    LBR::Native::now_us_ += LBR::Native::tick_step_us_;
+    return static_cast<uint32_t>(LBR::Native::now_us_ / 1000);
+}
+
+uint32_t HAL_RCC_GetHCLKFreq(void)
+{
+    return LBR::Native::hclk_hz_;
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void)
+{
+    return LBR::Native::pclk1_hz_;
+}
@@ -0,0 +1,46 @@
+/**
+ * @file fake_l4.h
+ * @brief Host state behind the NATIVE STM32L476 device and HAL headers
+ * @date 10/17/2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <stm32l476xx.h>
+
+namespace LBR
+{
+namespace Native
+{
+
+/**
+ * @brief Clears every fake peripheral, the core registers and the clock
+ * @note Registers taken over by a model are left to it
+ */
+void reset();
+
+/**
+ * @brief Host time that passes on every HAL_GetTick() call
+ * @details Busy-wait loops poll the tick, so each call stands in for one
+ *          pass of the loop and a stuck flag runs into its timeout.
+ *
+ * @param us microseconds per call, 0 stops the clock
+ */
+void set_tick_step(uint32_t us);
+
+/**
+ * @brief Moves host time forward, stands in for sleeping
+ */
+void advance_us(uint64_t us);
+
+uint64_t now_us();
+
+/**
+ * @brief Frequencies the HAL reports, both 80 MHz after reset(); hclk_hz
+ *        is also the SystemCoreClock
+ */
+void set_clocks(uint32_t hclk_hz, uint32_t pclk1_hz);
+
+}  // namespace Native
+}  // namespace LBR
@@ -0,0 +1,102 @@
+/**
+ * @file fake_reg.h
+ * @brief Host stand-in for a memory-mapped register with side effects
+ * @date 10/17/2026
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace LBR
+{
+namespace Native
+{
+
+class FakeReg;
+
+/**
+ * @class RegModel
+ * @brief Behavior behind the registers of one peripheral
+ */
+class RegModel
+{
+public:
+    /**
+     * @brief Serves a read, may change state like clear-on-read flags
+     *
+     * @param reg register being read
+     * @return value the driver sees
+     */
+    virtual uint32_t on_read(FakeReg& reg) = 0;
+
+    /**
+     * @brief Accepts a write, including every read-modify-write
+     *
+     * @param reg register being written
+     * @param value value the driver wrote
+     */
+    virtual void on_write(FakeReg& reg, uint32_t value) = 0;
+
+    virtual ~RegModel() = default;
+};
+
+/**
+ * @class FakeReg
+ * @brief 32-bit register whose accesses go through a RegModel
+ * @details Reads and writes like the volatile uint32_t it replaces in the
+ *          register structs, so drivers compile unchanged. Without a model
+ *          it is plain memory.
+ */
+class FakeReg
+{
+public:
+    constexpr FakeReg() = default;
+    FakeReg(const FakeReg&) = delete;
+
+    operator uint32_t()
+    {
+        return model ? model->on_read(*this) : value;
+    }
+
+    FakeReg& operator=(uint32_t v)
+    {
+        if (model)
+        {
+            model->on_write(*this, v);
+        }
+        else
+        {
+            value = v;
+        }
+        return *this;
+    }
+
+    FakeReg& operator=(const FakeReg&) = delete;
+
+    // Masks like ~I2C_CR1_PE are 64 bits wide on the host, the upper half
+    // is dropped as it is on the 32-bit bus
+    FakeReg& operator|=(uint64_t v)
+    {
+        return *this =
+                   static_cast<uint32_t>(*this) | static_cast<uint32_t>(v);
+    }
+
+    FakeReg& operator&=(uint64_t v)
+    {
+        return *this =
+                   static_cast<uint32_t>(*this) & static_cast<uint32_t>(v);
+    }
+
+    FakeReg& operator^=(uint64_t v)
+    {
+        return *this =
+                   static_cast<uint32_t>(*this) ^ static_cast<uint32_t>(v);
+    }
+
+    uint32_t value{0};  ///< Raw contents, models read and write it freely
+    RegModel* model{nullptr};
+};
+
+}  // namespace Native
+}  // namespace LBR
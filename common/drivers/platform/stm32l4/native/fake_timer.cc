@@ -0,0 +1,119 @@
+/**
+ * @file fake_timer.cc
+ * @brief Register-level model of an STM32L4 timer in encoder mode
+ * @date 10/17/2026
+ */
+
+#include "fake_timer.h"
+#include <initializer_list>
+
+namespace LBR
+{
+namespace Native
+{
+
+// SMS = 011, counting on both edges of both inputs
+static constexpr uint32_t ENCODER_MODE_3 = TIM_SMCR_SMS_0 | TIM_SMCR_SMS_1;
+
+// DIER enable bits sit at the positions of the SR flags they unmask
+static constexpr uint32_t IRQ_FLAGS = TIM_SR_UIF | TIM_SR_CC1IF |
+                                      TIM_SR_CC2IF | TIM_SR_CC3IF |
+                                      TIM_SR_CC4IF | TIM_SR_TIF;
+
+FakeTimer::FakeTimer(TIM_TypeDef& regs) : _regs(regs)
+{
+    // The rest have no side effects and stay plain memory
+    for (FakeReg* reg : {&_regs.CR1, &_regs.SR, &_regs.CNT})
+    {
+        reg->value = 0;
+        reg->model = this;
+    }
+}
+
+FakeTimer::~FakeTimer()
+{
+    for (FakeReg* reg : {&_regs.CR1, &_regs.SR, &_regs.CNT})
+    {
+        reg->model = nullptr;
+    }
+}
+
+void FakeTimer::step(int32_t counts)
+{
+    if (!(_regs.CR1.value & TIM_CR1_CEN) ||
+        (_regs.SMCR.value & TIM_SMCR_SMS) != ENCODER_MODE_3)
+    {
+        return;
+    }
+
+    const bool up = counts > 0;
+    for (int32_t i = 0; i < (up ? counts : -counts); i++)
+    {
+        edge(up);
+    }
+}
+
+bool FakeTimer::irq_pending() const
+{
+    return _regs.SR.value & _regs.DIER.value & IRQ_FLAGS;
+}
+
+uint32_t FakeTimer::on_read(FakeReg& reg)
+{
+    if (&reg == &_regs.CNT && (_regs.CR1.value & TIM_CR1_UIFREMAP) &&
+        (_regs.SR.value & TIM_SR_UIF))
+    {
+        return reg.value | TIM_CNT_UIFCPY;
+    }
+    return reg.value;
+}
+
+void FakeTimer::on_write(FakeReg& reg, uint32_t value)
+{
+    if (&reg == &_regs.SR)
+    {
+        // rc_w0
+        _regs.SR.value &= value;
+    }
+    else if (&reg == &_regs.CNT)
+    {
+        // UIFCPY is read-only
+        _regs.CNT.value = value & ~TIM_CNT_UIFCPY;
+    }
+    else
+    {
+        reg.value = value;
+    }
+}
+
+void FakeTimer::edge(bool up)
+{
+    const uint32_t arr = _regs.ARR.value;
+    uint32_t& cnt = _regs.CNT.value;
+    if (up)
+    {
+        _regs.CR1.value &= ~TIM_CR1_DIR;
+        cnt = (cnt >= arr) ? 0 : cnt + 1;
+    }
+    else
+    {
+        _regs.CR1.value |= TIM_CR1_DIR;
+        cnt = (cnt == 0) ? arr : cnt - 1;
+    }
+    if ((up && cnt == 0) || (!up && cnt == arr))
+    {
+        _regs.SR.value |= TIM_SR_UIF;
+    }
+
+    const uint32_t enable = _on_b ? TIM_CCER_CC2E : TIM_CCER_CC1E;
+    const uint32_t flag = _on_b ? TIM_SR_CC2IF : TIM_SR_CC1IF;
+    const uint32_t over = _on_b ? TIM_SR_CC2OF : TIM_SR_CC1OF;
+    if (_regs.CCER.value & enable)
+    {
+        _regs.SR.value |= (_regs.SR.value & flag) ? (flag | over) : flag;
+    }
+    _on_b = !_on_b;
+}
+
+}  // namespace Native
+}  // namespace LBR
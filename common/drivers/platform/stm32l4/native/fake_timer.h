@@ -0,0 +1,66 @@
+/**
+ * @file fake_timer.h
+ * @brief Register-level model of an STM32L4 timer in encoder mode
+ * @date 10/17/2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "fake_reg.h"
+#include <stm32l476xx.h>
+
+namespace LBR
+{
+namespace Native
+{
+
+/**
+ * @class FakeTimer
+ * @brief Takes over a TIM_TypeDef and counts quadrature edges
+ * @details Follows RM0351 encoder mode 3, every edge of either input
+ *          moves CNT by one count while CEN is set. Passing ARR to 0 or
+ *          0 to ARR raises UIF, and each edge raises the capture flag of
+ *          its input, CCxOF if the last one was not cleared. SR bits are
+ *          cleared by writing 0 and kept by writing 1. With UIFREMAP set
+ *          UIF reads back as bit 31 of CNT.
+ *
+ *          Interrupts are not raised on their own, tests poll
+ *          irq_pending() and call the driver's handler.
+ */
+class FakeTimer : public RegModel
+{
+public:
+    /**
+     * @param regs register block the driver is pointed at, e.g. *TIM3
+     */
+    explicit FakeTimer(TIM_TypeDef& regs);
+    ~FakeTimer() override;
+
+    FakeTimer(const FakeTimer&) = delete;
+    FakeTimer& operator=(const FakeTimer&) = delete;
+
+    /**
+     * @brief Turns the shaft by a number of edges
+     *
+     * @param counts edges to feed, positive counts up
+     */
+    void step(int32_t counts);
+
+    /**
+     * @brief A flag is set in SR with its interrupt enabled in DIER
+     */
+    bool irq_pending() const;
+
+    uint32_t on_read(FakeReg& reg) override;
+    void on_write(FakeReg& reg, uint32_t value) override;
+
+private:
+    void edge(bool up);
+
+    TIM_TypeDef& _regs;
+    bool _on_b{false};  ///< Input of the next edge, A and B alternate
+};
+
+}  // namespace Native
+}  // namespace LBR
@@ -0,0 +1,229 @@
+/**
+ * @file stm32l476xx.h
+ * @brief Host stand-in for the STM32L476 device header
+ * @date 10/17/2026
+ * @details Shadows the vendor header in NATIVE builds. Bit definitions,
+ *          IRQ numbers and most register structs come from the vendor
+ *          header itself. Peripherals whose registers have side effects
+ *          swap their struct for one of FakeRegs driven by a model, and
+ *          every instance the drivers use points at a host object below.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "fake_reg.h"
+
+// Vendor layouts moved out of the way, the fakes below take the names
+#define I2C_TypeDef Vendor_I2C_TypeDef
+#define DMA_TypeDef Vendor_DMA_TypeDef
+#define DMA_Channel_TypeDef Vendor_DMA_Channel_TypeDef
+#define TIM_TypeDef Vendor_TIM_TypeDef
+#define EXTI_TypeDef Vendor_EXTI_TypeDef
+#include_next <stm32l476xx.h>
+#undef I2C_TypeDef
+#undef DMA_TypeDef
+#undef DMA_Channel_TypeDef
+#undef TIM_TypeDef
+#undef EXTI_TypeDef
+
+/**
+ * @brief I2C registers, see FakeI2c for their behavior
+ */
+struct I2C_TypeDef
+{
+    LBR::Native::FakeReg CR1;
+    LBR::Native::FakeReg CR2;
+    LBR::Native::FakeReg OAR1;
+    LBR::Native::FakeReg OAR2;
+    LBR::Native::FakeReg TIMINGR;
+    LBR::Native::FakeReg TIMEOUTR;
+    LBR::Native::FakeReg ISR;
+    LBR::Native::FakeReg ICR;
+    LBR::Native::FakeReg PECR;
+    LBR::Native::FakeReg RXDR;
+    LBR::Native::FakeReg TXDR;
+};
+
+/**
+ * @brief DMA flag registers, see FakeDma
+ */
+struct DMA_TypeDef
+{
+    LBR::Native::FakeReg ISR;
+    LBR::Native::FakeReg IFCR;
+};
+
+/**
+ * @brief DMA channel registers, see FakeDma
+ */
+struct DMA_Channel_TypeDef
+{
+    LBR::Native::FakeReg CCR;
+    LBR::Native::FakeReg CNDTR;
+    LBR::Native::FakeReg CPAR;
+    LBR::Native::FakeReg CMAR;
+};
+
+/**
+ * @brief EXTI registers, PR1 is write-one-to-clear through FakeExti
+ * @note The rest stay volatile, st_gpio updates them through pointers
+ */
+struct EXTI_TypeDef
+{
+    __IO uint32_t IMR1;
+    __IO uint32_t EMR1;
+    __IO uint32_t RTSR1;
+    __IO uint32_t FTSR1;
+    __IO uint32_t SWIER1;
+    LBR::Native::FakeReg PR1;
+    uint32_t RESERVED1;
+    uint32_t RESERVED2;
+    __IO uint32_t IMR2;
+    __IO uint32_t EMR2;
+    __IO uint32_t RTSR2;
+    __IO uint32_t FTSR2;
+    __IO uint32_t SWIER2;
+    __IO uint32_t PR2;
+};
+
+/**
+ * @brief Timer registers, see FakeTimer
+ */
+struct TIM_TypeDef
+{
+    LBR::Native::FakeReg CR1;
+    LBR::Native::FakeReg CR2;
+    LBR::Native::FakeReg SMCR;
+    LBR::Native::FakeReg DIER;
+    LBR::Native::FakeReg SR;
+    LBR::Native::FakeReg EGR;
+    LBR::Native::FakeReg CCMR1;
+    LBR::Native::FakeReg CCMR2;
+    LBR::Native::FakeReg CCER;
+    LBR::Native::FakeReg CNT;
+    LBR::Native::FakeReg PSC;
+    LBR::Native::FakeReg ARR;
+    LBR::Native::FakeReg RCR;
+    LBR::Native::FakeReg CCR1;
+    LBR::Native::FakeReg CCR2;
+    LBR::Native::FakeReg CCR3;
+    LBR::Native::FakeReg CCR4;
+    LBR::Native::FakeReg BDTR;
+    LBR::Native::FakeReg DCR;
+    LBR::Native::FakeReg DMAR;
+    LBR::Native::FakeReg OR1;
+    LBR::Native::FakeReg CCMR3;
+    LBR::Native::FakeReg CCR5;
+    LBR::Native::FakeReg CCR6;
+    LBR::Native::FakeReg OR2;
+    LBR::Native::FakeReg OR3;
+};
+
+namespace LBR
+{
+namespace Native
+{
+
+constexpr size_t NUM_GPIO_PORTS = 8;  ///< GPIOA to GPIOH
+constexpr size_t NUM_DMA_CHANNELS = 7;
+
+extern I2C_TypeDef i2c1;
+extern I2C_TypeDef i2c2;
+extern I2C_TypeDef i2c3;
+extern DMA_TypeDef dma1;
+extern DMA_Channel_TypeDef dma1_channel[NUM_DMA_CHANNELS];
+extern DMA_Request_TypeDef dma1_cselr;
+extern GPIO_TypeDef gpio[NUM_GPIO_PORTS];
+extern EXTI_TypeDef exti;
+extern SYSCFG_TypeDef syscfg;
+extern RCC_TypeDef rcc;
+extern TIM_TypeDef tim1;
+extern TIM_TypeDef tim2;
+extern TIM_TypeDef tim3;
+extern TIM_TypeDef tim4;
+extern TIM_TypeDef tim5;
+extern TIM_TypeDef tim6;
+extern TIM_TypeDef tim7;
+extern TIM_TypeDef tim8;
+extern TIM_TypeDef tim15;
+extern TIM_TypeDef tim16;
+extern TIM_TypeDef tim17;
+
+}  // namespace Native
+}  // namespace LBR
+
+#undef I2C1
+#undef I2C2
+#undef I2C3
+#define I2C1 (&LBR::Native::i2c1)
+#define I2C2 (&LBR::Native::i2c2)
+#define I2C3 (&LBR::Native::i2c3)
+
+#undef DMA1
+#undef DMA1_Channel1
+#undef DMA1_Channel2
+#undef DMA1_Channel3
+#undef DMA1_Channel4
+#undef DMA1_Channel5
+#undef DMA1_Channel6
+#undef DMA1_Channel7
+#undef DMA1_CSELR
+#define DMA1 (&LBR::Native::dma1)
+#define DMA1_Channel1 (&LBR::Native::dma1_channel[0])
+#define DMA1_Channel2 (&LBR::Native::dma1_channel[1])
+#define DMA1_Channel3 (&LBR::Native::dma1_channel[2])
+#define DMA1_Channel4 (&LBR::Native::dma1_channel[3])
+#define DMA1_Channel5 (&LBR::Native::dma1_channel[4])
+#define DMA1_Channel6 (&LBR::Native::dma1_channel[5])
+#define DMA1_Channel7 (&LBR::Native::dma1_channel[6])
+#define DMA1_CSELR (&LBR::Native::dma1_cselr)
+
+// Ports are told apart by their distance from GPIOA, like on the chip
+#undef GPIOA_BASE
+#undef GPIOB_BASE
+#undef GPIOC_BASE
+#undef GPIOD_BASE
+#undef GPIOE_BASE
+#undef GPIOF_BASE
+#undef GPIOG_BASE
+#undef GPIOH_BASE
+#define GPIOA_BASE (reinterpret_cast<uintptr_t>(&LBR::Native::gpio[0]))
+#define GPIOB_BASE (reinterpret_cast<uintptr_t>(&LBR::Native::gpio[1]))
+#define GPIOC_BASE (reinterpret_cast<uintptr_t>(&LBR::Native::gpio[2]))
+#define GPIOD_BASE (reinterpret_cast<uintptr_t>(&LBR::Native::gpio[3]))
+#define GPIOE_BASE (reinterpret_cast<uintptr_t>(&LBR::Native::gpio[4]))
+#define GPIOF_BASE (reinterpret_cast<uintptr_t>(&LBR::Native::gpio[5]))
+#define GPIOG_BASE (reinterpret_cast<uintptr_t>(&LBR::Native::gpio[6]))
+#define GPIOH_BASE (reinterpret_cast<uintptr_t>(&LBR::Native::gpio[7]))
+
+#undef EXTI
+#undef SYSCFG
+#undef RCC
+#define EXTI (&LBR::Native::exti)
+#define SYSCFG (&LBR::Native::syscfg)
+#define RCC (&LBR::Native::rcc)
+
+#undef TIM1
+#undef TIM2
+#undef TIM3
+#undef TIM4
+#undef TIM5
+#undef TIM6
+#undef TIM7
+#undef TIM8
+#undef TIM15
+#undef TIM16
+#undef TIM17
+#define TIM1 (&LBR::Native::tim1)
+#define TIM2 (&LBR::Native::tim2)
+#define TIM3 (&LBR::Native::tim3)
+#define TIM4 (&LBR::Native::tim4)
+#define TIM5 (&LBR::Native::tim5)
+#define TIM6 (&LBR::Native::tim6)
+#define TIM7 (&LBR::Native::tim7)
+#define TIM8 (&LBR::Native::tim8)
+#define TIM15 (&LBR::Native::tim15)
+#define TIM16 (&LBR::Native::tim16)
+#define TIM17 (&LBR::Native::tim17)
@@ -0,0 +1,20 @@
+/**
+ * @file stm32l4xx_hal.h
+ * @brief Host stand-in for the parts of the STM32L4 HAL the drivers use
+ * @date 10/17/2026
+ * @details The tick and clock frequencies are set through fake_l4.h.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <stm32l476xx.h>
+
+/**
+ * @brief Milliseconds of host time, see LBR::Native::set_tick_step()
+ */
+uint32_t HAL_GetTick(void);
+
+uint32_t HAL_RCC_GetHCLKFreq(void);
+
+uint32_t HAL_RCC_GetPCLK1Freq(void);
@@ -1,16 +1,65 @@
 
 
 #include "st_encoder.h"
+#include "stm32l4xx_hal.h"
 
 namespace LBR
 {
 namespace Stml4
 {
 
+static constexpr uint32_t COUNT_MASK = 0xFFFF;
+static constexpr uint32_t COUNT_RANGE = COUNT_MASK + 1;
+static constexpr uint32_t EDGE_IRQS = TIM_DIER_CC1IE | TIM_DIER_CC2IE;
+static constexpr uint32_t EDGE_FLAGS =
+    TIM_SR_CC1IF | TIM_SR_CC2IF | TIM_SR_CC1OF | TIM_SR_CC2OF;
+
+/**
+ * Clock enable, update and capture interrupts of each timer with an
+ * encoder mode
+ */
+struct EncoderTimer
+{
+    TIM_TypeDef* base;
+    volatile uint32_t* enr;
+    uint32_t en_bit;
+    IRQn_Type update_irq;
+    IRQn_Type capture_irq;
+};
+
+static const EncoderTimer* find_timer(TIM_TypeDef* base)
+{
+    static const EncoderTimer timers[] = {
+        {TIM1, &RCC->APB2ENR, RCC_APB2ENR_TIM1EN, TIM1_UP_TIM16_IRQn,
+         TIM1_CC_IRQn},
+        {TIM2, &RCC->APB1ENR1, RCC_APB1ENR1_TIM2EN, TIM2_IRQn, TIM2_IRQn},
+        {TIM3, &RCC->APB1ENR1, RCC_APB1ENR1_TIM3EN, TIM3_IRQn, TIM3_IRQn},
+        {TIM4, &RCC->APB1ENR1, RCC_APB1ENR1_TIM4EN, TIM4_IRQn, TIM4_IRQn},
+        {TIM5, &RCC->APB1ENR1, RCC_APB1ENR1_TIM5EN, TIM5_IRQn, TIM5_IRQn},
+        {TIM8, &RCC->APB2ENR, RCC_APB2ENR_TIM8EN, TIM8_UP_IRQn, TIM8_CC_IRQn},
+    };
+    for (const EncoderTimer& timer : timers)
+    {
+        if (timer.base == base)
+        {
+            return &timer;
+        }
+    }
+    return nullptr;
+}
+
+/* Which way a wrap went, from where the counter is now: just past 0
+ * after an overflow, just below the top after an underflow */
+static int32_t wrap_direction(uint32_t cnt)
+{
+    return ((cnt & COUNT_MASK) < COUNT_RANGE / 2) ? 1 : -1;
+}
+
 HwEncoder::HwEncoder(const StEncoderParams& params)
     : gpio_a_(params.pin_a_params),
       gpio_b_(params.pin_b_params),
-      timer_base_(params.timer_base)
+      timer_base_(params.timer_base),
+      irq_priority_(params.irq_priority)
 {
 }
 
@@ -24,8 +73,17 @@ bool HwEncoder::init(void)
         return false;
     }
 
+    const EncoderTimer* timer = find_timer(timer_base_);
+    if (timer == nullptr)
+    {
+        _status = 1;
+        return false;
+    }
+    *timer->enr |= timer->en_bit;
+
     timer_base_->CR1 = 0;
-    timer_base_->ARR = 0xFFFF;
+    // 16 bits on the 32-bit TIM2/5 too, bit 31 of CNT becomes UIFCPY
+    timer_base_->ARR = COUNT_MASK;
     timer_base_->PSC = 0;
     timer_base_->CNT = 0;
 
@@ -39,14 +97,46 @@ bool HwEncoder::init(void)
     timer_base_->CCER &= ~(TIM_CCER_CC1P | TIM_CCER_CC2P);
     timer_base_->CCER |= TIM_CCER_CC1E | TIM_CCER_CC2E;
 
-    timer_base_->CR1 |= TIM_CR1_CEN;
+    // Edge timestamps, leaves a running cycle counter alone
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    timestamp_hz_ = HAL_RCC_GetHCLKFreq();
+
+    wraps_.store(0, std::memory_order_relaxed);
+    edge_valid_ = false;
+    timer_base_->SR = 0;
+    timer_base_->DIER |= TIM_DIER_UIE | EDGE_IRQS;
+    NVIC_SetPriority(timer->update_irq, irq_priority_);
+    NVIC_EnableIRQ(timer->update_irq);
+    NVIC_SetPriority(timer->capture_irq, irq_priority_);
+    NVIC_EnableIRQ(timer->capture_irq);
+
+    timer_base_->CR1 |= TIM_CR1_UIFREMAP | TIM_CR1_CEN;
     _status = 0;
     return true;
 }
 
 int HwEncoder::getTicks() const
 {
-    return static_cast<int>(timer_base_->CNT);
+    int32_t wraps;
+    uint32_t cnt;
+    // Retry if irq_handler() ran between the two reads
+    do
+    {
+        wraps = wraps_.load(std::memory_order_acquire);
+        cnt = timer_base_->CNT;
+    } while (wraps != wraps_.load(std::memory_order_acquire));
+
+    // Wrapped but irq_handler() hasn't run, we may be preempting it
+    if (cnt & TIM_CNT_UIFCPY)
+    {
+        wraps += wrap_direction(cnt);
+    }
+
+    // Two's complement wraps of the 32-bit position are fine for deltas
+    const uint32_t ticks =
+        static_cast<uint32_t>(wraps) * COUNT_RANGE + (cnt & COUNT_MASK);
+    return static_cast<int>(ticks);
 }
 
 int HwEncoder::getStatus() const
@@ -54,5 +144,45 @@ int HwEncoder::getStatus() const
     return _status;
 }
 
+bool HwEncoder::getEdge(EncoderEdge& edge) const
+{
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    edge = EncoderEdge{edge_ticks_, edge_time_, DWT->CYCCNT};
+    const bool valid = edge_valid_;
+    // Time the next edge, a flag left from an earlier one is stale
+    timer_base_->SR = ~EDGE_FLAGS;
+    timer_base_->DIER |= EDGE_IRQS;
+    __set_PRIMASK(primask);
+    return valid;
+}
+
+void HwEncoder::irq_handler()
+{
+    /* Flag and count change together, a higher priority getTicks() must
+     * see either the pending flag or the counted wrap, never both. The
+     * edge is read whole by getEdge() for the same reason. */
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    const uint32_t sr = timer_base_->SR;
+    if (sr & TIM_SR_UIF)
+    {
+        const int32_t dir = wrap_direction(timer_base_->CNT);
+        timer_base_->SR = ~static_cast<uint32_t>(TIM_SR_UIF);
+        wraps_.store(wraps_.load(std::memory_order_relaxed) + dir,
+                     std::memory_order_release);
+    }
+    if ((sr & (TIM_SR_CC1IF | TIM_SR_CC2IF)) &&
+        (timer_base_->DIER & EDGE_IRQS))
+    {
+        edge_time_ = DWT->CYCCNT;
+        edge_ticks_ = getTicks();
+        edge_valid_ = true;
+        timer_base_->DIER &= ~EDGE_IRQS;
+        timer_base_->SR = ~EDGE_FLAGS;
+    }
+    __set_PRIMASK(primask);
+}
+
 }  // namespace Stml4
 }  // namespace LBR
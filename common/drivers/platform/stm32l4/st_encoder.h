@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include "encoder.h"
 #include "st_gpio.h"
@@ -23,20 +24,55 @@ struct StEncoderParams
     StGpioParams pin_a_params;
     StGpioParams pin_b_params;
     TIM_TypeDef* timer_base;
+    uint32_t irq_priority{0};  ///< NVIC priority of the timer interrupts
 };
 
-class HwEncoder
+/**
+ * @class HwEncoder
+ * @brief Quadrature encoder on a timer in encoder mode, extended to 32 bits
+ * @details The counter runs over 16 bits on every timer. Its update
+ *          interrupt counts the wraps, and UIFREMAP copies the update flag
+ *          into CNT so the count and a not yet handled wrap are read
+ *          together. getTicks() is safe from thread context and from
+ *          interrupts of any priority.
+ *
+ *          getEdge() arms the channel capture interrupt, which stamps the
+ *          first edge after it with the DWT cycle counter and disarms
+ *          itself. Polled once per control tick that is at most one
+ *          interrupt per tick at any speed.
+ * @note The counter must not move more than 32768 counts between a wrap
+ *       and its interrupt, which tells overflow from underflow by where
+ *       the counter landed.
+ */
+class HwEncoder : public Encoder
 {
 public:
     explicit HwEncoder(const StEncoderParams& params);
     bool init(void);
-    int getTicks() const;
-    int getStatus() const;
+    int getTicks() const override;
+    int getStatus() const override;
+    bool getEdge(EncoderEdge& edge) const override;
+    uint32_t getTimestampHz() const override
+    {
+        return timestamp_hz_;
+    }
+
+    /**
+     * @brief Call from the timer's update and capture interrupt handlers
+     */
+    void irq_handler();
 
 private:
     HwGpio gpio_a_;
     HwGpio gpio_b_;
     TIM_TypeDef* const timer_base_;
+    const uint32_t irq_priority_;
+    std::atomic<int32_t> wraps_{0};  ///< Net overflows minus underflows
+    uint32_t timestamp_hz_{0};
+    // First edge after the last getEdge(), written by irq_handler()
+    int edge_ticks_{0};
+    uint32_t edge_time_{0};
+    bool edge_valid_{false};
     int _status{0};
 };
 
@@ -0,0 +1,166 @@
+/**
+ * @file st_flash.cc
+ * @brief Internal flash page driver implementation for STM32L476xx
+ * @date 10/17/2026
+ */
+
+#include "st_flash.h"
+#include <cstring>
+#include "stm32l4xx_hal.h"
+
+namespace LBR
+{
+namespace Stml4
+{
+
+// RM0351 3.3.1, 1MB split into two 512KB banks of 2KB pages
+static constexpr uint32_t FLASH_START = 0x08000000;
+static constexpr uint32_t BANK_BYTES = 0x80000;
+static constexpr uint32_t FLASH_BYTES = 2 * BANK_BYTES;
+
+static constexpr uint32_t UNLOCK_KEY1 = 0x45670123;
+static constexpr uint32_t UNLOCK_KEY2 = 0xCDEF89AB;
+
+static constexpr uint32_t SR_ERRORS =
+    FLASH_SR_OPERR | FLASH_SR_PROGERR | FLASH_SR_WRPERR | FLASH_SR_PGAERR |
+    FLASH_SR_SIZERR | FLASH_SR_PGSERR | FLASH_SR_MISERR | FLASH_SR_FASTERR |
+    FLASH_SR_RDERR | FLASH_SR_OPTVERR;
+
+HwFlash::HwFlash(const StFlashParams& params)
+    : page_addr_{params.page_addr}, timeout_ms_{params.timeout_ms}
+{
+}
+
+size_t HwFlash::size() const
+{
+    return PAGE_SIZE;
+}
+
+size_t HwFlash::write_unit() const
+{
+    return WRITE_UNIT;
+}
+
+bool HwFlash::read(size_t offset, std::span<uint8_t> data)
+{
+    if (!valid() || offset + data.size() > PAGE_SIZE)
+    {
+        return false;
+    }
+    std::memcpy(data.data(),
+                reinterpret_cast<const void*>(page_addr_ + offset),
+                data.size());
+    return true;
+}
+
+bool HwFlash::write(size_t offset, std::span<const uint8_t> data)
+{
+    if (!valid() || offset % WRITE_UNIT != 0 ||
+        data.size() % WRITE_UNIT != 0 || offset + data.size() > PAGE_SIZE)
+    {
+        return false;
+    }
+    if (!unlock())
+    {
+        return false;
+    }
+
+    bool ok = true;
+    FLASH->CR |= FLASH_CR_PG;
+    for (size_t i = 0; i < data.size() && ok; i += WRITE_UNIT)
+    {
+        // Both words back to back, the second one starts programming
+        uint32_t words[2];
+        std::memcpy(words, data.data() + i, sizeof(words));
+        volatile uint32_t* dst =
+            reinterpret_cast<volatile uint32_t*>(page_addr_ + offset + i);
+        dst[0] = words[0];
+        dst[1] = words[1];
+        ok = wait_ready();
+    }
+    FLASH->CR &= ~FLASH_CR_PG;
+    lock();
+    return ok;
+}
+
+bool HwFlash::erase()
+{
+    if (!valid() || !unlock())
+    {
+        return false;
+    }
+
+    // With FB_MODE set the banks are swapped in the memory map
+    const bool swapped = (SYSCFG->MEMRMP & SYSCFG_MEMRMP_FB_MODE) != 0;
+    const uint32_t offset = page_addr_ - FLASH_START;
+    const bool bank2 = (offset >= BANK_BYTES) != swapped;
+    const uint32_t page = (offset % BANK_BYTES) / PAGE_SIZE;
+
+    FLASH->CR &= ~(FLASH_CR_PNB | FLASH_CR_BKER);
+    FLASH->CR |= FLASH_CR_PER | (page << FLASH_CR_PNB_Pos) |
+                 (bank2 ? FLASH_CR_BKER : 0);
+    FLASH->CR |= FLASH_CR_STRT;
+    const bool ok = wait_ready();
+    FLASH->CR &= ~(FLASH_CR_PER | FLASH_CR_PNB | FLASH_CR_BKER);
+
+    // The data cache may still hold lines of the old contents
+    if (FLASH->ACR & FLASH_ACR_DCEN)
+    {
+        FLASH->ACR &= ~FLASH_ACR_DCEN;
+        FLASH->ACR |= FLASH_ACR_DCRST;
+        FLASH->ACR &= ~FLASH_ACR_DCRST;
+        FLASH->ACR |= FLASH_ACR_DCEN;
+    }
+
+    lock();
+    return ok;
+}
+
+bool HwFlash::valid() const
+{
+    return page_addr_ >= FLASH_START &&
+           page_addr_ + PAGE_SIZE <= FLASH_START + FLASH_BYTES &&
+           (page_addr_ - FLASH_START) % PAGE_SIZE == 0;
+}
+
+bool HwFlash::unlock()
+{
+    if (!wait_ready())
+    {
+        return false;
+    }
+    if (FLASH->CR & FLASH_CR_LOCK)
+    {
+        FLASH->KEYR = UNLOCK_KEY1;
+        FLASH->KEYR = UNLOCK_KEY2;
+    }
+    // Errors left over from an earlier operation block the next one
+    FLASH->SR = SR_ERRORS | FLASH_SR_EOP;
+    return (FLASH->CR & FLASH_CR_LOCK) == 0;
+}
+
+void HwFlash::lock()
+{
+    FLASH->CR |= FLASH_CR_LOCK;
+}
+
+bool HwFlash::wait_ready()
+{
+    const uint32_t start = HAL_GetTick();
+    while (FLASH->SR & FLASH_SR_BSY)
+    {
+        if ((HAL_GetTick() - start) >= timeout_ms_)
+        {
+            return false;
+        }
+    }
+    if (FLASH->SR & SR_ERRORS)
+    {
+        FLASH->SR = SR_ERRORS;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace Stml4
+}  // namespace LBR
@@ -0,0 +1,59 @@
+/**
+ * @file st_flash.h
+ * @brief Internal flash page driver for the stml4
+ * @date 10/17/2026
+ * @note One HwFlash owns one 2KB page. The page must be kept out of the
+ *       linker's FLASH region so code never lands in it.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "flash.h"
+#include "stm32l476xx.h"
+
+namespace LBR
+{
+namespace Stml4
+{
+
+/**
+ * @brief Collection of settings for one flash page.
+ */
+struct StFlashParams
+{
+    uint32_t page_addr;  ///< First byte of the page, 2KB aligned
+    uint32_t timeout_ms;
+};
+
+class HwFlash : public Flash
+{
+public:
+    static constexpr size_t PAGE_SIZE = 0x800;
+    static constexpr size_t WRITE_UNIT = 8;  ///< Double word with ECC
+
+    /**
+     * @brief Hw Contructor
+     * @param params struct of page address and timeout.
+     */
+    explicit HwFlash(const StFlashParams& params);
+
+    size_t size() const override;
+    size_t write_unit() const override;
+    bool read(size_t offset, std::span<uint8_t> data) override;
+    bool write(size_t offset, std::span<const uint8_t> data) override;
+    bool erase() override;
+
+private:
+    bool valid() const;
+    bool unlock();
+    void lock();
+    bool wait_ready();
+
+    const uint32_t page_addr_;
+    const uint32_t timeout_ms_;
+};
+
+}  // namespace Stml4
+}  // namespace LBR
@@ -16,6 +16,36 @@ static inline void set_field(volatile uint32_t* field, uint32_t val,
     *field |= (mask & val) << (pos * bits);
 }
 
+/**
+ * @brief Owner of one EXTI line
+ */
+struct ExtiSlot
+{
+    GpioIrqCallback cb;
+    void* ctx;
+    GPIO_TypeDef* port;
+};
+
+static ExtiSlot exti_slots[ST_GPIO_MAX_PINS]{};
+
+static IRQn_Type exti_irqn(uint8_t line)
+{
+    if (line <= 4)
+    {
+        return static_cast<IRQn_Type>(EXTI0_IRQn + line);
+    }
+    return (line <= 9) ? EXTI9_5_IRQn : EXTI15_10_IRQn;
+}
+
+/**
+ * @brief SYSCFG_EXTICR port code, GPIOA = 0 up to GPIOH = 7
+ */
+static uint32_t exti_port(const GPIO_TypeDef* port)
+{
+    return (reinterpret_cast<uintptr_t>(port) - GPIOA_BASE) /
+           (GPIOB_BASE - GPIOA_BASE);
+}
+
 HwGpio::HwGpio(const StGpioParams& params)
     : settings_{params.settings},
       pin_num_{params.pin_num},
@@ -68,5 +98,81 @@ bool HwGpio::read(void)
     return base_addr_->IDR & (1u << pin_num_);
 }
 
+bool HwGpio::enable_irq(GpioEdge edge, GpioIrqCallback cb, void* ctx,
+                        uint32_t priority)
+{
+    if (pin_num_ >= ST_GPIO_MAX_PINS || base_addr_ == nullptr ||
+        cb == nullptr)
+    {
+        return false;
+    }
+    ExtiSlot& slot = exti_slots[pin_num_];
+    if (slot.port != nullptr && slot.port != base_addr_)
+    {
+        return false;
+    }
+
+    const uint32_t bit = 1u << pin_num_;
+    EXTI->IMR1 &= ~bit;
+    slot = ExtiSlot{cb, ctx, base_addr_};
+
+    RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN;
+    set_field(&SYSCFG->EXTICR[pin_num_ / 4u], exti_port(base_addr_),
+              pin_num_ % 4u, 4);
+
+    const uint32_t edges = static_cast<uint32_t>(edge);
+    set_field(&EXTI->RTSR1, edges & 0x1u, pin_num_, 1);
+    set_field(&EXTI->FTSR1, (edges >> 1) & 0x1u, pin_num_, 1);
+
+    // Drop an edge latched before the callback was in place
+    EXTI->PR1 = bit;
+    EXTI->IMR1 |= bit;
+
+    const IRQn_Type irqn = exti_irqn(pin_num_);
+    NVIC_SetPriority(irqn, priority);
+    NVIC_EnableIRQ(irqn);
+    return true;
+}
+
+void HwGpio::disable_irq(void)
+{
+    if (pin_num_ >= ST_GPIO_MAX_PINS)
+    {
+        return;
+    }
+    ExtiSlot& slot = exti_slots[pin_num_];
+    if (slot.port != base_addr_)
+    {
+        return;
+    }
+
+    // Shared handlers stay enabled, the other lines may still use them
+    const uint32_t bit = 1u << pin_num_;
+    EXTI->IMR1 &= ~bit;
+    EXTI->PR1 = bit;
+    slot = ExtiSlot{};
+}
+
+void HwGpio::exti_irq_handler(uint8_t first, uint8_t last)
+{
+    for (uint8_t line = first; line <= last && line < ST_GPIO_MAX_PINS;
+         line++)
+    {
+        const uint32_t bit = 1u << line;
+        if ((EXTI->PR1 & EXTI->IMR1 & bit) == 0)
+        {
+            continue;
+        }
+        // Write-one-to-clear, before the callback so a new edge during it
+        // pends again
+        EXTI->PR1 = bit;
+        const ExtiSlot& slot = exti_slots[line];
+        if (slot.cb != nullptr)
+        {
+            slot.cb(slot.ctx);
+        }
+    }
+}
+
 }  // namespace Stml4
 }  // namespace LBR
\ No newline at end of file
@@ -47,6 +47,21 @@ enum class GpioPupd : uint8_t
     PULL_DOWN
 };
 
+/**
+ * @brief Input edges that trigger an EXTI line
+ */
+enum class GpioEdge : uint8_t
+{
+    RISING = 1,
+    FALLING,
+    BOTH
+};
+
+/**
+ * @brief Called from the EXTI handler with the pending line cleared
+ */
+using GpioIrqCallback = void (*)(void* ctx);
+
 /**
  * @brief Collection of control params to configure gpio.
  */
@@ -88,6 +103,30 @@ public:
     bool set(const bool active) override;
     bool read(void) override;
 
+    /**
+     * @brief Routes the pin to its EXTI line and enables the interrupt
+     * @note EXTI lines are shared by pin number, so only one port can own
+     *       each line. Call after init().
+     * @param edge edges that fire the callback
+     * @param cb called in interrupt context
+     * @param ctx passed to cb
+     * @param priority NVIC priority of the line's interrupt
+     * @return true if success, false if the line is owned by another port.
+     */
+    bool enable_irq(GpioEdge edge, GpioIrqCallback cb, void* ctx,
+                    uint32_t priority = 0);
+
+    /**
+     * @brief Masks the pin's EXTI line and releases it
+     */
+    void disable_irq(void);
+
+    /**
+     * @brief Dispatches the pending lines in [first, last], call from
+     *        EXTIx_IRQHandler with the lines that handler serves
+     */
+    static void exti_irq_handler(uint8_t first, uint8_t last);
+
 private:
     StGpioSettings settings_;
     const uint8_t pin_num_;
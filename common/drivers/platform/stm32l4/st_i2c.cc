@@ -6,50 +6,251 @@
  */
 
 #include "st_i2c.h"
+#include <algorithm>
 #include <array>
+#include "delay.h"
+#include "stm32l4xx_hal.h"
 
 namespace LBR
 {
 namespace Stml4
 {
+
+// Interrupts used by the *_it transfers
+static constexpr uint32_t IT_MASK = I2C_CR1_TXIE | I2C_CR1_RXIE |
+                                    I2C_CR1_TCIE | I2C_CR1_STOPIE |
+                                    I2C_CR1_NACKIE | I2C_CR1_ERRIE;
+
+// Error flags reported through the error interrupt
+static constexpr uint32_t ERR_MASK =
+    I2C_ISR_BERR | I2C_ISR_ARLO | I2C_ISR_OVR | I2C_ISR_TIMEOUT;
+
+// CR2 fields rewritten for every transfer phase
+static constexpr uint32_t CR2_XFER_MASK = I2C_CR2_NBYTES | I2C_CR2_RD_WRN |
+                                          I2C_CR2_SADD | I2C_CR2_AUTOEND |
+                                          I2C_CR2_RELOAD;
+
+// NBYTES is 8 bits wide, longer phases are chained through RELOAD/TCR
+static constexpr size_t MAX_NBYTES = 255;
+
+// DMA request number of I2Cx_RX/TX in DMA1_CSELR (RM0351 table 44)
+static constexpr uint32_t DMA_REQ_I2C = 3;
+
+// SMBus clock-low timeout, enforced in hardware through TIMEOUTA
+static constexpr uint32_t SCL_LOW_TIMEOUT_MS = 25;
+
+// Half period of the recovery clock, ~100 kHz
+static constexpr uint32_t RECOVERY_HALF_PERIOD_US = 5;
+
+/**
+ * @brief IRQ, reset and DMA wiring of an I2C instance
+ */
+struct I2cInstance
+{
+    I2C_TypeDef* base_addr;
+    IRQn_Type ev_irq;
+    IRQn_Type er_irq;
+    uint32_t rst_bit;             // RCC_APB1RSTR1
+    DMA_Channel_TypeDef* dma_rx;  // DMA1 channel serving RX requests
+    uint8_t dma_rx_num;           // 1-based, as in the reference manual
+    IRQn_Type dma_rx_irq;
+};
+
+/**
+ * @brief Looks up the wiring of an I2C instance
+ * @return nullptr if base_addr is not a known I2C instance
+ */
+static const I2cInstance* find_instance(const I2C_TypeDef* base_addr)
+{
+    static const I2cInstance instances[] = {
+        {I2C1, I2C1_EV_IRQn, I2C1_ER_IRQn, RCC_APB1RSTR1_I2C1RST,
+         DMA1_Channel7, 7, DMA1_Channel7_IRQn},
+        {I2C2, I2C2_EV_IRQn, I2C2_ER_IRQn, RCC_APB1RSTR1_I2C2RST,
+         DMA1_Channel5, 5, DMA1_Channel5_IRQn},
+        {I2C3, I2C3_EV_IRQn, I2C3_ER_IRQn, RCC_APB1RSTR1_I2C3RST,
+         DMA1_Channel3, 3, DMA1_Channel3_IRQn},
+    };
+
+    for (const I2cInstance& inst : instances)
+    {
+        if (inst.base_addr == base_addr)
+        {
+            return &inst;
+        }
+    }
+    return nullptr;
+}
+
 HwI2c::HwI2c(const StI2cParams& params)
-    : _base_addr{params.base_addr}, _timingr{params.timingr}
+    : _base_addr{params.base_addr},
+      _timingr{params.timingr},
+      _use_dma{params.use_dma},
+      _timeout_ms{params.timeout_ms},
+      _scl{params.scl},
+      _sda{params.sda},
+      _now_ms{params.now_ms}
 {
 }
 
 bool HwI2c::init()
 {
-    if (_base_addr == nullptr)
+    // Without a clock no deadline would ever pass
+    if (_base_addr == nullptr || _now_ms == nullptr)
     {
         return false;
     }
 
+    _trace.init();
+
     // Reset peripheral
     _base_addr->CR1 &= ~I2C_CR1_PE;
 
     // Configure timing
     _base_addr->TIMINGR = _timingr;
 
+    /**
+     * Hardware SCL-low timeout, TIMEOUTA = t * f_i2cclk / 2048 - 1
+     * I2CxSEL is left at its reset value so the kernel clock is PCLK1
+     */
+    uint32_t timeouta =
+        (HAL_RCC_GetPCLK1Freq() / 1000U) * SCL_LOW_TIMEOUT_MS / 2048U;
+    timeouta = std::clamp<uint32_t>(timeouta, 1U, 0x1000U) - 1U;
+    _base_addr->TIMEOUTR = 0;
+    _base_addr->TIMEOUTR =
+        (timeouta << I2C_TIMEOUTR_TIMEOUTA_Pos) | I2C_TIMEOUTR_TIMOUTEN;
+
     _base_addr->CR2 &= ~I2C_CR2_ADD10;  // 7-bit addressing mode
 
     // Enable peripheral
     _base_addr->CR1 |= I2C_CR1_PE;
 
+    const I2cInstance* inst = find_instance(_base_addr);
+
+    // Event/error lines stay quiet until a *_it transfer sets CR1 IE bits
+    if (inst != nullptr)
+    {
+        NVIC_EnableIRQ(inst->ev_irq);
+        NVIC_EnableIRQ(inst->er_irq);
+    }
+
+    // Route the instance's RX requests to its DMA1 channel
+    _dma_rx = nullptr;
+    if (_use_dma && inst != nullptr)
+    {
+        RCC->AHB1ENR |= RCC_AHB1ENR_DMA1EN;
+
+        const uint32_t sel_pos = (inst->dma_rx_num - 1) * 4;
+        DMA1_CSELR->CSELR &= ~(0xFUL << sel_pos);
+        DMA1_CSELR->CSELR |= DMA_REQ_I2C << sel_pos;
+
+        inst->dma_rx->CCR = 0;
+        inst->dma_rx->CPAR = static_cast<uint32_t>(
+            reinterpret_cast<uintptr_t>(&_base_addr->RXDR));
+
+        _dma_rx = inst->dma_rx;
+        _dma_rx_shift = sel_pos;
+        NVIC_EnableIRQ(inst->dma_rx_irq);
+    }
+
+    // A transfer that recover() ended keeps its result for get_xfer_state()
+    if (_xfer_state == I2cXferState::BUSY)
+    {
+        _xfer_state = I2cXferState::IDLE;
+    }
+
     return true;
 }
 
-bool HwI2c::mem_read(std::span<uint8_t> data, const uint8_t reg_addr,
-                     uint8_t dev_addr)
+I2cStatus HwI2c::recover()
 {
     if (_base_addr == nullptr)
     {
-        return false;
+        return I2cStatus::NOT_READY;
+    }
+
+    // Abandon whatever the ISR was driving
+    if (_xfer_state == I2cXferState::BUSY)
+    {
+        finish_xfer(I2cStatus::TIMEOUT);
+    }
+
+    // Peripheral reset, clears every register including stuck flags
+    const I2cInstance* inst = find_instance(_base_addr);
+    if (inst != nullptr)
+    {
+        RCC->APB1RSTR1 |= inst->rst_bit;
+        RCC->APB1RSTR1 &= ~inst->rst_bit;
+    }
+    else
+    {
+        _base_addr->CR1 &= ~I2C_CR1_PE;
+    }
+
+    if (_scl != nullptr && _sda != nullptr)
+    {
+        clock_out_bus();
+    }
+
+    return init() ? I2cStatus::OK : I2cStatus::NOT_READY;
+}
+
+void HwI2c::clock_out_bus()
+{
+    StGpioParams scl_params = *_scl;
+    scl_params.settings.mode = GpioMode::GPOUT;
+    scl_params.settings.otype = GpioOtype::OPEN_DRAIN;
+    StGpioParams sda_params = *_sda;
+    sda_params.settings.mode = GpioMode::GPOUT;
+    sda_params.settings.otype = GpioOtype::OPEN_DRAIN;
+
+    HwGpio scl(scl_params);
+    HwGpio sda(sda_params);
+    scl.set(true);
+    sda.set(true);
+    scl.init();
+    sda.init();
+
+    // Up to 9 clocks lets a slave finish the byte it is holding SDA for
+    for (int i = 0; i < 9 && !sda.read(); i++)
+    {
+        scl.set(false);
+        Utils::DelayUs(RECOVERY_HALF_PERIOD_US);
+        scl.set(true);
+        Utils::DelayUs(RECOVERY_HALF_PERIOD_US);
+    }
+
+    // STOP condition, SDA rising while SCL is high
+    scl.set(false);
+    Utils::DelayUs(RECOVERY_HALF_PERIOD_US);
+    sda.set(false);
+    Utils::DelayUs(RECOVERY_HALF_PERIOD_US);
+    scl.set(true);
+    Utils::DelayUs(RECOVERY_HALF_PERIOD_US);
+    sda.set(true);
+    Utils::DelayUs(RECOVERY_HALF_PERIOD_US);
+
+    // Hand the pins back to the peripheral
+    HwGpio(*_scl).init();
+    HwGpio(*_sda).init();
+}
+
+I2cStatus HwI2c::bus_ready() const
+{
+    if (_base_addr == nullptr)
+    {
+        return I2cStatus::NOT_READY;
     }
 
     // Check if init was called
     if (!(_base_addr->CR1 & I2C_CR1_PE))
     {
-        return false;
+        return I2cStatus::NOT_READY;
+    }
+
+    // Interrupt-driven transfer still owns the peripheral
+    if (_xfer_state == I2cXferState::BUSY)
+    {
+        return I2cStatus::BUSY;
     }
 
     /**
@@ -58,404 +259,668 @@ bool HwI2c::mem_read(std::span<uint8_t> data, const uint8_t reg_addr,
      */
     if (_base_addr->CR2 & I2C_CR2_START)
     {
-        return false;
+        return I2cStatus::BUSY;
     }
 
     // Make sure I2C bus is idle
     if (_base_addr->ISR & I2C_ISR_BUSY)
     {
-        return false;
+        return I2cStatus::BUSY;
     }
 
-    // Writing register address to write to
-    _base_addr->CR2 &=
-        ~(I2C_CR2_NBYTES | I2C_CR2_RD_WRN | I2C_CR2_SADD | I2C_CR2_AUTOEND);
-    _base_addr->CR2 |= (1 << I2C_CR2_NBYTES_Pos |
-                        (dev_addr << (I2C_CR2_SADD_Pos + 1)) | I2C_CR2_START);
+    return I2cStatus::OK;
+}
+
+I2cStatus HwI2c::begin()
+{
+    _start_tick = _now_ms();
+    const uint32_t trace_start = _trace.now();
 
-    while (!(_base_addr->ISR & I2C_ISR_TXIS))
+    I2cStatus status = bus_ready();
+    const bool retried = (status == I2cStatus::BUSY);
+
+    // A bus that never goes idle is held by a stuck slave, clock it free
+    while (status == I2cStatus::BUSY && _xfer_state != I2cXferState::BUSY)
     {
-        // TODO: replace while with timeout
+        if (expired())
+        {
+            recover();
+            return I2cStatus::TIMEOUT;
+        }
+        status = bus_ready();
     }
 
-    _base_addr->TXDR = reg_addr;
-
-    while (!(_base_addr->ISR & I2C_ISR_TC))
+    if (status == I2cStatus::OK)
     {
-        // TODO : replace while with timeout
+        _trace.start(trace_start, retried);
     }
+    return status;
+}
 
-    // Configuring and initiating transfer
-    _base_addr->CR2 &=
-        ~(I2C_CR2_NBYTES | I2C_CR2_RD_WRN | I2C_CR2_SADD | I2C_CR2_AUTOEND);
-    _base_addr->CR2 |= ((data.size() << I2C_CR2_NBYTES_Pos) | I2C_CR2_RD_WRN |
-                        (dev_addr << (I2C_CR2_SADD_Pos + 1)) | I2C_CR2_AUTOEND |
-                        I2C_CR2_START);
+bool HwI2c::expired() const
+{
+    return (_now_ms() - _start_tick) >= _timeout_ms;
+}
 
-    for (uint8_t& byte : data)
+I2cStatus HwI2c::wait_flag(uint32_t flag)
+{
+    while (!(_base_addr->ISR & flag))
     {
-        // Wait for transfer
-        while (!(_base_addr->ISR & I2C_ISR_RXNE))
+        const uint32_t isr = _base_addr->ISR;
+
+        if (isr & I2C_ISR_NACKF)
+        {
+            return handle_nack();
+        }
+
+        if (isr & ERR_MASK)
         {
-            // TODO: replace while with timeout
+            _base_addr->ICR = I2C_ICR_BERRCF | I2C_ICR_ARLOCF | I2C_ICR_OVRCF |
+                              I2C_ICR_TIMOUTCF;
+            recover();
+            return (isr & I2C_ISR_TIMEOUT) ? I2cStatus::TIMEOUT
+                                           : I2cStatus::BUS_ERROR;
         }
 
-        byte = _base_addr->RXDR;
+        if (expired())
+        {
+            recover();
+            return I2cStatus::TIMEOUT;
+        }
+    }
+
+    return I2cStatus::OK;
+}
+
+I2cStatus HwI2c::handle_nack()
+{
+    _base_addr->ICR = I2C_ICR_NACKCF;
+
+    // Without AUTOEND the STOP has to be issued by hand
+    if (!(_base_addr->CR2 & I2C_CR2_AUTOEND))
+    {
+        _base_addr->CR2 |= I2C_CR2_STOP;
     }
 
-    // Detect stop
     while (!(_base_addr->ISR & I2C_ISR_STOPF))
     {
-        // TODO: replace while with timeout
+        if (expired())
+        {
+            recover();
+            return I2cStatus::TIMEOUT;
+        }
     }
-    _base_addr->ICR |= I2C_ICR_STOPCF;
+    _base_addr->ICR = I2C_ICR_STOPCF;
 
-    return true;
+    // Drop the byte that was queued for the slave that went away
+    _base_addr->ISR |= I2C_ISR_TXE;
+
+    return I2cStatus::NACK;
 }
 
-bool HwI2c::mem_read(std::span<uint8_t> data, const uint16_t reg_addr,
-                     uint8_t dev_addr)
+uint32_t HwI2c::first_chunk(size_t len, bool last)
 {
-    if (_base_addr == nullptr)
+    const size_t chunk = std::min(len, MAX_NBYTES);
+    _pending = len - chunk;
+    _pending_last = last;
+    return (chunk << I2C_CR2_NBYTES_Pos) | chunk_end();
+}
+
+uint32_t HwI2c::chunk_end() const
+{
+    // AUTOEND is ignored while RELOAD is set, so only one is ever written
+    if (_pending > 0)
     {
-        return false;
+        return I2C_CR2_RELOAD;
     }
+    return _pending_last ? I2C_CR2_AUTOEND : 0;
+}
 
-    // Check if init was called
-    if (!(_base_addr->CR1 & I2C_CR1_PE))
+void HwI2c::reload_chunk()
+{
+    const size_t chunk = std::min(_pending, MAX_NBYTES);
+    _pending -= chunk;
+
+    // Writing NBYTES clears TCR and releases the stretched SCL
+    uint32_t cr2 = _base_addr->CR2;
+    cr2 &= ~(I2C_CR2_NBYTES | I2C_CR2_RELOAD | I2C_CR2_AUTOEND);
+    cr2 |= (chunk << I2C_CR2_NBYTES_Pos) | chunk_end();
+    _base_addr->CR2 = cr2;
+}
+
+I2cStatus HwI2c::wait_data(uint32_t flag)
+{
+    for (;;)
     {
-        return false;
+        const I2cStatus status = wait_flag(flag | I2C_ISR_TCR);
+        if (status != I2cStatus::OK)
+        {
+            return status;
+        }
+
+        // The last byte of a chunk can raise RXNE together with TCR
+        if (_base_addr->ISR & flag)
+        {
+            _trace.mark(I2cTracePhase::ADDRESS);
+            return I2cStatus::OK;
+        }
+
+        reload_chunk();
     }
+}
 
-    /**
-     * Setting target
-     * Checking if communication in progress
-     */
-    if (_base_addr->CR2 & I2C_CR2_START)
+I2cStatus HwI2c::send_reg(uint16_t reg_addr, uint8_t reg_len)
+{
+    for (int8_t shift = (reg_len - 1) * 8; shift >= 0; shift -= 8)
     {
-        return false;
+        I2cStatus status = wait_data(I2C_ISR_TXIS);
+        if (status != I2cStatus::OK)
+        {
+            return status;
+        }
+        _base_addr->TXDR = static_cast<uint8_t>((reg_addr >> shift) & 0xFF);
     }
 
-    // Make sure I2C bus is idle
-    if (_base_addr->ISR & I2C_ISR_BUSY)
+    return I2cStatus::OK;
+}
+
+I2cStatus HwI2c::send_data(std::span<const uint8_t> data)
+{
+    for (const uint8_t byte : data)
     {
-        return false;
+        I2cStatus status = wait_data(I2C_ISR_TXIS);
+        if (status != I2cStatus::OK)
+        {
+            return status;
+        }
+        _base_addr->TXDR = byte;
     }
 
-    // Writing register address to write to
-    _base_addr->CR2 &=
-        ~(I2C_CR2_NBYTES | I2C_CR2_RD_WRN | I2C_CR2_SADD | I2C_CR2_AUTOEND);
-    _base_addr->CR2 |= (2 << I2C_CR2_NBYTES_Pos |
-                        (dev_addr << (I2C_CR2_SADD_Pos + 1)) | I2C_CR2_START);
+    return I2cStatus::OK;
+}
+
+void HwI2c::start_rx_dma(std::span<uint8_t> data, bool irq)
+{
+    _dma_rx->CCR = 0;
+    DMA1->IFCR = DMA_IFCR_CGIF1 << _dma_rx_shift;
+    _dma_rx->CMAR =
+        static_cast<uint32_t>(reinterpret_cast<uintptr_t>(data.data()));
+    _dma_rx->CNDTR = data.size();
+    _dma_rx->CCR = DMA_CCR_MINC | DMA_CCR_PL_1 | (irq ? DMA_CCR_TEIE : 0) |
+                   DMA_CCR_EN;
+    _base_addr->CR1 |= I2C_CR1_RXDMAEN;
+}
+
+bool HwI2c::stop_rx_dma()
+{
+    _base_addr->CR1 &= ~I2C_CR1_RXDMAEN;
+    const bool done = (_dma_rx->CNDTR == 0) &&
+                      !(DMA1->ISR & (DMA_ISR_TEIF1 << _dma_rx_shift));
+    _dma_rx->CCR = 0;
+    DMA1->IFCR = DMA_IFCR_CGIF1 << _dma_rx_shift;
+    return done;
+}
 
-    while (!(_base_addr->ISR & I2C_ISR_TXIS))
+I2cStatus HwI2c::end_phase(bool last)
+{
+    if (!last)
     {
-        // TODO: replace while with timeout
+        // Bus is held for the repeated-START of the next phase
+        return wait_flag(I2C_ISR_TC);
     }
-    _base_addr->TXDR = static_cast<uint8_t>((reg_addr >> 8) & 0xFF);  // MSB
-    while (!(_base_addr->ISR & I2C_ISR_TXIS))
+
+    // Detect stop
+    _trace.mark(I2cTracePhase::DATA);
+    const I2cStatus status = wait_flag(I2C_ISR_STOPF);
+    if (status != I2cStatus::OK)
     {
-        // TODO: replace while with timeout
+        return status;
     }
-    _base_addr->TXDR = static_cast<uint8_t>(reg_addr & 0xFF);  // LSB
+    _base_addr->ICR = I2C_ICR_STOPCF;
+    _trace.mark(I2cTracePhase::STOP);
 
-    while (!(_base_addr->ISR & I2C_ISR_TC))
+    return I2cStatus::OK;
+}
+
+I2cStatus HwI2c::receive(std::span<uint8_t> data, uint8_t dev_addr, bool last)
+{
+    // DMA has to be armed before the first byte can land in RXDR
+    if (_dma_rx != nullptr)
     {
-        // TODO : replace while with timeout
+        start_rx_dma(data, false);
     }
 
     // Configuring and initiating transfer
-    _base_addr->CR2 &=
-        ~(I2C_CR2_NBYTES | I2C_CR2_RD_WRN | I2C_CR2_SADD | I2C_CR2_AUTOEND);
-    _base_addr->CR2 |= ((data.size() << I2C_CR2_NBYTES_Pos) | I2C_CR2_RD_WRN |
-                        (dev_addr << (I2C_CR2_SADD_Pos + 1)) | I2C_CR2_AUTOEND |
-                        I2C_CR2_START);
+    _base_addr->CR2 &= ~CR2_XFER_MASK;
+    _base_addr->CR2 |= (first_chunk(data.size(), last) | I2C_CR2_RD_WRN |
+                        (dev_addr << (I2C_CR2_SADD_Pos + 1)) | I2C_CR2_START);
 
-    for (uint8_t& byte : data)
+    I2cStatus status = I2cStatus::OK;
+    if (_dma_rx == nullptr)
+    {
+        for (uint8_t& byte : data)
+        {
+            // Wait for transfer
+            status = wait_data(I2C_ISR_RXNE);
+            if (status != I2cStatus::OK)
+            {
+                return status;
+            }
+
+            byte = _base_addr->RXDR;
+        }
+    }
+    else
     {
-        // Wait for transfer
-        while (!(_base_addr->ISR & I2C_ISR_RXNE))
+        // DMA keeps draining RXDR, only the NBYTES chain needs feeding
+        while (_pending > 0)
         {
-            // TODO: replace while with timeout
+            status = wait_flag(I2C_ISR_TCR);
+            if (status != I2cStatus::OK)
+            {
+                return status;
+            }
+            reload_chunk();
         }
+    }
 
-        byte = _base_addr->RXDR;
+    status = end_phase(last);
+    if (status != I2cStatus::OK)
+    {
+        return status;
     }
 
-    // Detect stop
-    while (!(_base_addr->ISR & I2C_ISR_STOPF))
+    // DMA wrote straight into data, just confirm every byte arrived
+    if (_dma_rx != nullptr && !stop_rx_dma())
     {
-        // TODO: replace while with timeout
+        return I2cStatus::BUS_ERROR;
     }
-    _base_addr->ICR |= I2C_ICR_STOPCF;
 
-    return true;
+    return I2cStatus::OK;
 }
 
-bool HwI2c::mem_write(std::span<const uint8_t> data, const uint8_t reg_addr,
-                      uint8_t dev_addr)
+I2cStatus HwI2c::read_mem(std::span<uint8_t> data, uint16_t reg_addr,
+                          uint8_t reg_len, uint8_t dev_addr, bool last)
 {
-    if (_base_addr == nullptr)
-    {
-        return false;
-    }
+    // Writing register address to write to
+    _base_addr->CR2 &= ~CR2_XFER_MASK;
+    _base_addr->CR2 |= (reg_len << I2C_CR2_NBYTES_Pos |
+                        (dev_addr << (I2C_CR2_SADD_Pos + 1)) | I2C_CR2_START);
 
-    // Check if init was called
-    if (!(_base_addr->CR1 & I2C_CR1_PE))
+    I2cStatus status = send_reg(reg_addr, reg_len);
+    if (status != I2cStatus::OK)
     {
-        return false;
+        return status;
     }
 
-    /**
-     * Setting target
-     * Checking if communication in progress
-     */
-    if (_base_addr->CR2 & I2C_CR2_START)
+    status = wait_flag(I2C_ISR_TC);
+    if (status != I2cStatus::OK)
     {
-        return false;
+        return status;
     }
 
-    // Make sure I2C bus is idle
-    if (_base_addr->ISR & I2C_ISR_BUSY)
-    {
-        return false;
-    }
+    return receive(data, dev_addr, last);
+}
 
+I2cStatus HwI2c::write_mem(std::span<const uint8_t> data, uint16_t reg_addr,
+                           uint8_t reg_len, uint8_t dev_addr, bool last)
+{
     // Configuring and initiating transfer
-    _base_addr->CR2 &=
-        ~(I2C_CR2_NBYTES | I2C_CR2_RD_WRN | I2C_CR2_SADD | I2C_CR2_AUTOEND);
-    _base_addr->CR2 |= (((data.size() + 1) << I2C_CR2_NBYTES_Pos) |
-                        (dev_addr << (I2C_CR2_SADD_Pos + 1)) | I2C_CR2_AUTOEND |
-                        I2C_CR2_START);
+    _base_addr->CR2 &= ~CR2_XFER_MASK;
+    _base_addr->CR2 |= (first_chunk(data.size() + reg_len, last) |
+                        (dev_addr << (I2C_CR2_SADD_Pos + 1)) | I2C_CR2_START);
 
     // Write register address to write to
-    while (!(_base_addr->ISR & I2C_ISR_TXIS))
+    I2cStatus status = send_reg(reg_addr, reg_len);
+    if (status != I2cStatus::OK)
     {
-        // TODO: replace while with timeout
+        return status;
     }
-    _base_addr->TXDR = reg_addr;
 
     // Writing data
-    for (const uint8_t byte : data)
+    status = send_data(data);
+    if (status != I2cStatus::OK)
     {
-        // Wait for transfer or NACK
-        while (!(_base_addr->ISR & (I2C_ISR_TXIS | I2C_ISR_NACKF)))
-        {
-            // TODO: replace while with timeout
-        }
+        return status;
+    }
 
-        if (_base_addr->ISR & I2C_ISR_NACKF)
-        {
-            _base_addr->ICR |= I2C_ICR_NACKCF;
-            return false;
-        }
+    return end_phase(last);
+}
 
-        _base_addr->TXDR = byte;
+I2cStatus HwI2c::mem_read(std::span<uint8_t> data, const uint8_t reg_addr,
+                          uint8_t dev_addr)
+{
+    const I2cStatus status = begin();
+    if (status != I2cStatus::OK)
+    {
+        return status;
     }
 
-    // Detect stop
-    while (!(_base_addr->ISR & I2C_ISR_STOPF))
+    return _trace.end(dev_addr, data.size(),
+                      read_mem(data, reg_addr, 1, dev_addr, true));
+}
+
+I2cStatus HwI2c::mem_read(std::span<uint8_t> data, const uint16_t reg_addr,
+                          uint8_t dev_addr)
+{
+    const I2cStatus status = begin();
+    if (status != I2cStatus::OK)
     {
-        // TODO: replace while with timeout
+        return status;
     }
-    _base_addr->ICR |= I2C_ICR_STOPCF;
 
-    return true;
+    return _trace.end(dev_addr, data.size(),
+                      read_mem(data, reg_addr, 2, dev_addr, true));
 }
 
-bool HwI2c::mem_write(std::span<const uint8_t> data, const uint16_t reg_addr,
-                      uint8_t dev_addr)
+I2cStatus HwI2c::mem_write(std::span<const uint8_t> data,
+                           const uint8_t reg_addr, uint8_t dev_addr)
 {
-    if (_base_addr == nullptr)
+    const I2cStatus status = begin();
+    if (status != I2cStatus::OK)
     {
-        return false;
+        return status;
     }
 
-    // Check if init was called
-    if (!(_base_addr->CR1 & I2C_CR1_PE))
+    return _trace.end(dev_addr, data.size(),
+                      write_mem(data, reg_addr, 1, dev_addr, true));
+}
+
+I2cStatus HwI2c::mem_write(std::span<const uint8_t> data,
+                           const uint16_t reg_addr, uint8_t dev_addr)
+{
+    const I2cStatus status = begin();
+    if (status != I2cStatus::OK)
     {
-        return false;
+        return status;
     }
 
-    /**
-     * Setting target
-     * Checking if communication in progress
-     */
-    if (_base_addr->CR2 & I2C_CR2_START)
+    return _trace.end(dev_addr, data.size(),
+                      write_mem(data, reg_addr, 2, dev_addr, true));
+}
+
+I2cStatus HwI2c::read(std::span<uint8_t> data, uint8_t dev_addr)
+{
+    const I2cStatus status = begin();
+    if (status != I2cStatus::OK)
     {
-        return false;
+        return status;
     }
 
-    // Make sure I2C bus is idle
-    if (_base_addr->ISR & I2C_ISR_BUSY)
+    return _trace.end(dev_addr, data.size(), receive(data, dev_addr, true));
+}
+
+I2cStatus HwI2c::write(std::span<const uint8_t> data, uint8_t dev_addr)
+{
+    const I2cStatus status = begin();
+    if (status != I2cStatus::OK)
     {
-        return false;
+        return status;
     }
 
-    // Configuring and initiating transfer
-    _base_addr->CR2 &=
-        ~(I2C_CR2_NBYTES | I2C_CR2_RD_WRN | I2C_CR2_SADD | I2C_CR2_AUTOEND);
-    _base_addr->CR2 |= (((data.size() + 2) << I2C_CR2_NBYTES_Pos) |
-                        (dev_addr << (I2C_CR2_SADD_Pos + 1)) | I2C_CR2_AUTOEND |
-                        I2C_CR2_START);
+    return _trace.end(dev_addr, data.size(),
+                      write_mem(data, 0, 0, dev_addr, true));
+}
 
-    // Write register address to write to
-    while (!(_base_addr->ISR & I2C_ISR_TXIS))
+I2cStatus HwI2c::transfer(std::span<const I2cOp> ops)
+{
+    size_t bytes = 0;
+    for (const I2cOp& op : ops)
     {
-        // TODO: replace while with timeout
+        bytes += op.rx.size() + op.tx.size();
     }
-    _base_addr->TXDR = static_cast<uint8_t>((reg_addr >> 8) & 0xFF);  // MSB
-    while (!(_base_addr->ISR & I2C_ISR_TXIS))
+
+    // Zero-length reads are skipped, the STOP goes after the last real op
+    size_t end = ops.size();
+    while (end > 0 && ops[end - 1].is_empty_read())
     {
-        // TODO: replace while with timeout
+        end--;
     }
-    _base_addr->TXDR = static_cast<uint8_t>(reg_addr & 0xFF);  // LSB
 
-    // Writing data
-    for (const uint8_t byte : data)
-    {
-        // Wait for transfer or NACK
-        while (!(_base_addr->ISR & (I2C_ISR_TXIS | I2C_ISR_NACKF)))
-        {
-            // TODO: replace while with timeout
-        }
+    // Bus ownership is checked once, every op after the first is a restart
+    I2cStatus status = begin();
 
-        if (_base_addr->ISR & I2C_ISR_NACKF)
+    for (size_t i = 0; i < end && status == I2cStatus::OK; i++)
+    {
+        const I2cOp& op = ops[i];
+        if (op.is_empty_read())
         {
-            _base_addr->ICR |= I2C_ICR_NACKCF;
-            return false;
+            continue;
         }
+        const bool last = (i + 1 == end);
 
-        _base_addr->TXDR = byte;
-    }
-
-    // Detect stop
-    while (!(_base_addr->ISR & I2C_ISR_STOPF))
-    {
-        // TODO: replace while with timeout
+        status = (op.dir == I2cOp::Dir::READ)
+                     ? read_mem(op.rx, op.reg_addr, 1, op.dev_addr, last)
+                     : write_mem(op.tx, op.reg_addr, 1, op.dev_addr, last);
     }
-    _base_addr->ICR |= I2C_ICR_STOPCF;
 
-    return true;
+    // Filed under the first target, chained ops share one bus transaction
+    return ops.empty() ? status : _trace.end(ops[0].dev_addr, bytes, status);
 }
 
-bool HwI2c::read(std::span<uint8_t> data, uint8_t dev_addr)
+I2cStatus HwI2c::mem_read_it(std::span<uint8_t> data, const uint8_t reg_addr,
+                             uint8_t dev_addr, I2cDoneCallback cb, void* ctx)
 {
-    if (_base_addr == nullptr)
+    if (data.empty())
     {
-        return false;
+        return I2cStatus::NOT_READY;
     }
 
-    // Check if init was called
-    if (!(_base_addr->CR1 & I2C_CR1_PE))
+    I2cStatus status = bus_ready();
+    if (status != I2cStatus::OK)
     {
-        return false;
+        return status;
     }
 
-    /**
-     * Setting target
-     * Checking if communication in progress
-     */
-    if (_base_addr->CR2 & I2C_CR2_START)
+    _xfer = Xfer{data.data(), nullptr,        data.size(),   0,  reg_addr,
+                 dev_addr,    XferPhase::REG, I2cStatus::OK, cb, ctx};
+    _start_tick = _now_ms();
+    _xfer_state = I2cXferState::BUSY;
+    _trace.start(_trace.now(), false);
+
+    _base_addr->ICR = I2C_ICR_NACKCF | I2C_ICR_STOPCF;
+    _base_addr->CR1 |= IT_MASK;
+
+    // Received bytes are moved by DMA, RXNE must not raise an interrupt
+    if (_dma_rx != nullptr)
     {
-        return false;
+        _base_addr->CR1 &= ~I2C_CR1_RXIE;
     }
 
-    // Make sure I2C bus is idle
-    if (_base_addr->ISR & I2C_ISR_BUSY)
+    // Register address phase, no AUTOEND so TC fires for the restart
+    _base_addr->CR2 &= ~CR2_XFER_MASK;
+    _base_addr->CR2 |= (1 << I2C_CR2_NBYTES_Pos |
+                        (dev_addr << (I2C_CR2_SADD_Pos + 1)) | I2C_CR2_START);
+
+    return I2cStatus::OK;
+}
+
+I2cStatus HwI2c::mem_write_it(std::span<const uint8_t> data,
+                              const uint8_t reg_addr, uint8_t dev_addr,
+                              I2cDoneCallback cb, void* ctx)
+{
+    I2cStatus status = bus_ready();
+    if (status != I2cStatus::OK)
     {
-        return false;
+        return status;
     }
 
-    // Configuring and initiating transfer
-    _base_addr->CR2 &=
-        ~(I2C_CR2_NBYTES | I2C_CR2_RD_WRN | I2C_CR2_SADD | I2C_CR2_AUTOEND);
-    _base_addr->CR2 |= ((data.size() << I2C_CR2_NBYTES_Pos) | I2C_CR2_RD_WRN |
-                        (dev_addr << (I2C_CR2_SADD_Pos + 1)) | I2C_CR2_AUTOEND |
-                        I2C_CR2_START);
+    _xfer = Xfer{nullptr,  data.data(),    data.size(),   0,  reg_addr,
+                 dev_addr, XferPhase::REG, I2cStatus::OK, cb, ctx};
+    _start_tick = _now_ms();
+    _xfer_state = I2cXferState::BUSY;
+    _trace.start(_trace.now(), false);
 
-    for (uint8_t& byte : data)
-    {
-        // Wait for transfer
-        while (!(_base_addr->ISR & I2C_ISR_RXNE))
-        {
-            // TODO: replace while with timeout
-        }
+    _base_addr->ICR = I2C_ICR_NACKCF | I2C_ICR_STOPCF;
+    _base_addr->CR1 |= IT_MASK;
 
-        byte = _base_addr->RXDR;
-    }
+    // Register address and data go out in a single AUTOEND transfer
+    _base_addr->CR2 &= ~CR2_XFER_MASK;
+    _base_addr->CR2 |= (first_chunk(data.size() + 1, true) |
+                        (dev_addr << (I2C_CR2_SADD_Pos + 1)) | I2C_CR2_START);
 
-    // Detect stop
-    while (!(_base_addr->ISR & I2C_ISR_STOPF))
+    return I2cStatus::OK;
+}
+
+I2cXferState HwI2c::get_xfer_state()
+{
+    // The ISR cannot see a transfer that simply stops making progress
+    if (_xfer_state == I2cXferState::BUSY && expired())
     {
-        // TODO: replace while with timeout
+        recover();
     }
-    _base_addr->ICR |= I2C_ICR_STOPCF;
 
-    return true;
+    return _xfer_state;
 }
 
-bool HwI2c::write(std::span<const uint8_t> data, uint8_t dev_addr)
+I2cStatus HwI2c::get_xfer_status() const
 {
-    if (_base_addr == nullptr)
+    return _xfer.status;
+}
+
+void HwI2c::ev_irq_handler()
+{
+    const uint32_t isr = _base_addr->ISR;
+
+    if (isr & I2C_ISR_NACKF)
     {
-        return false;
+        _base_addr->ICR = I2C_ICR_NACKCF;
+        _xfer.status = I2cStatus::NACK;
+
+        // Without AUTOEND the STOP has to be issued by hand
+        if (!(_base_addr->CR2 & I2C_CR2_AUTOEND))
+        {
+            _base_addr->CR2 |= I2C_CR2_STOP;
+        }
     }
 
-    // Check if init was called
-    if (!(_base_addr->CR1 & I2C_CR1_PE))
+    // Under DMA a chunk's last byte can show RXNE next to TCR or STOPF,
+    // it belongs to the channel
+    if ((isr & I2C_ISR_RXNE) && _dma_rx == nullptr)
     {
-        return false;
+        const uint8_t byte = _base_addr->RXDR;
+        if (_xfer.idx < _xfer.len)
+        {
+            _xfer.rx[_xfer.idx++] = byte;
+            if (_xfer.idx == _xfer.len)
+            {
+                _trace.mark(I2cTracePhase::DATA);
+            }
+        }
     }
 
-    /**
-     * Setting target
-     * Checking if communication in progress
-     */
-    if (_base_addr->CR2 & I2C_CR2_START)
+    if (isr & I2C_ISR_TXIS)
     {
-        return false;
+        if (_xfer.phase == XferPhase::REG)
+        {
+            _trace.mark(I2cTracePhase::ADDRESS);
+            _base_addr->TXDR = _xfer.reg_addr;
+            if (_xfer.tx != nullptr)
+            {
+                _xfer.phase = XferPhase::TX;
+            }
+        }
+        else if (_xfer.idx < _xfer.len)
+        {
+            _base_addr->TXDR = _xfer.tx[_xfer.idx++];
+            if (_xfer.idx == _xfer.len)
+            {
+                _trace.mark(I2cTracePhase::DATA);
+            }
+        }
     }
 
-    // Make sure I2C bus is idle
-    if (_base_addr->ISR & I2C_ISR_BUSY)
+    if ((isr & I2C_ISR_TC) && _xfer.phase == XferPhase::REG)
     {
-        return false;
+        // Register address sent, restart in read direction
+        _xfer.phase = XferPhase::RX;
+        if (_dma_rx != nullptr)
+        {
+            start_rx_dma(std::span<uint8_t>(_xfer.rx, _xfer.len), true);
+        }
+        _base_addr->CR2 &= ~CR2_XFER_MASK;
+        _base_addr->CR2 |= (first_chunk(_xfer.len, true) | I2C_CR2_RD_WRN |
+                            (_xfer.dev_addr << (I2C_CR2_SADD_Pos + 1)) |
+                            I2C_CR2_START);
     }
 
-    // Configuring and initiating transfer
-    _base_addr->CR2 &=
-        ~(I2C_CR2_NBYTES | I2C_CR2_RD_WRN | I2C_CR2_SADD | I2C_CR2_AUTOEND);
-    _base_addr->CR2 |= ((data.size() << I2C_CR2_NBYTES_Pos) |
-                        (dev_addr << (I2C_CR2_SADD_Pos + 1)) | I2C_CR2_AUTOEND |
-                        I2C_CR2_START);
+    if (isr & I2C_ISR_TCR)
+    {
+        reload_chunk();
+    }
 
-    // Write
-    for (const uint8_t byte : data)
+    if (isr & I2C_ISR_STOPF)
     {
-        // Wait for transfer or NACK
-        while (!(_base_addr->ISR & (I2C_ISR_TXIS | I2C_ISR_NACKF)))
+        _base_addr->ICR = I2C_ICR_STOPCF;
+        if (_xfer.phase == XferPhase::RX && _dma_rx != nullptr &&
+            stop_rx_dma())
         {
-            // TODO: replace while with timeout
+            _xfer.idx = _xfer.len;
+            _trace.mark(I2cTracePhase::DATA);
         }
-
-        if (_base_addr->ISR & I2C_ISR_NACKF)
+        _trace.mark(I2cTracePhase::STOP);
+        if (_xfer.status == I2cStatus::OK && _xfer.idx != _xfer.len)
         {
-            _base_addr->ICR |= I2C_ICR_NACKCF;
-            return false;
+            _xfer.status = I2cStatus::BUS_ERROR;
         }
+        finish_xfer(_xfer.status);
+    }
+}
 
-        _base_addr->TXDR = byte;
+void HwI2c::er_irq_handler()
+{
+    const uint32_t isr = _base_addr->ISR;
+
+    if (isr & ERR_MASK)
+    {
+        _base_addr->ICR = I2C_ICR_BERRCF | I2C_ICR_ARLOCF | I2C_ICR_OVRCF |
+                          I2C_ICR_TIMOUTCF;
+        finish_xfer((isr & I2C_ISR_TIMEOUT) ? I2cStatus::TIMEOUT
+                                            : I2cStatus::BUS_ERROR);
     }
+}
 
-    // Detect stop
-    while (!(_base_addr->ISR & I2C_ISR_STOPF))
+void HwI2c::dma_irq_handler()
+{
+    if (_dma_rx == nullptr)
     {
-        // TODO: replace while with timeout
+        return;
     }
-    _base_addr->ICR |= I2C_ICR_STOPCF;
 
-    return true;
+    if (DMA1->ISR & (DMA_ISR_TEIF1 << _dma_rx_shift))
+    {
+        // Bus is left stretched waiting on RXDR, a PE cycle releases it
+        stop_rx_dma();
+        _base_addr->CR1 &= ~I2C_CR1_PE;
+        _base_addr->CR1 |= I2C_CR1_PE;
+        if (_xfer_state == I2cXferState::BUSY)
+        {
+            finish_xfer(I2cStatus::BUS_ERROR);
+        }
+        return;
+    }
+
+    // Completion is signalled by STOPF, only acknowledge the channel here
+    DMA1->IFCR = (DMA_IFCR_CTCIF1 | DMA_IFCR_CHTIF1) << _dma_rx_shift;
+}
+
+void HwI2c::finish_xfer(I2cStatus status)
+{
+    _base_addr->CR1 &= ~IT_MASK;
+    if (_dma_rx != nullptr && (_base_addr->CR1 & I2C_CR1_RXDMAEN))
+    {
+        stop_rx_dma();
+    }
+
+    _xfer.status = status;
+    _xfer_state = (status == I2cStatus::OK) ? I2cXferState::DONE
+                                            : I2cXferState::ERROR;
+    _trace.end(_xfer.dev_addr, _xfer.len, status);
+
+    if (_xfer.cb != nullptr)
+    {
+        _xfer.cb(_xfer.ctx, status);
+    }
 }
 
 }  // namespace Stml4
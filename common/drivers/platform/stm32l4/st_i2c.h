@@ -9,6 +9,9 @@
 
 #include <array>
 #include "i2c.h"
+#include "st_gpio.h"
+#include "st_i2c_timing.h"
+#include "st_i2c_trace.h"
 #include "stm32l476xx.h"
 
 namespace LBR
@@ -18,13 +21,53 @@ namespace Stml4
 
 /**
  * @brief Collection of base address and timing register info
+ * @note timingr comes from compute_timingr() for the I2C kernel clock (PCLK1)
+ *       or from HwClock::get_timingR()
+ * @note use_dma moves received bytes with the instance's DMA1 RX channel
+ *       (I2C1: ch7, I2C2: ch5, I2C3: ch3) instead of a per-byte RXDR loop
+ * @note timeout_ms bounds every blocking call and *_it transfer, measured
+ *       on now_ms
+ * @note scl/sda are the AF pin configs, optional; when given, recover()
+ *       clocks a stuck slave free through them before re-initializing
+ * @note now_ms is required and must already be counting, e.g. HAL_GetTick
+ *       with SysTick running; a frozen clock means no call ever times out
  */
 struct StI2cParams
 {
     I2C_TypeDef* base_addr;
     uint32_t timingr;
+    bool use_dma{false};
+    uint32_t timeout_ms{10};
+    const StGpioParams* scl{nullptr};
+    const StGpioParams* sda{nullptr};
+    uint32_t (*now_ms)(){nullptr};
 };
 
+/**
+ * @brief State of an interrupt-driven transfer
+ */
+enum class I2cXferState : uint8_t
+{
+    IDLE = 0,
+    BUSY,
+    DONE,
+    ERROR
+};
+
+/**
+ * @brief Completion callback for interrupt-driven transfers
+ * @note Called from the I2C interrupt, keep it short
+ * @param ctx context pointer handed to the *_it call
+ * @param status I2cStatus::OK if the transfer completed without error
+ */
+using I2cDoneCallback = void (*)(void* ctx, I2cStatus status);
+
+/**
+ * @class HwI2c
+ * @brief Register-level I2C master
+ * @note Blocking calls return within timeout_ms plus one recover() in the
+ *       worst case; a timeout or bus error always ends in a recover()
+ */
 class HwI2c : public I2c
 {
 
@@ -39,20 +82,159 @@ public:
      */
     bool init();
 
-    bool mem_read(std::span<uint8_t> data, const uint8_t reg_addr,
-                  uint8_t dev_addr) override;
-    bool mem_read(std::span<uint8_t> data, const uint16_t reg_addr,
-                  uint8_t dev_addr) override;
-    bool mem_write(std::span<const uint8_t> data, const uint8_t reg_addr,
-                   uint8_t dev_addr) override;
-    bool mem_write(std::span<const uint8_t> data, const uint16_t reg_addr,
-                   uint8_t dev_addr) override;
-    bool read(std::span<uint8_t> data, uint8_t dev_addr) override;
-    bool write(std::span<const uint8_t> data, uint8_t dev_addr) override;
+    /**
+     * @brief Resets the peripheral, clocks out a stuck slave if the pins
+     *        are known, then re-runs init()
+     * 
+     * @note Aborts any interrupt-driven transfer with I2cStatus::TIMEOUT
+     * @return I2cStatus::OK if the peripheral came back
+     */
+    I2cStatus recover();
+
+    I2cStatus mem_read(std::span<uint8_t> data, const uint8_t reg_addr,
+                       uint8_t dev_addr) override;
+    I2cStatus mem_read(std::span<uint8_t> data, const uint16_t reg_addr,
+                       uint8_t dev_addr) override;
+    I2cStatus mem_write(std::span<const uint8_t> data, const uint8_t reg_addr,
+                        uint8_t dev_addr) override;
+    I2cStatus mem_write(std::span<const uint8_t> data,
+                        const uint16_t reg_addr, uint8_t dev_addr) override;
+    I2cStatus read(std::span<uint8_t> data, uint8_t dev_addr) override;
+    I2cStatus write(std::span<const uint8_t> data, uint8_t dev_addr) override;
+    I2cStatus transfer(std::span<const I2cOp> ops) override;
+
+    /**
+     * @brief Starts an interrupt-driven read from a device with 8-bit memory
+     *        addresses and returns without waiting for the bus
+     * 
+     * @param data block of memory to read into, must stay valid until done
+     * @param reg_addr data register of external device to read from
+     * @param dev_addr address of target device
+     * @param cb optional callback run from the ISR when the transfer ends
+     * @param ctx context pointer handed back to cb
+     * @return I2cStatus::OK if the transfer was started
+     */
+    I2cStatus mem_read_it(std::span<uint8_t> data, const uint8_t reg_addr,
+                          uint8_t dev_addr, I2cDoneCallback cb = nullptr,
+                          void* ctx = nullptr);
+
+    /**
+     * @brief Starts an interrupt-driven write to a device with 8-bit memory
+     *        addresses and returns without waiting for the bus
+     * 
+     * @param data block of memory to write, must stay valid until done
+     * @param reg_addr data register of external device to write to
+     * @param dev_addr address of target device
+     * @param cb optional callback run from the ISR when the transfer ends
+     * @param ctx context pointer handed back to cb
+     * @return I2cStatus::OK if the transfer was started
+     */
+    I2cStatus mem_write_it(std::span<const uint8_t> data,
+                           const uint8_t reg_addr, uint8_t dev_addr,
+                           I2cDoneCallback cb = nullptr, void* ctx = nullptr);
+
+    /**
+     * @brief Pollable state of the last interrupt-driven transfer
+     * @note A transfer still busy past timeout_ms is aborted through
+     *       recover() here
+     */
+    I2cXferState get_xfer_state();
+
+    /**
+     * @brief Result of the last interrupt-driven transfer
+     */
+    I2cStatus get_xfer_status() const;
+
+    /**
+     * @brief Event interrupt handler, call from I2Cx_EV_IRQHandler
+     */
+    void ev_irq_handler();
+
+    /**
+     * @brief Error interrupt handler, call from I2Cx_ER_IRQHandler
+     */
+    void er_irq_handler();
+
+    /**
+     * @brief RX DMA channel handler, call from DMA1_ChannelX_IRQHandler
+     */
+    void dma_irq_handler();
+
+    /**
+     * @brief Transaction statistics, empty unless built with LBR_I2C_TRACE
+     */
+    const I2cTrace& trace() const
+    {
+        return _trace;
+    }
+
+    I2cTrace& trace()
+    {
+        return _trace;
+    }
 
 private:
+    enum class XferPhase : uint8_t
+    {
+        REG,
+        RX,
+        TX
+    };
+
+    /**
+     * @brief Bookkeeping for the transfer currently driven by the ISR
+     */
+    struct Xfer
+    {
+        uint8_t* rx;
+        const uint8_t* tx;
+        size_t len;
+        size_t idx;
+        uint8_t reg_addr;
+        uint8_t dev_addr;
+        XferPhase phase;
+        I2cStatus status;
+        I2cDoneCallback cb;
+        void* ctx;
+    };
+
+    I2cStatus bus_ready() const;
+    I2cStatus begin();
+    bool expired() const;
+    I2cStatus wait_flag(uint32_t flag);
+    I2cStatus handle_nack();
+    uint32_t first_chunk(size_t len, bool last);
+    uint32_t chunk_end() const;
+    void reload_chunk();
+    I2cStatus wait_data(uint32_t flag);
+    void clock_out_bus();
+    I2cStatus send_reg(uint16_t reg_addr, uint8_t reg_len);
+    I2cStatus send_data(std::span<const uint8_t> data);
+    I2cStatus end_phase(bool last);
+    I2cStatus receive(std::span<uint8_t> data, uint8_t dev_addr, bool last);
+    I2cStatus read_mem(std::span<uint8_t> data, uint16_t reg_addr,
+                       uint8_t reg_len, uint8_t dev_addr, bool last);
+    I2cStatus write_mem(std::span<const uint8_t> data, uint16_t reg_addr,
+                        uint8_t reg_len, uint8_t dev_addr, bool last);
+    void start_rx_dma(std::span<uint8_t> data, bool irq);
+    bool stop_rx_dma();
+    void finish_xfer(I2cStatus status);
+
     I2C_TypeDef* _base_addr;
     uint32_t _timingr;
+    bool _use_dma;
+    uint32_t _timeout_ms;
+    const StGpioParams* _scl;
+    const StGpioParams* _sda;
+    uint32_t (*_now_ms)();
+    uint32_t _start_tick{0};
+    size_t _pending{0};  // bytes of the phase not yet loaded into NBYTES
+    bool _pending_last{false};
+    DMA_Channel_TypeDef* _dma_rx{nullptr};
+    uint32_t _dma_rx_shift{0};
+    Xfer _xfer{};
+    volatile I2cXferState _xfer_state{I2cXferState::IDLE};
+    [[no_unique_address]] I2cTrace _trace{};
 };
 }  // namespace Stml4
 }  // namespace LBR
@@ -0,0 +1,213 @@
+/**
+ * @file st_i2c_timing.h
+ * @brief Compile-time TIMINGR solver for the STM32L4 I2C peripheral
+ * @date 10/17/2026
+ * @note Follows the method of AN4235 / RM0351 section 39.4.9, assumes the
+ *       analog filter is on (ANFOFF = 0) and the digital filter is off
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace LBR
+{
+namespace Stml4
+{
+
+/**
+ * @brief I2C bus speed modes
+ */
+enum class I2cSpeed : uint32_t
+{
+    STANDARD = 100'000,
+    FAST = 400'000,
+    FAST_PLUS = 1'000'000
+};
+
+/**
+ * @brief Timing limits of one bus speed mode, from the I2C specification
+ * @note All values are in nanoseconds
+ */
+struct I2cBusSpec
+{
+    uint32_t hddat_min;  // data hold time
+    uint32_t vddat_max;  // data valid time
+    uint32_t sudat_min;  // data setup time
+    uint32_t low_min;    // SCL low period
+    uint32_t high_min;   // SCL high period
+};
+
+constexpr I2cBusSpec get_bus_spec(I2cSpeed speed)
+{
+    switch (speed)
+    {
+        case I2cSpeed::FAST:
+            return {0, 900, 100, 1300, 600};
+        case I2cSpeed::FAST_PLUS:
+            return {0, 450, 50, 500, 260};
+        case I2cSpeed::STANDARD:
+        default:
+            return {0, 3450, 250, 4700, 4000};
+    }
+}
+
+namespace detail
+{
+// Analog filter delay range (datasheet t_AF), in ps
+inline constexpr int64_t AF_MIN_PS = 50'000;
+inline constexpr int64_t AF_MAX_PS = 260'000;
+
+constexpr int64_t abs_diff(int64_t a, int64_t b)
+{
+    return (a > b) ? (a - b) : (b - a);
+}
+
+constexpr uint32_t pack(uint32_t presc, uint32_t scldel, uint32_t sdadel,
+                        uint32_t sclh, uint32_t scll)
+{
+    return (presc << 28) | (scldel << 20) | (sdadel << 16) | (sclh << 8) |
+           scll;
+}
+}  // namespace detail
+
+/**
+ * @brief Checks a TIMINGR value against the bus spec
+ * 
+ * @param timingr value to check
+ * @param clk_hz I2C kernel clock
+ * @param speed target bus speed
+ * @param rise_ns SCL/SDA rise time of the board
+ * @param fall_ns SCL/SDA fall time of the board
+ * @return true if the resulting bus meets the spec and runs between 80% and
+ *         100% of the target speed
+ */
+constexpr bool check_timingr(uint32_t timingr, uint32_t clk_hz, I2cSpeed speed,
+                             uint32_t rise_ns, uint32_t fall_ns)
+{
+    using namespace detail;
+
+    const I2cBusSpec spec = get_bus_spec(speed);
+    const int64_t t_clk = 1'000'000'000'000LL / clk_hz;
+    const int64_t t_rise = rise_ns * 1000LL;
+    const int64_t t_fall = fall_ns * 1000LL;
+
+    const int64_t presc = ((timingr >> 28) & 0xF) + 1;
+    const int64_t scldel = ((timingr >> 20) & 0xF) + 1;
+    const int64_t sdadel = (timingr >> 16) & 0xF;
+    const int64_t sclh = ((timingr >> 8) & 0xFF) + 1;
+    const int64_t scll = (timingr & 0xFF) + 1;
+
+    const int64_t t_presc = presc * t_clk;
+    const int64_t t_sync = AF_MIN_PS + 2 * t_clk;
+    const int64_t t_low = scll * t_presc + t_sync;
+    const int64_t t_high = sclh * t_presc + t_sync;
+    const int64_t t_scl = t_low + t_high + t_rise + t_fall;
+
+    const int64_t sdadel_min =
+        spec.hddat_min * 1000LL + t_fall - AF_MIN_PS - 3 * t_clk;
+    const int64_t sdadel_max =
+        spec.vddat_max * 1000LL - t_rise - AF_MAX_PS - 4 * t_clk;
+    const int64_t t_sdadel = sdadel * t_presc + t_clk;
+    const int64_t t_scldel = scldel * t_presc;
+
+    const int64_t rate = static_cast<int64_t>(speed);
+    const int64_t t_bus_min = 1'000'000'000'000LL / rate;
+    const int64_t t_bus_max = t_bus_min * 10 / 8;
+
+    return t_low >= spec.low_min * 1000LL && t_high >= spec.high_min * 1000LL &&
+           t_high > t_clk && t_scl >= t_bus_min && t_scl <= t_bus_max &&
+           t_sdadel >= sdadel_min && t_sdadel <= sdadel_max &&
+           t_scldel >= t_rise + spec.sudat_min * 1000LL;
+}
+
+/**
+ * @brief Solves PRESC/SCLDEL/SDADEL/SCLH/SCLL for a kernel clock and speed
+ * 
+ * @param clk_hz I2C kernel clock
+ * @param speed target bus speed
+ * @param rise_ns SCL/SDA rise time of the board
+ * @param fall_ns SCL/SDA fall time of the board
+ * @return TIMINGR value closest to the target speed, 0 if none exists
+ */
+constexpr uint32_t compute_timingr(uint32_t clk_hz, I2cSpeed speed,
+                                   uint32_t rise_ns = 100,
+                                   uint32_t fall_ns = 100)
+{
+    using namespace detail;
+
+    const I2cBusSpec spec = get_bus_spec(speed);
+    const int64_t t_clk = 1'000'000'000'000LL / clk_hz;
+    const int64_t t_rise = rise_ns * 1000LL;
+    const int64_t t_fall = fall_ns * 1000LL;
+    const int64_t t_bus = 1'000'000'000'000LL / static_cast<int64_t>(speed);
+    const int64_t t_sync = AF_MIN_PS + 2 * t_clk;
+
+    int64_t sdadel_min =
+        spec.hddat_min * 1000LL + t_fall - AF_MIN_PS - 3 * t_clk;
+    int64_t sdadel_max =
+        spec.vddat_max * 1000LL - t_rise - AF_MAX_PS - 4 * t_clk;
+    sdadel_min = (sdadel_min < 0) ? 0 : sdadel_min;
+    sdadel_max = (sdadel_max < 0) ? 0 : sdadel_max;
+    const int64_t scldel_min = t_rise + spec.sudat_min * 1000LL;
+
+    uint32_t best = 0;
+    int64_t best_error = t_bus;
+
+    for (uint32_t presc = 0; presc < 16; presc++)
+    {
+        const int64_t t_presc = (presc + 1) * t_clk;
+
+        // Smallest data delays that satisfy setup and hold at this prescaler
+        uint32_t scldel = 0;
+        while (scldel < 16 && (scldel + 1) * t_presc < scldel_min)
+        {
+            scldel++;
+        }
+        uint32_t sdadel = 0;
+        while (sdadel < 16 && sdadel * t_presc + t_clk < sdadel_min)
+        {
+            sdadel++;
+        }
+        if (scldel > 15 || sdadel > 15 ||
+            sdadel * t_presc + t_clk > sdadel_max)
+        {
+            continue;
+        }
+
+        for (uint32_t scll = 0; scll < 256; scll++)
+        {
+            const int64_t t_low = (scll + 1) * t_presc + t_sync;
+            if (t_low < spec.low_min * 1000LL)
+            {
+                continue;
+            }
+
+            // SCLH that lands the period closest to the target speed
+            const int64_t t_high_want = t_bus - t_low - t_rise - t_fall;
+            int64_t sclh = (t_high_want - t_sync + t_presc / 2) / t_presc - 1;
+            sclh = (sclh < 0) ? 0 : ((sclh > 255) ? 255 : sclh);
+
+            const uint32_t timingr =
+                pack(presc, scldel, sdadel, static_cast<uint32_t>(sclh), scll);
+            if (!check_timingr(timingr, clk_hz, speed, rise_ns, fall_ns))
+            {
+                continue;
+            }
+
+            const int64_t t_high = (sclh + 1) * t_presc + t_sync;
+            const int64_t error =
+                abs_diff(t_low + t_high + t_rise + t_fall, t_bus);
+            if (error < best_error)
+            {
+                best_error = error;
+                best = timingr;
+            }
+        }
+    }
+
+    return best;
+}
+
+}  // namespace Stml4
+}  // namespace LBR
@@ -0,0 +1,327 @@
+/**
+ * @file st_i2c_trace.h
+ * @brief Optional DWT-timed transaction tracer for HwI2c
+ * @date 10/17/2026
+ * @note Only active when built with LBR_I2C_TRACE, otherwise I2cTrace is an
+ *       empty class whose calls inline away
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include "i2c.h"
+#include "stm32l476xx.h"
+
+#ifdef LBR_I2C_TRACE
+#include <algorithm>
+#include <bit>
+#endif
+
+namespace LBR
+{
+namespace Stml4
+{
+
+/**
+ * @brief Points of a transaction that get a timestamp
+ */
+enum class I2cTracePhase : uint8_t
+{
+    ADDRESS,  ///< Target acknowledged its address
+    DATA,     ///< Last data byte moved
+    STOP      ///< STOP detected, bus released
+};
+
+/**
+ * @brief Timeline of one transaction
+ * @note Phase times are DWT cycles after start, 0 if never reached
+ */
+struct I2cTraceRecord
+{
+    uint32_t start;  ///< DWT cycle count when the caller asked for the bus
+    uint32_t address;
+    uint32_t data;
+    uint32_t stop;
+    uint16_t bytes;
+    uint8_t dev_addr;
+    I2cStatus status;
+};
+
+static constexpr size_t I2C_TRACE_BUCKETS = 16;
+
+/**
+ * @brief Aggregate of every transaction to one target
+ * @note hist[i] counts transactions that took [2^i, 2^(i+1)) us, bucket 0
+ *       also holds anything under 1 us
+ */
+struct I2cTraceDevice
+{
+    uint8_t dev_addr;
+    uint32_t count;
+    uint32_t bytes;
+    uint32_t nacks;
+    uint32_t timeouts;
+    uint32_t bus_errors;
+    uint32_t retries;  ///< Transactions that found the bus busy first
+    uint64_t total_cycles;
+    uint32_t max_cycles;
+    std::array<uint32_t, I2C_TRACE_BUCKETS> hist;
+};
+
+#ifdef LBR_I2C_TRACE
+
+/**
+ * @class I2cTrace
+ * @brief Fixed-size RAM table of per-device latency statistics plus a ring
+ *        of the latest transaction timelines
+ */
+class I2cTrace
+{
+public:
+    static constexpr bool ENABLED = true;
+    static constexpr size_t MAX_DEVICES = 4;
+    static constexpr size_t NUM_RECORDS = 32;
+
+    /**
+     * @brief Starts the DWT cycle counter, leaves a running count alone
+     */
+    void init()
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+
+    static uint32_t now()
+    {
+        return DWT->CYCCNT;
+    }
+
+    /**
+     * @brief Opens a transaction once the bus is owned
+     *
+     * @param start cycle count from when the bus was first requested
+     * @param retried whether the bus was found busy before
+     */
+    void start(uint32_t start, bool retried)
+    {
+        _cur = I2cTraceRecord{start, 0, 0, 0, 0, 0, I2cStatus::OK};
+        _retried = retried;
+        _open = true;
+    }
+
+    void mark(I2cTracePhase phase)
+    {
+        if (!_open)
+        {
+            return;
+        }
+
+        const uint32_t delta = std::max<uint32_t>(now() - _cur.start, 1);
+        switch (phase)
+        {
+            case I2cTracePhase::ADDRESS:
+                // Later phases of a chained transfer keep the first one
+                if (_cur.address == 0)
+                {
+                    _cur.address = delta;
+                }
+                break;
+            case I2cTracePhase::DATA:
+                _cur.data = delta;
+                break;
+            case I2cTracePhase::STOP:
+                _cur.stop = delta;
+                break;
+        }
+    }
+
+    /**
+     * @brief Closes the open transaction and files it
+     * @return status, untouched, so calls can wrap a return expression
+     */
+    I2cStatus end(uint8_t dev_addr, size_t bytes, I2cStatus status)
+    {
+        if (!_open)
+        {
+            return status;
+        }
+        _open = false;
+
+        const uint32_t cycles = now() - _cur.start;
+        _cur.dev_addr = dev_addr;
+        _cur.bytes = static_cast<uint16_t>(std::min<size_t>(bytes, 0xFFFF));
+        _cur.status = status;
+        _records[_next_record] = _cur;
+        _next_record = (_next_record + 1) % NUM_RECORDS;
+        _num_records = std::min(_num_records + 1, NUM_RECORDS);
+
+        I2cTraceDevice* dev = slot(dev_addr);
+        if (dev == nullptr)
+        {
+            _dropped++;
+            return status;
+        }
+
+        dev->count++;
+        dev->bytes += bytes;
+        dev->retries += _retried ? 1 : 0;
+        dev->nacks += (status == I2cStatus::NACK) ? 1 : 0;
+        dev->timeouts += (status == I2cStatus::TIMEOUT) ? 1 : 0;
+        dev->bus_errors += (status == I2cStatus::BUS_ERROR) ? 1 : 0;
+        dev->total_cycles += cycles;
+        dev->max_cycles = std::max(dev->max_cycles, cycles);
+
+        const uint32_t us = cycles_to_us(cycles);
+        const size_t bucket = (us > 1) ? std::bit_width(us) - 1 : 0;
+        dev->hist[std::min(bucket, I2C_TRACE_BUCKETS - 1)]++;
+        return status;
+    }
+
+    /**
+     * @return statistics of a target, nullptr if it was never seen
+     */
+    const I2cTraceDevice* find(uint8_t dev_addr) const
+    {
+        for (size_t i = 0; i < _num_devices; i++)
+        {
+            if (_devices[i].dev_addr == dev_addr)
+            {
+                return &_devices[i];
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @return latest timelines, a ring with the oldest entry at next_record()
+     *         once full
+     */
+    std::span<const I2cTraceRecord> records() const
+    {
+        return std::span<const I2cTraceRecord>(_records.data(), _num_records);
+    }
+
+    size_t next_record() const
+    {
+        return _next_record;
+    }
+
+    /**
+     * @return transactions not filed because the device table was full
+     */
+    uint32_t dropped() const
+    {
+        return _dropped;
+    }
+
+    void reset()
+    {
+        _devices = {};
+        _num_devices = 0;
+        _num_records = 0;
+        _next_record = 0;
+        _dropped = 0;
+    }
+
+    /**
+     * @brief Converts with the current core clock, so numbers from different
+     *        HwClock configurations compare directly
+     */
+    static uint32_t cycles_to_us(uint32_t cycles)
+    {
+        const uint32_t cycles_per_us = SystemCoreClock / 1'000'000;
+        return (cycles_per_us > 0) ? cycles / cycles_per_us : 0;
+    }
+
+private:
+    I2cTraceDevice* slot(uint8_t dev_addr)
+    {
+        for (size_t i = 0; i < _num_devices; i++)
+        {
+            if (_devices[i].dev_addr == dev_addr)
+            {
+                return &_devices[i];
+            }
+        }
+        if (_num_devices == MAX_DEVICES)
+        {
+            return nullptr;
+        }
+        I2cTraceDevice& dev = _devices[_num_devices++];
+        dev.dev_addr = dev_addr;
+        return &dev;
+    }
+
+    std::array<I2cTraceDevice, MAX_DEVICES> _devices{};
+    size_t _num_devices{0};
+    std::array<I2cTraceRecord, NUM_RECORDS> _records{};
+    size_t _num_records{0};
+    size_t _next_record{0};
+    uint32_t _dropped{0};
+    I2cTraceRecord _cur{};
+    bool _retried{false};
+    bool _open{false};
+};
+
+#else
+
+/**
+ * @class I2cTrace
+ * @brief Disabled tracer, same interface, no storage and no code
+ */
+class I2cTrace
+{
+public:
+    static constexpr bool ENABLED = false;
+
+    void init() {}
+
+    static constexpr uint32_t now()
+    {
+        return 0;
+    }
+
+    void start(uint32_t, bool) {}
+
+    void mark(I2cTracePhase) {}
+
+    I2cStatus end(uint8_t, size_t, I2cStatus status)
+    {
+        return status;
+    }
+
+    const I2cTraceDevice* find(uint8_t) const
+    {
+        return nullptr;
+    }
+
+    std::span<const I2cTraceRecord> records() const
+    {
+        return {};
+    }
+
+    size_t next_record() const
+    {
+        return 0;
+    }
+
+    uint32_t dropped() const
+    {
+        return 0;
+    }
+
+    void reset() {}
+
+    static constexpr uint32_t cycles_to_us(uint32_t)
+    {
+        return 0;
+    }
+};
+
+#endif
+
+}  // namespace Stml4
+}  // namespace LBR
@@ -0,0 +1,117 @@
+#include "st_quad_decoder.h"
+#include "stm32l4xx_hal.h"
+
+namespace LBR
+{
+namespace Stml4
+{
+
+/* Count change indexed by previous state << 2 | new state, states as B A.
+ * Forward runs 00 -> 01 -> 11 -> 10 -> 00. */
+static constexpr int8_t TRANSITIONS[16] = {
+    // to 00  01  10  11
+    0, 1, -1, 0,   // from 00
+    -1, 0, 0, 1,   // from 01
+    1, 0, 0, -1,   // from 10
+    0, -1, 1, 0,   // from 11
+};
+
+// Both pins changed at once: 00 <-> 11 and 01 <-> 10
+static constexpr uint16_t ILLEGAL_TRANSITIONS =
+    (1u << 0b0011) | (1u << 0b0110) | (1u << 0b1001) | (1u << 0b1100);
+
+static void decoder_edge(void* ctx)
+{
+    static_cast<HwQuadDecoder*>(ctx)->irq_handler();
+}
+
+HwQuadDecoder::HwQuadDecoder(const StQuadDecoderParams& params)
+    : gpio_a_(params.pin_a_params),
+      gpio_b_(params.pin_b_params),
+      port_a_(params.pin_a_params.base_addr),
+      port_b_(params.pin_b_params.base_addr),
+      pin_a_(params.pin_a_params.pin_num),
+      pin_b_(params.pin_b_params.pin_num),
+      irq_priority_(params.irq_priority)
+{
+}
+
+bool HwQuadDecoder::init()
+{
+    if (!gpio_a_.init() || !gpio_b_.init())
+    {
+        _status = 1;
+        return false;
+    }
+
+    // Edge timestamps, leaves a running cycle counter alone
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    timestamp_hz_ = HAL_RCC_GetHCLKFreq();
+
+    state_ = read_state();
+    if (!gpio_a_.enable_irq(GpioEdge::BOTH, decoder_edge, this,
+                            irq_priority_) ||
+        !gpio_b_.enable_irq(GpioEdge::BOTH, decoder_edge, this,
+                            irq_priority_))
+    {
+        gpio_a_.disable_irq();
+        _status = 1;
+        return false;
+    }
+    _status = 0;
+    return true;
+}
+
+int HwQuadDecoder::getTicks() const
+{
+    return ticks_.load(std::memory_order_relaxed);
+}
+
+int HwQuadDecoder::getStatus() const
+{
+    return _status;
+}
+
+bool HwQuadDecoder::getEdge(EncoderEdge& edge) const
+{
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    edge = EncoderEdge{edge_ticks_, edge_time_, DWT->CYCCNT};
+    const bool valid = edge_valid_;
+    __set_PRIMASK(primask);
+    return valid;
+}
+
+void HwQuadDecoder::irq_handler()
+{
+    const uint32_t now = DWT->CYCCNT;
+    const uint32_t state = read_state();
+    const uint32_t transition = (state_ << 2) | state;
+    state_ = state;
+
+    illegal_.store(illegal_.load(std::memory_order_relaxed) +
+                       ((ILLEGAL_TRANSITIONS >> transition) & 1u),
+                   std::memory_order_relaxed);
+    const int32_t delta = TRANSITIONS[transition];
+    if (delta == 0)
+    {
+        // Bounce back to the same state, or a missed edge
+        return;
+    }
+    const int32_t ticks = ticks_.load(std::memory_order_relaxed) + delta;
+    ticks_.store(ticks, std::memory_order_relaxed);
+    edge_ticks_ = ticks;
+    edge_time_ = now;
+    edge_valid_ = true;
+}
+
+uint32_t HwQuadDecoder::read_state() const
+{
+    const uint32_t a = (port_a_->IDR >> pin_a_) & 1u;
+    const uint32_t b = (port_b_->IDR >> pin_b_) & 1u;
+    return a | (b << 1);
+}
+
+}  // namespace Stml4
+}  // namespace LBR
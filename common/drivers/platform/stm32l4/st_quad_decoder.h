@@ -0,0 +1,96 @@
+/**
+ * @file st_quad_decoder.h
+ * @brief Quadrature decoding in software on EXTI pins for the stml4
+ * @date 10/17/2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include "encoder.h"
+#include "st_gpio.h"
+
+namespace LBR
+{
+namespace Stml4
+{
+
+struct StQuadDecoderParams
+{
+    StGpioParams pin_a_params;
+    StGpioParams pin_b_params;
+    uint32_t irq_priority{0};  ///< NVIC priority of both EXTI lines
+};
+
+/**
+ * @class HwQuadDecoder
+ * @brief Quadrature encoder on any two input pins, counted on every edge
+ * @details For encoder pins without a timer encoder mode, see HwEncoder
+ *          otherwise. Both edges of both pins interrupt, and the handler
+ *          looks the previous and new A/B state up in a 16-entry table.
+ *          A transition where both pins changed means an edge was missed,
+ *          it is counted instead of guessed. Each counted edge is stamped
+ *          with the DWT cycle counter for getEdge().
+ * @note The A and B lines must not share an EXTI line with another pin,
+ *       and the board must route both EXTI handlers to
+ *       HwGpio::exti_irq_handler(). getEdge() must not run at a higher
+ *       priority than irq_priority.
+ */
+class HwQuadDecoder : public Encoder
+{
+public:
+    explicit HwQuadDecoder(const StQuadDecoderParams& params);
+
+    /**
+     * @brief Initializes both pins and enables their interrupts
+     * @return true if successful, false if a pin or EXTI line failed
+     */
+    bool init();
+
+    int getTicks() const override;
+    int getStatus() const override;
+    bool getEdge(EncoderEdge& edge) const override;
+    uint32_t getTimestampHz() const override
+    {
+        return timestamp_hz_;
+    }
+
+    /**
+     * @brief Transitions that skipped a state, each one lost a count
+     */
+    uint32_t illegal_transitions() const
+    {
+        return illegal_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Decodes one edge, init() hooks it to both pins' EXTI lines
+     */
+    void irq_handler();
+
+private:
+    uint32_t read_state() const;
+
+    HwGpio gpio_a_;
+    HwGpio gpio_b_;
+    GPIO_TypeDef* const port_a_;
+    GPIO_TypeDef* const port_b_;
+    const uint8_t pin_a_;
+    const uint8_t pin_b_;
+    const uint32_t irq_priority_;
+    uint32_t timestamp_hz_{0};
+
+    // Written by irq_handler() only
+    uint32_t state_{0};  ///< Last A/B levels, A in bit 0 and B in bit 1
+    std::atomic<int32_t> ticks_{0};
+    std::atomic<uint32_t> illegal_{0};
+    int edge_ticks_{0};
+    uint32_t edge_time_{0};
+    bool edge_valid_{false};
+
+    int _status{0};
+};
+
+}  // namespace Stml4
+}  // namespace LBR
@@ -2,8 +2,9 @@
 
 extern "C"
 {
-    /* Needs to be defined or else we will never timout. */
-    void SysTick_Handler()
+    /* Needs to be defined or else we will never timout. Weak so a board that
+     * defines its own handler can still link HwClock in. */
+    __weak void SysTick_Handler()
     {
         HAL_IncTick();
     }
@@ -27,11 +28,53 @@ extern "C"
 namespace LBR::Stml4
 {
 
-static constexpr uint32_t YshiVal{
-    0x10909CEC}; /* Idk where this comes from but it works. */
-static constexpr uint32_t timingR_4Mhz{0x00100D14};
-static constexpr uint32_t timingR_80Mhz{0x10D19CE4};
-static constexpr uint32_t timingR_64Mhz{0x10B17D85};
+/* Reference values generated by cubeMX (Standard mode, 100ns rise/fall), kept
+ * to check the solver against. The old 64Mhz value (0x10B17D85) is not listed
+ * since its SCL low period is under the 4.7us Standard mode minimum. */
+static_assert(check_timingr(0x00100D14, 4'000'000, I2cSpeed::STANDARD, 100, 100));
+static_assert(check_timingr(0x10D19CE4, 80'000'000, I2cSpeed::STANDARD, 100,
+                            100));
+
+/**
+ * @brief TIMINGR values per bus speed for one system clock
+ */
+struct I2cTimings
+{
+    uint32_t standard;
+    uint32_t fast;
+    uint32_t fast_plus;
+
+    constexpr uint32_t get(I2cSpeed speed) const
+    {
+        switch (speed)
+        {
+            case I2cSpeed::FAST:
+                return fast;
+            case I2cSpeed::FAST_PLUS:
+                return fast_plus;
+            case I2cSpeed::STANDARD:
+            default:
+                return standard;
+        }
+    }
+};
+
+static constexpr I2cTimings make_timings(uint32_t clk_hz)
+{
+    return {compute_timingr(clk_hz, I2cSpeed::STANDARD),
+            compute_timingr(clk_hz, I2cSpeed::FAST),
+            compute_timingr(clk_hz, I2cSpeed::FAST_PLUS)};
+}
+
+static constexpr I2cTimings timingR_4Mhz{make_timings(4'000'000)};
+static constexpr I2cTimings timingR_80Mhz{make_timings(80'000'000)};
+static constexpr I2cTimings timingR_64Mhz{make_timings(64'000'000)};
+
+/* 0 marks unsupported: the solver needs about 9.5Mhz for Fast mode and 56Mhz
+ * for Fast mode plus, so the 4Mhz default only reaches Standard mode */
+static_assert(timingR_4Mhz.standard != 0);
+static_assert(timingR_4Mhz.fast == 0 && timingR_4Mhz.fast_plus == 0);
+static_assert(timingR_80Mhz.fast_plus != 0 && timingR_64Mhz.fast_plus != 0);
 
 /**
  * @brief configures high speed external clock for sysclock
@@ -176,32 +219,46 @@ bool SystemClock_ConfigHSI64()
     return true;
 }
 
-bool HwClock::init(configuration config)
+bool HwClock::init(configuration config, I2cSpeed i2c_speed)
 {
     HAL_Init();
     switch (config)
     {
         case configuration::DEFAULT_4MHZ:
-            i2c_const = timingR_4Mhz;
+            i2c_const = timingR_4Mhz.get(i2c_speed);
             hz = 4'000'000;
-            return true;
+            break;
         case configuration::HSI_64MHZ:
-            i2c_const = timingR_64Mhz;
+        case configuration::HSE_64MHZ:
+            i2c_const = timingR_64Mhz.get(i2c_speed);
             hz = 64'000'000;
-            return SystemClock_ConfigHSI64();
+            break;
         case configuration::HSI_80MHZ:
-            i2c_const = timingR_80Mhz;
+            i2c_const = timingR_80Mhz.get(i2c_speed);
             hz = 80'000'000;
+            break;
+        default:
+            return false;
+    }
+    if (i2c_const == 0)
+    {
+        // Bus speed out of reach of this clock, don't hand out TIMINGR 0
+        return false;
+    }
+
+    switch (config)
+    {
+        case configuration::HSI_64MHZ:
+            return SystemClock_ConfigHSI64();
+        case configuration::HSI_80MHZ:
             return SystemClock_ConfigHSI80();
         case configuration::HSE_64MHZ:
-            i2c_const = timingR_64Mhz;
-            hz = 64'000'000;
             return SystemClock_ConfigHSE64();
+        case configuration::DEFAULT_4MHZ:
         default:
-            return false;
+            return true;
     }
     // SystemClock_ConfigHSE();
     // HAL_DeInit();
-    return true;
 }
 }  // namespace LBR::Stml4
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "st_i2c_timing.h"
 #include "stm32l476xx.h"
 #include "stm32l4xx_hal.h"
 #include "sys_clock.h"
@@ -29,9 +30,12 @@ public:
      * @brief Initialize the system clock at the begining of the program in bsp ONCE. 
      *  this should be called BEFORE any other periopheral are setup.
      * @param Configuration to be used.
-     * @return True if success.
+     * @param i2c_speed bus speed get_timingR() is solved for.
+     * @return True if success, false if i2c_speed can't be reached from
+     *         the configured clock (Fast mode or Fast mode plus from
+     *         DEFAULT_4MHZ), the clock is left unchanged then.
      */
-    bool init(configuration);
+    bool init(configuration, I2cSpeed i2c_speed = I2cSpeed::STANDARD);
 
     uint32_t get_hz() const
     {
@@ -43,7 +47,8 @@ public:
     }
 
 private:
-    /* Will hold MAGIC numbers for I2c generated by cubeMX */
+    /* TIMINGR solved at compile time for the configured clock, 0 if the
+     * requested bus speed can't be reached from it */
     uint32_t i2c_const;
     uint32_t hz;
 };
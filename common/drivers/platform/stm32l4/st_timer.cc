@@ -0,0 +1,105 @@
+#include "st_timer.h"
+#include "stm32l4xx_hal.h"
+
+namespace LBR
+{
+namespace Stml4
+{
+
+static constexpr uint32_t MAX_COUNT = 0x10000;  // 16-bit PSC and ARR
+
+HwTimer::HwTimer(const StTimerParams& params)
+    : base_addr_(params.base_addr), rate_hz_(params.rate_hz)
+{
+}
+
+bool HwTimer::init()
+{
+    if (base_addr_ == TIM6)
+    {
+        RCC->APB1ENR1 |= RCC_APB1ENR1_TIM6EN;
+        irqn_ = TIM6_DAC_IRQn;
+    }
+    else if (base_addr_ == TIM7)
+    {
+        RCC->APB1ENR1 |= RCC_APB1ENR1_TIM7EN;
+        irqn_ = TIM7_IRQn;
+    }
+    else
+    {
+        return false;
+    }
+
+    // APB1 timers run at twice PCLK1 whenever APB1 is divided
+    uint32_t timer_clk = HAL_RCC_GetPCLK1Freq();
+    if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1)
+    {
+        timer_clk *= 2;
+    }
+    if (rate_hz_ == 0 || rate_hz_ > timer_clk)
+    {
+        return false;
+    }
+
+    // Smallest prescaler that fits the period in ARR, best resolution
+    const uint32_t ticks = timer_clk / rate_hz_;
+    const uint32_t psc = (ticks + MAX_COUNT - 1) / MAX_COUNT;
+    const uint32_t arr = ticks / psc;
+    if (psc > MAX_COUNT || arr < 1)
+    {
+        return false;
+    }
+
+    base_addr_->CR1 = 0;
+    base_addr_->DIER = 0;
+    base_addr_->PSC = psc - 1;
+    base_addr_->ARR = arr - 1;
+    // Only overflows raise UIF, then load PSC/ARR without a spurious tick
+    base_addr_->CR1 = TIM_CR1_URS;
+    base_addr_->EGR = TIM_EGR_UG;
+    base_addr_->SR = 0;
+
+    actual_hz_ = timer_clk / (psc * arr);
+    return true;
+}
+
+bool HwTimer::start(TimerCallback cb, void* ctx, uint32_t priority)
+{
+    if (cb == nullptr || actual_hz_ == 0)
+    {
+        return false;
+    }
+
+    cb_ = cb;
+    ctx_ = ctx;
+    base_addr_->CNT = 0;
+    base_addr_->SR = 0;
+    base_addr_->DIER |= TIM_DIER_UIE;
+    NVIC_SetPriority(irqn_, priority);
+    NVIC_EnableIRQ(irqn_);
+    base_addr_->CR1 |= TIM_CR1_CEN;
+    return true;
+}
+
+void HwTimer::stop()
+{
+    base_addr_->CR1 &= ~TIM_CR1_CEN;
+    base_addr_->DIER &= ~TIM_DIER_UIE;
+    base_addr_->SR = 0;
+}
+
+void HwTimer::irq_handler()
+{
+    if (base_addr_->SR & TIM_SR_UIF)
+    {
+        // rc_w0, writing 1 elsewhere leaves other flags alone
+        base_addr_->SR = ~static_cast<uint32_t>(TIM_SR_UIF);
+        if (cb_ != nullptr)
+        {
+            cb_(ctx_);
+        }
+    }
+}
+
+}  // namespace Stml4
+}  // namespace LBR
@@ -0,0 +1,83 @@
+/**
+ * @file st_timer.h
+ * @brief Periodic interrupt from a basic timer for the stml4
+ * @date 10/17/2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "stm32l476xx.h"
+
+namespace LBR
+{
+namespace Stml4
+{
+
+/**
+ * @brief Called from the timer's update interrupt
+ */
+using TimerCallback = void (*)(void* ctx);
+
+/**
+ * @brief Collection of timer base address and tick rate.
+ * @note Only the basic timers TIM6/TIM7 are accepted, they have no
+ *       channels another driver could be using
+ */
+struct StTimerParams
+{
+    TIM_TypeDef* base_addr;
+    uint32_t rate_hz;
+};
+
+class HwTimer
+{
+public:
+    /**
+     * @brief Hw Contructor
+     * @param params struct of timer and rate.
+     */
+    explicit HwTimer(const StTimerParams& params);
+
+    /**
+     * @brief Enables the timer clock and solves PSC/ARR for the rate from
+     *        the current APB1 timer clock
+     * @return true if successful, false if the timer or rate is invalid
+     */
+    bool init();
+
+    /**
+     * @brief Starts firing cb once per period
+     * @param cb called in interrupt context
+     * @param ctx passed to cb
+     * @param priority NVIC priority of the timer interrupt
+     */
+    bool start(TimerCallback cb, void* ctx, uint32_t priority = 0);
+
+    void stop();
+
+    /**
+     * @brief Call from TIM6_DAC_IRQHandler / TIM7_IRQHandler
+     */
+    void irq_handler();
+
+    /**
+     * @brief Rate actually reached, rate_hz unless the clock does not
+     *        divide evenly
+     */
+    uint32_t rate_hz() const
+    {
+        return actual_hz_;
+    }
+
+private:
+    TIM_TypeDef* const base_addr_;
+    const uint32_t rate_hz_;
+    uint32_t actual_hz_{0};
+    IRQn_Type irqn_{};
+    TimerCallback cb_{nullptr};
+    void* ctx_{nullptr};
+};
+
+}  // namespace Stml4
+}  // namespace LBR
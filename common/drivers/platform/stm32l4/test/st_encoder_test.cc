@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include "fake_l4.h"
+#include "fake_timer.h"
+#include "st_encoder.h"
+
+using namespace LBR;
+using namespace LBR::Stml4;
+
+namespace
+{
+
+// TIM3_CH1/CH2 on PA6/PA7
+const StGpioSettings ENC_PIN{GpioMode::ALT_FUNC, GpioOtype::PUSH_PULL,
+                             GpioOspeed::LOW, GpioPupd::NO_PULL, 2};
+
+class StEncoderTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Native::reset();
+        ASSERT_TRUE(enc.init());
+    }
+
+    // Edges one at a time, each interrupt served before the next edge
+    void turn(int32_t counts)
+    {
+        const int32_t dir = (counts > 0) ? 1 : -1;
+        for (int32_t i = 0; i != counts; i += dir)
+        {
+            timer.step(dir);
+            for (int n = 0; timer.irq_pending(); n++)
+            {
+                ASSERT_LT(n, 10) << "interrupt storm";
+                enc.irq_handler();
+            }
+        }
+    }
+
+    Native::FakeTimer timer{*TIM3};
+    HwEncoder enc{StEncoderParams{{ENC_PIN, 6, GPIOA}, {ENC_PIN, 7, GPIOA},
+                                  TIM3, 5}};
+};
+
+TEST_F(StEncoderTest, InitSetsUpEncoderMode)
+{
+    EXPECT_TRUE(RCC->APB1ENR1 & RCC_APB1ENR1_TIM3EN);
+    EXPECT_EQ(TIM3->SMCR & TIM_SMCR_SMS, TIM_SMCR_SMS_0 | TIM_SMCR_SMS_1);
+    EXPECT_EQ(static_cast<uint32_t>(TIM3->ARR), 0xFFFFu);
+    EXPECT_TRUE(TIM3->CR1 & TIM_CR1_CEN);
+    EXPECT_TRUE(TIM3->CR1 & TIM_CR1_UIFREMAP);
+    EXPECT_TRUE(TIM3->DIER & TIM_DIER_UIE);
+    EXPECT_TRUE(NVIC_GetEnableIRQ(TIM3_IRQn));
+    EXPECT_EQ(NVIC_GetPriority(TIM3_IRQn), 5u);
+    EXPECT_EQ(enc.getTicks(), 0);
+}
+
+TEST_F(StEncoderTest, CountsForwardThroughTheWrap)
+{
+    turn(65535);
+    EXPECT_EQ(enc.getTicks(), 65535);
+    turn(1);
+    EXPECT_EQ(static_cast<uint32_t>(TIM3->CNT), 0u);
+    EXPECT_EQ(enc.getTicks(), 65536);
+    turn(70000);
+    EXPECT_EQ(enc.getTicks(), 135536);
+}
+
+TEST_F(StEncoderTest, CountsBackwardThroughZero)
+{
+    turn(-1);
+    EXPECT_EQ(static_cast<uint32_t>(TIM3->CNT), 0xFFFFu);
+    EXPECT_EQ(enc.getTicks(), -1);
+    turn(-70000);
+    EXPECT_EQ(enc.getTicks(), -70001);
+}
+
+TEST_F(StEncoderTest, ManyTurnsBothWays)
+{
+    turn(200'000);
+    EXPECT_EQ(enc.getTicks(), 200'000);
+    turn(-400'000);
+    EXPECT_EQ(enc.getTicks(), -200'000);
+    turn(200'000);
+    EXPECT_EQ(enc.getTicks(), 0);
+}
+
+TEST_F(StEncoderTest, JitterOnTheWrapPoint)
+{
+    // A shaft resting on the wrap, every other edge crosses it
+    turn(65535);
+    for (int i = 0; i < 20; i++)
+    {
+        turn(1);
+        ASSERT_EQ(enc.getTicks(), 65536) << "pass " << i;
+        turn(-1);
+        ASSERT_EQ(enc.getTicks(), 65535) << "pass " << i;
+    }
+
+    // Same around zero, from below
+    turn(-65535);
+    for (int i = 0; i < 20; i++)
+    {
+        turn(-1);
+        ASSERT_EQ(enc.getTicks(), -1) << "pass " << i;
+        turn(1);
+        ASSERT_EQ(enc.getTicks(), 0) << "pass " << i;
+    }
+}
+
+TEST_F(StEncoderTest, UnservedOverflowCountsFromUifcpy)
+{
+    turn(65534);
+    // Interrupt held off, as if getTicks() preempted the update handler
+    timer.step(3);
+    ASSERT_TRUE(TIM3->SR & TIM_SR_UIF);
+    EXPECT_TRUE(TIM3->CNT & TIM_CNT_UIFCPY);
+    EXPECT_EQ(enc.getTicks(), 65537);
+
+    enc.irq_handler();
+    EXPECT_FALSE(TIM3->SR & TIM_SR_UIF);
+    EXPECT_EQ(enc.getTicks(), 65537);
+}
+
+TEST_F(StEncoderTest, UnservedUnderflowCountsFromUifcpy)
+{
+    timer.step(-3);
+    ASSERT_TRUE(TIM3->SR & TIM_SR_UIF);
+    EXPECT_EQ(enc.getTicks(), -3);
+
+    enc.irq_handler();
+    EXPECT_EQ(enc.getTicks(), -3);
+    turn(3);
+    EXPECT_EQ(enc.getTicks(), 0);
+}
+
+TEST_F(StEncoderTest, EdgeIsStampedOnce)
+{
+    EncoderEdge edge{};
+    enc.getEdge(edge);
+    DWT->CYCCNT = 1234;
+    turn(-2);
+
+    DWT->CYCCNT = 5678;
+    ASSERT_TRUE(enc.getEdge(edge));
+    EXPECT_EQ(edge.ticks, -1);
+    EXPECT_EQ(edge.time, 1234u);
+    EXPECT_EQ(edge.now, 5678u);
+}
+
+}  // namespace
@@ -0,0 +1,290 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include "fake_dma.h"
+#include "fake_i2c.h"
+#include "fake_l4.h"
+#include "st_i2c.h"
+#include "stm32l4xx_hal.h"
+
+using namespace LBR;
+using namespace LBR::Stml4;
+
+namespace
+{
+
+constexpr uint8_t DEV_ADDR = 0x28;
+constexpr uint32_t TIMEOUT_MS = 10;
+constexpr uint8_t RX_CHANNEL = 7;  // I2C1_RX
+
+uint32_t addr32(const void* ptr)
+{
+    return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(ptr));
+}
+
+// Plain register file, reads back what was written
+class RegFile : public Sim::SimI2cDevice
+{
+public:
+    I2cStatus read(uint16_t reg_addr, std::span<uint8_t> data) override
+    {
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            data[i] = regs[(reg_addr + i) % regs.size()];
+        }
+        return I2cStatus::OK;
+    }
+
+    I2cStatus write(uint16_t reg_addr, std::span<const uint8_t> data) override
+    {
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            regs[(reg_addr + i) % regs.size()] = data[i];
+        }
+        return I2cStatus::OK;
+    }
+
+    std::array<uint8_t, 256> regs{};
+};
+
+struct Done
+{
+    uint32_t calls{0};
+    I2cStatus status{I2cStatus::OK};
+};
+
+void on_done(void* ctx, I2cStatus status)
+{
+    Done* done = static_cast<Done*>(ctx);
+    done->calls++;
+    done->status = status;
+}
+
+class StI2cDmaTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Native::reset();
+        mem = Native::FakeDma::memory();
+        ASSERT_FALSE(mem.empty()) << "no memory below 4 GiB for the DMA";
+        std::fill(mem.begin(), mem.end(), 0);
+
+        fake.connect_dma(dma, RX_CHANNEL);
+        ASSERT_TRUE(fake.attach(dev, DEV_ADDR));
+        for (size_t i = 0; i < dev.regs.size(); i++)
+        {
+            dev.regs[i] = static_cast<uint8_t>(i);
+        }
+        ASSERT_TRUE(i2c.init());
+    }
+
+    // Stands in for the NVIC, runs the handlers while a flag is pending
+    void run_irqs()
+    {
+        for (int i = 0; i < 10'000; i++)
+        {
+            if (fake.er_pending())
+            {
+                i2c.er_irq_handler();
+            }
+            else if (dma.irq_pending(RX_CHANNEL))
+            {
+                i2c.dma_irq_handler();
+            }
+            else if (fake.ev_pending())
+            {
+                i2c.ev_irq_handler();
+            }
+            else
+            {
+                return;
+            }
+        }
+        FAIL() << "interrupt storm";
+    }
+
+    Native::FakeDma dma{*DMA1, Native::dma1_channel, *DMA1_CSELR};
+    Native::FakeI2c fake{*I2C1};
+    RegFile dev;
+    HwI2c i2c{StI2cParams{I2C1, 0x10909CEC, true, TIMEOUT_MS, nullptr,
+                          nullptr, HAL_GetTick}};
+    std::span<uint8_t> mem;
+};
+
+TEST_F(StI2cDmaTest, InitRoutesTheRxChannel)
+{
+    EXPECT_TRUE(RCC->AHB1ENR & RCC_AHB1ENR_DMA1EN);
+    EXPECT_EQ((DMA1_CSELR->CSELR >> 24) & 0xF, 3u);
+    EXPECT_EQ(static_cast<uint32_t>(DMA1_Channel7->CPAR),
+              addr32(&I2C1->RXDR));
+    EXPECT_EQ(static_cast<uint32_t>(DMA1_Channel7->CCR), 0u);
+    EXPECT_TRUE(NVIC_GetEnableIRQ(DMA1_Channel7_IRQn));
+}
+
+TEST_F(StI2cDmaTest, ChannelFlagsHalfAndFullTransfer)
+{
+    // Channel 2 by hand, request 5 from a stand-alone data register
+    Native::FakeReg src;
+    DMA1_CSELR->CSELR = 5UL << 4;
+    DMA1_Channel2->CPAR = addr32(&src);
+    DMA1_Channel2->CMAR = addr32(&mem[100]);
+    DMA1_Channel2->CNDTR = 4;
+    DMA1_Channel2->CCR = DMA_CCR_MINC | DMA_CCR_HTIE | DMA_CCR_TCIE |
+                         DMA_CCR_EN;
+
+    // Locked while enabled
+    DMA1_Channel2->CNDTR = 9;
+    EXPECT_EQ(static_cast<uint32_t>(DMA1_Channel2->CNDTR), 4u);
+
+    src.value = 0xA0;
+    EXPECT_FALSE(dma.request(2, 3, src));
+    EXPECT_TRUE(dma.request(2, 5, src));
+    EXPECT_FALSE(DMA1->ISR & DMA_ISR_HTIF2);
+
+    src.value = 0xA1;
+    EXPECT_TRUE(dma.request(2, 5, src));
+    EXPECT_TRUE(DMA1->ISR & DMA_ISR_HTIF2);
+    EXPECT_TRUE(DMA1->ISR & DMA_ISR_GIF2);
+    EXPECT_TRUE(dma.irq_pending(2));
+
+    DMA1->IFCR = DMA_IFCR_CHTIF2;
+    EXPECT_FALSE(DMA1->ISR & DMA_ISR_HTIF2);
+    EXPECT_TRUE(DMA1->ISR & DMA_ISR_GIF2);
+    EXPECT_FALSE(dma.irq_pending(2));
+
+    src.value = 0xA2;
+    EXPECT_TRUE(dma.request(2, 5, src));
+    src.value = 0xA3;
+    EXPECT_TRUE(dma.request(2, 5, src));
+    EXPECT_TRUE(DMA1->ISR & DMA_ISR_TCIF2);
+    EXPECT_EQ(static_cast<uint32_t>(DMA1_Channel2->CNDTR), 0u);
+    EXPECT_TRUE(dma.irq_pending(2));
+
+    // Nothing left to move
+    EXPECT_FALSE(dma.request(2, 5, src));
+    EXPECT_EQ(mem[99], 0);
+    EXPECT_EQ(mem[100], 0xA0);
+    EXPECT_EQ(mem[103], 0xA3);
+    EXPECT_EQ(mem[104], 0);
+
+    DMA1->IFCR = DMA_IFCR_CGIF2;
+    EXPECT_EQ(static_cast<uint32_t>(DMA1->ISR), 0u);
+}
+
+TEST_F(StI2cDmaTest, BlockingReadLandsThroughDma)
+{
+    std::span<uint8_t> buf = mem.first(16);
+    ASSERT_EQ(i2c.mem_read(buf, static_cast<uint8_t>(0x20), DEV_ADDR),
+              I2cStatus::OK);
+    for (size_t i = 0; i < buf.size(); i++)
+    {
+        EXPECT_EQ(buf[i], 0x20 + i);
+    }
+
+    // Channel handed back clean
+    EXPECT_FALSE(I2C1->CR1 & I2C_CR1_RXDMAEN);
+    EXPECT_EQ(static_cast<uint32_t>(DMA1_Channel7->CCR), 0u);
+    EXPECT_EQ(static_cast<uint32_t>(DMA1->ISR), 0u);
+}
+
+TEST_F(StI2cDmaTest, LongBlockingReadReloadsUnderDma)
+{
+    std::span<uint8_t> buf = mem.first(600);
+    ASSERT_EQ(i2c.mem_read(buf, static_cast<uint8_t>(0x00), DEV_ADDR),
+              I2cStatus::OK);
+    for (size_t i = 0; i < buf.size(); i++)
+    {
+        ASSERT_EQ(buf[i], i & 0xFF) << "byte " << i;
+    }
+    // 255 + 255 + 90
+    EXPECT_EQ(fake.stats().reloads, 2u);
+}
+
+TEST_F(StI2cDmaTest, ItReadCompletesOnStopNotOnTheChannel)
+{
+    std::span<uint8_t> buf = mem.first(8);
+    Done done;
+    ASSERT_EQ(i2c.mem_read_it(buf, 0x40, DEV_ADDR, on_done, &done),
+              I2cStatus::OK);
+    EXPECT_FALSE(I2C1->CR1 & I2C_CR1_RXIE);
+
+    // Run the event interrupt until the channel has moved every byte
+    for (int i = 0; i < 100 && !(DMA1->ISR & DMA_ISR_TCIF7); i++)
+    {
+        ASSERT_TRUE(fake.ev_pending());
+        i2c.ev_irq_handler();
+    }
+    EXPECT_TRUE(DMA1->ISR & DMA_ISR_HTIF7);
+    EXPECT_TRUE(DMA1_Channel7->CCR & DMA_CCR_TEIE);
+
+    // Half and full transfer are only acknowledged
+    i2c.dma_irq_handler();
+    EXPECT_FALSE(DMA1->ISR & (DMA_ISR_HTIF7 | DMA_ISR_TCIF7));
+    EXPECT_EQ(i2c.get_xfer_state(), I2cXferState::BUSY);
+    EXPECT_EQ(done.calls, 0u);
+
+    run_irqs();
+    EXPECT_EQ(i2c.get_xfer_state(), I2cXferState::DONE);
+    EXPECT_EQ(done.calls, 1u);
+    EXPECT_EQ(done.status, I2cStatus::OK);
+    for (size_t i = 0; i < buf.size(); i++)
+    {
+        EXPECT_EQ(buf[i], 0x40 + i);
+    }
+    EXPECT_FALSE(I2C1->CR1 & I2C_CR1_RXDMAEN);
+}
+
+TEST_F(StI2cDmaTest, ItReloadLeavesRxneToTheChannel)
+{
+    // Each chunk's last byte is still in RXDR when TCR interrupts
+    fake.late_dma(true);
+    std::span<uint8_t> buf = mem.first(600);
+    Done done;
+    ASSERT_EQ(i2c.mem_read_it(buf, 0x00, DEV_ADDR, on_done, &done),
+              I2cStatus::OK);
+
+    uint32_t both = 0;
+    for (int i = 0; i < 100 && fake.ev_pending(); i++)
+    {
+        const uint32_t isr = I2C1->ISR;
+        if ((isr & I2C_ISR_RXNE) && (isr & I2C_ISR_TCR))
+        {
+            both++;
+        }
+        i2c.ev_irq_handler();
+    }
+    run_irqs();
+    EXPECT_EQ(both, 2u);
+
+    EXPECT_EQ(i2c.get_xfer_state(), I2cXferState::DONE);
+    EXPECT_EQ(done.status, I2cStatus::OK);
+    for (size_t i = 0; i < buf.size(); i++)
+    {
+        ASSERT_EQ(buf[i], i & 0xFF) << "byte " << i;
+    }
+    EXPECT_EQ(static_cast<uint32_t>(DMA1_Channel7->CNDTR), 0u);
+}
+
+TEST_F(StI2cDmaTest, ItTransferErrorEndsInBusError)
+{
+    // Out of the DMA's reach, the first byte faults the channel
+    std::array<uint8_t, 8> far{};
+    Done done;
+    ASSERT_EQ(i2c.mem_read_it(far, 0x40, DEV_ADDR, on_done, &done),
+              I2cStatus::OK);
+    run_irqs();
+    EXPECT_EQ(i2c.get_xfer_state(), I2cXferState::ERROR);
+    EXPECT_EQ(done.status, I2cStatus::BUS_ERROR);
+    EXPECT_EQ(done.calls, 1u);
+
+    // The PE cycle released the stretched bus
+    EXPECT_FALSE(I2C1->ISR & I2C_ISR_BUSY);
+    EXPECT_FALSE(DMA1->ISR & DMA_ISR_TEIF7);
+    std::span<uint8_t> buf = mem.first(4);
+    EXPECT_EQ(i2c.mem_read(buf, static_cast<uint8_t>(0x40), DEV_ADDR),
+              I2cStatus::OK);
+    EXPECT_EQ(buf[3], 0x43);
+}
+
+}  // namespace
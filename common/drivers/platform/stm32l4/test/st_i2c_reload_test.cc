@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <vector>
+#include "fake_i2c.h"
+#include "fake_l4.h"
+#include "st_i2c.h"
+#include "stm32l4xx_hal.h"
+
+using namespace LBR;
+using namespace LBR::Stml4;
+
+namespace
+{
+
+constexpr uint8_t DEV_ADDR = 0x28;
+constexpr uint8_t REG_ADDR = 0x10;
+
+// CR2 fields that describe the chunking
+constexpr uint32_t CR2_MASK = I2C_CR2_NBYTES | I2C_CR2_RELOAD |
+                              I2C_CR2_AUTOEND | I2C_CR2_RD_WRN |
+                              I2C_CR2_START;
+
+constexpr uint32_t START = I2C_CR2_START;
+constexpr uint32_t RD = I2C_CR2_RD_WRN;
+constexpr uint32_t RELOAD = I2C_CR2_RELOAD;
+constexpr uint32_t AUTOEND = I2C_CR2_AUTOEND;
+
+uint32_t cr2(uint32_t nbytes, uint32_t flags)
+{
+    return (nbytes << I2C_CR2_NBYTES_Pos) | flags;
+}
+
+// Plain register file, reads back what was written
+class RegFile : public Sim::SimI2cDevice
+{
+public:
+    I2cStatus read(uint16_t reg_addr, std::span<uint8_t> data) override
+    {
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            data[i] = regs[(reg_addr + i) & 0xFF];
+        }
+        return I2cStatus::OK;
+    }
+
+    I2cStatus write(uint16_t reg_addr, std::span<const uint8_t> data) override
+    {
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            regs[(reg_addr + i) & 0xFF] = data[i];
+        }
+        return I2cStatus::OK;
+    }
+
+    std::array<uint8_t, 256> regs{};
+};
+
+class StI2cReloadTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Native::reset();
+        ASSERT_TRUE(fake.attach(dev, DEV_ADDR));
+        for (size_t i = 0; i < dev.regs.size(); i++)
+        {
+            dev.regs[i] = static_cast<uint8_t>(i);
+        }
+        ASSERT_TRUE(i2c.init());
+        fake.clear_log();
+    }
+
+    std::vector<uint32_t> logged() const
+    {
+        std::vector<uint32_t> out;
+        for (const uint32_t value : fake.cr2_log())
+        {
+            out.push_back(value & CR2_MASK);
+        }
+        return out;
+    }
+
+    void read(size_t len, const std::vector<uint32_t>& expected)
+    {
+        std::vector<uint8_t> buf(len);
+        ASSERT_EQ(i2c.mem_read(buf, REG_ADDR, DEV_ADDR), I2cStatus::OK);
+        for (size_t i = 0; i < len; i++)
+        {
+            ASSERT_EQ(buf[i], (REG_ADDR + i) & 0xFF) << "byte " << i;
+        }
+        EXPECT_EQ(logged(), expected);
+    }
+
+    void write(size_t len, const std::vector<uint32_t>& expected)
+    {
+        std::vector<uint8_t> buf(len);
+        for (size_t i = 0; i < len; i++)
+        {
+            buf[i] = static_cast<uint8_t>(i * 7 + 3);
+        }
+        ASSERT_EQ(i2c.mem_write(buf, REG_ADDR, DEV_ADDR), I2cStatus::OK);
+
+        // Longer writes wrap the register file, the last pass is what stays
+        for (size_t i = (len > 256) ? len - 256 : 0; i < len; i++)
+        {
+            ASSERT_EQ(dev.regs[(REG_ADDR + i) & 0xFF], buf[i]) << "byte " << i;
+        }
+        EXPECT_EQ(logged(), expected);
+        EXPECT_EQ(fake.stats().stray_writes, 0u);
+    }
+
+    Native::FakeI2c fake{*I2C1};
+    RegFile dev;
+    HwI2c i2c{StI2cParams{I2C1, 0x10909CEC, false, 100, nullptr, nullptr,
+                          HAL_GetTick}};
+};
+
+TEST_F(StI2cReloadTest, Read1Byte)
+{
+    read(1, {cr2(1, START), cr2(1, START | RD | AUTOEND)});
+}
+
+TEST_F(StI2cReloadTest, Read255BytesFitsOneChunk)
+{
+    read(255, {cr2(1, START), cr2(255, START | RD | AUTOEND)});
+}
+
+TEST_F(StI2cReloadTest, Read256BytesReloadsOnce)
+{
+    read(256, {cr2(1, START), cr2(255, START | RD | RELOAD),
+               cr2(1, RD | AUTOEND)});
+}
+
+TEST_F(StI2cReloadTest, Read1024BytesChainsFiveChunks)
+{
+    read(1024, {cr2(1, START), cr2(255, START | RD | RELOAD),
+                cr2(255, RD | RELOAD), cr2(255, RD | RELOAD),
+                cr2(255, RD | RELOAD), cr2(4, RD | AUTOEND)});
+}
+
+// Writes count the register byte in NBYTES too
+
+TEST_F(StI2cReloadTest, Write1Byte)
+{
+    write(1, {cr2(2, START | AUTOEND)});
+}
+
+TEST_F(StI2cReloadTest, Write255BytesSpillsTheLastByte)
+{
+    write(255, {cr2(255, START | RELOAD), cr2(1, AUTOEND)});
+}
+
+TEST_F(StI2cReloadTest, Write256BytesReloadsOnce)
+{
+    write(256, {cr2(255, START | RELOAD), cr2(2, AUTOEND)});
+}
+
+TEST_F(StI2cReloadTest, Write1024BytesChainsFiveChunks)
+{
+    write(1024, {cr2(255, START | RELOAD), cr2(255, RELOAD),
+                 cr2(255, RELOAD), cr2(255, RELOAD), cr2(5, AUTOEND)});
+}
+
+TEST_F(StI2cReloadTest, ItRead1024BytesReloadsFromTheInterrupt)
+{
+    std::vector<uint8_t> buf(1024);
+    ASSERT_EQ(i2c.mem_read_it(buf, REG_ADDR, DEV_ADDR), I2cStatus::OK);
+    for (int i = 0; i < 10'000 && fake.ev_pending(); i++)
+    {
+        i2c.ev_irq_handler();
+    }
+    ASSERT_EQ(i2c.get_xfer_state(), I2cXferState::DONE);
+    EXPECT_EQ(buf[1023], (REG_ADDR + 1023) & 0xFF);
+    EXPECT_EQ(logged(), (std::vector<uint32_t>{
+                            cr2(1, START), cr2(255, START | RD | RELOAD),
+                            cr2(255, RD | RELOAD), cr2(255, RD | RELOAD),
+                            cr2(255, RD | RELOAD), cr2(4, RD | AUTOEND)}));
+}
+
+}  // namespace
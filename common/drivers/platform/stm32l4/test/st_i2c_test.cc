@@ -0,0 +1,340 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <type_traits>
+#include "fake_i2c.h"
+#include "fake_l4.h"
+#include "st_i2c.h"
+#include "stm32l4xx_hal.h"
+
+using namespace LBR;
+using namespace LBR::Stml4;
+
+namespace
+{
+
+constexpr uint8_t DEV_ADDR = 0x28;
+constexpr uint32_t TIMEOUT_MS = 10;
+
+// Without LBR_I2C_TRACE the tracer is an empty member that takes no space,
+// st_i2c_trace_test covers the traced build
+static_assert(!I2cTrace::ENABLED);
+static_assert(std::is_empty_v<I2cTrace>);
+
+// Plain register file, reads back what was written
+class RegFile : public Sim::SimI2cDevice
+{
+public:
+    I2cStatus read(uint16_t reg_addr, std::span<uint8_t> data) override
+    {
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            data[i] = regs[(reg_addr + i) % regs.size()];
+        }
+        return I2cStatus::OK;
+    }
+
+    I2cStatus write(uint16_t reg_addr, std::span<const uint8_t> data) override
+    {
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            regs[(reg_addr + i) % regs.size()] = data[i];
+        }
+        return I2cStatus::OK;
+    }
+
+    std::array<uint8_t, 256> regs{};
+};
+
+struct Done
+{
+    uint32_t calls{0};
+    I2cStatus status{I2cStatus::OK};
+};
+
+void on_done(void* ctx, I2cStatus status)
+{
+    Done* done = static_cast<Done*>(ctx);
+    done->calls++;
+    done->status = status;
+}
+
+class StI2cTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Native::reset();
+        ASSERT_TRUE(fake.attach(dev, DEV_ADDR));
+        for (size_t i = 0; i < dev.regs.size(); i++)
+        {
+            dev.regs[i] = static_cast<uint8_t>(i);
+        }
+        ASSERT_TRUE(i2c.init());
+    }
+
+    // Stands in for the NVIC, runs the handlers while a flag is pending
+    void run_irqs()
+    {
+        for (int i = 0; i < 10'000; i++)
+        {
+            if (fake.er_pending())
+            {
+                i2c.er_irq_handler();
+            }
+            else if (fake.ev_pending())
+            {
+                i2c.ev_irq_handler();
+            }
+            else
+            {
+                return;
+            }
+        }
+        FAIL() << "interrupt storm";
+    }
+
+    Native::FakeI2c fake{*I2C1};
+    RegFile dev;
+    HwI2c i2c{StI2cParams{I2C1, 0x10909CEC, false, TIMEOUT_MS, nullptr,
+                          nullptr, HAL_GetTick}};
+};
+
+TEST_F(StI2cTest, InitEnablesThePeripheralAndItsInterrupts)
+{
+    EXPECT_TRUE(I2C1->CR1 & I2C_CR1_PE);
+    EXPECT_EQ(static_cast<uint32_t>(I2C1->TIMINGR), 0x10909CECu);
+    EXPECT_TRUE(I2C1->TIMEOUTR & I2C_TIMEOUTR_TIMOUTEN);
+    EXPECT_TRUE(NVIC_GetEnableIRQ(I2C1_EV_IRQn));
+    EXPECT_TRUE(NVIC_GetEnableIRQ(I2C1_ER_IRQn));
+    // The lines stay quiet until a *_it transfer asks for them
+    EXPECT_FALSE(I2C1->CR1 & (I2C_CR1_TXIE | I2C_CR1_RXIE));
+}
+
+TEST_F(StI2cTest, BlockingReadAndWriteRoundTrip)
+{
+    const std::array<uint8_t, 3> out{0xA1, 0xB2, 0xC3};
+    ASSERT_EQ(i2c.mem_write(out, static_cast<uint8_t>(0x40), DEV_ADDR),
+              I2cStatus::OK);
+    EXPECT_EQ(dev.regs[0x40], 0xA1);
+    EXPECT_EQ(dev.regs[0x42], 0xC3);
+
+    std::array<uint8_t, 3> in{};
+    ASSERT_EQ(i2c.mem_read(in, static_cast<uint8_t>(0x40), DEV_ADDR),
+              I2cStatus::OK);
+    EXPECT_EQ(in, out);
+
+    // Write, then register and a repeated START for the read
+    EXPECT_EQ(fake.stats().starts, 3u);
+    EXPECT_EQ(fake.stats().stops, 2u);
+    EXPECT_EQ(fake.stats().stray_writes, 0u);
+    EXPECT_FALSE(I2C1->ISR & I2C_ISR_BUSY);
+}
+
+TEST_F(StI2cTest, TransferSkipsZeroLengthReads)
+{
+    std::array<uint8_t, 2> buf{};
+    const std::array<uint8_t, 1> out{0x5A};
+    const std::array<I2cOp, 4> ops{
+        I2cOp::read(DEV_ADDR, 0x00, {}),
+        I2cOp::write(DEV_ADDR, 0x30, out),
+        I2cOp::read(DEV_ADDR, 0x30, buf),
+        I2cOp::read(DEV_ADDR, 0x40, {}),
+    };
+    ASSERT_EQ(i2c.transfer(ops), I2cStatus::OK);
+    EXPECT_EQ(buf[0], 0x5A);
+    EXPECT_EQ(buf[1], 0x31);
+
+    // Write, register and repeated START for the read, STOP after the read
+    EXPECT_EQ(fake.stats().starts, 3u);
+    EXPECT_EQ(fake.stats().stops, 1u);
+    EXPECT_FALSE(I2C1->ISR & I2C_ISR_BUSY);
+}
+
+TEST_F(StI2cTest, ItReadReturnsBeforeTheBusMoves)
+{
+    std::array<uint8_t, 6> buf{};
+    Done done;
+    ASSERT_EQ(i2c.mem_read_it(buf, 0x10, DEV_ADDR, on_done, &done),
+              I2cStatus::OK);
+
+    // Only the START went out, the rest is up to the interrupts
+    EXPECT_EQ(i2c.get_xfer_state(), I2cXferState::BUSY);
+    EXPECT_EQ(buf[0], 0);
+    EXPECT_TRUE(fake.ev_pending());
+
+    run_irqs();
+    EXPECT_EQ(i2c.get_xfer_state(), I2cXferState::DONE);
+    EXPECT_EQ(i2c.get_xfer_status(), I2cStatus::OK);
+    EXPECT_EQ(done.calls, 1u);
+    EXPECT_EQ(done.status, I2cStatus::OK);
+    for (size_t i = 0; i < buf.size(); i++)
+    {
+        EXPECT_EQ(buf[i], 0x10 + i);
+    }
+
+    // Interrupts are off again between transfers
+    EXPECT_FALSE(I2C1->CR1 & (I2C_CR1_TXIE | I2C_CR1_RXIE | I2C_CR1_STOPIE));
+    EXPECT_FALSE(I2C1->ISR & I2C_ISR_BUSY);
+}
+
+TEST_F(StI2cTest, ItWriteLandsInTheTarget)
+{
+    const std::array<uint8_t, 4> out{9, 8, 7, 6};
+    Done done;
+    ASSERT_EQ(i2c.mem_write_it(out, 0x80, DEV_ADDR, on_done, &done),
+              I2cStatus::OK);
+    run_irqs();
+    EXPECT_EQ(i2c.get_xfer_state(), I2cXferState::DONE);
+    EXPECT_EQ(done.calls, 1u);
+    EXPECT_EQ(dev.regs[0x80], 9);
+    EXPECT_EQ(dev.regs[0x83], 6);
+    EXPECT_EQ(fake.stats().starts, 1u);
+}
+
+TEST_F(StI2cTest, BlockingCallsWaitOutAnItTransfer)
+{
+    std::array<uint8_t, 2> buf{};
+    ASSERT_EQ(i2c.mem_read_it(buf, 0x10, DEV_ADDR), I2cStatus::OK);
+
+    std::array<uint8_t, 2> other{};
+    EXPECT_EQ(i2c.mem_read(other, static_cast<uint8_t>(0x20), DEV_ADDR),
+              I2cStatus::BUSY);
+    EXPECT_EQ(i2c.mem_read_it(other, 0x20, DEV_ADDR), I2cStatus::BUSY);
+
+    run_irqs();
+    EXPECT_EQ(i2c.mem_read(other, static_cast<uint8_t>(0x20), DEV_ADDR),
+              I2cStatus::OK);
+    EXPECT_EQ(other[1], 0x21);
+}
+
+TEST_F(StI2cTest, ItNackEndsTheTransfer)
+{
+    fake.inject_nack(DEV_ADDR, 1);
+    std::array<uint8_t, 4> buf{};
+    Done done;
+    ASSERT_EQ(i2c.mem_read_it(buf, 0x10, DEV_ADDR, on_done, &done),
+              I2cStatus::OK);
+    run_irqs();
+    EXPECT_EQ(i2c.get_xfer_state(), I2cXferState::ERROR);
+    EXPECT_EQ(done.status, I2cStatus::NACK);
+    EXPECT_EQ(done.calls, 1u);
+
+    // The STOP was issued by hand and the bus is free for the next one
+    EXPECT_FALSE(I2C1->ISR & I2C_ISR_BUSY);
+    EXPECT_EQ(i2c.mem_read(buf, static_cast<uint8_t>(0x10), DEV_ADDR),
+              I2cStatus::OK);
+}
+
+TEST_F(StI2cTest, ItBusErrorGoesThroughTheErrorInterrupt)
+{
+    fake.inject_error(I2C_ISR_BERR, 3);
+    std::array<uint8_t, 8> buf{};
+    Done done;
+    ASSERT_EQ(i2c.mem_read_it(buf, 0x10, DEV_ADDR, on_done, &done),
+              I2cStatus::OK);
+    run_irqs();
+    EXPECT_EQ(i2c.get_xfer_state(), I2cXferState::ERROR);
+    EXPECT_EQ(done.status, I2cStatus::BUS_ERROR);
+    EXPECT_FALSE(I2C1->ISR & I2C_ISR_BERR);
+}
+
+TEST_F(StI2cTest, StalledItTransferTimesOutWhenPolled)
+{
+    std::array<uint8_t, 4> buf{};
+    Done done;
+    ASSERT_EQ(i2c.mem_read_it(buf, 0x10, DEV_ADDR, on_done, &done),
+              I2cStatus::OK);
+    fake.hold_bus();
+    run_irqs();
+    EXPECT_EQ(i2c.get_xfer_state(), I2cXferState::BUSY);
+
+    Native::advance_us(TIMEOUT_MS * 1000);
+    EXPECT_EQ(i2c.get_xfer_state(), I2cXferState::ERROR);
+    EXPECT_EQ(done.status, I2cStatus::TIMEOUT);
+
+    // recover() reset the peripheral and freed the bus
+    EXPECT_EQ(i2c.mem_read(buf, static_cast<uint8_t>(0x10), DEV_ADDR),
+              I2cStatus::OK);
+}
+
+TEST_F(StI2cTest, BlockingReadTimesOutOnAHeldBus)
+{
+    fake.hold_bus();
+    std::array<uint8_t, 4> buf{};
+    const uint64_t start = Native::now_us();
+    EXPECT_EQ(i2c.mem_read(buf, static_cast<uint8_t>(0x10), DEV_ADDR),
+              I2cStatus::TIMEOUT);
+    EXPECT_GE(Native::now_us() - start, TIMEOUT_MS * 1000);
+    EXPECT_EQ(i2c.mem_read(buf, static_cast<uint8_t>(0x10), DEV_ADDR),
+              I2cStatus::OK);
+}
+
+TEST_F(StI2cTest, BlockingWriteStuckOnTxisTimesOutAndRecovers)
+{
+    // The target stretches SCL after the register and one data byte
+    fake.hold_bus(2);
+    const std::array<uint8_t, 4> out{1, 2, 3, 4};
+    const uint64_t start = Native::now_us();
+    EXPECT_EQ(i2c.mem_write(out, static_cast<uint8_t>(0x40), DEV_ADDR),
+              I2cStatus::TIMEOUT);
+
+    // Gave up on the deadline, not before and not much after
+    const uint64_t waited = Native::now_us() - start;
+    EXPECT_GE(waited, TIMEOUT_MS * 1000);
+    EXPECT_LT(waited, (TIMEOUT_MS + 1) * 1000);
+    EXPECT_EQ(fake.stats().resets, 1u);
+
+    EXPECT_EQ(i2c.mem_write(out, static_cast<uint8_t>(0x40), DEV_ADDR),
+              I2cStatus::OK);
+    EXPECT_EQ(dev.regs[0x43], 4);
+}
+
+TEST_F(StI2cTest, ItWriteStuckOnTxisTimesOutOnTheDeadline)
+{
+    fake.hold_bus(2);
+    const std::array<uint8_t, 4> out{1, 2, 3, 4};
+    Done done;
+    ASSERT_EQ(i2c.mem_write_it(out, 0x40, DEV_ADDR, on_done, &done),
+              I2cStatus::OK);
+    run_irqs();
+    EXPECT_FALSE(fake.ev_pending());
+
+    Native::advance_us((TIMEOUT_MS - 1) * 1000);
+    EXPECT_EQ(i2c.get_xfer_state(), I2cXferState::BUSY);
+    EXPECT_EQ(done.calls, 0u);
+    EXPECT_EQ(fake.stats().resets, 0u);
+
+    Native::advance_us(1000);
+    EXPECT_EQ(i2c.get_xfer_state(), I2cXferState::ERROR);
+    EXPECT_EQ(done.calls, 1u);
+    EXPECT_EQ(done.status, I2cStatus::TIMEOUT);
+    EXPECT_EQ(fake.stats().resets, 1u);
+}
+
+TEST_F(StI2cTest, InitNeedsAClock)
+{
+    HwI2c no_clock{StI2cParams{I2C1, 0x10909CEC, false, TIMEOUT_MS}};
+    EXPECT_FALSE(no_clock.init());
+}
+
+TEST_F(StI2cTest, DisabledTraceRecordsNothing)
+{
+    std::array<uint8_t, 4> buf{};
+    ASSERT_EQ(i2c.mem_read_it(buf, 0x10, DEV_ADDR), I2cStatus::OK);
+    run_irqs();
+    EXPECT_TRUE(i2c.trace().records().empty());
+    EXPECT_EQ(i2c.trace().find(DEV_ADDR), nullptr);
+}
+
+TEST_F(StI2cTest, BlockingNackReleasesTheBus)
+{
+    fake.inject_nack(DEV_ADDR, 1);
+    std::array<uint8_t, 4> buf{};
+    EXPECT_EQ(i2c.mem_read(buf, static_cast<uint8_t>(0x10), DEV_ADDR),
+              I2cStatus::NACK);
+    EXPECT_FALSE(I2C1->ISR & (I2C_ISR_BUSY | I2C_ISR_NACKF | I2C_ISR_STOPF));
+    EXPECT_EQ(i2c.mem_read(buf, static_cast<uint8_t>(0x10), DEV_ADDR),
+              I2cStatus::OK);
+}
+
+}  // namespace
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include <array>
+#include "fake_i2c.h"
+#include "fake_l4.h"
+#include "st_i2c.h"
+#include "stm32l4xx_hal.h"
+
+using namespace LBR;
+using namespace LBR::Stml4;
+
+namespace
+{
+
+constexpr uint8_t DEV_ADDR = 0x28;
+constexpr uint32_t CYCLES_PER_IRQ = 100;
+
+static_assert(I2cTrace::ENABLED);
+
+// Plain register file, reads back what was written
+class RegFile : public Sim::SimI2cDevice
+{
+public:
+    I2cStatus read(uint16_t reg_addr, std::span<uint8_t> data) override
+    {
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            data[i] = regs[(reg_addr + i) % regs.size()];
+        }
+        return I2cStatus::OK;
+    }
+
+    I2cStatus write(uint16_t reg_addr, std::span<const uint8_t> data) override
+    {
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            regs[(reg_addr + i) % regs.size()] = data[i];
+        }
+        return I2cStatus::OK;
+    }
+
+    std::array<uint8_t, 256> regs{};
+};
+
+class StI2cTraceTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Native::reset();
+        ASSERT_TRUE(fake.attach(dev, DEV_ADDR));
+        ASSERT_TRUE(i2c.init());
+    }
+
+    /* Runs the event handler while it has work, the cycle counter moves
+     * CYCLES_PER_IRQ ahead of each call. Returns the number of calls. */
+    uint32_t run_irqs()
+    {
+        uint32_t calls = 0;
+        while (fake.ev_pending() && calls < 1000)
+        {
+            DWT->CYCCNT += CYCLES_PER_IRQ;
+            i2c.ev_irq_handler();
+            calls++;
+        }
+        return calls;
+    }
+
+    Native::FakeI2c fake{*I2C1};
+    RegFile dev;
+    HwI2c i2c{StI2cParams{I2C1, 0x10909CEC, false, 10, nullptr, nullptr,
+                          HAL_GetTick}};
+};
+
+TEST_F(StI2cTraceTest, InitStartsTheCycleCounter)
+{
+    EXPECT_TRUE(CoreDebug->DEMCR & CoreDebug_DEMCR_TRCENA_Msk);
+    EXPECT_TRUE(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk);
+}
+
+TEST_F(StI2cTraceTest, ItReadRecordsItsPhasesInOrder)
+{
+    std::array<uint8_t, 6> buf{};
+    DWT->CYCCNT = 5000;
+    ASSERT_EQ(i2c.mem_read_it(buf, 0x10, DEV_ADDR), I2cStatus::OK);
+    const uint32_t calls = run_irqs();
+    ASSERT_EQ(i2c.get_xfer_state(), I2cXferState::DONE);
+
+    // Register byte, restart, one call per byte, the last one with STOPF
+    EXPECT_EQ(calls, 2u + buf.size());
+
+    const std::span<const I2cTraceRecord> records = i2c.trace().records();
+    ASSERT_EQ(records.size(), 1u);
+    const I2cTraceRecord& rec = records[0];
+    EXPECT_EQ(rec.start, 5000u);
+    // The address went out on the first call, TXIS for the register byte
+    EXPECT_EQ(rec.address, CYCLES_PER_IRQ);
+    // Last byte and STOP are seen by the same call
+    EXPECT_EQ(rec.data, calls * CYCLES_PER_IRQ);
+    EXPECT_EQ(rec.stop, calls * CYCLES_PER_IRQ);
+    EXPECT_EQ(rec.dev_addr, DEV_ADDR);
+    EXPECT_EQ(rec.bytes, buf.size());
+    EXPECT_EQ(rec.status, I2cStatus::OK);
+
+    const I2cTraceDevice* stats = i2c.trace().find(DEV_ADDR);
+    ASSERT_NE(stats, nullptr);
+    EXPECT_EQ(stats->count, 1u);
+    EXPECT_EQ(stats->bytes, buf.size());
+    EXPECT_EQ(stats->total_cycles, calls * CYCLES_PER_IRQ);
+    // 800 cycles at 80 MHz is 10 us, the [8, 16) us bucket
+    EXPECT_EQ(stats->hist[3], 1u);
+}
+
+TEST_F(StI2cTraceTest, NackIsFiledAgainstTheTarget)
+{
+    fake.inject_nack(DEV_ADDR, 1);
+    std::array<uint8_t, 2> buf{};
+    ASSERT_EQ(i2c.mem_read_it(buf, 0x10, DEV_ADDR), I2cStatus::OK);
+    run_irqs();
+
+    const std::span<const I2cTraceRecord> records = i2c.trace().records();
+    ASSERT_EQ(records.size(), 1u);
+    EXPECT_EQ(records[0].status, I2cStatus::NACK);
+    EXPECT_EQ(records[0].address, 0u);
+    EXPECT_GT(records[0].stop, 0u);
+    EXPECT_EQ(i2c.trace().find(DEV_ADDR)->nacks, 1u);
+}
+
+}  // namespace
@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+// Ahead of the device headers, CMSIS defines __I and __O
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+#include "fake_exti.h"
+#include "fake_l4.h"
+#include "st_quad_decoder.h"
+
+using namespace LBR;
+using namespace LBR::Stml4;
+
+namespace
+{
+
+// The PPS board's encoder pins
+constexpr uint8_t PIN_A = 4;
+constexpr uint8_t PIN_B = 5;
+
+const StGpioSettings ENC_PIN{GpioMode::INPUT, GpioOtype::PUSH_PULL,
+                             GpioOspeed::LOW, GpioPupd::NO_PULL, 0};
+
+// B A states in forward order
+constexpr uint32_t FORWARD[4] = {0b00, 0b01, 0b11, 0b10};
+
+class StQuadDecoderTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Native::reset();
+        ASSERT_TRUE(dec.init());
+    }
+
+    // Both pins move before either interrupt runs, like a missed edge
+    void set_ab(uint32_t state)
+    {
+        exti.set_pin(*GPIOC, PIN_A, state & 1u);
+        exti.set_pin(*GPIOC, PIN_B, state & 2u);
+        dispatch();
+    }
+
+    // What the board's EXTI4 and EXTI9_5 handlers do
+    void dispatch()
+    {
+        for (int n = 0; exti.pending(); n++)
+        {
+            ASSERT_LT(n, 10) << "interrupt storm";
+            HwGpio::exti_irq_handler(4, 4);
+            HwGpio::exti_irq_handler(5, 9);
+        }
+    }
+
+    void turn(int cycles)
+    {
+        const int dir = (cycles > 0) ? 1 : -1;
+        for (int i = 0; i != cycles * 4; i += dir)
+        {
+            pos_ = (pos_ + 4 + dir) % 4;
+            set_ab(FORWARD[pos_]);
+        }
+    }
+
+    Native::FakeExti exti{*EXTI};
+    HwQuadDecoder dec{StQuadDecoderParams{
+        {ENC_PIN, PIN_A, GPIOC}, {ENC_PIN, PIN_B, GPIOC}, 0}};
+    int pos_{0};
+};
+
+TEST_F(StQuadDecoderTest, InitArmsBothEdgesOfBothLines)
+{
+    const uint32_t lines = (1u << PIN_A) | (1u << PIN_B);
+    EXPECT_EQ(EXTI->IMR1 & lines, lines);
+    EXPECT_EQ(EXTI->RTSR1 & lines, lines);
+    EXPECT_EQ(EXTI->FTSR1 & lines, lines);
+    // Port C is code 2 in EXTICR2 for lines 4 and 5
+    EXPECT_EQ(SYSCFG->EXTICR[1] & 0xFFu, 0x22u);
+    EXPECT_TRUE(NVIC_GetEnableIRQ(EXTI4_IRQn));
+    EXPECT_TRUE(NVIC_GetEnableIRQ(EXTI9_5_IRQn));
+    EXPECT_EQ(dec.getStatus(), 0);
+}
+
+TEST_F(StQuadDecoderTest, CountsEveryEdgeBothWays)
+{
+    turn(10);
+    EXPECT_EQ(dec.getTicks(), 40);
+    turn(-25);
+    EXPECT_EQ(dec.getTicks(), -60);
+    EXPECT_EQ(dec.illegal_transitions(), 0u);
+    // Each edge was served and cleared
+    EXPECT_EQ(static_cast<uint32_t>(EXTI->PR1), 0u);
+}
+
+TEST_F(StQuadDecoderTest, DoubleStepIsCountedNotGuessed)
+{
+    turn(1);
+    set_ab(0b11);
+    EXPECT_EQ(dec.getTicks(), 4);
+    EXPECT_EQ(dec.illegal_transitions(), 1u);
+
+    // Tracking resumes from the new state
+    set_ab(0b10);
+    EXPECT_EQ(dec.getTicks(), 5);
+}
+
+TEST_F(StQuadDecoderTest, BounceBackIsNotCounted)
+{
+    set_ab(0b01);
+    set_ab(0b00);
+    set_ab(0b01);
+    EXPECT_EQ(dec.getTicks(), 1);
+    EXPECT_EQ(dec.illegal_transitions(), 0u);
+}
+
+TEST_F(StQuadDecoderTest, EdgeIsStamped)
+{
+    EncoderEdge edge{};
+    EXPECT_FALSE(dec.getEdge(edge));
+
+    DWT->CYCCNT = 1000;
+    set_ab(0b10);
+    DWT->CYCCNT = 2000;
+    ASSERT_TRUE(dec.getEdge(edge));
+    EXPECT_EQ(edge.ticks, -1);
+    EXPECT_EQ(edge.time, 1000u);
+    EXPECT_EQ(edge.now, 2000u);
+}
+
+// Host cost of one edge, printed for comparison with the M4 budget
+TEST_F(StQuadDecoderTest, CyclesPerEdge)
+{
+    constexpr size_t EDGES = 1 << 20;
+    std::mt19937 rng(7);
+    std::bernoulli_distribution forward(0.6);
+    std::vector<uint32_t> states;
+    int expected = 0;
+    // Ends where it started so the walk can be fed twice
+    while (states.size() < EDGES || pos_ != 0)
+    {
+        const int dir = (states.size() >= EDGES || forward(rng)) ? 1 : -1;
+        pos_ = (pos_ + 4 + dir) % 4;
+        expected += dir;
+        states.push_back(FORWARD[pos_]);
+    }
+
+    auto run = [&](const char* name, auto&& feed)
+    {
+        const int start_ticks = dec.getTicks();
+        const auto start = std::chrono::steady_clock::now();
+#if defined(__x86_64__)
+        const uint64_t start_tsc = __rdtsc();
+#endif
+        for (const uint32_t state : states)
+        {
+            feed(state);
+        }
+#if defined(__x86_64__)
+        const double cycles =
+            static_cast<double>(__rdtsc() - start_tsc) / states.size();
+#else
+        const double cycles = 0.0;
+#endif
+        const double ns = std::chrono::duration<double, std::nano>(
+                              std::chrono::steady_clock::now() - start)
+                              .count() /
+                          states.size();
+        std::printf("%-9s %7.1f TSC cycles %6.1f ns per edge\n", name,
+                    cycles, ns);
+        EXPECT_EQ(dec.getTicks() - start_ticks, expected) << name;
+        EXPECT_GT(ns, 0.0);
+    };
+
+    // The decoder alone, as the M4 runs it after the EXTI dispatch
+    run("handler", [&](uint32_t state)
+        {
+            GPIOC->IDR = ((state & 1u) << PIN_A) | ((state >> 1) << PIN_B);
+            dec.irq_handler();
+        });
+
+    // Through HwGpio::exti_irq_handler(), host register models included
+    run("dispatch", [&](uint32_t state)
+        {
+            exti.set_pin(*GPIOC, PIN_A, state & 1u);
+            exti.set_pin(*GPIOC, PIN_B, state & 2u);
+            HwGpio::exti_irq_handler(4, 4);
+            HwGpio::exti_irq_handler(5, 9);
+        });
+
+    EXPECT_EQ(dec.illegal_transitions(), 0u);
+}
+
+}  // namespace
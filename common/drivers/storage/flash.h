@@ -0,0 +1,60 @@
+/**
+ * @file flash.h
+ * @brief Flash region driver interface
+ * @date 10/17/2026
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace LBR
+{
+
+/**
+ * @class Flash
+ * @brief Erasable non-volatile region, addressed from its start
+ * @details NOR semantics: erase() sets every byte to ERASED_VALUE and a
+ *          write unit can only be programmed once per erase.
+ */
+class Flash
+{
+public:
+    static constexpr uint8_t ERASED_VALUE = 0xFF;
+
+    /**
+     * @return region size in bytes
+     */
+    virtual size_t size() const = 0;
+
+    /**
+     * @return programming granularity in bytes, write offsets and lengths
+     *         must be multiples of it
+     */
+    virtual size_t write_unit() const = 0;
+
+    /**
+     * @brief Copies bytes out of the region
+     * @return true if success, false if out of range
+     */
+    virtual bool read(size_t offset, std::span<uint8_t> data) = 0;
+
+    /**
+     * @brief Programs erased write units
+     * @return true if success, false if misaligned, out of range, not
+     *         erased or the device reported an error
+     */
+    virtual bool write(size_t offset, std::span<const uint8_t> data) = 0;
+
+    /**
+     * @brief Erases the whole region
+     * @return true if success.
+     */
+    virtual bool erase() = 0;
+
+    virtual ~Flash() = default;
+};
+
+}  // namespace LBR